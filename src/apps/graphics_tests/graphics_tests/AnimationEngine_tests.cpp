@@ -0,0 +1,253 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/AnimationEngine.h>
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/SceneGraph.h>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+using namespace ad::arte::gltf;
+
+
+namespace {
+
+    constexpr float gPi = 3.14159265f;
+
+    /// @brief Add an accessor of floats, in its own buffer view.
+    void addFloats(GltfBuilder & aBuilder, const std::vector<float> & aValues, std::string_view aType)
+    {
+        const std::size_t elementSize = (aType == "SCALAR") ? 1 : (aType == "VEC3" ? 3 : 4);
+        aBuilder.addAccessor(R"("componentType": 5126, "type": ")" + std::string{aType} + "\""
+                             + ", \"bufferView\": " + std::to_string(aBuilder.addView(aValues))
+                             + ", \"count\": " + std::to_string(aValues.size() / elementSize));
+    }
+
+    /// @brief Add a scalar accessor of normalized unsigned bytes, in its own buffer view.
+    void addNormalized(GltfBuilder & aBuilder, const std::vector<std::uint8_t> & aValues)
+    {
+        aBuilder.addAccessor(R"("componentType": 5121, "normalized": true, "type": "SCALAR")"
+                             + std::string{", \"bufferView\": "} + std::to_string(aBuilder.addView(aValues))
+                             + ", \"count\": " + std::to_string(aValues.size()));
+    }
+
+
+    /// @brief Write a glTF with a single animation of 5 channels, each targeting its own root node:
+    /// * node 0 translation, linear over 16 keyframes every 0.25s, x being the squared keyframe index,
+    /// * node 1 rotation, linear from identity to 120 degrees around z, over 1s,
+    /// * node 2 scale, step at 0s, 1s and 2s to uniform scales of 1, 2 and 3,
+    /// * node 3 translation, cubic spline between (0, 0, 0) at 0s and (2, 2, 0) at 2s,
+    /// * node 4 morph weights of 2 targets, linear from (1, 0) to (0, 1) over 1s, stored as normalized bytes.
+    filesystem::path writeAnimation()
+    {
+        GltfBuilder builder;
+
+        std::vector<float> times16, translations16;
+        for (int keyframe = 0; keyframe != 16; ++keyframe)
+        {
+            times16.push_back(0.25f * keyframe);
+            translations16.insert(translations16.end(), {float(keyframe * keyframe), 0.f, 0.f});
+        }
+        addFloats(builder, times16, "SCALAR");        // 0
+        addFloats(builder, translations16, "VEC3");   // 1
+        addFloats(builder, {0.f, 1.f}, "SCALAR");     // 2
+        addFloats(builder, {0.f, 0.f, 0.f, 1.f,
+                            0.f, 0.f, std::sin(gPi / 3.f), std::cos(gPi / 3.f)}, "VEC4"); // 3
+        addFloats(builder, {0.f, 1.f, 2.f}, "SCALAR");                                      // 4
+        addFloats(builder, {1.f, 1.f, 1.f,  2.f, 2.f, 2.f,  3.f, 3.f, 3.f}, "VEC3");        // 5
+        addFloats(builder, {0.f, 2.f}, "SCALAR");                                           // 6
+        // (in-tangent, value, out-tangent) for each keyframe.
+        addFloats(builder, {9.f, 9.f, 9.f,  0.f, 0.f, 0.f,  4.f, 0.f, 0.f,
+                            0.f, 4.f, 0.f,  2.f, 2.f, 0.f,  9.f, 9.f, 9.f}, "VEC3");        // 7
+        addNormalized(builder, {255, 0,  0, 255});                                          // 8
+
+        return builder.write("animation_engine_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0, 1, 2, 3, 4]}],)"
+            R"("nodes": [{}, {}, {}, {}, {}],)"
+            R"("animations": [{"channels": [)"
+            R"({"sampler": 0, "target": {"node": 0, "path": "translation"}},)"
+            R"({"sampler": 1, "target": {"node": 1, "path": "rotation"}},)"
+            R"({"sampler": 2, "target": {"node": 2, "path": "scale"}},)"
+            R"({"sampler": 3, "target": {"node": 3, "path": "translation"}},)"
+            R"({"sampler": 4, "target": {"node": 4, "path": "weights"}}],)"
+            R"("samplers": [)"
+            R"({"input": 0, "output": 1},)"
+            R"({"input": 2, "output": 3, "interpolation": "LINEAR"},)"
+            R"({"input": 4, "output": 5, "interpolation": "STEP"},)"
+            R"({"input": 6, "output": 7, "interpolation": "CUBICSPLINE"},)"
+            R"({"input": 2, "output": 8}]}],)"
+            R"("meshes": [])");
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Animation evaluation")
+{
+    GIVEN("An animation with linear, step and cubic spline channels")
+    {
+        initializeLogging();
+        const Gltf gltf{writeAnimation()};
+        BufferCache buffers{gltf};
+        AnimationEngine engine{gltf, buffers};
+        SceneGraph scene{gltf, Index<Scene>{0}};
+        const SceneGraph::TrsArrays & poses = scene.getLocalPoses();
+        auto id = [&scene](std::size_t aNode){ return *scene.find(Index<Node>{aNode}); };
+
+        AnimationEngine::Instance instance = engine.instantiate(Index<Animation>{0}, scene);
+        auto evaluateAt = [&](float aTime)
+        {
+            instance.time = aTime;
+            engine.evaluate(std::span{&instance, 1}, false);
+        };
+
+        THEN("The clip tracks are extracted from the accessors")
+        {
+            const AnimationEngine::Clip & clip = engine.getClip(Index<Animation>{0});
+            REQUIRE(clip.duration == 3.75f);
+            REQUIRE(clip.tracks.size() == 5);
+            REQUIRE(clip.tracks[0].componentCount == 3);
+            REQUIRE(clip.tracks[1].componentCount == 4);
+            REQUIRE(clip.tracks[3].values.size() == 2 * 3 * 3);
+            REQUIRE(clip.tracks[4].componentCount == 2);
+            // Normalized bytes
+            REQUIRE(clip.tracks[4].values == std::vector<float>{1.f, 0.f, 0.f, 1.f});
+        }
+
+        WHEN("Time advances forward by small steps")
+        {
+            std::size_t cursorMismatches = 0;
+            std::size_t valueMismatches = 0;
+            for (int step = 0; step != 40; ++step)
+            {
+                const float time = 0.1f * step;
+                evaluateAt(time);
+                const auto keyframe = std::min(15u, static_cast<unsigned int>(time / 0.25f));
+                cursorMismatches += (instance.cursors[0] != keyframe) ? 1 : 0;
+
+                const float u = std::min(1.f, (time - 0.25f * keyframe) / 0.25f);
+                const float expected = (keyframe == 15) ?
+                    225.f
+                    : float(keyframe * keyframe) + u * float(2 * keyframe + 1);
+                valueMismatches += (poses.tx[id(0)] != Approx(expected).margin(1e-4f)) ? 1 : 0;
+            }
+
+            THEN("The cursor follows the keyframe preceding the time, and translations are interpolated")
+            {
+                REQUIRE(cursorMismatches == 0);
+                REQUIRE(valueMismatches == 0);
+            }
+        }
+
+        WHEN("Time jumps far forward, then wraps around")
+        {
+            evaluateAt(0.1f);
+            evaluateAt(3.3f);
+            const std::uint32_t forwardCursor = instance.cursors[0];
+            const float forwardValue = poses.tx[id(0)];
+            evaluateAt(0.3f);
+            const std::uint32_t wrappedCursor = instance.cursors[0];
+            const float wrappedValue = poses.tx[id(0)];
+            evaluateAt(10.f);
+
+            THEN("The cursor is found by searching, and times past the end are clamped")
+            {
+                REQUIRE(forwardCursor == 13);
+                REQUIRE(forwardValue == Approx(169.f + 0.2f * 27.f));
+                REQUIRE(wrappedCursor == 1);
+                REQUIRE(wrappedValue == Approx(1.f + 0.2f * 3.f));
+                REQUIRE(instance.cursors[0] == 15);
+                REQUIRE(poses.tx[id(0)] == 225.f);
+            }
+        }
+
+        WHEN("Step channels are evaluated")
+        {
+            std::vector<float> scales;
+            for (float time : {0.f, 0.99f, 1.f, 1.5f, 2.5f})
+            {
+                evaluateAt(time);
+                scales.push_back(poses.sx[id(2)]);
+                REQUIRE(poses.sz[id(2)] == poses.sx[id(2)]);
+            }
+
+            THEN("The value of the preceding keyframe is held")
+            {
+                REQUIRE(scales == std::vector<float>{1.f, 1.f, 2.f, 2.f, 3.f});
+            }
+        }
+
+        WHEN("Cubic spline channels are evaluated")
+        {
+            evaluateAt(1.f);
+
+            THEN("The Hermite basis is applied to the values and the tangents scaled by the keyframe delta")
+            {
+                // u = 0.5, delta = 2: h00 = 0.5, h10 = 0.25, h01 = 0.5, h11 = -0.25
+                // x = 0.25 * 4 + 0.5 * 2, y = 0.5 * 2 - 0.25 * 4
+                REQUIRE(poses.tx[id(3)] == Approx(2.f));
+                REQUIRE(poses.ty[id(3)] == Approx(0.f).margin(1e-6f));
+                REQUIRE(poses.tz[id(3)] == Approx(0.f).margin(1e-6f));
+            }
+
+            THEN("Keyframes hold their value, not their tangents")
+            {
+                evaluateAt(0.f);
+                REQUIRE(poses.tx[id(3)] == 0.f);
+                evaluateAt(2.f);
+                REQUIRE(poses.tx[id(3)] == 2.f);
+                REQUIRE(poses.ty[id(3)] == 2.f);
+            }
+        }
+
+        WHEN("Rotations are interpolated a quarter of the way")
+        {
+            engine.rotationInterpolation = AnimationEngine::RotationInterpolation::Slerp;
+            evaluateAt(0.25f);
+            const float slerpZ = poses.rz[id(1)];
+            const float slerpW = poses.rw[id(1)];
+
+            engine.rotationInterpolation = AnimationEngine::RotationInterpolation::Nlerp;
+            evaluateAt(0.25f);
+            const float nlerpZ = poses.rz[id(1)];
+            const float nlerpW = poses.rw[id(1)];
+
+            THEN("Slerp rotates at constant angular velocity, nlerp along the normalized chord")
+            {
+                // A quarter of 120 degrees, so a half-angle of 15 degrees.
+                REQUIRE(slerpZ == Approx(std::sin(gPi / 12.f)));
+                REQUIRE(slerpW == Approx(std::cos(gPi / 12.f)));
+
+                const float chordZ = 0.25f * std::sin(gPi / 3.f);
+                const float chordW = 0.75f + 0.25f * std::cos(gPi / 3.f);
+                const float norm = std::sqrt(chordZ * chordZ + chordW * chordW);
+                REQUIRE(nlerpZ == Approx(chordZ / norm));
+                REQUIRE(nlerpW == Approx(chordW / norm));
+                // The angle differs by more than a degree.
+                REQUIRE(2.f * std::atan2(slerpZ, slerpW) - 2.f * std::atan2(nlerpZ, nlerpW) > gPi / 180.f);
+                REQUIRE(poses.rx[id(1)] == 0.f);
+                REQUIRE(poses.ry[id(1)] == 0.f);
+            }
+        }
+
+        WHEN("Morph target weights are evaluated")
+        {
+            evaluateAt(0.25f);
+
+            THEN("They are interpolated into the instance weights")
+            {
+                REQUIRE(instance.weights.size() == 2);
+                REQUIRE(instance.weights[0] == Approx(0.75f));
+                REQUIRE(instance.weights[1] == Approx(0.25f));
+            }
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#include "catch.hpp"
+
+#include "FilesystemHelpers.h"
+
+#include <graphics/detail/BakedFont.h>
+
+#include <test_commons/PathProvider.h>
+
+#include <algorithm>
+#include <fstream>
+
+
+using namespace ad;
+using namespace ad::graphics::detail;
+
+
+SCENARIO("Baking font atlases to a mapped file")
+{
+    GIVEN("A font face configured as for text rendering")
+    {
+        arte::Freetype freetype;
+        arte::FontFace fontFace = freetype.load(resource::pathFor("fonts/dejavu-fonts-ttf-2.37/DejaVuSans.ttf"));
+        fontFace.inverseYAxis(true);
+        fontFace.setPixelHeight(24);
+
+        const baked::Range ranges[] = {{0x20, 0x7F}, {0xC0, 0x100}};
+        // Small pages, so the glyphs span several of them.
+        const BakedFontSize baked = bakeFontSize(fontFace, ranges, GlyphRasterization::Coverage, {128, 128});
+
+        WHEN("It is written to a file and mapped")
+        {
+            const filesystem::path path = ensureTemporaryImageFolder("graphics_tests") / "DejaVuSans.adfb";
+            writeBakedFont(path, std::vector<BakedFontSizeView>{baked.view()});
+            const BakedFont bakedFont{path};
+
+            THEN("The mapped size is found, with the glyphs rendered at their atlas position")
+            {
+                REQUIRE(bakedFont.find(24, GlyphRasterization::Msdf) == nullptr);
+                const BakedFontSizeView * size = bakedFont.find(24, GlyphRasterization::Coverage);
+                REQUIRE(size != nullptr);
+                REQUIRE(size->pages.size() > 1);
+                REQUIRE(size->glyphs.size() == baked.glyphs.size());
+                REQUIRE(size->ranges.size() == 2);
+                REQUIRE(size->lineHeight == baked.lineHeight);
+
+                std::size_t mismatches = 0;
+                for (const baked::Glyph & glyph : size->glyphs)
+                {
+                    const RasterizedGlyph rasterized = rasterizeGlyph(fontFace, glyph.charCode);
+                    const RenderedGlyph rendered = fromBaked(glyph);
+                    mismatches += (rendered.freetypeIndex != rasterized.freetypeIndex
+                                   || rendered.penAdvance != rasterized.penAdvance) ? 1 : 0;
+
+                    const BakedPageView & page = size->pages.at(glyph.page);
+                    const math::Vec<2, GLint> start = rendered.offsetInTexture + size->margins;
+                    for (GLint row = 0; row != rasterized.resolution.height(); ++row)
+                    {
+                        mismatches += std::equal(
+                            rasterized.bitmap.begin() + row * rasterized.resolution.width(),
+                            rasterized.bitmap.begin() + (row + 1) * rasterized.resolution.width(),
+                            page.pixels.begin() + (start.y() + row) * size->atlasDimension.width() + start.x()) ? 0 : 1;
+                    }
+                }
+                REQUIRE(mismatches == 0);
+            }
+
+            THEN("The kerning pairs are restored without querying the face")
+            {
+                const BakedFontSizeView & size = bakedFont.getSizes().front();
+                REQUIRE(size.kerningPairs.size() == baked.kerningPairs.size());
+
+                const FT_UInt a = fontFace.getGlyphIndex(0x41);
+                const FT_UInt v = fontFace.getGlyphIndex(0x56);
+                REQUIRE(fontFace.kern(a, v).x() != 0.f);
+
+                std::vector<arte::KerningTable::Pair> pairs;
+                for (const baked::KerningPair & pair : size.kerningPairs)
+                {
+                    pairs.push_back({pair.left, pair.right, {pair.offset[0], pair.offset[1]}});
+                }
+                arte::KerningTable kerning;
+                kerning.addPairs(size.eagerGlyphs, pairs);
+                REQUIRE(kerning.hasKerning());
+                REQUIRE(kerning.get(a, v, fontFace) == fontFace.kern(a, v));
+                REQUIRE(kerning.size() == baked.kerningPairs.size());
+            }
+        }
+
+        WHEN("A truncated file is mapped")
+        {
+            const filesystem::path path = ensureTemporaryImageFolder("graphics_tests") / "truncated.adfb";
+            writeBakedFont(path, std::vector<BakedFontSizeView>{baked.view()});
+            filesystem::resize_file(path, 256);
+
+            THEN("It is rejected")
+            {
+                REQUIRE_THROWS_AS(BakedFont{path}, std::runtime_error);
+            }
+        }
+
+        WHEN("Files with invalid code point ranges are mapped")
+        {
+            const filesystem::path path = ensureTemporaryImageFolder("graphics_tests") / "invalid_range.adfb";
+            auto writeWithRange = [&](baked::Range aRange)
+            {
+                BakedFontSizeView view = baked.view();
+                view.ranges = {&aRange, 1};
+                writeBakedFont(path, std::vector<BakedFontSizeView>{view});
+            };
+
+            THEN("Empty, reversed and oversized ranges are rejected")
+            {
+                writeWithRange({0x20, 0x20});
+                REQUIRE_THROWS_AS(BakedFont{path}, std::runtime_error);
+                writeWithRange({0x7F, 0x20});
+                REQUIRE_THROWS_AS(BakedFont{path}, std::runtime_error);
+                writeWithRange({0x20, 0xFFFFFFFF});
+                REQUIRE_THROWS_AS(BakedFont{path}, std::runtime_error);
+
+                writeWithRange({0x20, baked::gCodePointEnd});
+                REQUIRE_NOTHROW(BakedFont{path});
+            }
+        }
+    }
+}
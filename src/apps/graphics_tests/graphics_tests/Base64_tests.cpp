@@ -0,0 +1,145 @@
+#include "catch.hpp"
+
+#include <arte/detail/Base64.h>
+#include <arte/detail/MemoryStream.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    std::string encode(const std::vector<std::byte> & aData)
+    {
+        constexpr const char * alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        auto at = [&](std::size_t aIndex) -> std::uint32_t
+        {
+            return aIndex < aData.size() ? std::to_integer<std::uint32_t>(aData[aIndex]) : 0;
+        };
+
+        std::string result;
+        for (std::size_t first = 0; first < aData.size(); first += 3)
+        {
+            const std::uint32_t packed = (at(first) << 16) | (at(first + 1) << 8) | at(first + 2);
+            result += alphabet[packed >> 18];
+            result += alphabet[(packed >> 12) & 0x3F];
+            result += (first + 1 < aData.size()) ? alphabet[(packed >> 6) & 0x3F] : '=';
+            result += (first + 2 < aData.size()) ? alphabet[packed & 0x3F] : '=';
+        }
+        return result;
+    }
+
+
+    std::vector<std::byte> makeRandomBytes(std::size_t aCount)
+    {
+        std::mt19937 generator{static_cast<std::mt19937::result_type>(aCount)};
+        std::vector<std::byte> result(aCount);
+        for (std::byte & value : result)
+        {
+            value = static_cast<std::byte>(generator());
+        }
+        return result;
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Base64 decoding")
+{
+    GIVEN("Random data of lengths covering the vectorized blocks and the scalar tail")
+    {
+        THEN("Decoding the encoded data restores it")
+        {
+            for (std::size_t length = 0; length != 200; ++length)
+            {
+                std::vector<std::byte> data = makeRandomBytes(length);
+                std::string encoded = encode(data);
+
+                REQUIRE(detail::getDecodedSize(encoded) == length);
+
+                std::vector<std::byte> decoded(length);
+                REQUIRE(detail::decodeBase64(encoded, decoded) == length);
+                REQUIRE(decoded == data);
+
+                // Without padding
+                std::string unpadded = encoded.substr(0, encoded.find('='));
+                REQUIRE(detail::getDecodedSize(unpadded) == length);
+                std::vector<std::byte> decodedUnpadded(length);
+                detail::decodeBase64(unpadded, decodedUnpadded);
+                REQUIRE(decodedUnpadded == data);
+            }
+        }
+    }
+
+    GIVEN("Encoded data containing a character outside of the alphabet")
+    {
+        std::string encoded = encode(makeRandomBytes(150));
+        std::vector<std::byte> decoded(150);
+
+        THEN("Decoding throws, wherever the character is")
+        {
+            for (std::size_t position : {3, 40, 100, 198})
+            {
+                std::string corrupted = encoded;
+                corrupted[position] = '\n';
+                REQUIRE_THROWS_AS(detail::decodeBase64(corrupted, decoded), std::invalid_argument);
+            }
+        }
+    }
+
+    GIVEN("An output smaller than the decoded size")
+    {
+        std::string encoded = encode(makeRandomBytes(64));
+        std::vector<std::byte> decoded(63);
+
+        THEN("Decoding throws")
+        {
+            REQUIRE_THROWS_AS(detail::decodeBase64(encoded, decoded), std::invalid_argument);
+        }
+    }
+}
+
+
+SCENARIO("Memory streams")
+{
+    GIVEN("A memory stream over some bytes")
+    {
+        std::vector<std::byte> data = makeRandomBytes(32);
+        detail::MemoryIstream stream{data};
+
+        THEN("It reads and seeks like a file stream")
+        {
+            char read[8];
+            stream.read(read, 8);
+            REQUIRE(std::memcmp(read, data.data(), 8) == 0);
+
+            stream.seekg(16, std::ios_base::cur);
+            REQUIRE(stream.tellg() == 24);
+            stream.read(read, 8);
+            REQUIRE(std::memcmp(read, data.data() + 24, 8) == 0);
+
+            stream.read(read, 1);
+            REQUIRE(stream.eof());
+        }
+    }
+}
+
+
+TEST_CASE("Base64 decoding throughput", "[!benchmark]")
+{
+    const std::size_t byteCount = 16 * 1024 * 1024;
+    std::string encoded = encode(makeRandomBytes(byteCount));
+    std::vector<std::byte> decoded(byteCount);
+
+    // Divide the mean time by the encoded size (about 22 MB) for the throughput.
+    BENCHMARK("Decode 16 MB")
+    {
+        return detail::decodeBase64(encoded, decoded);
+    };
+}
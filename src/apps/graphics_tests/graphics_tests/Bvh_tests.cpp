@@ -0,0 +1,398 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Bvh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+using namespace ad::arte::gltf;
+
+
+namespace {
+
+    std::vector<Aabb> makeRandomBoxes(std::size_t aCount, std::mt19937 & aRandom)
+    {
+        std::uniform_real_distribution<float> center{-500.f, 500.f};
+        std::uniform_real_distribution<float> halfExtent{0.5f, 3.f};
+        std::vector<Aabb> boxes;
+        for (std::size_t box = 0; box != aCount; ++box)
+        {
+            const float x = center(aRandom), y = center(aRandom), z = center(aRandom), extent = halfExtent(aRandom);
+            boxes.push_back({{x - extent, y - extent, z - extent}, {x + extent, y + extent, z + extent}});
+        }
+        return boxes;
+    }
+
+    /// @brief Perspective projection looking down -z from the origin, as a row-vector matrix.
+    Frustum makePerspectiveFrustum()
+    {
+        const float f = 1.f / std::tan(0.5f * 1.2f); // 1.2 radians vertical field of view
+        const float near = 1.f, far = 400.f;
+        const float matrix[16] = {
+            f,   0.f, 0.f,                             0.f,
+            0.f, f,   0.f,                             0.f,
+            0.f, 0.f, (far + near) / (near - far),     -1.f,
+            0.f, 0.f, 2.f * far * near / (near - far), 0.f,
+        };
+        return Frustum::FromViewProjection(std::span<const float, 16>{matrix});
+    }
+
+    /// @brief Brute force conservative culling: a box is kept unless it is fully outside a plane.
+    std::vector<std::uint32_t> cullBruteForce(const Frustum & aFrustum, std::span<const Aabb> aBoxes)
+    {
+        std::vector<std::uint32_t> visible;
+        for (std::uint32_t boxId = 0; boxId != aBoxes.size(); ++boxId)
+        {
+            const Aabb & box = aBoxes[boxId];
+            bool outside = false;
+            for (const auto & [a, b, c, d] : aFrustum.planes)
+            {
+                outside |= a * (a >= 0.f ? box.max[0] : box.min[0])
+                         + b * (b >= 0.f ? box.max[1] : box.min[1])
+                         + c * (c >= 0.f ? box.max[2] : box.min[2]) + d < 0.f;
+            }
+            if (!outside)
+            {
+                visible.push_back(boxId);
+            }
+        }
+        return visible;
+    }
+
+    std::vector<std::uint32_t> cullSorted(const Bvh & aBvh, const Frustum & aFrustum, std::span<const Aabb> aBoxes)
+    {
+        std::vector<std::uint32_t> visible;
+        aBvh.cull(aFrustum, aBoxes, visible);
+        std::sort(visible.begin(), visible.end());
+        return visible;
+    }
+
+    /// @brief Brute force slab test against all boxes, returns the closest entry distance.
+    std::optional<float> pickBruteForce(const Ray & aRay, std::span<const Aabb> aBoxes)
+    {
+        std::optional<float> closest;
+        for (const Aabb & box : aBoxes)
+        {
+            float near = 0.f;
+            float far = std::numeric_limits<float>::infinity();
+            for (std::size_t axis = 0; axis != 3; ++axis)
+            {
+                float t0 = (box.min[axis] - aRay.origin[axis]) / aRay.direction[axis];
+                float t1 = (box.max[axis] - aRay.origin[axis]) / aRay.direction[axis];
+                near = std::max(near, std::min(t0, t1));
+                far = std::min(far, std::max(t0, t1));
+            }
+            if (near <= far && (!closest || near < *closest))
+            {
+                closest = near;
+            }
+        }
+        return closest;
+    }
+
+    std::size_t countPickMismatches(const Bvh & aBvh, std::span<const Aabb> aBoxes, std::mt19937 & aRandom)
+    {
+        std::uniform_real_distribution<float> coordinate{-600.f, 600.f};
+        std::normal_distribution<float> direction;
+
+        std::size_t mismatches = 0;
+        for (std::size_t rayId = 0; rayId != 200; ++rayId)
+        {
+            Ray ray{{coordinate(aRandom), coordinate(aRandom), coordinate(aRandom)}, {}};
+            // Aim close to the center, so most rays hit something.
+            for (std::size_t axis = 0; axis != 3; ++axis)
+            {
+                ray.direction[axis] = -ray.origin[axis] + 50.f * direction(aRandom);
+            }
+
+            const std::optional<Bvh::Hit> hit = aBvh.pick(ray, aBoxes);
+            const std::optional<float> expected = pickBruteForce(ray, aBoxes);
+            if (hit.has_value() != expected.has_value()
+                || (hit && hit->distance != Approx(*expected).margin(1e-6f)))
+            {
+                ++mismatches;
+            }
+        }
+        return mismatches;
+    }
+
+    /// @brief Count the nodes whose bounds are not exactly the union of their boxes.
+    std::size_t countLooseNodes(const Bvh & aBvh, std::span<const Aabb> aBoxes)
+    {
+        std::size_t loose = 0;
+        for (const Bvh::Node & node : aBvh.getNodes())
+        {
+            Aabb bounds = Aabb::Empty();
+            for (std::uint32_t position = node.first; position != node.first + node.count; ++position)
+            {
+                bounds.extend(aBoxes[aBvh.getOrder()[position]]);
+            }
+            loose += (bounds != node.bounds) ? 1 : 0;
+        }
+        return loose;
+    }
+
+    /// @brief Write a glTF with two mesh instances, and a node without mesh:
+    /// * node 0 instantiates mesh 0 (bounds [-1, 1] given by its accessor), translated by (0, 0, -10),
+    /// * node 1, translated by (0, 0, -20), has child node 2 instantiating mesh 1 (positions in [-0.5, 0.5]
+    ///   without accessor bounds), translated by (5, 0, 0),
+    /// * node 3 has no mesh.
+    filesystem::path writeInstances()
+    {
+        const std::vector<float> cube{-1.f, -1.f, -1.f,  1.f, 1.f, 1.f,  1.f, -1.f, 0.f};
+        const std::vector<float> smallCube{-0.5f, -0.5f, -0.5f,  0.5f, 0.5f, 0.5f,  0.f, 0.5f, 0.f};
+
+        GltfBuilder builder;
+        builder.addAccessor(R"("componentType": 5126, "type": "VEC3", "count": 3, "min": [-1, -1, -1], "max": [1, 1, 1])"
+                            R"(, "bufferView": )" + std::to_string(builder.addView(cube)));
+        builder.addAccessor(R"("componentType": 5126, "type": "VEC3", "count": 3, "bufferView": )"
+                            + std::to_string(builder.addView(smallCube)));
+
+        return builder.write("bvh_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0, 1, 3]}],)"
+            R"("nodes": [)"
+               R"({"mesh": 0, "translation": [0, 0, -10]},)"
+               R"({"translation": [0, 0, -20], "children": [2]},)"
+               R"({"mesh": 1, "translation": [5, 0, 0]},)"
+               R"({}],)"
+            R"("meshes": [{"primitives": [{"attributes": {"POSITION": 0}}]}, {"primitives": [{"attributes": {"POSITION": 1}}]}])");
+    }
+
+    /// @brief The index in `aBvh.getInstances()` of the instance on glTF node `aNode`.
+    std::uint32_t findInstance(const SceneBvh & aBvh, const SceneGraph & aScene, Index<Node> aNode)
+    {
+        const std::span<const SceneBvh::Instance> instances = aBvh.getInstances();
+        auto found = std::find_if(instances.begin(), instances.end(),
+                                  [&](const SceneBvh::Instance & aInstance)
+                                  { return aScene.getNode(aInstance.node) == aNode; });
+        REQUIRE(found != instances.end());
+        return static_cast<std::uint32_t>(found - instances.begin());
+    }
+
+    Aabb makeBox(std::array<float, 3> aCenter, float aHalfExtent)
+    {
+        return {{aCenter[0] - aHalfExtent, aCenter[1] - aHalfExtent, aCenter[2] - aHalfExtent},
+                {aCenter[0] + aHalfExtent, aCenter[1] + aHalfExtent, aCenter[2] + aHalfExtent}};
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Bounding volume hierarchy queries")
+{
+    std::mt19937 random{11};
+
+    GIVEN("A hierarchy over random boxes")
+    {
+        std::vector<Aabb> boxes = makeRandomBoxes(20000, random);
+        Bvh bvh{boxes};
+        const Frustum frustum = makePerspectiveFrustum();
+
+        THEN("Culling and picking match brute force searches")
+        {
+            const std::vector<std::uint32_t> visible = cullSorted(bvh, frustum, boxes);
+            REQUIRE(!visible.empty());
+            REQUIRE(visible.size() < boxes.size() / 2);
+            REQUIRE(visible == cullBruteForce(frustum, boxes));
+            REQUIRE(countPickMismatches(bvh, boxes, random) == 0);
+        }
+
+        WHEN("Some boxes move and the hierarchy is refit")
+        {
+            std::uniform_int_distribution<std::uint32_t> pickBox{0, static_cast<std::uint32_t>(boxes.size() - 1)};
+            std::uniform_real_distribution<float> offset{-50.f, 50.f};
+            std::vector<std::uint32_t> changed;
+            for (std::size_t move = 0; move != 500; ++move)
+            {
+                const std::uint32_t boxId = pickBox(random);
+                for (std::size_t axis = 0; axis != 3; ++axis)
+                {
+                    const float delta = offset(random);
+                    boxes[boxId].min[axis] += delta;
+                    boxes[boxId].max[axis] += delta;
+                }
+                changed.push_back(boxId);
+            }
+            bvh.refit(boxes, changed);
+
+            THEN("All nodes tightly bound their boxes, and queries still match brute force searches")
+            {
+                REQUIRE(countLooseNodes(bvh, boxes) == 0);
+                REQUIRE(cullSorted(bvh, frustum, boxes) == cullBruteForce(frustum, boxes));
+                REQUIRE(countPickMismatches(bvh, boxes, random) == 0);
+            }
+        }
+
+        WHEN("All boxes move and the hierarchy is refit")
+        {
+            std::vector<std::uint32_t> changed(boxes.size());
+            std::iota(changed.begin(), changed.end(), 0);
+            for (Aabb & box : boxes)
+            {
+                box.min[1] *= 0.5f;
+                box.max[1] *= 0.5f;
+            }
+            bvh.refit(boxes, changed);
+
+            THEN("All nodes tightly bound their boxes")
+            {
+                REQUIRE(countLooseNodes(bvh, boxes) == 0);
+                REQUIRE(cullSorted(bvh, frustum, boxes) == cullBruteForce(frustum, boxes));
+            }
+        }
+    }
+
+    GIVEN("A hierarchy deeper than the inline traversal stack")
+    {
+        // Boxes growing exponentially along x: each split only peels off the few largest ones.
+        std::vector<Aabb> boxes;
+        for (int exponent = -120; exponent != 126; ++exponent)
+        {
+            const float x = std::ldexp(1.f, exponent);
+            boxes.push_back({{0.75f * x, -0.25f * x, -0.25f * x}, {1.25f * x, 0.25f * x, 0.25f * x}});
+        }
+        const Bvh bvh{boxes};
+
+        THEN("Culling and picking around the smallest boxes match brute force searches")
+        {
+            Frustum frustum;
+            const float bound = std::ldexp(1.f, -100);
+            frustum.planes = {{{1.f, 0.f, 0.f, 0.f}, {-1.f, 0.f, 0.f, bound},
+                               {0.f, 1.f, 0.f, bound}, {0.f, -1.f, 0.f, bound},
+                               {0.f, 0.f, 1.f, bound}, {0.f, 0.f, -1.f, bound}}};
+            const std::vector<std::uint32_t> visible = cullSorted(bvh, frustum, boxes);
+            REQUIRE(visible.size() == 21);
+            REQUIRE(visible == cullBruteForce(frustum, boxes));
+
+            const Ray ray{{-1.f, 0.f, 0.f}, {1.f, 0.f, 0.f}};
+            const std::optional<Bvh::Hit> hit = bvh.pick(ray, boxes);
+            REQUIRE(hit);
+            REQUIRE(hit->box == 0);
+        }
+    }
+}
+
+
+SCENARIO("Scene bounding volume hierarchy")
+{
+    GIVEN("A hierarchy over the mesh instances of a scene graph")
+    {
+        initializeLogging();
+        const Gltf gltf{writeInstances()};
+        BufferCache buffers{gltf};
+        SceneGraph scene{gltf, Index<Scene>{0}};
+        SceneBvh bvh{buffers, scene};
+
+        const std::uint32_t near = findInstance(bvh, scene, Index<Node>{0});
+        const std::uint32_t child = findInstance(bvh, scene, Index<Node>{2});
+        const Frustum frustum = makePerspectiveFrustum();
+        std::vector<std::uint32_t> visible;
+
+        THEN("There is one instance per node with a mesh, bounded in world space")
+        {
+            REQUIRE(bvh.getInstances().size() == 2);
+            CHECK(bvh.getInstances()[near].mesh == Index<Mesh>{0});
+            CHECK(bvh.getInstances()[child].mesh == Index<Mesh>{1});
+            CHECK(bvh.getWorldBounds()[near] == makeBox({0.f, 0.f, -10.f}, 1.f));
+            CHECK(bvh.getWorldBounds()[child] == makeBox({5.f, 0.f, -20.f}, 0.5f));
+        }
+
+        THEN("Both instances are visible, and picked along the view axis")
+        {
+            bvh.cull(frustum, visible);
+            std::sort(visible.begin(), visible.end());
+            CHECK(visible == std::vector<std::uint32_t>{0, 1});
+
+            const std::optional<Bvh::Hit> hit = bvh.pick(Ray{{0.f, 0.f, 0.f}, {0.f, 0.f, -1.f}});
+            REQUIRE(hit);
+            CHECK(hit->box == near);
+            CHECK(hit->distance == Approx(9.f));
+
+            const std::optional<Bvh::Hit> childHit = bvh.pick(Ray{{5.f, 0.f, 0.f}, {0.f, 0.f, -1.f}});
+            REQUIRE(childHit);
+            CHECK(childHit->box == child);
+            CHECK(childHit->distance == Approx(19.5f));
+        }
+
+        WHEN("The first instance moves behind the camera, the parent of the other deeper, and the hierarchy is refit")
+        {
+            scene.setTranslation(*scene.find(Index<Node>{0}), 0.f, 0.f, 10.f);
+            scene.setTranslation(*scene.find(Index<Node>{1}), 0.f, 0.f, -30.f);
+            scene.update();
+            bvh.refit();
+
+            THEN("The world bounds follow the instances")
+            {
+                CHECK(bvh.getWorldBounds()[near] == makeBox({0.f, 0.f, 10.f}, 1.f));
+                CHECK(bvh.getWorldBounds()[child] == makeBox({5.f, 0.f, -30.f}, 0.5f));
+            }
+
+            THEN("Only the other instance is visible")
+            {
+                bvh.cull(frustum, visible);
+                CHECK(visible == std::vector<std::uint32_t>{child});
+            }
+
+            THEN("Picking finds the instances at their new positions")
+            {
+                CHECK_FALSE(bvh.pick(Ray{{0.f, 0.f, 0.f}, {0.f, 0.f, -1.f}}));
+
+                const std::optional<Bvh::Hit> behind = bvh.pick(Ray{{0.f, 0.f, 0.f}, {0.f, 0.f, 1.f}});
+                REQUIRE(behind);
+                CHECK(behind->box == near);
+                CHECK(behind->distance == Approx(9.f));
+
+                const std::optional<Bvh::Hit> childHit = bvh.pick(Ray{{5.f, 0.f, 0.f}, {0.f, 0.f, -1.f}});
+                REQUIRE(childHit);
+                CHECK(childHit->box == child);
+                CHECK(childHit->distance == Approx(29.5f));
+            }
+        }
+    }
+}
+
+TEST_CASE("Bounding volume hierarchy over 100k boxes", "[!benchmark]")
+{
+    std::mt19937 random{11};
+    std::vector<Aabb> boxes = makeRandomBoxes(100000, random);
+    Bvh bvh{boxes};
+    const Frustum frustum = makePerspectiveFrustum();
+    std::vector<std::uint32_t> visible;
+    visible.reserve(boxes.size());
+
+    BENCHMARK("Cull a perspective view")
+    {
+        visible.clear();
+        bvh.cull(frustum, boxes, visible);
+        return visible.size();
+    };
+
+    BENCHMARK("Cull by brute force")
+    {
+        return cullBruteForce(frustum, boxes).size();
+    };
+
+    std::vector<std::uint32_t> changed(1000);
+    std::iota(changed.begin(), changed.end(), 0);
+    BENCHMARK("Refit after 1k boxes moved")
+    {
+        for (std::uint32_t boxId : changed)
+        {
+            boxes[boxId].min[0] += 1.f;
+            boxes[boxId].max[0] += 1.f;
+        }
+        bvh.refit(boxes, changed);
+        return bvh.getNodes()[0].bounds.max[0];
+    };
+}
@@ -0,0 +1,192 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Decomposition.h>
+#include <arte/gltf/Gltf.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+using namespace ad::arte::gltf;
+
+
+namespace {
+
+    void requireEqual(const Affine & aLhs, const Affine & aRhs, float aMargin = 1e-5f)
+    {
+        for (std::size_t element = 0; element != aLhs.elements.size(); ++element)
+        {
+            REQUIRE(aLhs.elements[element] == Approx(aRhs.elements[element]).margin(aMargin));
+        }
+    }
+
+    void requireEqual(const std::array<float, 3> & aLhs, const std::array<float, 3> & aRhs, float aMargin = 1e-5f)
+    {
+        for (std::size_t component = 0; component != 3; ++component)
+        {
+            REQUIRE(aLhs[component] == Approx(aRhs[component]).margin(aMargin));
+        }
+    }
+
+    /// @brief Quaternions q and -q are the same rotation.
+    void requireSameRotation(const std::array<float, 4> & aLhs, const std::array<float, 4> & aRhs)
+    {
+        const float dot = aLhs[0] * aRhs[0] + aLhs[1] * aRhs[1] + aLhs[2] * aRhs[2] + aLhs[3] * aRhs[3];
+        REQUIRE(std::abs(dot) == Approx(1.f).margin(1e-5f));
+    }
+
+    Affine recompose(const Trs & aTrs)
+    { return makeAffine(aTrs.translation, aTrs.rotation, aTrs.scale); }
+
+} // anonymous namespace
+
+
+SCENARIO("Decomposition of affine transformations")
+{
+    GIVEN("A reference matrix: scale by 2, rotate by 90 degrees around y, then translate")
+    {
+        // Row-vector convention: the x axis is mapped to -z, the z axis to x.
+        const Affine reference{{
+            0.f, 0.f, -2.f,
+            0.f, 2.f, 0.f,
+            2.f, 0.f, 0.f,
+            1.f, 2.f, 3.f,
+        }};
+        const Trs trs = decompose(reference);
+
+        THEN("The components are recovered")
+        {
+            requireEqual(trs.translation, {1.f, 2.f, 3.f});
+            requireEqual(trs.scale, {2.f, 2.f, 2.f});
+            const float half = std::sqrt(0.5f);
+            requireSameRotation(trs.rotation, {0.f, half, 0.f, half});
+            REQUIRE(trs.rotation[3] >= 0.f);
+        }
+    }
+
+    GIVEN("Transformations composed from TRS, with non-uniform and negative scales")
+    {
+        std::mt19937 generator{7};
+        std::uniform_real_distribution<float> coordinate{-10.f, 10.f};
+        std::uniform_real_distribution<float> component{-1.f, 1.f};
+        std::uniform_real_distribution<float> magnitude{0.1f, 5.f};
+
+        std::vector<Trs> references;
+        std::vector<Affine> transformations;
+        for (std::size_t index = 0; index != 37; ++index) // not a multiple of the group size
+        {
+            std::array<float, 4> rotation{component(generator), component(generator),
+                                          component(generator), component(generator)};
+            const float norm = std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1]
+                                         + rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+            for (float & value : rotation)
+            {
+                value /= norm;
+            }
+            // Every other transformation mirrors along x.
+            references.push_back(Trs{
+                .translation = {coordinate(generator), coordinate(generator), coordinate(generator)},
+                .rotation = rotation,
+                .scale = {(index % 2 ? -1.f : 1.f) * magnitude(generator), magnitude(generator), magnitude(generator)},
+            });
+            transformations.push_back(recompose(references.back()));
+        }
+
+        THEN("Decomposition recovers each TRS, which recomposes to the transformation")
+        {
+            for (std::size_t index = 0; index != references.size(); ++index)
+            {
+                const Trs trs = decompose(transformations[index]);
+                requireEqual(trs.translation, references[index].translation);
+                requireEqual(trs.scale, references[index].scale, 1e-4f);
+                requireSameRotation(trs.rotation, references[index].rotation);
+                requireEqual(recompose(trs), transformations[index], 1e-4f);
+            }
+        }
+
+        THEN("The batched decomposition matches the single one")
+        {
+            SceneGraph::TrsArrays arrays;
+            decompose(transformations, arrays);
+            REQUIRE(arrays.tx.size() == transformations.size());
+            for (std::size_t index = 0; index != transformations.size(); ++index)
+            {
+                const Trs trs = decompose(transformations[index]);
+                REQUIRE(arrays.tx[index] == trs.translation[0]);
+                REQUIRE(arrays.rx[index] == trs.rotation[0]);
+                REQUIRE(arrays.rw[index] == trs.rotation[3]);
+                REQUIRE(arrays.sx[index] == trs.scale[0]);
+                REQUIRE(arrays.sz[index] == trs.scale[2]);
+            }
+        }
+    }
+
+    GIVEN("A symmetric shear")
+    {
+        const Affine shear{{
+            1.f,  0.5f, 0.f,
+            0.5f, 1.f,  0.f,
+            0.f,  0.f,  1.f,
+            0.f,  0.f,  0.f,
+        }};
+
+        THEN("The closest rotation is the identity")
+        {
+            const Trs trs = decompose(shear);
+            requireSameRotation(trs.rotation, {0.f, 0.f, 0.f, 1.f});
+            requireEqual(trs.scale, {1.f, 1.f, 1.f});
+        }
+    }
+
+    GIVEN("A singular transformation, flattening the y axis")
+    {
+        const Trs reference{
+            .translation = {0.f, 1.f, 0.f},
+            .rotation = {0.f, 0.f, std::sqrt(0.5f), std::sqrt(0.5f)},
+            .scale = {3.f, 0.f, 1.f},
+        };
+        const Trs trs = decompose(recompose(reference));
+
+        THEN("The collapsed axis gets a null scale")
+        {
+            requireEqual(trs.scale, reference.scale);
+            requireSameRotation(trs.rotation, reference.rotation);
+            requireEqual(recompose(trs), recompose(reference));
+        }
+    }
+
+    GIVEN("A glTF node specified by a matrix")
+    {
+        initializeLogging();
+        // Column-major in the glTF file: this is a mirror along x, then a translation by (4, 5, 6).
+        const Gltf gltf{GltfBuilder{}.write("decomposition_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0]}],)"
+            R"("nodes": [{"matrix": [-1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  4, 5, 6, 1]}],)"
+            R"("meshes": [])")};
+
+        THEN("Its pose can be read as TRS")
+        {
+            const Node::TRS trs = getTransformationAsTRS(gltf.get(Index<Node>{0}));
+            REQUIRE(trs.translation.x() == Approx(4.f));
+            REQUIRE(trs.translation.z() == Approx(6.f));
+            REQUIRE(trs.scale.x() == Approx(-1.f));
+            REQUIRE(trs.scale.y() == Approx(1.f));
+            REQUIRE(trs.rotation.w() == Approx(1.f));
+        }
+
+        THEN("The scene graph stores it as TRS")
+        {
+            const SceneGraph scene{gltf, Index<Scene>{0}};
+            REQUIRE(scene.getLocalPoses().sx[0] == Approx(-1.f));
+            REQUIRE(scene.getLocalPoses().ty[0] == Approx(5.f));
+            REQUIRE(scene.getWorldTransformation(0).at(0, 0) == Approx(-1.f));
+            REQUIRE(scene.getWorldTransformation(0).at(3, 2) == Approx(6.f));
+        }
+    }
+}
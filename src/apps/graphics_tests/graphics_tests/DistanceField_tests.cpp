@@ -0,0 +1,80 @@
+#include "catch.hpp"
+
+#include <arte/DistanceField.h>
+
+#include <test_commons/PathProvider.h>
+
+#include <algorithm>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    float median(const GlyphDistanceField & aField, int aX, int aY)
+    {
+        const std::size_t texel = GlyphDistanceField::gChannels * (aY * aField.resolution.width() + aX);
+        const float r = std::to_integer<int>(aField.texels[texel]);
+        const float g = std::to_integer<int>(aField.texels[texel + 1]);
+        const float b = std::to_integer<int>(aField.texels[texel + 2]);
+        return std::max(std::min(r, g), std::min(std::max(r, g), b)) / 255.f;
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Multi-channel signed distance fields of glyphs")
+{
+    GIVEN("A font face")
+    {
+        Freetype freetype;
+        FontFace fontFace = freetype.load(resource::pathFor("fonts/dejavu-fonts-ttf-2.37/DejaVuSans.ttf"));
+        fontFace.setPixelHeight(48);
+
+        THEN("The field reconstructs the coverage rendered by FreeType, away from the outline")
+        {
+            const float range = 4.f;
+            std::size_t checked = 0;
+            std::size_t mismatches = 0;
+            // Straight and curved outlines, sharp corners, and holes.
+            for (CharCode charCode : {0x41u /* A */, 0x42u /* B */, 0x4Fu /* O */, 0x67u /* g */, 0x26u /* & */, 0x40u /* @ */})
+            {
+                const GlyphDistanceField field = generateMsdf(fontFace, charCode, range);
+
+                const FT_GlyphSlot slot = fontFace.loadChar(charCode, FT_LOAD_RENDER | FT_LOAD_NO_HINTING);
+                const FT_Bitmap & bitmap = slot->bitmap;
+                REQUIRE(slot->bitmap_left == field.origin.x() + range / 2);
+                REQUIRE(slot->bitmap_top == field.origin.y() + field.resolution.height() - range / 2);
+
+                // The coverage bitmap rows go from the top, the field rows from the bottom.
+                for (unsigned int row = 0; row != bitmap.rows; ++row)
+                {
+                    for (unsigned int column = 0; column != bitmap.width; ++column)
+                    {
+                        const int coverage = bitmap.buffer[row * bitmap.pitch + column];
+                        if (coverage > 16 && coverage < 240)
+                        {
+                            continue; // on the outline
+                        }
+                        const float distance = median(field,
+                                                      column + static_cast<int>(range / 2),
+                                                      field.resolution.height() - 1 - row - static_cast<int>(range / 2));
+                        ++checked;
+                        mismatches += ((coverage >= 240) != (distance > .5f)) ? 1 : 0;
+                    }
+                }
+            }
+            REQUIRE(checked > 1000);
+            REQUIRE(mismatches == 0);
+        }
+
+        THEN("A glyph without outline gives a field entirely outside")
+        {
+            const GlyphDistanceField field = generateMsdf(fontFace, 0x20 /* space */);
+            REQUIRE(std::all_of(field.texels.begin(), field.texels.end(),
+                                [](std::byte aValue){ return aValue == std::byte{0}; }));
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#include "catch.hpp"
+
+#include <arte/Freetype.h>
+
+#include <test_commons/PathProvider.h>
+
+#include <algorithm>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+SCENARIO("Font faces rendering identically from several libraries")
+{
+    GIVEN("A font face with a transform and a pixel size")
+    {
+        const filesystem::path fontPath = resource::pathFor("fonts/dejavu-fonts-ttf-2.37/DejaVuSans.ttf");
+        Freetype freetype;
+        FontFace fontFace = freetype.load(fontPath);
+        fontFace.inverseYAxis(true);
+        fontFace.setPixelHeight(37);
+
+        WHEN("The same file is opened in another library, matching the settings of the first face")
+        {
+            Freetype otherFreetype;
+            FontFace otherFace = otherFreetype.load(fontPath);
+            otherFace.matchSettings(fontFace);
+
+            THEN("Both faces render the same bitmaps and metrics")
+            {
+                REQUIRE(otherFace.getPixelSize() == fontFace.getPixelSize());
+
+                std::size_t mismatches = 0;
+                for (CharCode charCode : {0x41u /* A */, 0x67u /* g */, 0x40u /* @ */, 0xE9u /* é */})
+                {
+                    FT_GlyphSlot slot = fontFace.loadChar(charCode, FT_LOAD_RENDER);
+                    const FT_Glyph_Metrics metrics = slot->metrics;
+                    const FT_Bitmap bitmap = slot->bitmap;
+                    std::vector<unsigned char> pixels(bitmap.buffer, bitmap.buffer + bitmap.rows * bitmap.pitch);
+
+                    FT_GlyphSlot otherSlot = otherFace.loadChar(charCode, FT_LOAD_RENDER);
+                    const FT_Bitmap otherBitmap = otherSlot->bitmap;
+                    mismatches += (metrics.horiBearingY != otherSlot->metrics.horiBearingY
+                                   || metrics.horiAdvance != otherSlot->metrics.horiAdvance
+                                   || bitmap.rows != otherBitmap.rows
+                                   || bitmap.pitch != otherBitmap.pitch
+                                   || !std::equal(pixels.begin(), pixels.end(), otherBitmap.buffer)) ? 1 : 0;
+                }
+                REQUIRE(mismatches == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+
+#include "FilesystemHelpers.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+
+namespace ad {
+
+
+/// @brief Standard base64 encoding, with padding.
+inline std::string encodeBase64(std::span<const std::byte> aData)
+{
+    constexpr const char * alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    auto at = [&](std::size_t aIndex) -> std::uint32_t
+    {
+        return aIndex < aData.size() ? std::to_integer<std::uint32_t>(aData[aIndex]) : 0;
+    };
+
+    std::string result;
+    for (std::size_t first = 0; first < aData.size(); first += 3)
+    {
+        const std::uint32_t packed = (at(first) << 16) | (at(first + 1) << 8) | at(first + 2);
+        result += alphabet[packed >> 18];
+        result += alphabet[(packed >> 12) & 0x3F];
+        result += (first + 1 < aData.size()) ? alphabet[(packed >> 6) & 0x3F] : '=';
+        result += (first + 2 < aData.size()) ? alphabet[packed & 0x3F] : '=';
+    }
+    return result;
+}
+
+
+/// @brief A folder owned by this test process, so processes running in parallel never write the same files.
+inline const filesystem::path & getProcessTemporaryFolder()
+{
+    /// @brief Removes the folder and its content when the test process exits.
+    struct TemporaryFolder
+    {
+        ~TemporaryFolder()
+        {
+            std::error_code ignored;
+            filesystem::remove_all(path, ignored);
+        }
+
+        filesystem::path path;
+    };
+
+    static const TemporaryFolder folder = []
+    {
+        std::random_device entropy;
+        const filesystem::path parent = ensureTemporaryImageFolder("graphics_tests");
+        for (;;)
+        {
+            filesystem::path candidate = parent / ("gltf-" + std::to_string(entropy()));
+            if (filesystem::create_directory(candidate))
+            {
+                return TemporaryFolder{candidate};
+            }
+        }
+    }();
+    return folder.path;
+}
+
+
+/// @brief Assembles a glTF document whose binary data is in a single buffer (buffer 0),
+/// then writes it to a unique path in the process temporary folder.
+///
+/// The JSON of buffer views and accessors is given by the tests, only the byte offsets
+/// of the data appended to buffer 0 are tracked.
+class GltfBuilder
+{
+public:
+    /// @brief Append bytes to buffer 0, aligned on 4 bytes.
+    /// @return The offset of the bytes in the buffer.
+    std::size_t append(const void * aData, std::size_t aByteLength)
+    {
+        mBin.resize((mBin.size() + 3) / 4 * 4);
+        const std::size_t offset = mBin.size();
+        const std::byte * data = static_cast<const std::byte *>(aData);
+        mBin.insert(mBin.end(), data, data + aByteLength);
+        return offset;
+    }
+
+    template <class T_value>
+    std::size_t append(const std::vector<T_value> & aValues)
+    { return append(aValues.data(), aValues.size() * sizeof(T_value)); }
+
+    /// @brief Append bytes to buffer 0, in a buffer view of their own.
+    /// @param aMembers Additional members of the buffer view, e.g. `"byteStride": 12`.
+    /// @return The index of the buffer view.
+    std::size_t addView(const void * aData, std::size_t aByteLength, std::string_view aMembers = {})
+    {
+        const std::size_t offset = append(aData, aByteLength);
+        return addView("\"buffer\": 0, \"byteOffset\": " + std::to_string(offset)
+                       + ", \"byteLength\": " + std::to_string(aByteLength)
+                       + (aMembers.empty() ? "" : ", ") + std::string{aMembers});
+    }
+
+    template <class T_value>
+    std::size_t addView(const std::vector<T_value> & aValues, std::string_view aMembers = {})
+    { return addView(aValues.data(), aValues.size() * sizeof(T_value), aMembers); }
+
+    /// @brief Add a buffer view from all its members.
+    /// @return The index of the buffer view.
+    std::size_t addView(std::string aMembers)
+    { return add(mViews, std::move(aMembers)); }
+
+    /// @return The index of the accessor.
+    std::size_t addAccessor(std::string aMembers)
+    { return add(mAccessors, std::move(aMembers)); }
+
+    /// @brief Add a buffer after buffer 0 (which only exists if data was appended, or if it is embedded).
+    void addBuffer(std::string aMembers)
+    { add(mBuffers, std::move(aMembers)); }
+
+    /// @brief Embed buffer 0 as a base64 data uri, instead of writing it to a .bin file next to the .gltf.
+    void embedBuffer()
+    { mIsEmbedded = true; }
+
+    /// @brief Write the document, and buffer 0 unless it is embedded.
+    /// @param aName The stem of the written files, made unique in the process.
+    /// @param aMembers The top level members other than `asset`, `buffers`, `bufferViews` and `accessors`.
+    /// @return The path of the .gltf file. Buffer 0, if not embedded, has the same path with the .bin extension.
+    filesystem::path write(std::string_view aName, std::string_view aMembers) const
+    {
+        static std::size_t fileCount = 0;
+        const std::string stem = std::string{aName} + "-" + std::to_string(fileCount++);
+        const filesystem::path folder = getProcessTemporaryFolder();
+
+        std::string buffers;
+        if (hasBin())
+        {
+            std::string uri;
+            if (mIsEmbedded)
+            {
+                uri = "data:application/octet-stream;base64," + encodeBase64(mBin);
+            }
+            else
+            {
+                uri = stem + ".bin";
+                std::ofstream{folder / uri, std::ios::binary}
+                    .write(reinterpret_cast<const char *>(mBin.data()), mBin.size());
+            }
+            buffers = "{\"uri\": \"" + uri + "\", \"byteLength\": " + std::to_string(mBin.size()) + "}";
+        }
+        for (const std::string & buffer : mBuffers)
+        {
+            buffers += (buffers.empty() ? "" : ", ") + buffer;
+        }
+
+        filesystem::path path = folder / (stem + ".gltf");
+        std::ofstream{path}
+            << "{\"asset\": {\"version\": \"2.0\"}, " << aMembers << ","
+            << "\"buffers\": [" << buffers << "],"
+            << "\"bufferViews\": [" << join(mViews) << "],"
+            << "\"accessors\": [" << join(mAccessors) << "]}";
+        return path;
+    }
+
+private:
+    bool hasBin() const
+    { return !mBin.empty() || mIsEmbedded; }
+
+    static std::size_t add(std::vector<std::string> & aObjects, std::string aMembers)
+    {
+        aObjects.push_back("{" + std::move(aMembers) + "}");
+        return aObjects.size() - 1;
+    }
+
+    static std::string join(const std::vector<std::string> & aObjects)
+    {
+        std::string result;
+        for (const std::string & object : aObjects)
+        {
+            result += (result.empty() ? "" : ", ") + object;
+        }
+        return result;
+    }
+
+    std::vector<std::byte> mBin;
+    std::vector<std::string> mBuffers; // after buffer 0
+    std::vector<std::string> mViews;
+    std::vector<std::string> mAccessors;
+    bool mIsEmbedded{false};
+};
+
+
+} // namespace ad
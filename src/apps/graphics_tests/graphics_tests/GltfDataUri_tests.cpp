@@ -0,0 +1,114 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/Images.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+using namespace ad::arte::gltf;
+
+
+namespace {
+
+    const std::vector<float> gPositions{
+        0.f, 0.f, 0.f,
+        1.f, 0.f, 0.f,
+        0.f, 1.f, -0.5f,
+    };
+
+
+    ImageRgba makeImage()
+    {
+        ImageRgba image{{5, 3}, math::sdr::Rgba{0, 0, 0, 255}};
+        for (std::size_t row = 0; row != 3; ++row)
+        {
+            for (std::size_t column = 0; column != 5; ++column)
+            {
+                image.at(column, row) = math::sdr::Rgba{
+                    static_cast<math::sdr::Value_t>(50 * column),
+                    static_cast<math::sdr::Value_t>(100 * row),
+                    static_cast<math::sdr::Value_t>(7 * (column + row)),
+                    static_cast<math::sdr::Value_t>(255 - 10 * column),
+                };
+            }
+        }
+        return image;
+    }
+
+
+    /// @brief Write a glTF whose buffer is embedded as a data uri, holding positions then a png image.
+    /// Image 0 is the same png embedded as a data uri, image 1 references it through a buffer view.
+    filesystem::path writeEmbedded(const std::vector<std::byte> & aPng)
+    {
+        GltfBuilder builder;
+        builder.embedBuffer();
+        builder.addAccessor(R"("componentType": 5126, "type": "VEC3", "count": 3, "bufferView": )"
+                            + std::to_string(builder.addView(gPositions)));
+        const std::size_t imageView = builder.addView(aPng);
+
+        return builder.write("gltf_data_uri_tests",
+            R"("scene": 0, "scenes": [{"nodes": []}], "nodes": [], "meshes": [],)"
+            R"("images": [{"uri": "data:image/png;base64,)" + encodeBase64(aPng) + R"("},)"
+            R"({"bufferView": )" + std::to_string(imageView) + R"(, "mimeType": "image/png"}])");
+    }
+
+
+    bool isSamePixels(const ImageRgba & aLhs, const ImageRgba & aRhs)
+    {
+        return aLhs.dimensions() == aRhs.dimensions()
+            && std::memcmp(aLhs.data(), aRhs.data(), aLhs.size_bytes()) == 0;
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Embedded glTF buffers and images")
+{
+    GIVEN("A glTF embedding its buffer and a png image as base64 data uris")
+    {
+        initializeLogging();
+        const ImageRgba image = makeImage();
+        std::ostringstream encoded;
+        image.write(ImageFormat::Png, encoded);
+        const std::string pngString = std::move(encoded).str();
+        std::vector<std::byte> png(pngString.size());
+        std::memcpy(png.data(), pngString.data(), png.size());
+
+        const Gltf gltf{writeEmbedded(png)};
+        BufferCache buffers{gltf};
+
+        THEN("The buffer is decoded, and accessors read from it")
+        {
+            const std::span<const std::byte> buffer = buffers.get(Index<Buffer>{0});
+            REQUIRE(buffer.size() == gPositions.size() * sizeof(float) + png.size());
+            REQUIRE(std::memcmp(buffer.data() + gPositions.size() * sizeof(float), png.data(), png.size()) == 0);
+            REQUIRE(readAsFloats(buffers, *gltf.get(Index<Accessor>{0})) == gPositions);
+        }
+
+        THEN("The data uri image is decoded to the original pixels")
+        {
+            REQUIRE(getDataUriMediaType(std::get<Uri>(gltf.get(Index<gltf::Image>{0})->dataSource).string) == "image/png");
+            REQUIRE(getImageFormat(gltf, Index<gltf::Image>{0}) == ImageFormat::Png);
+
+            const std::span<const std::byte> data = buffers.getImageData(Index<gltf::Image>{0});
+            REQUIRE(data.size() == png.size());
+            REQUIRE(std::memcmp(data.data(), png.data(), png.size()) == 0);
+            REQUIRE(isSamePixels(readImage<math::sdr::Rgba>(buffers, Index<gltf::Image>{0}), image));
+        }
+
+        THEN("The buffer view image is decoded to the original pixels")
+        {
+            REQUIRE(getImageFormat(gltf, Index<gltf::Image>{1}) == ImageFormat::Png);
+            REQUIRE(isSamePixels(readImage<math::sdr::Rgba>(buffers, Index<gltf::Image>{1}), image));
+        }
+    }
+}
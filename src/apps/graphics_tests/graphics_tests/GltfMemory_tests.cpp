@@ -0,0 +1,158 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+
+#include <algorithm>
+#include <string>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    constexpr std::size_t gWideAttributeCount = 20;
+
+    /// @brief Write a glTF with a quadtree of `aNodeCount` named nodes,
+    /// and `aMeshCount` named meshes with a single primitive.
+    /// The last mesh has a second primitive, with more attributes than GL_MAX_VERTEX_ATTRIBS minimal value.
+    filesystem::path writeDocument(std::size_t aNodeCount, std::size_t aMeshCount)
+    {
+        std::string nodes;
+        for (std::size_t node = 0; node != aNodeCount; ++node)
+        {
+            nodes += (node == 0 ? "" : ",");
+            nodes += "{\"name\": \"a node with a long descriptive name " + std::to_string(node) + "\"";
+            if (node < aMeshCount)
+            {
+                nodes += ", \"mesh\": " + std::to_string(node);
+            }
+            std::string children;
+            for (std::size_t child = 4 * node + 1; child < std::min(4 * node + 5, aNodeCount); ++child)
+            {
+                children += (children.empty() ? "" : ", ") + std::to_string(child);
+            }
+            if (!children.empty())
+            {
+                nodes += ", \"children\": [" + children + "]";
+            }
+            nodes += "}";
+        }
+
+        std::string meshes;
+        for (std::size_t mesh = 0; mesh != aMeshCount; ++mesh)
+        {
+            meshes += (mesh == 0 ? "" : ",");
+            meshes += "{\"name\": \"shared mesh name for all meshes\", \"primitives\": [{\"attributes\": "
+                      "{\"TEXCOORD_0\": 2, \"POSITION\": 0, \"NORMAL\": 1}, \"indices\": 3}";
+            if (mesh == aMeshCount - 1)
+            {
+                std::string attributes;
+                for (std::size_t attribute = 0; attribute != gWideAttributeCount; ++attribute)
+                {
+                    attributes += (attribute == 0 ? "\"_CUSTOM_" : ", \"_CUSTOM_")
+                                  + std::to_string(attribute) + "\": " + std::to_string(attribute);
+                }
+                meshes += ", {\"attributes\": {" + attributes + "}}";
+            }
+            meshes += "]}";
+        }
+
+        return GltfBuilder{}.write("memory_tests",
+            "\"scene\": 0, \"scenes\": [{\"name\": \"the scene\", \"nodes\": [0]}],"
+            "\"nodes\": [" + nodes + "], \"meshes\": [" + meshes + "]");
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Gltf document memory")
+{
+    GIVEN("A glTF document with many named nodes and meshes, and a baseline document 4 times smaller")
+    {
+        initializeLogging();
+
+        constexpr std::size_t nodeCount = 20000;
+        constexpr std::size_t meshCount = 2000;
+        const Gltf baseline{writeDocument(nodeCount / 4, meshCount / 4)};
+        const Gltf gltf{writeDocument(nodeCount, meshCount)};
+
+        const gltf::DocumentArena & arena = gltf.getArena();
+        const gltf::DocumentArena & baselineArena = baseline.getArena();
+        WARN("The arena of " << nodeCount << " nodes and " << meshCount << " meshes uses "
+             << arena.getUsedBytes() << " bytes out of " << arena.getReservedBytes() << " bytes in "
+             << arena.getReservedBlocks() << " blocks. The baseline arena uses "
+             << baselineArena.getUsedBytes() << " bytes out of " << baselineArena.getReservedBytes()
+             << " bytes in " << baselineArena.getReservedBlocks() << " blocks.");
+
+        THEN("The arena grows linearly in bytes, and logarithmically in heap blocks")
+        {
+            // Per-element storage is sized to the element: 4 times the elements is at most 4 times the bytes
+            // (with some margin for the interning set buckets).
+            REQUIRE(arena.getUsedBytes() < 4.5 * baselineArena.getUsedBytes());
+            // Blocks at least double in size: 4 times the bytes is at most 3 more blocks.
+            REQUIRE(arena.getReservedBlocks() <= baselineArena.getReservedBlocks() + 3);
+            // Monotonic growth leaves at most the last block partially unused,
+            // on top of the interning set buckets released on rehash.
+            REQUIRE(arena.getReservedBytes() < 3 * arena.getUsedBytes());
+        }
+
+        THEN("Names, child lists and attributes are available")
+        {
+            const gltf::Node & node = gltf.get(gltf::Index<gltf::Node>{1});
+            REQUIRE(node.name == "a node with a long descriptive name 1");
+            REQUIRE(node.children.size() == 4);
+            REQUIRE(node.children[0] == 5);
+            REQUIRE(node.children[3] == 8);
+            REQUIRE(gltf.get(gltf::Index<gltf::Node>{nodeCount - 1})->children.empty());
+            REQUIRE(gltf.get(gltf::Index<gltf::Scene>{0})->name == "the scene");
+
+            const gltf::Primitive & primitive = gltf.get(gltf::Index<gltf::Mesh>{0})->primitives[0];
+            REQUIRE(primitive.attributes.size() == 3);
+            REQUIRE(primitive.attributes.at("POSITION") == 0);
+            REQUIRE(primitive.attributes.at("NORMAL") == 1);
+            REQUIRE(primitive.attributes.find("TEXCOORD_0")->second == 2);
+            REQUIRE_FALSE(primitive.attributes.contains("TANGENT"));
+            REQUIRE_THROWS_AS(primitive.attributes.at("TANGENT"), std::out_of_range);
+            // Ordered by semantic, as the std::map it replaces.
+            REQUIRE(primitive.attributes.begin()->first == "NORMAL");
+        }
+
+        THEN("Primitives are not limited in attribute count")
+        {
+            const gltf::Primitive & primitive = gltf.get(gltf::Index<gltf::Mesh>{meshCount - 1})->primitives[1];
+            REQUIRE(primitive.attributes.size() == gWideAttributeCount);
+            std::size_t mismatches = 0;
+            for (std::size_t attribute = 0; attribute != gWideAttributeCount; ++attribute)
+            {
+                mismatches += (primitive.attributes.at("_CUSTOM_" + std::to_string(attribute)) != attribute) ? 1 : 0;
+            }
+            REQUIRE(mismatches == 0);
+        }
+
+        THEN("Mesh primitives can be iterated as owned elements")
+        {
+            std::size_t primitiveCount = 0;
+            for (Const_Owned<gltf::Primitive> primitive
+                 : gltf.get(gltf::Index<gltf::Mesh>{meshCount - 1}).iterate(&gltf::Mesh::primitives))
+            {
+                REQUIRE(primitive->attributes.size() == (primitiveCount == 0 ? 3 : gWideAttributeCount));
+                ++primitiveCount;
+            }
+            REQUIRE(primitiveCount == 2);
+        }
+
+        THEN("Equal names share their storage")
+        {
+            const gltf::Mesh & first = gltf.get(gltf::Index<gltf::Mesh>{0});
+            const gltf::Mesh & last = gltf.get(gltf::Index<gltf::Mesh>{meshCount - 1});
+            REQUIRE(first.name.data() == last.name.data());
+            REQUIRE(first.primitives[0].attributes.begin()->first.data()
+                    == last.primitives[0].attributes.begin()->first.data());
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/SceneTraversal.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    /// @brief Write a glTF whose nodes form a chain of `aChainLength` nodes under root 0,
+    /// followed by a second root with two leaf children.
+    filesystem::path writeHierarchy(std::size_t aChainLength)
+    {
+        std::string nodes;
+        for (std::size_t node = 0; node != aChainLength; ++node)
+        {
+            nodes += "{\"name\": \"chain" + std::to_string(node) + "\"";
+            if (node + 1 != aChainLength)
+            {
+                nodes += ", \"children\": [" + std::to_string(node + 1) + "]";
+            }
+            nodes += "},";
+        }
+        const std::size_t root = aChainLength;
+        nodes += "{\"name\": \"root\", \"children\": [" + std::to_string(root + 1) + ", " + std::to_string(root + 2) + "]},"
+                 "{\"name\": \"leftLeaf\"},"
+                 "{\"name\": \"rightLeaf\"}";
+
+        return GltfBuilder{}.write("traversal_tests",
+            "\"scene\": 0, \"scenes\": [{\"nodes\": [0, " + std::to_string(root) + "]}],"
+            "\"nodes\": [" + nodes + "], \"meshes\": []");
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Gltf traversal")
+{
+    GIVEN("A glTF scene with a hierarchy deeper than the inline traversal stack")
+    {
+        initializeLogging();
+        const std::size_t chainLength = gltf::SceneTraversal::gInlineDepth + 8;
+        const Gltf gltf{writeHierarchy(chainLength)};
+
+        THEN("The node range lazily yields each node with its index")
+        {
+            Const_OwnedRange<gltf::Node> nodes = gltf.getNodes();
+            REQUIRE(nodes.size() == gltf.countNodes());
+            REQUIRE(gltf.getNodeSpan().size() == gltf.countNodes());
+
+            std::size_t expectedId = 0;
+            for (Const_Owned<gltf::Node> node : nodes)
+            {
+                REQUIRE(node.id() == expectedId);
+                REQUIRE(&(*node) == &gltf.getNodeSpan()[expectedId]);
+                ++expectedId;
+            }
+            REQUIRE(nodes.end() - nodes.begin() == static_cast<std::ptrdiff_t>(gltf.countNodes()));
+        }
+
+        THEN("Children are lazily iterated through their indices")
+        {
+            Const_Owned<gltf::Node> root = gltf.get(gltf::Index<gltf::Node>{chainLength});
+            std::vector<std::string_view> names;
+            for (Const_Owned<gltf::Node> child : root.iterate(&gltf::Node::children))
+            {
+                names.push_back(child->name);
+            }
+            REQUIRE(names == std::vector<std::string_view>{"leftLeaf", "rightLeaf"});
+        }
+
+        THEN("The scene traversal visits the nodes in depth-first pre-order, with their parent and depth")
+        {
+            gltf::SceneTraversal traversal{gltf, gltf::Index<gltf::Scene>{0}};
+
+            std::size_t visitCount = 0;
+            for (const gltf::SceneTraversal::Visit & visit : traversal)
+            {
+                if (visitCount < chainLength)
+                {
+                    REQUIRE(visit.node.id() == visitCount);
+                    REQUIRE(visit.depth == visitCount);
+                    REQUIRE(visit.parent == (visitCount == 0 ? std::nullopt
+                                                             : std::optional<gltf::Index<gltf::Node>>{visitCount - 1}));
+                }
+                else if (visitCount == chainLength)
+                {
+                    REQUIRE(visit.node->name == "root");
+                    REQUIRE(visit.depth == 0);
+                    REQUIRE_FALSE(visit.parent);
+                }
+                else
+                {
+                    REQUIRE(visit.node->name == (visitCount == chainLength + 1 ? "leftLeaf" : "rightLeaf"));
+                    REQUIRE(visit.depth == 1);
+                    REQUIRE(visit.parent == gltf::Index<gltf::Node>{chainLength});
+                }
+                ++visitCount;
+            }
+            REQUIRE(visitCount == gltf.countNodes());
+
+            // Restarting the traversal
+            REQUIRE((*traversal.begin()).node.id() == 0);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#include "catch.hpp"
+
+#include <graphics/detail/GlyphUtilities_deprecated.h>
+#include <graphics/detail/Logging.h>
+
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics::detail;
+
+
+namespace {
+
+    using PageUsage = DynamicGlyphCache::PageUsage;
+
+    /// @brief A cache without atlases, only tracking the use of `aPageUsages`.
+    DynamicGlyphCache makeCache(std::vector<PageUsage> aPageUsages, std::size_t aMaxPages, std::uint64_t aFrame)
+    {
+        DynamicGlyphCache cache;
+        cache.pageUsages = std::move(aPageUsages);
+        cache.maxPages = aMaxPages;
+        cache.frame = aFrame;
+        return cache;
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Selecting the glyph atlas page to recycle")
+{
+    initializeLogging();
+
+    GIVEN("Pages last used during the current and the previous frames")
+    {
+        const std::vector<PageUsage> pages{{.lastUseFrame = 10}, {.lastUseFrame = 9}};
+
+        THEN("They are protected")
+        {
+            REQUIRE_FALSE(DynamicGlyphCache::findRecyclablePage(pages, 10));
+        }
+
+        THEN("The page unused for two frames can be recycled")
+        {
+            REQUIRE(DynamicGlyphCache::findRecyclablePage(pages, 11) == 1u);
+        }
+    }
+
+    GIVEN("Pages last used at different frames")
+    {
+        const std::vector<PageUsage> pages{
+            {.lastUseFrame = 5},
+            {.lastUseFrame = 2},
+            {.lastUseFrame = 30},
+            {.lastUseFrame = 3},
+        };
+
+        THEN("The least recently used page is recycled")
+        {
+            REQUIRE(DynamicGlyphCache::findRecyclablePage(pages, 31) == 1u);
+        }
+
+        WHEN("The least recently used pages are pinned")
+        {
+            std::vector<PageUsage> pinned = pages;
+            pinned[1].pins = 1;
+            pinned[3].pins = 2;
+
+            THEN("The least recently used page among the unpinned ones is recycled")
+            {
+                REQUIRE(DynamicGlyphCache::findRecyclablePage(pinned, 31) == 0u);
+            }
+
+            THEN("No page is recycled if the others are in use")
+            {
+                pinned[0].pins = 1;
+                REQUIRE_FALSE(DynamicGlyphCache::findRecyclablePage(pinned, 31));
+            }
+        }
+    }
+
+    GIVEN("A cache with a budget of two pages")
+    {
+        WHEN("It has a single page")
+        {
+            DynamicGlyphCache cache = makeCache({{.lastUseFrame = 0}}, 2, 10);
+
+            THEN("It grows, which is within the budget")
+            {
+                REQUIRE_FALSE(cache.selectRecycledPage());
+                REQUIRE(cache.statistics.pagesOverBudget == 0);
+            }
+        }
+
+        WHEN("It has two pages, one unused for several frames")
+        {
+            DynamicGlyphCache cache = makeCache({{.lastUseFrame = 10}, {.lastUseFrame = 4}}, 2, 10);
+
+            THEN("The unused page is recycled")
+            {
+                REQUIRE(cache.selectRecycledPage() == 1u);
+                REQUIRE(cache.statistics.pagesOverBudget == 0);
+            }
+        }
+
+        WHEN("It has two pages in use")
+        {
+            DynamicGlyphCache cache = makeCache({{.lastUseFrame = 10}, {.lastUseFrame = 4, .pins = 1}}, 2, 10);
+
+            THEN("It grows, each page beyond the budget being counted")
+            {
+                REQUIRE_FALSE(cache.selectRecycledPage());
+                REQUIRE(cache.statistics.pagesOverBudget == 1);
+                cache.pageUsages.push_back({.lastUseFrame = 10});
+                REQUIRE_FALSE(cache.selectRecycledPage());
+                REQUIRE(cache.statistics.pagesOverBudget == 2);
+            }
+
+            THEN("Once unpinned, the page is recycled")
+            {
+                cache.unpinPage(1);
+                REQUIRE(cache.selectRecycledPage() == 1u);
+                REQUIRE(cache.statistics.pagesOverBudget == 0);
+            }
+        }
+    }
+
+    GIVEN("An unbounded cache with pages in use")
+    {
+        DynamicGlyphCache cache = makeCache({{.lastUseFrame = 10}, {.lastUseFrame = 10}}, 0, 10);
+
+        THEN("It grows, without counting pages over budget")
+        {
+            REQUIRE_FALSE(cache.selectRecycledPage());
+            REQUIRE(cache.statistics.pagesOverBudget == 0);
+        }
+    }
+}
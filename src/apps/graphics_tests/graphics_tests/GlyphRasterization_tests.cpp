@@ -0,0 +1,135 @@
+#include "catch.hpp"
+
+#include <graphics/detail/GlyphUtilities_deprecated.h>
+
+#include <test_commons/PathProvider.h>
+
+#include <cstring>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics::detail;
+
+
+namespace {
+
+    bool isSame(const RasterizedGlyph & aLhs, const RasterizedGlyph & aRhs)
+    {
+        return aLhs.bitmap == aRhs.bitmap
+            && aLhs.format == aRhs.format
+            && aLhs.resolution == aRhs.resolution
+            && aLhs.controlBoxSize == aRhs.controlBoxSize
+            && aLhs.bearing == aRhs.bearing
+            && aLhs.penAdvance == aRhs.penAdvance
+            && aLhs.freetypeIndex == aRhs.freetypeIndex;
+    }
+
+    /// @brief Count the code points whose glyph rendered on worker threads differs from the serial rendering.
+    std::size_t countParallelMismatches(const arte::FontFace & aFontFace,
+                                        const filesystem::path & aFontPath,
+                                        const std::vector<arte::CharCode> & aCharCodes,
+                                        GlyphRasterization aRasterization)
+    {
+        const std::vector<std::optional<RasterizedGlyph>> parallel =
+            rasterizeGlyphs(aFontFace, aFontPath, aCharCodes, aRasterization);
+        REQUIRE(parallel.size() == aCharCodes.size());
+
+        std::size_t mismatches = 0;
+        for (std::size_t index = 0; index != aCharCodes.size(); ++index)
+        {
+            if (aFontFace.hasGlyph(aCharCodes[index]))
+            {
+                const RasterizedGlyph serial = rasterizeGlyph(aFontFace, aCharCodes[index], aRasterization);
+                mismatches += (!parallel[index] || !isSame(*parallel[index], serial)) ? 1 : 0;
+            }
+            else
+            {
+                mismatches += parallel[index] ? 1 : 0;
+            }
+        }
+        return mismatches;
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Rasterizing glyphs on worker threads")
+{
+    GIVEN("A font face configured as for text rendering")
+    {
+        const filesystem::path fontPath = resource::pathFor("fonts/dejavu-fonts-ttf-2.37/DejaVuSans.ttf");
+        arte::Freetype freetype;
+        arte::FontFace fontFace = freetype.load(fontPath);
+        fontFace.inverseYAxis(true);
+        fontFace.setPixelHeight(24);
+
+        THEN("Coverage glyphs are identical to the serial rendering, over several blocks")
+        {
+            // Latin, Greek and Cyrillic, including code points without a glyph.
+            std::vector<arte::CharCode> charCodes;
+            for (arte::CharCode charCode = 0x20; charCode != 0x600; ++charCode)
+            {
+                charCodes.push_back(charCode);
+            }
+            REQUIRE(charCodes.size() >= 4 * DynamicGlyphCache::gMinParallelPreload);
+            REQUIRE(countParallelMismatches(fontFace, fontPath, charCodes, GlyphRasterization::Coverage) == 0);
+        }
+
+        THEN("Distance field glyphs are identical to the serial rendering")
+        {
+            std::vector<arte::CharCode> charCodes;
+            for (arte::CharCode charCode = 0x21; charCode < 0x7F; charCode += 3)
+            {
+                charCodes.push_back(charCode);
+            }
+            REQUIRE(countParallelMismatches(fontFace, fontPath, charCodes, GlyphRasterization::Msdf) == 0);
+        }
+    }
+}
+
+
+SCENARIO("Copying glyph bitmap rows")
+{
+    // 2 pixels wide, 3 rows, padded to 4 bytes per row.
+    const unsigned char top[] = {1, 2}, middle[] = {3, 4}, bottom[] = {5, 6};
+    const std::vector<std::byte> expected{
+        std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}, std::byte{5}, std::byte{6}};
+
+    GIVEN("A bitmap flowing down (positive pitch)")
+    {
+        unsigned char buffer[12] = {};
+        std::memcpy(buffer, top, 2);
+        std::memcpy(buffer + 4, middle, 2);
+        std::memcpy(buffer + 8, bottom, 2);
+        FT_Bitmap bitmap{};
+        bitmap.rows = 3;
+        bitmap.width = 2;
+        bitmap.pitch = 4;
+        bitmap.buffer = buffer;
+
+        THEN("The rows are copied from top to bottom, without padding")
+        {
+            REQUIRE(copyRows(bitmap) == expected);
+        }
+    }
+
+    GIVEN("A bitmap flowing up (negative pitch)")
+    {
+        // The buffer starts with the bottom row.
+        unsigned char buffer[12] = {};
+        std::memcpy(buffer, bottom, 2);
+        std::memcpy(buffer + 4, middle, 2);
+        std::memcpy(buffer + 8, top, 2);
+        FT_Bitmap bitmap{};
+        bitmap.rows = 3;
+        bitmap.width = 2;
+        bitmap.pitch = -4;
+        bitmap.buffer = buffer;
+
+        THEN("The rows are copied from top to bottom, without padding")
+        {
+            REQUIRE(copyRows(bitmap) == expected);
+        }
+    }
+}
@@ -0,0 +1,200 @@
+#include "catch.hpp"
+
+#include <graphics/detail/GlyphTable.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+
+
+using namespace ad;
+using namespace ad::graphics::detail;
+
+
+namespace {
+
+    // Same size as a rendered glyph.
+    struct Glyph
+    {
+        arte::CharCode charCode;
+        float metrics[9];
+    };
+
+    Glyph makeGlyph(arte::CharCode aCharCode)
+    {
+        return Glyph{.charCode = aCharCode, .metrics = {static_cast<float>(aCharCode)}};
+    }
+
+    // Typical UI strings, mostly ASCII with a few accented and non-Latin characters.
+    const std::u32string gUiText =
+        U"Settings  Audio  Video  Controls  Résumé  Quitter l'application ?  "
+        U"Score: 12 480  Élan vital  Größe  Ωmega  Привет  Player 1 — Ready";
+
+} // anonymous namespace
+
+
+SCENARIO("Glyph table lookups")
+{
+    GIVEN("A table with glyphs in the dense range, in an added dense range, and hashed")
+    {
+        GlyphTable<Glyph> table;
+        table.addDenseRange(0x400, 0x500); // Cyrillic
+        table.insert('A', makeGlyph('A'));
+        table.insert(0xE9, makeGlyph(0xE9)); // 'é'
+        table.insert(0x41F, makeGlyph(0x41F)); // 'П'
+        table.insert(0x3A9, makeGlyph(0x3A9)); // 'Ω'
+
+        THEN("Each glyph is found, other code points are not")
+        {
+            REQUIRE(table.size() == 4);
+            for (arte::CharCode charCode : {0x41u, 0xE9u, 0x41Fu, 0x3A9u})
+            {
+                REQUIRE(table.find(charCode) != nullptr);
+                REQUIRE(table.find(charCode)->charCode == charCode);
+            }
+            REQUIRE(table.find('B') == nullptr);
+            REQUIRE(table.find(0x420) == nullptr);
+            REQUIRE(table.find(0x3AA) == nullptr);
+        }
+
+        THEN("Hashed glyphs are still found once their range becomes dense")
+        {
+            table.addDenseRange(0x370, 0x400); // Greek
+            REQUIRE(table.find(0x3A9)->charCode == 0x3A9);
+            REQUIRE(table.find(0x41F)->charCode == 0x41F);
+            REQUIRE(table.find(0x3AA) == nullptr);
+        }
+
+        THEN("A dense range containing existing dense ranges is merged with them")
+        {
+            table.addDenseRange(0x420, 0x430);
+            // Strictly contains [0x420, 0x430[ and overlaps [0x400, 0x500[, so it covers Greek and Cyrillic.
+            table.addDenseRange(0x300, 0x600);
+            table.insert(0x425, makeGlyph(0x425));
+            table.insert(0x5FF, makeGlyph(0x5FF));
+            table.insert(0x600, makeGlyph(0x600));
+
+            REQUIRE(table.size() == 7);
+            std::size_t visited = 0;
+            table.forEach([&visited](const Glyph &){ ++visited; });
+            REQUIRE(visited == 7);
+            for (arte::CharCode charCode : {0x41u, 0xE9u, 0x3A9u, 0x41Fu, 0x425u, 0x5FFu, 0x600u})
+            {
+                REQUIRE(table.find(charCode) != nullptr);
+                REQUIRE(table.find(charCode)->charCode == charCode);
+            }
+            REQUIRE(table.find(0x2FF) == nullptr);
+            REQUIRE(table.find(0x426) == nullptr);
+            REQUIRE(table.find(0x601) == nullptr);
+
+            REQUIRE(table.eraseIf([](const Glyph & aGlyph){ return aGlyph.charCode >= 0x400; }) == 4);
+            REQUIRE(table.find(0x3A9)->charCode == 0x3A9);
+            REQUIRE(table.find(0x425) == nullptr);
+            REQUIRE(table.find(0x600) == nullptr);
+        }
+    }
+
+    GIVEN("A table with many hashed glyphs")
+    {
+        GlyphTable<Glyph> table;
+        // CJK ideographs, with a stride so the keys are not contiguous.
+        for (arte::CharCode charCode = 0x4E00; charCode < 0x9FFF; charCode += 7)
+        {
+            table.insert(charCode, makeGlyph(charCode));
+        }
+
+        THEN("They are all found after the hash table grew")
+        {
+            std::size_t mismatches = 0;
+            for (arte::CharCode charCode = 0x4E00; charCode < 0x9FFF; ++charCode)
+            {
+                const Glyph * found = table.find(charCode);
+                const bool expected = (charCode - 0x4E00) % 7 == 0;
+                mismatches += (expected ? (found == nullptr || found->charCode != charCode)
+                                        : (found != nullptr)) ? 1 : 0;
+            }
+            REQUIRE(mismatches == 0);
+        }
+
+        THEN("Erasing some of them keeps the others reachable")
+        {
+            // Half of the ideographs, and a dense glyph.
+            table.insert('A', makeGlyph('A'));
+            const std::size_t erased = table.eraseIf(
+                [](const Glyph & aGlyph){ return aGlyph.charCode == 'A' || aGlyph.charCode % 2 == 0; });
+            REQUIRE(erased + table.size() == 1 + (0x9FFF - 0x4E00 + 6) / 7);
+            REQUIRE(table.find('A') == nullptr);
+
+            std::size_t mismatches = 0;
+            for (arte::CharCode charCode = 0x4E00; charCode < 0x9FFF; charCode += 7)
+            {
+                const Glyph * found = table.find(charCode);
+                mismatches += ((charCode % 2 == 0) ? (found != nullptr)
+                                                   : (found == nullptr || found->charCode != charCode)) ? 1 : 0;
+            }
+            REQUIRE(mismatches == 0);
+        }
+    }
+}
+
+
+namespace {
+
+    /// @brief Benchmark looking up each code point of `aText`, in the table and in the map it replaced.
+    void benchmarkLookups(const std::string & aName, const std::u32string & aText)
+    {
+        std::unordered_map<arte::CharCode, Glyph> map;
+        GlyphTable<Glyph> table;
+        for (char32_t codePoint : aText)
+        {
+            if (!table.find(codePoint))
+            {
+                map.emplace(codePoint, makeGlyph(codePoint));
+                table.insert(codePoint, makeGlyph(codePoint));
+            }
+        }
+
+        BENCHMARK("unordered_map, " + aName)
+        {
+            float advance = 0.f;
+            for (char32_t codePoint : aText)
+            {
+                advance += map.find(codePoint)->second.metrics[0];
+            }
+            return advance;
+        };
+
+        BENCHMARK("GlyphTable, " + aName)
+        {
+            float advance = 0.f;
+            for (char32_t codePoint : aText)
+            {
+                advance += table.find(codePoint)->metrics[0];
+            }
+            return advance;
+        };
+    }
+
+} // anonymous namespace
+
+
+TEST_CASE("Glyph lookups while laying out UI strings", "[!benchmark]")
+{
+    // Mixed: mostly dense lookups, with a few hashed ones.
+    benchmarkLookups("UI strings", gUiText);
+
+    // Latin-1 only: all lookups in the dense range.
+    std::u32string latin;
+    std::copy_if(gUiText.begin(), gUiText.end(), std::back_inserter(latin),
+                 [](char32_t aCodePoint){ return aCodePoint < 0x100; });
+    benchmarkLookups("Latin-1", latin);
+
+    // CJK ideographs: all lookups in the hash table.
+    std::u32string ideographs;
+    for (char32_t codePoint = 0x4E00; ideographs.size() != gUiText.size(); codePoint += 13)
+    {
+        ideographs += codePoint;
+    }
+    benchmarkLookups("CJK", ideographs);
+}
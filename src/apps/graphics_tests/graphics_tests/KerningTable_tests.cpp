@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include <arte/KerningTable.h>
+
+#include <test_commons/PathProvider.h>
+
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+SCENARIO("Precomputed kerning tables")
+{
+    GIVEN("A font face with kerning")
+    {
+        Freetype freetype;
+        FontFace fontFace = freetype.load(resource::pathFor("fonts/dejavu-fonts-ttf-2.37/DejaVuSans.ttf"));
+        fontFace.setPixelHeight(32);
+        REQUIRE(fontFace.hasKerning());
+
+        std::vector<FT_UInt> glyphs;
+        for (CharCode charCode = 0x20; charCode != 0x7F; ++charCode)
+        {
+            glyphs.push_back(fontFace.getGlyphIndex(charCode));
+        }
+
+        KerningTable table{fontFace};
+        // Added in two steps, to also compute the pairs between successive additions.
+        table.addGlyphs(fontFace, std::span{glyphs}.first(40));
+        table.addGlyphs(fontFace, std::span{glyphs}.subspan(40));
+
+        THEN("Lookups between added glyphs match FreeType, storing only non-null pairs")
+        {
+            std::size_t nonNull = 0;
+            std::size_t mismatches = 0;
+            for (FT_UInt left : glyphs)
+            {
+                for (FT_UInt right : glyphs)
+                {
+                    const math::Vec<2, float> expected = fontFace.kern(left, right);
+                    mismatches += (table.get(left, right, fontFace) != expected) ? 1 : 0;
+                    nonNull += (expected != math::Vec<2, float>{0.f, 0.f}) ? 1 : 0;
+                }
+            }
+            REQUIRE(mismatches == 0);
+            REQUIRE(nonNull != 0);
+            REQUIRE(table.size() == nonNull);
+        }
+
+        THEN("Pairs with other glyphs are queried, only non-null offsets being memoized")
+        {
+            const FT_UInt other = fontFace.getGlyphIndex(0xC0); // 'À'
+            const FT_UInt kerned = fontFace.getGlyphIndex('V');
+            const FT_UInt unkerned = fontFace.getGlyphIndex('~');
+            REQUIRE(fontFace.kern(other, kerned) != math::Vec<2, float>{0.f, 0.f});
+            REQUIRE(fontFace.kern(other, unkerned) == math::Vec<2, float>{0.f, 0.f});
+
+            const std::size_t size = table.size();
+            for (int repeat = 0; repeat != 2; ++repeat)
+            {
+                REQUIRE(table.get(other, kerned, fontFace) == fontFace.kern(other, kerned));
+                REQUIRE(table.get(other, unkerned, fontFace) == math::Vec<2, float>{0.f, 0.f});
+                REQUIRE(table.size() == size + 1);
+            }
+        }
+    }
+
+    GIVEN("A default table")
+    {
+        Freetype freetype;
+        FontFace fontFace = freetype.load(resource::pathFor("fonts/dejavu-fonts-ttf-2.37/DejaVuSans.ttf"));
+        KerningTable table;
+
+        THEN("It has no kerning")
+        {
+            REQUIRE_FALSE(table.hasKerning());
+            REQUIRE(table.get(fontFace.getGlyphIndex('A'), fontFace.getGlyphIndex('V'), fontFace)
+                    == math::Vec<2, float>{0.f, 0.f});
+        }
+    }
+}
@@ -0,0 +1,239 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+#include "SyntheticMeshes.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/MeshOptimization.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+using namespace ad::arte::gltf;
+
+
+namespace {
+
+    constexpr std::uint32_t gGridSize = 48;
+    constexpr std::uint32_t gSparseCount = 64;
+
+    using Triangle = std::array<std::array<float, 2>, 3>;
+
+    /// @brief Rotate the triangle so it starts with its smallest vertex, preserving the winding.
+    Triangle canonical(Triangle aTriangle)
+    {
+        std::rotate(aTriangle.begin(), std::min_element(aTriangle.begin(), aTriangle.end()), aTriangle.end());
+        return aTriangle;
+    }
+
+    std::vector<Triangle> sortedTriangles(std::span<const std::uint32_t> aIndices, std::span<const float> aPositions)
+    {
+        std::vector<Triangle> triangles;
+        for (std::size_t first = 0; first != aIndices.size(); first += 3)
+        {
+            Triangle triangle;
+            for (std::size_t corner = 0; corner != 3; ++corner)
+            {
+                triangle[corner] = {aPositions[3 * aIndices[first + corner]], aPositions[3 * aIndices[first + corner] + 1]};
+            }
+            triangles.push_back(canonical(triangle));
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    /// @brief The value of the sparse texture coordinates of vertex `aVertex`.
+    std::array<float, 2> sparseValue(std::uint32_t aVertex)
+    {
+        // Substitutions are made every few vertices, the other texture coordinates being 0.
+        constexpr std::uint32_t step = gGridSize * gGridSize / gSparseCount;
+        if (aVertex % step == 0)
+        {
+            return {float(aVertex), 0.5f * float(aVertex)};
+        }
+        return {0.f, 0.f};
+    }
+
+    /// @brief A grid whose vertices and triangles are randomly shuffled, written with sparse texture coordinates.
+    struct ShuffledGrid
+    {
+        ShuffledGrid()
+        {
+            std::mt19937 random{3};
+            const Geometry grid = makeGrid(gGridSize);
+            const std::uint32_t vertexCount = gGridSize * gGridSize;
+
+            std::vector<std::uint32_t> permutation(vertexCount);
+            std::iota(permutation.begin(), permutation.end(), 0);
+            std::shuffle(permutation.begin(), permutation.end(), random);
+            positions.resize(grid.positions.size());
+            for (std::uint32_t vertex = 0; vertex != vertexCount; ++vertex)
+            {
+                std::copy_n(&grid.positions[3 * vertex], 3, &positions[3 * permutation[vertex]]);
+            }
+
+            std::vector<std::uint32_t> triangles(grid.indices.size() / 3);
+            std::iota(triangles.begin(), triangles.end(), 0);
+            std::shuffle(triangles.begin(), triangles.end(), random);
+            for (std::uint32_t triangle : triangles)
+            {
+                for (std::size_t corner = 0; corner != 3; ++corner)
+                {
+                    indices.push_back(permutation[grid.indices[3 * triangle + corner]]);
+                }
+            }
+        }
+
+        filesystem::path write() const
+        {
+            std::vector<std::uint16_t> sparseIndices;
+            std::vector<float> sparseValues;
+            for (std::uint32_t vertex = 0; vertex != gGridSize * gGridSize; vertex += gGridSize * gGridSize / gSparseCount)
+            {
+                sparseIndices.push_back(static_cast<std::uint16_t>(vertex));
+                const std::array<float, 2> value = sparseValue(vertex);
+                sparseValues.insert(sparseValues.end(), value.begin(), value.end());
+            }
+
+            GltfBuilder builder;
+            builder.addAccessor(R"("componentType": 5126, "type": "VEC3", "count": )" + std::to_string(positions.size() / 3)
+                                + R"(, "bufferView": )" + std::to_string(builder.addView(positions)));
+            builder.addAccessor(R"("componentType": 5125, "type": "SCALAR", "count": )" + std::to_string(indices.size())
+                                + R"(, "bufferView": )" + std::to_string(builder.addView(indices)));
+            const std::size_t sparseValuesOffset = builder.append(sparseValues);
+            const std::size_t sparseIndicesOffset = builder.append(sparseIndices);
+            const std::size_t sparseView = builder.addView(
+                R"("buffer": 0, "byteOffset": )" + std::to_string(sparseValuesOffset)
+                + R"(, "byteLength": )" + std::to_string(sparseIndicesOffset + sparseIndices.size() * sizeof(std::uint16_t)
+                                                         - sparseValuesOffset));
+            // Without a buffer view: zeros, then the sparse substitutions.
+            builder.addAccessor(R"("componentType": 5126, "type": "VEC2", "count": )" + std::to_string(positions.size() / 3)
+                                + R"(, "sparse": {"count": )" + std::to_string(gSparseCount)
+                                + R"(, "indices": {"bufferView": )" + std::to_string(sparseView)
+                                + R"(, "byteOffset": )" + std::to_string(sparseIndicesOffset - sparseValuesOffset)
+                                + R"(, "componentType": 5123})"
+                                + R"(, "values": {"bufferView": )" + std::to_string(sparseView) + "}}");
+
+            return builder.write("mesh_optimization_tests",
+                R"("scene": 0, "scenes": [{"nodes": [0]}], "nodes": [{"mesh": 0}],)"
+                R"("meshes": [{"primitives": [{"attributes": {"POSITION": 0, "TEXCOORD_0": 2}, "indices": 1}]}])");
+        }
+
+        std::vector<float> positions;
+        std::vector<std::uint32_t> indices;
+    };
+
+    const OptimizedPrimitive::Attribute & getAttribute(const OptimizedPrimitive & aPrimitive, std::string_view aSemantic)
+    {
+        return *std::find_if(aPrimitive.attributes.begin(), aPrimitive.attributes.end(),
+                             [aSemantic](const auto & aAttribute){ return aAttribute.semantic == aSemantic; });
+    }
+
+    template <class T_value>
+    std::vector<T_value> readAs(const std::vector<std::byte> & aBytes)
+    {
+        std::vector<T_value> result(aBytes.size() / sizeof(T_value));
+        std::memcpy(result.data(), aBytes.data(), aBytes.size());
+        return result;
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Mesh optimization")
+{
+    GIVEN("A grid whose vertices and triangles are shuffled")
+    {
+        initializeLogging();
+        const ShuffledGrid grid;
+        const std::size_t vertexCount = grid.positions.size() / 3;
+
+        THEN("The fetch remap is a permutation, in the order of first use")
+        {
+            const std::vector<std::uint32_t> remap = computeFetchRemap(grid.indices, vertexCount);
+            std::vector<std::uint32_t> sorted = remap;
+            std::sort(sorted.begin(), sorted.end());
+            std::vector<std::uint32_t> expected(vertexCount);
+            std::iota(expected.begin(), expected.end(), 0);
+            REQUIRE(sorted == expected);
+            REQUIRE(remap[grid.indices[0]] == 0);
+            REQUIRE(remap[grid.indices[1]] == 1);
+        }
+
+        WHEN("Its glTF primitive is optimized")
+        {
+            const Gltf gltf{grid.write()};
+            BufferCache buffers{gltf};
+            const Primitive & primitive = gltf.get(Index<Mesh>{0})->primitives[0];
+            const OptimizedPrimitive optimized = optimize(buffers, primitive);
+
+            THEN("The vertex cache efficiency improves")
+            {
+                REQUIRE(optimized.after.acmr < 0.5 * optimized.before.acmr);
+                REQUIRE(optimized.after.atvr < 0.5 * optimized.before.atvr);
+                REQUIRE(optimized.after.acmr < 1.);
+            }
+
+            THEN("Indices are downsized to 16 bits, and describe the same triangles")
+            {
+                REQUIRE(optimized.vertexCount == vertexCount);
+                REQUIRE(optimized.indexCount == grid.indices.size());
+                REQUIRE(optimized.indexComponentType == component::UnsignedShort);
+                REQUIRE(optimized.indices.size() == grid.indices.size() * sizeof(std::uint16_t));
+
+                const std::vector<std::uint16_t> shortIndices = readAs<std::uint16_t>(optimized.indices);
+                const std::vector<std::uint32_t> indices{shortIndices.begin(), shortIndices.end()};
+                const std::vector<float> positions = readAs<float>(getAttribute(optimized, "POSITION").data);
+                REQUIRE(sortedTriangles(indices, positions) == sortedTriangles(grid.indices, grid.positions));
+            }
+
+            THEN("The sparse attribute is densified, and follows its vertex")
+            {
+                // Positions are unique, so they identify the source vertex.
+                std::map<std::array<float, 2>, std::uint32_t> sourceVertex;
+                for (std::uint32_t vertex = 0; vertex != vertexCount; ++vertex)
+                {
+                    sourceVertex[{grid.positions[3 * vertex], grid.positions[3 * vertex + 1]}] = vertex;
+                }
+
+                const std::vector<float> positions = readAs<float>(getAttribute(optimized, "POSITION").data);
+                const std::vector<float> texCoords = readAs<float>(getAttribute(optimized, "TEXCOORD_0").data);
+                REQUIRE(texCoords.size() == 2 * vertexCount);
+                std::size_t mismatches = 0;
+                std::size_t substituted = 0;
+                for (std::size_t vertex = 0; vertex != vertexCount; ++vertex)
+                {
+                    const std::uint32_t source = sourceVertex.at({positions[3 * vertex], positions[3 * vertex + 1]});
+                    const std::array<float, 2> expected = sparseValue(source);
+                    mismatches += (texCoords[2 * vertex] != expected[0] || texCoords[2 * vertex + 1] != expected[1]) ? 1 : 0;
+                    substituted += (expected[0] != 0.f) ? 1 : 0;
+                }
+                REQUIRE(mismatches == 0);
+                REQUIRE(substituted == gSparseCount - 1); // Vertex 0 is substituted by (0, 0).
+            }
+        }
+
+        WHEN("It is optimized without downsizing indices")
+        {
+            const Gltf gltf{grid.write()};
+            BufferCache buffers{gltf};
+            const OptimizedPrimitive optimized =
+                optimize(buffers, gltf.get(Index<Mesh>{0})->primitives[0], {.downsizeIndices = false});
+
+            THEN("Indices are kept on 32 bits")
+            {
+                REQUIRE(optimized.indexComponentType == component::UnsignedInt);
+                REQUIRE(optimized.indices.size() == grid.indices.size() * sizeof(std::uint32_t));
+            }
+        }
+    }
+}
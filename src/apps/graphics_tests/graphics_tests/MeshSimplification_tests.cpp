@@ -0,0 +1,315 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+#include "SyntheticMeshes.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/MeshSimplification.h>
+
+#include <set>
+#include <utility>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    constexpr std::uint32_t gRings = 40;
+    constexpr std::uint32_t gSegments = 80;
+
+    /// @brief A UV sphere with a texture seam along the first meridian:
+    /// the triangles of the last segment use duplicates of the first meridian vertices.
+    /// @return The original and duplicate seam vertices, from the north to the south ring.
+    std::pair<std::vector<std::uint32_t>, std::vector<std::uint32_t>> cutSeam(Geometry & aSphere)
+    {
+        auto segmentOf = [](std::uint32_t aVertex) -> std::int64_t
+        { return (aVertex == 0 || aVertex == (gRings - 1) * gSegments + 1) ? -1 : (aVertex - 1) % gSegments; };
+
+        std::vector<std::uint32_t> originals;
+        std::vector<std::uint32_t> duplicates;
+        for (std::uint32_t ring = 1; ring != gRings; ++ring)
+        {
+            const std::uint32_t original = 1 + (ring - 1) * gSegments;
+            originals.push_back(original);
+            duplicates.push_back(static_cast<std::uint32_t>(aSphere.positions.size() / 3));
+            aSphere.positions.insert(aSphere.positions.end(),
+                                     aSphere.positions.begin() + 3 * original,
+                                     aSphere.positions.begin() + 3 * original + 3);
+        }
+
+        for (std::size_t first = 0; first != aSphere.indices.size(); first += 3)
+        {
+            const std::span<std::uint32_t> triangle{&aSphere.indices[first], 3};
+            if (std::any_of(triangle.begin(), triangle.end(),
+                            [&](std::uint32_t aVertex){ return segmentOf(aVertex) == gSegments - 1; }))
+            {
+                for (std::uint32_t & vertex : triangle)
+                {
+                    if (segmentOf(vertex) == 0)
+                    {
+                        vertex = duplicates[(vertex - 1) / gSegments];
+                    }
+                }
+            }
+        }
+        return {originals, duplicates};
+    }
+
+    std::set<std::pair<std::uint32_t, std::uint32_t>> getEdges(std::span<const std::uint32_t> aIndices)
+    {
+        std::set<std::pair<std::uint32_t, std::uint32_t>> edges;
+        for (std::size_t corner = 0; corner != aIndices.size(); ++corner)
+        {
+            edges.insert(std::minmax(aIndices[corner], aIndices[corner - corner % 3 + (corner % 3 + 1) % 3]));
+        }
+        return edges;
+    }
+
+    void requireEqual(const std::vector<gltf::Lod> & aLhs, const std::vector<gltf::Lod> & aRhs)
+    {
+        REQUIRE(aLhs.size() == aRhs.size());
+        for (std::size_t level = 0; level != aLhs.size(); ++level)
+        {
+            CHECK(aLhs[level].indices == aRhs[level].indices);
+            CHECK(aLhs[level].error == aRhs[level].error);
+        }
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Quadric error mesh simplification")
+{
+    GIVEN("A flat grid")
+    {
+        Geometry grid = makeGrid(32);
+
+        WHEN("It is simplified without error bound")
+        {
+            gltf::Lod lod = gltf::simplify(grid.indices, grid.positions, 0);
+
+            THEN("The triangle count is reduced without geometric error")
+            {
+                CHECK(lod.indices.size() < grid.indices.size() / 4);
+                CHECK(lod.error == Approx(0.f).margin(1e-5));
+            }
+
+            THEN("Border vertices are all kept, and still joined by the border edges")
+            {
+                std::vector<bool> referenced(grid.positions.size() / 3, false);
+                for (std::uint32_t index : lod.indices)
+                {
+                    referenced[index] = true;
+                }
+                const auto edges = getEdges(lod.indices);
+                std::size_t missingVertices = 0;
+                std::size_t missingEdges = 0;
+                for (std::uint32_t x = 0; x != 32; ++x)
+                {
+                    // Bottom, top, left and right sides.
+                    for (std::uint32_t vertex : {x, 31 * 32 + x, 32 * x, 32 * x + 31})
+                    {
+                        missingVertices += referenced[vertex] ? 0 : 1;
+                    }
+                    if (x != 31)
+                    {
+                        missingEdges += edges.contains({x, x + 1}) ? 0 : 1;
+                        missingEdges += edges.contains({31 * 32 + x, 31 * 32 + x + 1}) ? 0 : 1;
+                        missingEdges += edges.contains({32 * x, 32 * (x + 1)}) ? 0 : 1;
+                        missingEdges += edges.contains({32 * x + 31, 32 * (x + 1) + 31}) ? 0 : 1;
+                    }
+                }
+                REQUIRE(missingVertices == 0);
+                REQUIRE(missingEdges == 0);
+            }
+        }
+    }
+
+    GIVEN("A closed sphere")
+    {
+        Geometry sphere = makeSphere(gRings, gSegments);
+        const std::size_t triangleCount = sphere.indices.size() / 3;
+
+        WHEN("It is simplified to a target index count")
+        {
+            const std::size_t target = sphere.indices.size() / 10;
+            gltf::Lod lod = gltf::simplify(sphere.indices, sphere.positions, target);
+
+            THEN("The target is reached")
+            {
+                CHECK(lod.indices.size() <= target);
+                CHECK(lod.indices.size() > 0);
+                CHECK(lod.error > 0.f);
+            }
+
+            THEN("The result is deterministic")
+            {
+                gltf::Lod again = gltf::simplify(sphere.indices, sphere.positions, target);
+                CHECK(again.indices == lod.indices);
+                CHECK(again.error == lod.error);
+            }
+        }
+
+        WHEN("It is simplified with an error bound")
+        {
+            const float maximumError = 0.01f;
+            gltf::Lod lod = gltf::simplify(sphere.indices, sphere.positions, 0, maximumError);
+
+            THEN("The error does not exceed the bound")
+            {
+                CHECK(lod.error <= maximumError);
+                CHECK(lod.indices.size() / 3 < triangleCount);
+            }
+
+            THEN("Triangle centroids stay close to the sphere")
+            {
+                // Vertices are never moved, only chord deviation remains.
+                for (std::size_t triangle = 0; triangle != lod.indices.size() / 3; ++triangle)
+                {
+                    float centroid[3] = {0.f, 0.f, 0.f};
+                    for (std::size_t corner = 0; corner != 3; ++corner)
+                    {
+                        for (std::size_t axis = 0; axis != 3; ++axis)
+                        {
+                            centroid[axis] += sphere.positions[3 * lod.indices[3 * triangle + corner] + axis] / 3.f;
+                        }
+                    }
+                    float radius = std::sqrt(centroid[0] * centroid[0]
+                                             + centroid[1] * centroid[1]
+                                             + centroid[2] * centroid[2]);
+                    CHECK(radius > 0.9f);
+                }
+            }
+        }
+
+        WHEN("A LOD chain is generated")
+        {
+            std::vector<gltf::Lod> chain = gltf::generateLodChain(sphere.indices, sphere.positions);
+
+            THEN("Levels have decreasing triangle counts and increasing errors")
+            {
+                REQUIRE(chain.size() > 2);
+                CHECK(chain.front().indices == sphere.indices);
+                CHECK(chain.front().error == 0.f);
+                for (std::size_t level = 1; level != chain.size(); ++level)
+                {
+                    CHECK(chain[level].indices.size() < chain[level - 1].indices.size());
+                    CHECK(chain[level].error >= chain[level - 1].error);
+                }
+            }
+        }
+    }
+
+    GIVEN("A closed sphere with a texture seam")
+    {
+        Geometry sphere = makeSphere(gRings, gSegments);
+        const auto [originals, duplicates] = cutSeam(sphere);
+
+        WHEN("It is simplified to a small fraction of its triangles")
+        {
+            gltf::Lod lod = gltf::simplify(sphere.indices, sphere.positions, sphere.indices.size() / 10);
+
+            THEN("It is simplified")
+            {
+                CHECK(lod.indices.size() < sphere.indices.size() / 4);
+            }
+
+            THEN("Both sides of the seam keep all their vertices, joined by the seam edges")
+            {
+                std::vector<bool> referenced(sphere.positions.size() / 3, false);
+                for (std::uint32_t index : lod.indices)
+                {
+                    referenced[index] = true;
+                }
+                const auto edges = getEdges(lod.indices);
+                std::size_t missingVertices = 0;
+                std::size_t missingEdges = 0;
+                for (std::size_t ring = 0; ring != originals.size(); ++ring)
+                {
+                    missingVertices += (referenced[originals[ring]] ? 0 : 1) + (referenced[duplicates[ring]] ? 0 : 1);
+                    if (ring + 1 != originals.size())
+                    {
+                        missingEdges += edges.contains(std::minmax(originals[ring], originals[ring + 1])) ? 0 : 1;
+                        missingEdges += edges.contains(std::minmax(duplicates[ring], duplicates[ring + 1])) ? 0 : 1;
+                    }
+                }
+                REQUIRE(missingVertices == 0);
+                REQUIRE(missingEdges == 0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("glTF mesh LOD generation")
+{
+    GIVEN("A glTF with an indexed sphere, the same sphere without indices, and an indexed grid")
+    {
+        initializeLogging();
+
+        const Geometry sphere = makeSphere(gRings, gSegments);
+        const Geometry grid = makeGrid(32);
+        const std::vector<std::uint16_t> shortSphereIndices{sphere.indices.begin(), sphere.indices.end()};
+
+        GltfBuilder builder;
+        auto addPositions = [&builder](const Geometry & aGeometry)
+        {
+            builder.addAccessor(R"("componentType": 5126, "type": "VEC3", "count": )"
+                                + std::to_string(aGeometry.positions.size() / 3)
+                                + R"(, "bufferView": )" + std::to_string(builder.addView(aGeometry.positions)));
+        };
+        addPositions(sphere);
+        builder.addAccessor(R"("componentType": 5123, "type": "SCALAR", "count": )"
+                            + std::to_string(shortSphereIndices.size())
+                            + R"(, "bufferView": )" + std::to_string(builder.addView(shortSphereIndices)));
+        addPositions(grid);
+        builder.addAccessor(R"("componentType": 5125, "type": "SCALAR", "count": )"
+                            + std::to_string(grid.indices.size())
+                            + R"(, "bufferView": )" + std::to_string(builder.addView(grid.indices)));
+
+        const Gltf gltf{builder.write("mesh_simplification_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0, 1]}], "nodes": [{"mesh": 0}, {"mesh": 1}],)"
+            R"("meshes": [)"
+                R"({"primitives": [{"attributes": {"POSITION": 0}, "indices": 1}, {"attributes": {"POSITION": 0}}]},)"
+                R"({"primitives": [{"attributes": {"POSITION": 2}, "indices": 3}]}])")};
+        gltf::BufferCache buffers{gltf};
+
+        WHEN("The LODs of its meshes are generated")
+        {
+            const std::vector<gltf::MeshLods> lods = gltf::generateLods(buffers);
+
+            THEN("Each indexed triangle primitive has the LOD chain of its geometry")
+            {
+                REQUIRE(lods.size() == 2);
+                REQUIRE(lods[0].size() == 2);
+                REQUIRE(lods[1].size() == 1);
+
+                requireEqual(lods[0][0], gltf::generateLodChain(sphere.indices, sphere.positions));
+                requireEqual(lods[1][0], gltf::generateLodChain(grid.indices, grid.positions));
+            }
+
+            THEN("The sphere chain has several levels of decreasing detail, indexing the source vertices")
+            {
+                const std::vector<gltf::Lod> & chain = lods[0][0];
+                REQUIRE(chain.size() > 2);
+                CHECK(chain.front().indices == sphere.indices);
+                std::size_t outOfRange = 0;
+                for (std::size_t level = 1; level != chain.size(); ++level)
+                {
+                    CHECK(chain[level].indices.size() < chain[level - 1].indices.size());
+                    CHECK(chain[level].error >= chain[level - 1].error);
+                    outOfRange += std::count_if(chain[level].indices.begin(), chain[level].indices.end(),
+                                                [&](std::uint32_t aIndex){ return aIndex >= sphere.positions.size() / 3; });
+                }
+                REQUIRE(outOfRange == 0);
+            }
+
+            THEN("The non-indexed primitive has no LOD chain")
+            {
+                CHECK(lods[0][1].empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,206 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+#include "SyntheticMeshes.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Meshlets.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <sstream>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    void requireEqual(const gltf::Meshlets & aLhs, const gltf::Meshlets & aRhs)
+    {
+        CHECK(aLhs.vertices == aRhs.vertices);
+        CHECK(aLhs.triangles == aRhs.triangles);
+        REQUIRE(aLhs.meshlets.size() == aRhs.meshlets.size());
+        CHECK(std::memcmp(aLhs.meshlets.data(), aRhs.meshlets.data(), aLhs.meshlets.size() * sizeof(gltf::Meshlet)) == 0);
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Meshlets generation")
+{
+    GIVEN("A closed sphere")
+    {
+        Geometry sphere = makeSphere(40, 80);
+        const std::size_t triangleCount = sphere.indices.size() / 3;
+
+        WHEN("It is partitioned into meshlets")
+        {
+            gltf::Meshlets meshlets = gltf::buildMeshlets(sphere.indices, sphere.positions);
+
+            THEN("Meshlets respect the limits, and cover each triangle exactly once")
+            {
+                std::vector<int> triangleUses(triangleCount, 0);
+                std::map<std::array<std::uint32_t, 3>, std::size_t> triangleIds;
+                for (std::size_t triangle = 0; triangle != triangleCount; ++triangle)
+                {
+                    triangleIds[{sphere.indices[3 * triangle],
+                                 sphere.indices[3 * triangle + 1],
+                                 sphere.indices[3 * triangle + 2]}] = triangle;
+                }
+
+                std::size_t coveredTriangles = 0;
+                for (const gltf::Meshlet & meshlet : meshlets.meshlets)
+                {
+                    CHECK(meshlet.vertexCount <= gltf::gMeshletMaxVertices);
+                    CHECK(meshlet.triangleCount <= gltf::gMeshletMaxTriangles);
+                    for (std::size_t triangle = 0; triangle != meshlet.triangleCount; ++triangle)
+                    {
+                        std::array<std::uint32_t, 3> corners;
+                        for (std::size_t corner = 0; corner != 3; ++corner)
+                        {
+                            std::uint8_t local = meshlets.triangles[meshlet.triangleOffset + 3 * triangle + corner];
+                            REQUIRE(local < meshlet.vertexCount);
+                            corners[corner] = meshlets.vertices[meshlet.vertexOffset + local];
+                        }
+                        REQUIRE(triangleIds.contains(corners));
+                        ++triangleUses[triangleIds[corners]];
+                    }
+                    coveredTriangles += meshlet.triangleCount;
+                }
+                CHECK(coveredTriangles == triangleCount);
+                CHECK(std::all_of(triangleUses.begin(), triangleUses.end(), [](int aUses){ return aUses == 1; }));
+            }
+
+            THEN("Bounding spheres contain the meshlet vertices")
+            {
+                for (const gltf::Meshlet & meshlet : meshlets.meshlets)
+                {
+                    for (std::size_t local = 0; local != meshlet.vertexCount; ++local)
+                    {
+                        const float * position = &sphere.positions[3 * meshlets.vertices[meshlet.vertexOffset + local]];
+                        float distance = std::sqrt(std::pow(position[0] - meshlet.center[0], 2.f)
+                                                   + std::pow(position[1] - meshlet.center[1], 2.f)
+                                                   + std::pow(position[2] - meshlet.center[2], 2.f));
+                        CHECK(distance <= meshlet.radius * 1.0001f);
+                    }
+                }
+            }
+
+            THEN("A meshlet is back facing only if all its triangles are back facing")
+            {
+                std::size_t culled = 0;
+                for (std::array<float, 3> eye : {std::array<float, 3>{0.f, 0.f, 5.f},
+                                                 std::array<float, 3>{3.f, -2.f, 0.5f},
+                                                 std::array<float, 3>{-1.5f, 0.f, 0.f}})
+                {
+                    for (const gltf::Meshlet & meshlet : meshlets.meshlets)
+                    {
+                        if (!gltf::isBackFacing(meshlet, eye))
+                        {
+                            continue;
+                        }
+                        ++culled;
+                        for (std::size_t triangle = 0; triangle != meshlet.triangleCount; ++triangle)
+                        {
+                            const float * p[3];
+                            for (std::size_t corner = 0; corner != 3; ++corner)
+                            {
+                                std::uint8_t local = meshlets.triangles[meshlet.triangleOffset + 3 * triangle + corner];
+                                p[corner] = &sphere.positions[3 * meshlets.vertices[meshlet.vertexOffset + local]];
+                            }
+                            float ab[3], ac[3], toEye[3];
+                            for (std::size_t axis = 0; axis != 3; ++axis)
+                            {
+                                ab[axis] = p[1][axis] - p[0][axis];
+                                ac[axis] = p[2][axis] - p[0][axis];
+                                toEye[axis] = eye[axis] - p[0][axis];
+                            }
+                            float normal[3] = {
+                                ab[1] * ac[2] - ab[2] * ac[1],
+                                ab[2] * ac[0] - ab[0] * ac[2],
+                                ab[0] * ac[1] - ab[1] * ac[0],
+                            };
+                            CHECK(normal[0] * toEye[0] + normal[1] * toEye[1] + normal[2] * toEye[2] <= 1e-6f);
+                        }
+                    }
+                }
+                // The cone test must be useful on a sphere.
+                CHECK(culled > 0);
+            }
+
+            THEN("They can be serialized")
+            {
+                std::stringstream stream;
+                meshlets.write(stream);
+                requireEqual(gltf::Meshlets::Read(stream), meshlets);
+            }
+        }
+    }
+}
+
+
+SCENARIO("glTF primitives meshlets")
+{
+    GIVEN("A glTF with an indexed sphere, a non-indexed grid, and the sphere vertices as points")
+    {
+        initializeLogging();
+
+        const Geometry sphere = makeSphere(40, 80);
+        const std::vector<std::uint16_t> shortSphereIndices{sphere.indices.begin(), sphere.indices.end()};
+        // Each corner of the grid triangles is a distinct vertex.
+        const Geometry grid = makeGrid(16);
+        std::vector<float> soup;
+        for (std::uint32_t index : grid.indices)
+        {
+            soup.insert(soup.end(), grid.positions.begin() + 3 * index, grid.positions.begin() + 3 * index + 3);
+        }
+
+        GltfBuilder builder;
+        builder.addAccessor(R"("componentType": 5126, "type": "VEC3", "count": )"
+                            + std::to_string(sphere.positions.size() / 3)
+                            + R"(, "bufferView": )" + std::to_string(builder.addView(sphere.positions)));
+        builder.addAccessor(R"("componentType": 5123, "type": "SCALAR", "count": )"
+                            + std::to_string(shortSphereIndices.size())
+                            + R"(, "bufferView": )" + std::to_string(builder.addView(shortSphereIndices)));
+        builder.addAccessor(R"("componentType": 5126, "type": "VEC3", "count": )" + std::to_string(soup.size() / 3)
+                            + R"(, "bufferView": )" + std::to_string(builder.addView(soup)));
+
+        const Gltf gltf{builder.write("meshlets_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0, 1]}], "nodes": [{"mesh": 0}, {"mesh": 1}],)"
+            R"("meshes": [)"
+                R"({"primitives": [{"attributes": {"POSITION": 0}, "indices": 1}, {"attributes": {"POSITION": 0}, "mode": 0}]},)"
+                R"({"primitives": [{"attributes": {"POSITION": 2}}]}])")};
+        gltf::BufferCache buffers{gltf};
+
+        WHEN("The meshlets of its primitives are built")
+        {
+            const std::vector<gltf::MeshMeshlets> meshlets = gltf::buildMeshlets(buffers);
+
+            THEN("Triangle primitives have the meshlets of their triangle list")
+            {
+                REQUIRE(meshlets.size() == 2);
+                REQUIRE(meshlets[0].size() == 2);
+                REQUIRE(meshlets[1].size() == 1);
+
+                requireEqual(meshlets[0][0], gltf::buildMeshlets(sphere.indices, sphere.positions));
+                REQUIRE(meshlets[0][0].meshlets.size() > 1);
+
+                std::vector<std::uint32_t> soupIndices(soup.size() / 3);
+                std::iota(soupIndices.begin(), soupIndices.end(), 0);
+                requireEqual(meshlets[1][0], gltf::buildMeshlets(soupIndices, soup));
+                REQUIRE(meshlets[1][0].meshlets.size() > 1);
+            }
+
+            THEN("The points primitive has no meshlets")
+            {
+                CHECK(meshlets[0][1].meshlets.empty());
+                CHECK(meshlets[0][1].vertices.empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,894 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+#include "SyntheticMeshes.h"
+
+#include <arte/Logging.h>
+#include <arte/detail/MeshoptDecoder.h>
+#include <arte/gltf/Accessor.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    using Bytes = std::vector<std::byte>;
+
+
+    void pushByte(Bytes & aOutput, unsigned int aValue)
+    {
+        aOutput.push_back(static_cast<std::byte>(aValue));
+    }
+
+
+    template <class T_value>
+    Bytes toBytes(const std::vector<T_value> & aValues)
+    {
+        Bytes result(aValues.size() * sizeof(T_value));
+        std::memcpy(result.data(), aValues.data(), result.size());
+        return result;
+    }
+
+
+    //
+    // Reference data from the meshoptimizer test suite (demo/tests.cpp), produced by its encoders.
+    //
+    const std::vector<std::uint8_t> gReferenceTriangleStream{
+        0xe0, 0xf0, 0x10, 0xfe, 0xff, 0xf0, 0x0c, 0xff, 0x02, 0x02, 0x02, 0x00, 0x76, 0x87, 0x56, 0x67,
+        0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+    };
+    const std::vector<std::uint32_t> gReferenceTriangles{0, 1, 2, 2, 1, 3, 4, 6, 5, 7, 8, 9};
+
+    const std::vector<std::uint8_t> gReferenceIndexSequenceStream{
+        0xd1, 0x00, 0x04, 0xcd, 0x01, 0x04, 0x07, 0x98, 0x1f, 0x00, 0x00, 0x00, 0x00,
+    };
+    const std::vector<std::uint32_t> gReferenceIndexSequence{0, 1, 51, 2, 49, 1000};
+
+
+    //
+    // Encoders, producing the bitstreams of EXT_meshopt_compression (as the meshoptimizer encoders do).
+    //
+    constexpr std::array<unsigned int, 4> gModeBits{0, 2, 4, 8};
+
+    std::size_t measureGroup(const std::uint8_t * aValues, unsigned int aBits)
+    {
+        if (aBits == 8)
+        {
+            return 16;
+        }
+        const unsigned int escape = (1u << aBits) - 1;
+        const auto escaped = static_cast<std::size_t>(
+            std::count_if(aValues, aValues + 16, [escape](std::uint8_t aValue){ return aValue >= escape; }));
+        if (aBits == 0)
+        {
+            return escaped == 0 ? 0 : std::numeric_limits<std::size_t>::max();
+        }
+        return 16 * aBits / 8 + escaped;
+    }
+
+
+    void encodeGroup(Bytes & aOutput, const std::uint8_t * aValues, unsigned int aBits)
+    {
+        if (aBits == 0)
+        {
+            return;
+        }
+        else if (aBits == 8)
+        {
+            std::for_each(aValues, aValues + 16, [&](std::uint8_t aValue){ pushByte(aOutput, aValue); });
+            return;
+        }
+
+        const unsigned int escape = (1u << aBits) - 1;
+        unsigned int packed = 0;
+        unsigned int filled = 0;
+        for (std::size_t value = 0; value != 16; ++value)
+        {
+            packed = (packed << aBits) | std::min<unsigned int>(aValues[value], escape);
+            if ((filled += aBits) == 8)
+            {
+                pushByte(aOutput, packed);
+                packed = filled = 0;
+            }
+        }
+        for (std::size_t value = 0; value != 16; ++value)
+        {
+            if (aValues[value] >= escape)
+            {
+                pushByte(aOutput, aValues[value]);
+            }
+        }
+    }
+
+
+    Bytes encodeVertices(const Bytes & aVertices, std::size_t aCount, std::size_t aStride)
+    {
+        Bytes result;
+        pushByte(result, 0xa0);
+
+        const std::size_t blockSize = std::min((8192 / aStride) & ~std::size_t{15}, std::size_t{256});
+        std::vector<std::uint8_t> last(aStride);
+        std::memcpy(last.data(), aVertices.data(), aStride);
+
+        for (std::size_t first = 0; first < aCount; first += blockSize)
+        {
+            const std::size_t count = std::min(blockSize, aCount - first);
+            const std::size_t groupCount = (count + 15) / 16;
+            for (std::size_t byte = 0; byte != aStride; ++byte)
+            {
+                std::vector<std::uint8_t> deltas(groupCount * 16, 0);
+                for (std::size_t vertex = 0; vertex != count; ++vertex)
+                {
+                    const auto value = std::to_integer<std::uint8_t>(aVertices[(first + vertex) * aStride + byte]);
+                    const auto delta = static_cast<std::uint8_t>(value - last[byte]);
+                    deltas[vertex] = static_cast<std::uint8_t>((delta << 1) ^ (static_cast<std::int8_t>(delta) >> 7));
+                    last[byte] = value;
+                }
+
+                const std::size_t header = result.size();
+                result.resize(header + (groupCount + 3) / 4);
+                for (std::size_t group = 0; group != groupCount; ++group)
+                {
+                    const std::uint8_t * values = deltas.data() + group * 16;
+                    unsigned int best = 3;
+                    for (unsigned int mode = 0; mode != 3; ++mode)
+                    {
+                        if (measureGroup(values, gModeBits[mode]) < measureGroup(values, gModeBits[best]))
+                        {
+                            best = mode;
+                        }
+                    }
+                    result[header + group / 4] |= static_cast<std::byte>(best << ((group % 4) * 2));
+                    encodeGroup(result, values, gModeBits[best]);
+                }
+            }
+        }
+
+        // The tail stores the first vertex, padded to 32 bytes.
+        result.resize(result.size() + std::max<std::size_t>(aStride, 32) - aStride);
+        result.insert(result.end(), aVertices.begin(), aVertices.begin() + aStride);
+        return result;
+    }
+
+
+    void encodeVByte(Bytes & aOutput, std::uint32_t aValue)
+    {
+        for (; aValue >= 128; aValue >>= 7)
+        {
+            pushByte(aOutput, (aValue & 127) | 128);
+        }
+        pushByte(aOutput, aValue);
+    }
+
+
+    std::uint32_t zigzag(std::uint32_t aDelta)
+    {
+        return (aDelta << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(aDelta) >> 31);
+    }
+
+
+    Bytes encodeTriangles(const std::vector<std::uint32_t> & aIndices)
+    {
+        constexpr std::array<std::uint8_t, 16> codeAuxTable{
+            0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+        };
+
+        Bytes code, data;
+        std::array<std::uint32_t, 16> vertexFifo;
+        vertexFifo.fill(~0u);
+        std::array<std::array<std::uint32_t, 2>, 16> edgeFifo;
+        edgeFifo.fill({~0u, ~0u});
+        std::size_t vertexOffset = 0;
+        std::size_t edgeOffset = 0;
+        std::uint32_t next = 0;
+        std::uint32_t last = 0;
+
+        auto findVertex = [&](std::uint32_t aVertex) -> int
+        {
+            for (int distance = 0; distance != 16; ++distance)
+            {
+                if (vertexFifo[(vertexOffset - 1 - distance) & 15] == aVertex)
+                {
+                    return distance;
+                }
+            }
+            return -1;
+        };
+        auto pushVertex = [&](std::uint32_t aVertex, bool aCondition = true)
+        {
+            vertexFifo[vertexOffset] = aVertex;
+            vertexOffset = (vertexOffset + aCondition) & 15;
+        };
+        auto pushEdge = [&](std::uint32_t aFirst, std::uint32_t aSecond)
+        {
+            edgeFifo[edgeOffset] = {aFirst, aSecond};
+            edgeOffset = (edgeOffset + 1) & 15;
+        };
+        auto encodeFree = [&](std::uint32_t aIndex)
+        {
+            encodeVByte(data, zigzag(aIndex - last));
+            last = aIndex;
+        };
+
+        for (std::size_t first = 0; first != aIndices.size(); first += 3)
+        {
+            const std::array<std::uint32_t, 3> triangle{aIndices[first], aIndices[first + 1], aIndices[first + 2]};
+            auto rotate = [&](int aRotation)
+            {
+                return std::array<std::uint32_t, 3>{
+                    triangle[aRotation], triangle[(aRotation + 1) % 3], triangle[(aRotation + 2) % 3]};
+            };
+
+            int edge = -1;
+            for (int distance = 0; distance != 16 && edge == -1; ++distance)
+            {
+                const std::array<std::uint32_t, 2> & candidate = edgeFifo[(edgeOffset - 1 - distance) & 15];
+                for (int rotation = 0; rotation != 3; ++rotation)
+                {
+                    if (candidate[0] == triangle[rotation] && candidate[1] == triangle[(rotation + 1) % 3])
+                    {
+                        edge = (distance << 2) | rotation;
+                        break;
+                    }
+                }
+            }
+
+            if (edge >= 0 && (edge >> 2) < 15)
+            {
+                const auto [a, b, c] = rotate(edge & 3);
+                const int fc = findVertex(c);
+                int fec = (fc >= 1 && fc < 13) ? fc : (c == next ? (++next, 0) : 15);
+                if (fec == 15 && c + 1 == last)
+                {
+                    fec = 13;
+                }
+                else if (fec == 15 && c == last + 1)
+                {
+                    fec = 14;
+                }
+
+                pushByte(code, ((edge >> 2) << 4) | fec);
+                if (fec == 15)
+                {
+                    encodeFree(c);
+                }
+                else if (fec >= 13)
+                {
+                    last = c;
+                }
+                pushVertex(c, fec == 0 || fec >= 13);
+                pushEdge(c, b);
+                pushEdge(a, c);
+            }
+            else
+            {
+                const int rotation = (triangle[1] == next) ? 1 : (triangle[2] == next) ? 2 : 0;
+                const auto [a, b, c] = rotate(rotation);
+                const int fb = findVertex(b);
+                const int fc = findVertex(c);
+                const int fea = (a == next) ? (++next, 0) : 15;
+                const int feb = (fb >= 0 && fb < 14) ? fb + 1 : (b == next ? (++next, 0) : 15);
+                const int fec = (fc >= 0 && fc < 14) ? fc + 1 : (c == next ? (++next, 0) : 15);
+
+                const auto codeAux = static_cast<std::uint8_t>((feb << 4) | fec);
+                const auto tableIndex = std::find(codeAuxTable.begin(), codeAuxTable.end(), codeAux)
+                                        - codeAuxTable.begin();
+                if (fea == 0 && tableIndex < 14)
+                {
+                    pushByte(code, 0xf0 | static_cast<unsigned int>(tableIndex));
+                }
+                else
+                {
+                    pushByte(code, fea == 0 ? 0xfe : 0xff);
+                    pushByte(data, codeAux);
+                }
+
+                for (auto [fe, vertex] : {std::pair{fea, a}, std::pair{feb, b}, std::pair{fec, c}})
+                {
+                    if (fe == 15)
+                    {
+                        encodeFree(vertex);
+                    }
+                }
+
+                pushVertex(a);
+                pushVertex(b, feb == 0 || feb == 15);
+                pushVertex(c, fec == 0 || fec == 15);
+                pushEdge(b, a);
+                pushEdge(c, b);
+                pushEdge(a, c);
+            }
+        }
+
+        Bytes result;
+        pushByte(result, 0xe1);
+        result.insert(result.end(), code.begin(), code.end());
+        result.insert(result.end(), data.begin(), data.end());
+        for (std::uint8_t entry : codeAuxTable)
+        {
+            pushByte(result, entry);
+        }
+        return result;
+    }
+
+
+    Bytes encodeIndexSequence(const std::vector<std::uint32_t> & aIndices)
+    {
+        Bytes result;
+        pushByte(result, 0xd1);
+
+        std::array<std::uint32_t, 2> last{0, 0};
+        unsigned int current = 0;
+        for (std::uint32_t index : aIndices)
+        {
+            auto distance = [index](std::uint32_t aBaseline)
+            { return std::abs(static_cast<std::int64_t>(index) - aBaseline); };
+
+            if (distance(last[current ^ 1]) < distance(last[current]))
+            {
+                current ^= 1;
+            }
+            encodeVByte(result, (zigzag(index - last[current]) << 1) | current);
+            last[current] = index;
+        }
+
+        result.resize(result.size() + 4);
+        return result;
+    }
+
+
+    void encodeOctahedral(float aX, float aY, float aZ, std::int8_t * aOutput)
+    {
+        const float norm = std::abs(aX) + std::abs(aY) + std::abs(aZ);
+        float u = aX / norm;
+        float v = aY / norm;
+        if (aZ < 0.f)
+        {
+            const float folded = (1.f - std::abs(v)) * (u >= 0.f ? 1.f : -1.f);
+            v = (1.f - std::abs(u)) * (v >= 0.f ? 1.f : -1.f);
+            u = folded;
+        }
+        aOutput[0] = static_cast<std::int8_t>(std::lround(u * 127.f));
+        aOutput[1] = static_cast<std::int8_t>(std::lround(v * 127.f));
+        aOutput[2] = 127;
+        aOutput[3] = 0;
+    }
+
+
+    void encodeQuaternion(std::array<float, 4> aQuaternion, std::int16_t * aOutput)
+    {
+        const auto largest = std::max_element(aQuaternion.begin(), aQuaternion.end(),
+                                              [](float a, float b){ return std::abs(a) < std::abs(b); })
+                             - aQuaternion.begin();
+        const float sign = aQuaternion[largest] < 0.f ? -1.f : 1.f;
+        for (int component = 0; component != 3; ++component)
+        {
+            aOutput[component] = static_cast<std::int16_t>(
+                std::lround(sign * aQuaternion[(largest + component + 1) & 3] * std::numbers::sqrt2_v<float> * 32767.f));
+        }
+        aOutput[3] = static_cast<std::int16_t>((8191 << 2) | largest);
+    }
+
+
+    /// @brief Rotate each triangle to start with its smallest index, since the triangle codec
+    /// preserves triangles and their winding, but not their first vertex.
+    template <class T_index>
+    std::vector<std::uint32_t> canonicalizeTriangles(const std::vector<T_index> & aIndices)
+    {
+        std::vector<std::uint32_t> result(aIndices.begin(), aIndices.end());
+        for (auto triangle = result.begin(); triangle != result.end(); triangle += 3)
+        {
+            std::rotate(triangle, std::min_element(triangle, triangle + 3), triangle + 3);
+        }
+        return result;
+    }
+
+
+    //
+    // glTF assets
+    //
+    enum class Storage
+    {
+        Float,
+        Quantized, // KHR_mesh_quantization
+        Meshopt,   // KHR_mesh_quantization and EXT_meshopt_compression
+    };
+
+
+    /// @brief Write a glTF (and its .bin) with a single unit sphere mesh, with positions, normals and indices.
+    filesystem::path writeSphere(const Geometry & aSphere, Storage aStorage, const std::string & aName)
+    {
+        const std::size_t vertexCount = aSphere.positions.size() / 3;
+        const bool shortIndices = vertexCount <= 65536;
+        const std::size_t indexSize = shortIndices ? 2 : 4;
+
+        // Uncompressed content of the views.
+        Bytes positions, normals, indices;
+        if (aStorage == Storage::Float)
+        {
+            positions = toBytes(aSphere.positions);
+            // The normals of a unit sphere are its positions.
+            normals = positions;
+        }
+        else
+        {
+            std::vector<std::int16_t> quantized(vertexCount * 4, 0);
+            std::vector<std::int8_t> octahedral(vertexCount * 4, 0);
+            for (std::size_t vertex = 0; vertex != vertexCount; ++vertex)
+            {
+                const float * position = &aSphere.positions[vertex * 3];
+                for (std::size_t component = 0; component != 3; ++component)
+                {
+                    quantized[vertex * 4 + component] = static_cast<std::int16_t>(std::lround(position[component] * 32767.f));
+                }
+
+                if (aStorage == Storage::Meshopt)
+                {
+                    encodeOctahedral(position[0], position[1], position[2], &octahedral[vertex * 4]);
+                }
+                else
+                {
+                    for (std::size_t component = 0; component != 3; ++component)
+                    {
+                        octahedral[vertex * 4 + component] = static_cast<std::int8_t>(std::lround(position[component] * 127.f));
+                    }
+                }
+            }
+            positions = toBytes(quantized);
+            normals = toBytes(octahedral);
+        }
+        if (shortIndices)
+        {
+            indices = toBytes(std::vector<std::uint16_t>(aSphere.indices.begin(), aSphere.indices.end()));
+        }
+        else
+        {
+            indices = toBytes(aSphere.indices);
+        }
+
+        const std::size_t positionStride = (aStorage == Storage::Float) ? 12 : 8;
+        const std::size_t normalStride = (aStorage == Storage::Float) ? 12 : 4;
+
+        GltfBuilder builder;
+        std::size_t fallbackSize = 0;
+        auto addView = [&](const Bytes & aContent, std::size_t aStride, std::size_t aCount, bool aIsAttribute,
+                           const char * aFilter)
+        {
+            const std::string stride = aIsAttribute ? ", \"byteStride\": " + std::to_string(aStride) : "";
+            const std::string target = aIsAttribute ? ", \"target\": 34962" : ", \"target\": 34963";
+
+            if (aStorage != Storage::Meshopt)
+            {
+                builder.addView(aContent.data(), aContent.size(), (stride + target).substr(2));
+            }
+            else
+            {
+                const Bytes encoded = aIsAttribute ?
+                    encodeVertices(aContent, aCount, aStride) : encodeTriangles(aSphere.indices);
+                const std::size_t encodedOffset = builder.append(encoded.data(), encoded.size());
+                builder.addView("\"buffer\": 1, \"byteOffset\": " + std::to_string(fallbackSize)
+                                + ", \"byteLength\": " + std::to_string(aContent.size()) + stride + target
+                                + ", \"extensions\": {\"EXT_meshopt_compression\": {\"buffer\": 0, \"byteOffset\": "
+                                + std::to_string(encodedOffset) + ", \"byteLength\": " + std::to_string(encoded.size())
+                                + ", \"byteStride\": " + std::to_string(aStride) + ", \"count\": " + std::to_string(aCount)
+                                + ", \"mode\": \"" + (aIsAttribute ? "ATTRIBUTES" : "TRIANGLES") + "\""
+                                + ", \"filter\": \"" + aFilter + "\"}}");
+                fallbackSize += (aContent.size() + 3) & ~std::size_t{3};
+            }
+        };
+        addView(positions, positionStride, vertexCount, true, "NONE");
+        addView(normals, normalStride, vertexCount, true, "OCTAHEDRAL");
+        addView(indices, indexSize, aSphere.indices.size(), false, "NONE");
+
+        const std::string attributeType = (aStorage == Storage::Float) ?
+            "\"componentType\": 5126" : "\"componentType\": 5122, \"normalized\": true";
+        const std::string normalType = (aStorage == Storage::Float) ?
+            "\"componentType\": 5126" : "\"componentType\": 5120, \"normalized\": true";
+        const std::string bounds = (aStorage == Storage::Float) ?
+            "\"min\": [-1, -1, -1], \"max\": [1, 1, 1]" : "\"min\": [-32767, -32767, -32767], \"max\": [32767, 32767, 32767]";
+        builder.addAccessor("\"bufferView\": 0, " + attributeType + ", \"type\": \"VEC3\", \"count\": "
+                            + std::to_string(vertexCount) + ", " + bounds);
+        builder.addAccessor("\"bufferView\": 1, " + normalType + ", \"type\": \"VEC3\", \"count\": "
+                            + std::to_string(vertexCount));
+        builder.addAccessor("\"bufferView\": 2, \"componentType\": " + std::string{shortIndices ? "5123" : "5125"}
+                            + ", \"type\": \"SCALAR\", \"count\": " + std::to_string(aSphere.indices.size()));
+
+        std::string extensions;
+        if (aStorage == Storage::Quantized)
+        {
+            extensions = "\"extensionsUsed\": [\"KHR_mesh_quantization\"], "
+                         "\"extensionsRequired\": [\"KHR_mesh_quantization\"],";
+        }
+        else if (aStorage == Storage::Meshopt)
+        {
+            extensions = "\"extensionsUsed\": [\"KHR_mesh_quantization\", \"EXT_meshopt_compression\"], "
+                         "\"extensionsRequired\": [\"KHR_mesh_quantization\", \"EXT_meshopt_compression\"],";
+            builder.addBuffer("\"byteLength\": " + std::to_string(fallbackSize)
+                              + ", \"extensions\": {\"EXT_meshopt_compression\": {\"fallback\": true}}");
+        }
+
+        return builder.write(aName,
+            extensions + "\"scene\": 0, \"scenes\": [{\"nodes\": [0]}], \"nodes\": [{\"mesh\": 0}],"
+            "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0, \"NORMAL\": 1}, \"indices\": 2}]}]");
+    }
+
+
+    std::uintmax_t getDiskSize(const filesystem::path & aGltf)
+    {
+        filesystem::path bin = aGltf;
+        return filesystem::file_size(aGltf) + filesystem::file_size(bin.replace_extension(".bin"));
+    }
+
+
+    struct LoadedMesh
+    {
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<std::uint32_t> indices;
+    };
+
+
+    LoadedMesh loadMesh(const filesystem::path & aGltf)
+    {
+        const Gltf gltf{aGltf};
+        gltf::BufferCache buffers{gltf};
+        const gltf::Primitive & primitive = gltf.get(gltf::Index<gltf::Mesh>{0})->primitives[0];
+        return {
+            .positions = readAsFloats(buffers, gltf.get(primitive.attributes.at("POSITION"))),
+            .normals = readAsFloats(buffers, gltf.get(primitive.attributes.at("NORMAL"))),
+            .indices = readAsIndices(buffers, gltf.get(*primitive.indices)),
+        };
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Meshopt vertex codec")
+{
+    GIVEN("Vertices mixing smooth and random bytes, for several strides and counts")
+    {
+        std::mt19937 generator{37};
+
+        THEN("Decoding restores the vertices")
+        {
+            for (std::size_t stride : {4, 8, 12, 16, 36, 64})
+            {
+                // Counts exercise partial groups and blocks, and the scalar group decoding near the end.
+                for (std::size_t count : {1, 15, 16, 17, 255, 300, 1000})
+                {
+                    Bytes vertices(count * stride);
+                    for (std::size_t vertex = 0; vertex != count; ++vertex)
+                    {
+                        for (std::size_t byte = 0; byte != stride; ++byte)
+                        {
+                            // Some bytes are constant, some slowly varying, some noisy.
+                            const std::size_t value = (byte % 3 == 0) ? byte
+                                                    : (byte % 3 == 1) ? vertex / (byte + 1)
+                                                    : generator();
+                            vertices[vertex * stride + byte] = static_cast<std::byte>(value);
+                        }
+                    }
+
+                    const Bytes encoded = encodeVertices(vertices, count, stride);
+                    Bytes decoded(count * stride);
+                    detail::decodeMeshoptVertices(encoded, count, stride, decoded);
+                    REQUIRE(decoded == vertices);
+                }
+            }
+        }
+    }
+
+    GIVEN("A valid encoded stream")
+    {
+        const std::size_t count = 100;
+        Bytes vertices(count * 8);
+        std::generate(vertices.begin(), vertices.end(), [value = 0]() mutable { return static_cast<std::byte>(value++ / 7); });
+        const Bytes encoded = encodeVertices(vertices, count, 8);
+        Bytes decoded(count * 8);
+
+        THEN("Truncation, a wrong header or a wrong count are detected")
+        {
+            REQUIRE_THROWS_AS(detail::decodeMeshoptVertices({encoded.data(), encoded.size() - 1}, count, 8, decoded),
+                              std::invalid_argument);
+
+            Bytes corrupted = encoded;
+            corrupted[0] = std::byte{0x50};
+            REQUIRE_THROWS_AS(detail::decodeMeshoptVertices(corrupted, count, 8, decoded), std::invalid_argument);
+
+            REQUIRE_THROWS_AS(detail::decodeMeshoptVertices(encoded, count - 20, 8, decoded), std::invalid_argument);
+            REQUIRE_THROWS_AS(detail::decodeMeshoptVertices(encoded, count, 6, decoded), std::invalid_argument);
+        }
+    }
+}
+
+
+SCENARIO("Meshopt index codecs")
+{
+    GIVEN("Reference streams encoded by meshoptimizer")
+    {
+        THEN("Triangle decoding matches the reference indices, as 16 or 32 bit indices")
+        {
+            std::vector<std::uint32_t> decoded(gReferenceTriangles.size());
+            detail::decodeMeshoptTriangles(toBytes(gReferenceTriangleStream), decoded.size(), 4,
+                                           std::as_writable_bytes(std::span{decoded}));
+            REQUIRE(decoded == gReferenceTriangles);
+
+            std::vector<std::uint16_t> decodedShort(gReferenceTriangles.size());
+            detail::decodeMeshoptTriangles(toBytes(gReferenceTriangleStream), decodedShort.size(), 2,
+                                           std::as_writable_bytes(std::span{decodedShort}));
+            REQUIRE(std::equal(decodedShort.begin(), decodedShort.end(), gReferenceTriangles.begin()));
+        }
+
+        THEN("Index sequence decoding matches the reference indices")
+        {
+            std::vector<std::uint32_t> decoded(gReferenceIndexSequence.size());
+            detail::decodeMeshoptIndices(toBytes(gReferenceIndexSequenceStream), decoded.size(), 4,
+                                         std::as_writable_bytes(std::span{decoded}));
+            REQUIRE(decoded == gReferenceIndexSequence);
+        }
+    }
+
+    GIVEN("The triangles of a sphere, in their original and in a shuffled order")
+    {
+        const Geometry sphere = makeSphere(24, 32);
+        std::vector<std::uint32_t> shuffled = sphere.indices;
+        {
+            std::vector<std::array<std::uint32_t, 3>> triangles(shuffled.size() / 3);
+            std::memcpy(triangles.data(), shuffled.data(), shuffled.size() * sizeof(std::uint32_t));
+            std::shuffle(triangles.begin(), triangles.end(), std::mt19937{50});
+            std::memcpy(shuffled.data(), triangles.data(), shuffled.size() * sizeof(std::uint32_t));
+        }
+
+        THEN("Triangle decoding restores them (up to a rotation of each triangle), as 16 or 32 bit indices")
+        {
+            for (const std::vector<std::uint32_t> & indices : {sphere.indices, shuffled})
+            {
+                const Bytes encoded = encodeTriangles(indices);
+
+                std::vector<std::uint32_t> decoded(indices.size());
+                detail::decodeMeshoptTriangles(encoded, indices.size(), 4, std::as_writable_bytes(std::span{decoded}));
+                REQUIRE(canonicalizeTriangles(decoded) == canonicalizeTriangles(indices));
+
+                std::vector<std::uint16_t> decodedShort(indices.size());
+                detail::decodeMeshoptTriangles(encoded, indices.size(), 2, std::as_writable_bytes(std::span{decodedShort}));
+                REQUIRE(canonicalizeTriangles(decodedShort) == canonicalizeTriangles(indices));
+            }
+        }
+
+        THEN("A truncated triangle stream is detected")
+        {
+            const Bytes encoded = encodeTriangles(shuffled);
+            std::vector<std::uint32_t> decoded(shuffled.size());
+            REQUIRE_THROWS_AS(detail::decodeMeshoptTriangles({encoded.data(), encoded.size() - 20},
+                                                             shuffled.size(), 4,
+                                                             std::as_writable_bytes(std::span{decoded})),
+                              std::invalid_argument);
+        }
+
+        THEN("Index sequence decoding restores them")
+        {
+            const Bytes encoded = encodeIndexSequence(shuffled);
+            std::vector<std::uint32_t> decoded(shuffled.size());
+            detail::decodeMeshoptIndices(encoded, shuffled.size(), 4, std::as_writable_bytes(std::span{decoded}));
+            REQUIRE(decoded == shuffled);
+        }
+    }
+}
+
+
+SCENARIO("Meshopt filters")
+{
+    GIVEN("Reference filter inputs from meshoptimizer")
+    {
+        THEN("The octahedral filter matches the reference outputs, on bytes and shorts")
+        {
+            std::vector<std::int8_t> bytes{0, 1, 127, 0, 0, -69, 127, 1, -1, 1, 127, 0, 14, -126, 127, 1};
+            detail::applyMeshoptOctahedralFilter(std::as_writable_bytes(std::span{bytes}), 4, 4);
+            REQUIRE(bytes == std::vector<std::int8_t>{0, 1, 127, 0, 0, -97, 82, 1, -1, 1, 127, 0, 1, -126, -15, 1});
+
+            std::vector<std::uint16_t> shorts{0, 1, 2047, 0, 0, 1870, 2047, 1, 2017, 1, 2047, 0, 14, 1300, 2047, 1};
+            detail::applyMeshoptOctahedralFilter(std::as_writable_bytes(std::span{shorts}), 4, 8);
+            REQUIRE(shorts == std::vector<std::uint16_t>{
+                0, 16, 32767, 0, 0, 32621, 3088, 1, 32764, 16, 471, 0, 307, 28541, 16093, 1});
+        }
+
+        THEN("The quaternion filter matches the reference outputs")
+        {
+            std::vector<std::uint16_t> shorts{
+                0, 1, 0, 0x7fc, 0, 1870, 0, 0x7fd, 2017, 1, 0, 0x7fe, 14, 1300, 0, 0x7ff};
+            detail::applyMeshoptQuaternionFilter(std::as_writable_bytes(std::span{shorts}), 4, 8);
+            REQUIRE(shorts == std::vector<std::uint16_t>{
+                32767, 0, 11, 0, 0, 25013, 0, 21166, 11, 0, 23504, 22830, 158, 14715, 0, 29277});
+        }
+
+        THEN("The exponential filter matches the reference outputs")
+        {
+            std::vector<std::uint32_t> words{0, 0xff000003, 0x02fffff7, 0xfe7fffff};
+            detail::applyMeshoptExponentialFilter(std::as_writable_bytes(std::span{words}), 4, 4);
+            REQUIRE(words == std::vector<std::uint32_t>{0, 0x3fc00000, 0xc2100000, 0x49fffffe});
+        }
+    }
+
+    GIVEN("Unit vectors encoded octahedrally")
+    {
+        const Geometry sphere = makeSphere(12, 16);
+        const std::size_t count = sphere.positions.size() / 3;
+        std::vector<std::int8_t> encoded(count * 4);
+        for (std::size_t vertex = 0; vertex != count; ++vertex)
+        {
+            const float * position = &sphere.positions[vertex * 3];
+            encodeOctahedral(position[0], position[1], position[2], &encoded[vertex * 4]);
+        }
+
+        THEN("The filter reconstructs them at the precision of the encoding")
+        {
+            detail::applyMeshoptOctahedralFilter(std::as_writable_bytes(std::span{encoded}), count, 4);
+            for (std::size_t vertex = 0; vertex != count; ++vertex)
+            {
+                for (std::size_t component = 0; component != 3; ++component)
+                {
+                    REQUIRE(encoded[vertex * 4 + component] / 127.f
+                            == Approx(sphere.positions[vertex * 3 + component]).margin(0.03));
+                }
+            }
+        }
+    }
+
+    GIVEN("Unit quaternions encoded with their three smallest components")
+    {
+        const std::vector<std::array<float, 4>> quaternions{
+            {0.f, 0.f, 0.f, 1.f},
+            {0.5f, -0.5f, 0.5f, -0.5f},
+            {0.f, -0.8f, 0.f, 0.6f},
+            {0.1825742f, 0.3651484f, 0.5477226f, -0.7302967f},
+        };
+        std::vector<std::int16_t> encoded(quaternions.size() * 4);
+        for (std::size_t quaternion = 0; quaternion != quaternions.size(); ++quaternion)
+        {
+            encodeQuaternion(quaternions[quaternion], &encoded[quaternion * 4]);
+        }
+
+        THEN("The filter reconstructs them, up to their sign")
+        {
+            detail::applyMeshoptQuaternionFilter(std::as_writable_bytes(std::span{encoded}), quaternions.size(), 8);
+            for (std::size_t quaternion = 0; quaternion != quaternions.size(); ++quaternion)
+            {
+                const std::array<float, 4> & expected = quaternions[quaternion];
+                // The encoding makes the largest component positive.
+                const float sign = (*std::max_element(expected.begin(), expected.end(),
+                                                      [](float a, float b){ return std::abs(a) < std::abs(b); })
+                                    < 0.f) ? -1.f : 1.f;
+                for (std::size_t component = 0; component != 4; ++component)
+                {
+                    REQUIRE(encoded[quaternion * 4 + component] / 32767.f
+                            == Approx(sign * expected[component]).margin(0.001));
+                }
+            }
+        }
+    }
+
+    GIVEN("Floats encoded with a mantissa and an exponent")
+    {
+        const std::vector<float> values{1.5f, -3.25f, 1024.f, 0.0078125f, 0.f, -1.f / 3.f};
+        std::vector<std::uint32_t> encoded;
+        for (float value : values)
+        {
+            int exponent = 0;
+            std::frexp(value, &exponent);
+            exponent -= 23;
+            const auto mantissa = static_cast<std::int32_t>(std::lround(std::ldexp(value, -exponent)));
+            encoded.push_back((static_cast<std::uint32_t>(exponent) << 24) | (mantissa & 0xffffff));
+        }
+
+        THEN("The filter reconstructs them")
+        {
+            detail::applyMeshoptExponentialFilter(std::as_writable_bytes(std::span{encoded}), values.size(), 4);
+            for (std::size_t valueId = 0; valueId != values.size(); ++valueId)
+            {
+                float decoded;
+                std::memcpy(&decoded, &encoded[valueId], sizeof(decoded));
+                REQUIRE(decoded == Approx(values[valueId]).epsilon(1e-6));
+            }
+        }
+    }
+}
+
+
+SCENARIO("Quantized and meshopt compressed glTF")
+{
+    initializeLogging();
+
+    GIVEN("A sphere stored as floats, quantized, and quantized with meshopt compression")
+    {
+        const Geometry sphere = makeSphere(32, 48);
+        const LoadedMesh floats = loadMesh(writeSphere(sphere, Storage::Float, "sphere_float"));
+        const LoadedMesh quantized = loadMesh(writeSphere(sphere, Storage::Quantized, "sphere_quantized"));
+        const filesystem::path meshoptPath = writeSphere(sphere, Storage::Meshopt, "sphere_meshopt");
+        const LoadedMesh meshopt = loadMesh(meshoptPath);
+
+        THEN("Quantized attributes are read at the precision of their encoding")
+        {
+            REQUIRE(floats.positions == sphere.positions);
+            REQUIRE(quantized.positions.size() == sphere.positions.size());
+            for (std::size_t component = 0; component != sphere.positions.size(); ++component)
+            {
+                REQUIRE(quantized.positions[component] == Approx(sphere.positions[component]).margin(1.f / 32767));
+                REQUIRE(quantized.normals[component] == Approx(sphere.positions[component]).margin(1.f / 127));
+            }
+            REQUIRE(quantized.indices == sphere.indices);
+        }
+
+        THEN("Compressed buffer views decode to the quantized data")
+        {
+            REQUIRE(meshopt.positions == quantized.positions);
+            REQUIRE(canonicalizeTriangles(meshopt.indices) == canonicalizeTriangles(sphere.indices));
+            for (std::size_t component = 0; component != sphere.positions.size(); ++component)
+            {
+                REQUIRE(meshopt.normals[component] == Approx(sphere.positions[component]).margin(0.03));
+            }
+        }
+
+        THEN("The extensions are listed")
+        {
+            const Gltf gltf{meshoptPath};
+            REQUIRE(gltf.getExtensionsUsed().size() == 2);
+            REQUIRE(gltf.getExtensionsUsed()[1] == "EXT_meshopt_compression");
+            REQUIRE(gltf.get(gltf::Index<gltf::BufferView>{0})->meshoptCompression->mode
+                    == gltf::bufferview::MeshoptCompression::Mode::Attributes);
+        }
+    }
+
+    GIVEN("A glTF requiring an unsupported extension")
+    {
+        const filesystem::path path = GltfBuilder{}.write("unsupported_extension",
+            "\"extensionsRequired\": [\"KHR_draco_mesh_compression\"], \"scenes\": [], \"nodes\": [], \"meshes\": []");
+
+        THEN("Loading throws")
+        {
+            REQUIRE_THROWS_AS(Gltf{path}, std::runtime_error);
+        }
+    }
+}
+
+
+TEST_CASE("Quantized and meshopt compressed glTF loading", "[!benchmark]")
+{
+    initializeLogging();
+
+    const Geometry sphere = makeSphere(512, 512);
+    const filesystem::path floatPath = writeSphere(sphere, Storage::Float, "benchmark_float");
+    const filesystem::path quantizedPath = writeSphere(sphere, Storage::Quantized, "benchmark_quantized");
+    const filesystem::path meshoptPath = writeSphere(sphere, Storage::Meshopt, "benchmark_meshopt");
+
+    WARN("A sphere of " << sphere.positions.size() / 3 << " vertices and " << sphere.indices.size() / 3
+         << " triangles takes " << getDiskSize(floatPath) << " bytes as floats, "
+         << getDiskSize(quantizedPath) << " bytes quantized, "
+         << getDiskSize(meshoptPath) << " bytes quantized and meshopt compressed.");
+
+    BENCHMARK("Load floats")
+    {
+        return loadMesh(floatPath);
+    };
+
+    BENCHMARK("Load quantized")
+    {
+        return loadMesh(quantizedPath);
+    };
+
+    BENCHMARK("Load meshopt compressed")
+    {
+        return loadMesh(meshoptPath);
+    };
+}
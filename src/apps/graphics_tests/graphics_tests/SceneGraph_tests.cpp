@@ -0,0 +1,236 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/SceneGraph.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+using namespace ad::arte::gltf;
+
+
+namespace {
+
+    constexpr std::size_t gRootCount = 4;
+
+    /// @brief Write a glTF scene of `aNodeCount` nodes with random poses,
+    /// where each node past the first `gRootCount` roots is the child of a random preceding node.
+    filesystem::path writeRandomHierarchy(std::size_t aNodeCount, std::mt19937 & aRandom)
+    {
+        std::uniform_real_distribution<float> translation{-2.f, 2.f};
+        std::uniform_real_distribution<float> scale{0.8f, 1.2f};
+        std::normal_distribution<float> quaternion;
+
+        std::vector<std::vector<std::size_t>> children(aNodeCount);
+        for (std::size_t node = gRootCount; node < aNodeCount; ++node)
+        {
+            children[std::uniform_int_distribution<std::size_t>{0, node - 1}(aRandom)].push_back(node);
+        }
+
+        std::string nodes;
+        for (std::size_t node = 0; node != aNodeCount; ++node)
+        {
+            float q[4] = {quaternion(aRandom), quaternion(aRandom), quaternion(aRandom), quaternion(aRandom)};
+            const float norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+            nodes += (node == 0 ? "{" : ",{");
+            nodes += "\"translation\": [" + std::to_string(translation(aRandom)) + ", "
+                     + std::to_string(translation(aRandom)) + ", " + std::to_string(translation(aRandom)) + "], ";
+            nodes += "\"rotation\": [" + std::to_string(q[0] / norm) + ", " + std::to_string(q[1] / norm) + ", "
+                     + std::to_string(q[2] / norm) + ", " + std::to_string(q[3] / norm) + "], ";
+            nodes += "\"scale\": [" + std::to_string(scale(aRandom)) + ", "
+                     + std::to_string(scale(aRandom)) + ", " + std::to_string(scale(aRandom)) + "]";
+            if (!children[node].empty())
+            {
+                nodes += ", \"children\": [";
+                for (std::size_t child : children[node])
+                {
+                    nodes += (child == children[node].front() ? "" : ", ") + std::to_string(child);
+                }
+                nodes += "]";
+            }
+            nodes += "}";
+        }
+
+        return GltfBuilder{}.write("scene_graph_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0, 1, 2, 3]}],)"
+            "\"nodes\": [" + nodes + "], \"meshes\": []");
+    }
+
+    /// @brief The reference product `aFirst * aThen`, as a plain triple loop.
+    Affine multiply(const Affine & aFirst, const Affine & aThen)
+    {
+        Affine result;
+        for (std::size_t row = 0; row != 4; ++row)
+        {
+            for (std::size_t column = 0; column != 3; ++column)
+            {
+                float sum = (row == 3) ? aThen.at(3, column) : 0.f;
+                for (std::size_t inner = 0; inner != 3; ++inner)
+                {
+                    sum += aFirst.at(row, inner) * aThen.at(inner, column);
+                }
+                result.at(row, column) = sum;
+            }
+        }
+        return result;
+    }
+
+    /// @brief Naive recursive evaluation of the world transformation of `aId`, from the local poses only.
+    Affine evaluateWorld(const SceneGraph & aScene, SceneGraph::NodeId aId)
+    {
+        const SceneGraph::TrsArrays & local = aScene.getLocalPoses();
+        const Affine pose = makeAffine({local.tx[aId], local.ty[aId], local.tz[aId]},
+                                       {local.rx[aId], local.ry[aId], local.rz[aId], local.rw[aId]},
+                                       {local.sx[aId], local.sy[aId], local.sz[aId]});
+        const SceneGraph::NodeId parent = aScene.getParent(aId);
+        return (parent == SceneGraph::gNoParent) ? pose : multiply(pose, evaluateWorld(aScene, parent));
+    }
+
+    /// @brief Count the nodes whose world transformation differs from the naive evaluation.
+    std::size_t countWorldMismatches(const SceneGraph & aScene)
+    {
+        std::size_t mismatches = 0;
+        for (SceneGraph::NodeId id = 0; id != aScene.size(); ++id)
+        {
+            const Affine expected = evaluateWorld(aScene, id);
+            const Affine & world = aScene.getWorldTransformation(id);
+            for (std::size_t element = 0; element != world.elements.size(); ++element)
+            {
+                const float tolerance = 1e-4f * std::max(1.f, std::abs(expected.elements[element]));
+                if (std::abs(world.elements[element] - expected.elements[element]) > tolerance)
+                {
+                    ++mismatches;
+                    break;
+                }
+            }
+        }
+        return mismatches;
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Scene graph world transformations")
+{
+    initializeLogging();
+    std::mt19937 random{7};
+
+    GIVEN("Two random affine transformations")
+    {
+        std::uniform_real_distribution<float> element{-2.f, 2.f};
+        Affine first, then;
+        for (float & value : first.elements) { value = element(random); }
+        for (float & value : then.elements) { value = element(random); }
+
+        THEN("Their composition is the matrix product")
+        {
+            const Affine composed = compose(first, then);
+            const Affine expected = multiply(first, then);
+            for (std::size_t index = 0; index != composed.elements.size(); ++index)
+            {
+                REQUIRE(composed.elements[index] == Approx(expected.elements[index]).margin(1e-5f));
+            }
+        }
+
+        THEN("The normal matrix is the inverse transpose of the linear part")
+        {
+            // With N the inverse transpose of L: N * transpose(L) is the identity,
+            // so a normal transformed by N stays orthogonal to tangents transformed by L.
+            const std::array<float, 9> normal = getNormalMatrix(first);
+            std::size_t mismatches = 0;
+            for (std::size_t row = 0; row != 3; ++row)
+            {
+                for (std::size_t column = 0; column != 3; ++column)
+                {
+                    float product = 0.f;
+                    for (std::size_t inner = 0; inner != 3; ++inner)
+                    {
+                        product += normal[3 * row + inner] * first.at(column, inner);
+                    }
+                    mismatches += (product != Approx(row == column ? 1.f : 0.f).margin(1e-4f)) ? 1 : 0;
+                }
+            }
+            REQUIRE(mismatches == 0);
+        }
+    }
+
+    // The small hierarchy is updated serially, the large one by parallel tasks.
+    for (std::size_t nodeCount : {std::size_t{200}, std::size_t{5000}})
+    {
+        GIVEN("A random hierarchy of " + std::to_string(nodeCount) + " nodes")
+        {
+            const Gltf gltf{writeRandomHierarchy(nodeCount, random)};
+            SceneGraph scene{gltf, Index<Scene>{0}};
+            REQUIRE(scene.size() == nodeCount);
+
+            THEN("The initial world transformations match a naive recursive evaluation")
+            {
+                REQUIRE(countWorldMismatches(scene) == 0);
+            }
+
+            WHEN("Random local poses are edited between updates")
+            {
+                std::uniform_int_distribution<SceneGraph::NodeId> pickNode{0, static_cast<SceneGraph::NodeId>(nodeCount - 1)};
+                std::uniform_real_distribution<float> value{0.5f, 1.5f};
+
+                std::size_t worldMismatches = 0;
+                std::size_t changedMismatches = 0;
+                for (std::size_t round = 0; round != 8; ++round)
+                {
+                    std::vector<bool> edited(nodeCount, false);
+                    for (std::size_t edit = 0; edit != nodeCount / 50 + 1; ++edit)
+                    {
+                        const SceneGraph::NodeId id = pickNode(random);
+                        edited[id] = true;
+                        switch (edit % 4)
+                        {
+                            case 0:
+                                scene.setTranslation(id, value(random), -value(random), value(random));
+                                break;
+                            case 1:
+                                scene.setRotation(id, 0.f, std::sqrt(0.5f), 0.f, std::sqrt(0.5f));
+                                break;
+                            case 2:
+                                scene.setScale(id, value(random), value(random), value(random));
+                                break;
+                            case 3:
+                                scene.accessLocalPoses().ty[id] = value(random);
+                                scene.markLocalDirty(id);
+                                break;
+                        }
+                    }
+
+                    scene.update();
+                    worldMismatches += countWorldMismatches(scene);
+
+                    // Parents come first in the flattened order.
+                    for (SceneGraph::NodeId id = 0; id != nodeCount; ++id)
+                    {
+                        const SceneGraph::NodeId parent = scene.getParent(id);
+                        if (parent != SceneGraph::gNoParent && edited[parent])
+                        {
+                            edited[id] = true;
+                        }
+                        changedMismatches += (scene.isWorldChanged(id) != edited[id]) ? 1 : 0;
+                    }
+                }
+
+                THEN("Only the edited subtrees are recomputed, to the naive recursive evaluation")
+                {
+                    REQUIRE(worldMismatches == 0);
+                    REQUIRE(changedMismatches == 0);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#include "catch.hpp"
+
+#include <graphics/detail/ShelfPacker.h>
+
+#include <random>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics;
+using namespace ad::graphics::detail;
+
+
+namespace {
+
+    struct Placed
+    {
+        math::Position<2, GLint> position;
+        math::Size<2, GLint> size;
+    };
+
+    bool overlap(const Placed & aLhs, const Placed & aRhs)
+    {
+        return aLhs.position.x() < aRhs.position.x() + aRhs.size.width()
+            && aRhs.position.x() < aLhs.position.x() + aLhs.size.width()
+            && aLhs.position.y() < aRhs.position.y() + aRhs.size.height()
+            && aRhs.position.y() < aLhs.position.y() + aLhs.size.height();
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Shelf packing of rectangles")
+{
+    GIVEN("An empty packer")
+    {
+        ShelfPacker packer{{64, 32}};
+
+        THEN("Rectangles of the same height share a shelf")
+        {
+            REQUIRE(packer.insert({10, 8}) == math::Position<2, GLint>{0, 0});
+            REQUIRE(packer.insert({20, 8}) == math::Position<2, GLint>{10, 0});
+            REQUIRE(packer.getUsedHeight() == 8);
+        }
+
+        THEN("A full shelf opens a new one above it")
+        {
+            REQUIRE(packer.insert({60, 8}));
+            REQUIRE(packer.insert({10, 8}) == math::Position<2, GLint>{0, 8});
+            REQUIRE(packer.getUsedHeight() == 16);
+        }
+
+        THEN("A much shorter rectangle does not waste a tall shelf while there is room")
+        {
+            REQUIRE(packer.insert({10, 20}));
+            REQUIRE(packer.insert({10, 4}) == math::Position<2, GLint>{0, 20});
+            // The tall shelf is at most twice as tall as this rectangle: it is used.
+            REQUIRE(packer.insert({10, 10}) == math::Position<2, GLint>{10, 0});
+        }
+
+        THEN("Rectangles that do not fit are rejected")
+        {
+            REQUIRE_FALSE(packer.insert({65, 1}));
+            REQUIRE_FALSE(packer.insert({1, 33}));
+            REQUIRE(packer.insert({64, 32}));
+            REQUIRE_FALSE(packer.insert({1, 1}));
+        }
+    }
+
+    GIVEN("Many glyph sized rectangles")
+    {
+        const math::Size<2, GLint> dimensions{256, 256};
+        ShelfPacker packer{dimensions};
+        std::mt19937 generator{41};
+        std::uniform_int_distribution<GLint> width{2, 20};
+        std::uniform_int_distribution<GLint> height{14, 20};
+
+        std::vector<Placed> placed;
+        for (std::optional<math::Position<2, GLint>> position; ; )
+        {
+            const math::Size<2, GLint> size{width(generator), height(generator)};
+            if (!(position = packer.insert(size)))
+            {
+                break;
+            }
+            placed.push_back({*position, size});
+        }
+
+        THEN("They are packed in both dimensions, inside the area, without overlapping")
+        {
+            GLint area = 0;
+            std::size_t overlaps = 0;
+            for (std::size_t index = 0; index != placed.size(); ++index)
+            {
+                const Placed & rectangle = placed[index];
+                REQUIRE(rectangle.position.x() >= 0);
+                REQUIRE(rectangle.position.y() >= 0);
+                REQUIRE(rectangle.position.x() + rectangle.size.width() <= dimensions.width());
+                REQUIRE(rectangle.position.y() + rectangle.size.height() <= dimensions.height());
+                for (std::size_t other = index + 1; other != placed.size(); ++other)
+                {
+                    overlaps += overlap(rectangle, placed[other]) ? 1 : 0;
+                }
+                area += rectangle.size.width() * rectangle.size.height();
+            }
+            REQUIRE(overlaps == 0);
+            REQUIRE(packer.getUsedHeight() > 200);
+            REQUIRE(area > dimensions.width() * dimensions.height() * 3 / 4);
+        }
+    }
+}
@@ -0,0 +1,216 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/SceneGraph.h>
+#include <arte/gltf/Skinning.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+using namespace ad::arte::gltf;
+
+
+namespace {
+
+    constexpr std::size_t gJointCount = 3;
+
+    /// @brief Rigid inverse bind matrices, row-major row-vector (i.e. the glTF column-major layout).
+    const std::vector<float> gInverseBinds{
+        // Identity
+        1.f, 0.f, 0.f, 0.f,
+        0.f, 1.f, 0.f, 0.f,
+        0.f, 0.f, 1.f, 0.f,
+        0.f, 0.f, 0.f, 1.f,
+        // Translation by (0, -1, 0)
+        1.f, 0.f,  0.f, 0.f,
+        0.f, 1.f,  0.f, 0.f,
+        0.f, 0.f,  1.f, 0.f,
+        0.f, -1.f, 0.f, 1.f,
+        // 90 degrees around y, then translation by (1, -2, 0.5)
+        0.f, 0.f, -1.f, 0.f,
+        0.f, 1.f, 0.f,  0.f,
+        1.f, 0.f, 0.f,  0.f,
+        1.f, -2.f, 0.5f, 1.f,
+    };
+
+    /// @brief Write a glTF with a chain of 3 rigidly posed joints (nodes 0, 1, 2), and an unrelated root (node 3).
+    /// Skin 0 has inverse bind matrices, skin 1 uses the same joints without.
+    filesystem::path writeSkins()
+    {
+        GltfBuilder builder;
+        builder.addAccessor(R"("componentType": 5126, "type": "MAT4", "count": 3, "bufferView": )"
+                            + std::to_string(builder.addView(gInverseBinds)));
+
+        return builder.write("skinning_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0, 3]}],)"
+            R"("nodes": [)"
+               R"({"translation": [1, 2, 3], "rotation": [0, 0.38268343, 0, 0.92387953], "children": [1]},)"
+               R"({"translation": [0, 1, 0], "rotation": [0.5, 0.5, 0.5, 0.5], "children": [2]},)"
+               R"({"translation": [0, 1, 0.5], "rotation": [0, 0, 0.70710678, 0.70710678]},)"
+               R"({"translation": [5, 0, 0]}],)"
+            R"("skins": [{"joints": [0, 1, 2], "inverseBindMatrices": 0}, {"joints": [0, 1, 2]}],)"
+            R"("meshes": [])");
+    }
+
+    /// @brief The reference 4x4 product `aInverseBind * aWorld`, row-vector convention.
+    std::array<float, 16> multiply(const float * aInverseBind, const Affine & aWorld)
+    {
+        // Complete the affine world transformation with its implicit [0, 0, 0, 1] column.
+        float world[16];
+        for (std::size_t row = 0; row != 4; ++row)
+        {
+            for (std::size_t column = 0; column != 3; ++column)
+            {
+                world[4 * row + column] = aWorld.at(row, column);
+            }
+            world[4 * row + 3] = (row == 3) ? 1.f : 0.f;
+        }
+
+        std::array<float, 16> result{};
+        for (std::size_t row = 0; row != 4; ++row)
+        {
+            for (std::size_t column = 0; column != 4; ++column)
+            {
+                for (std::size_t inner = 0; inner != 4; ++inner)
+                {
+                    result[4 * row + column] += aInverseBind[4 * row + inner] * world[4 * inner + column];
+                }
+            }
+        }
+        return result;
+    }
+
+    using Quaternion = std::array<float, 4>; // (x, y, z, w)
+
+    Quaternion multiply(const Quaternion & aLhs, const Quaternion & aRhs)
+    {
+        const auto [x1, y1, z1, w1] = aLhs;
+        const auto [x2, y2, z2, w2] = aRhs;
+        return {
+            w1 * x2 + x1 * w2 + y1 * z2 - z1 * y2,
+            w1 * y2 - x1 * z2 + y1 * w2 + z1 * x2,
+            w1 * z2 + x1 * y2 - y1 * x2 + z1 * w2,
+            w1 * w2 - x1 * x2 - y1 * y2 - z1 * z2,
+        };
+    }
+
+    Quaternion conjugate(const Quaternion & aQuaternion)
+    { return {-aQuaternion[0], -aQuaternion[1], -aQuaternion[2], aQuaternion[3]}; }
+
+    /// @brief Transform the point `aPoint` by the unit dual quaternion `aDual` (real part, then dual part).
+    std::array<float, 3> transform(const float * aDual, const std::array<float, 3> & aPoint)
+    {
+        const Quaternion real{aDual[0], aDual[1], aDual[2], aDual[3]};
+        const Quaternion dual{aDual[4], aDual[5], aDual[6], aDual[7]};
+        const Quaternion rotated = multiply(multiply(real, {aPoint[0], aPoint[1], aPoint[2], 0.f}), conjugate(real));
+        const Quaternion translation = multiply(dual, conjugate(real));
+        return {
+            rotated[0] + 2.f * translation[0],
+            rotated[1] + 2.f * translation[1],
+            rotated[2] + 2.f * translation[2],
+        };
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Skinning palettes")
+{
+    GIVEN("A skinned chain of rigid joints")
+    {
+        initializeLogging();
+        const Gltf gltf{writeSkins()};
+        BufferCache buffers{gltf};
+        const Skinning skinning{gltf, buffers};
+        SceneGraph scene{gltf, Index<Scene>{0}};
+
+        std::vector<Skinning::Instance> instances{
+            skinning.instantiate(Index<Skin>{0}, scene, true),
+            skinning.instantiate(Index<Skin>{1}, scene),
+        };
+        skinning.update(instances);
+
+        THEN("Palette entries are the products of the inverse bind and joint world matrices")
+        {
+            const float identity[16] = {1.f, 0.f, 0.f, 0.f,  0.f, 1.f, 0.f, 0.f,  0.f, 0.f, 1.f, 0.f,  0.f, 0.f, 0.f, 1.f};
+            std::size_t mismatches = 0;
+            for (std::size_t jointId = 0; jointId != gJointCount; ++jointId)
+            {
+                const Affine & world = scene.getWorldTransformation(instances[0].joints[jointId]);
+                const std::array<float, 16> withInverseBind = multiply(gInverseBinds.data() + 16 * jointId, world);
+                const std::array<float, 16> withIdentity = multiply(identity, world);
+                for (std::size_t element = 0; element != 16; ++element)
+                {
+                    mismatches += (instances[0].palette[16 * jointId + element]
+                                   != Approx(withInverseBind[element]).margin(1e-5f)) ? 1 : 0;
+                    mismatches += (instances[1].palette[16 * jointId + element]
+                                   != Approx(withIdentity[element]).margin(1e-5f)) ? 1 : 0;
+                }
+            }
+            REQUIRE(mismatches == 0);
+            REQUIRE(instances[1].dualQuaternions.empty());
+        }
+
+        THEN("Dual quaternions transform points as the rigid palette matrices do")
+        {
+            const std::array<float, 3> points[] = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.5f, -2.f, 3.f}};
+            std::size_t mismatches = 0;
+            for (std::size_t jointId = 0; jointId != gJointCount; ++jointId)
+            {
+                const float * matrix = instances[0].palette.data() + 16 * jointId;
+                const float * dual = instances[0].dualQuaternions.data() + 8 * jointId;
+                for (const std::array<float, 3> & point : points)
+                {
+                    const std::array<float, 3> transformed = transform(dual, point);
+                    for (std::size_t column = 0; column != 3; ++column)
+                    {
+                        const float expected = point[0] * matrix[column] + point[1] * matrix[4 + column]
+                                             + point[2] * matrix[8 + column] + matrix[12 + column];
+                        mismatches += (transformed[column] != Approx(expected).margin(1e-4f)) ? 1 : 0;
+                    }
+                }
+            }
+            REQUIRE(mismatches == 0);
+        }
+
+        WHEN("The scene is updated without any joint changing")
+        {
+            std::fill(instances[0].palette.begin(), instances[0].palette.end(), -1.f);
+            scene.setTranslation(*scene.find(Index<Node>{3}), 0.f, 5.f, 0.f);
+            scene.update();
+            skinning.update(instances);
+
+            THEN("The palettes are left untouched")
+            {
+                REQUIRE_FALSE(instances[0].changed);
+                REQUIRE_FALSE(instances[1].changed);
+                REQUIRE(std::all_of(instances[0].palette.begin(), instances[0].palette.end(),
+                                    [](float aValue){ return aValue == -1.f; }));
+            }
+        }
+
+        WHEN("A joint moves")
+        {
+            std::fill(instances[0].palette.begin(), instances[0].palette.end(), -1.f);
+            scene.setTranslation(*scene.find(Index<Node>{1}), 0.f, 2.f, 0.f);
+            scene.update();
+            skinning.update(instances);
+
+            THEN("The palettes are recomputed")
+            {
+                REQUIRE(instances[0].changed);
+                REQUIRE(instances[1].changed);
+                const Affine & world = scene.getWorldTransformation(instances[0].joints[2]);
+                REQUIRE(instances[0].palette[16 * 2 + 12] == Approx(multiply(gInverseBinds.data() + 32, world)[12]));
+            }
+        }
+    }
+}
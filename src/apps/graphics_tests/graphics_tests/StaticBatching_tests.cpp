@@ -0,0 +1,123 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/SceneGraph.h>
+#include <arte/gltf/StaticBatching.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::arte;
+
+
+namespace {
+
+    /// @brief Write a glTF instantiating a single triangle (in the z = 0 plane, facing +z) on several nodes:
+    /// * node 0, material 0, translated by (2, 0, 0), with child node 3 (material 0) translated by (0, 1, 0),
+    /// * node 1, material 0, mirrored by a (-1, 1, 1) scale,
+    /// * node 2, material 1, rotated by 90 degrees around x.
+    filesystem::path writeInstances()
+    {
+        // Positions, then normals, in the same buffer view.
+        const std::vector<float> vertices{
+            0.f, 0.f, 0.f,  1.f, 0.f, 0.f,  0.f, 1.f, 0.f,
+            0.f, 0.f, 1.f,  0.f, 0.f, 1.f,  0.f, 0.f, 1.f,
+        };
+        const std::vector<std::uint16_t> indices{0, 1, 2};
+
+        GltfBuilder builder;
+        const std::string vertexView = std::to_string(builder.addView(vertices));
+        builder.addAccessor(R"("bufferView": )" + vertexView
+                            + R"(, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0, 0, 0], "max": [1, 1, 0])");
+        builder.addAccessor(R"("bufferView": )" + vertexView
+                            + R"(, "byteOffset": 36, "componentType": 5126, "count": 3, "type": "VEC3")");
+        builder.addAccessor(R"("bufferView": )" + std::to_string(builder.addView(indices))
+                            + R"(, "componentType": 5123, "count": 3, "type": "SCALAR")");
+
+        const std::string attributes = R"("attributes": {"POSITION": 0, "NORMAL": 1}, "indices": 2)";
+        return builder.write("static_batching_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0, 1, 2]}],)"
+            R"("nodes": [)"
+               R"({"mesh": 0, "translation": [2, 0, 0], "children": [3]},)"
+               R"({"mesh": 0, "scale": [-1, 1, 1]},)"
+               R"({"mesh": 1, "rotation": [0.70710678, 0, 0, 0.70710678]},)"
+               R"({"mesh": 0, "translation": [0, 1, 0]}],)"
+            R"("materials": [{}, {}],)"
+            R"("meshes": [{"primitives": [{)" + attributes + R"(, "material": 0}]},)"
+               R"({"primitives": [{)" + attributes + R"(, "material": 1}]}])");
+    }
+
+    std::vector<float> readVertex(const gltf::StaticBatch::Attribute & aAttribute, std::size_t aVertex)
+    {
+        auto first = aAttribute.values.begin() + aVertex * aAttribute.componentCount;
+        return {first, first + aAttribute.componentCount};
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Static batching")
+{
+    GIVEN("A scene instantiating a triangle with two materials")
+    {
+        initializeLogging();
+        const Gltf gltf{writeInstances()};
+        gltf::BufferCache buffers{gltf};
+        gltf::SceneGraph scene{gltf, gltf::Index<gltf::Scene>{0}};
+        scene.update();
+
+        const std::vector<gltf::StaticBatch> batches = gltf::batchStaticMeshes(buffers, scene);
+
+        THEN("There is one batch per material")
+        {
+            REQUIRE(batches.size() == 2);
+            REQUIRE(batches[0].material == gltf::Index<gltf::Material>{0});
+            REQUIRE(batches[1].material == gltf::Index<gltf::Material>{1});
+            REQUIRE(batches[0].submeshes.size() == 3);
+            REQUIRE(batches[0].countVertices() == 9);
+            REQUIRE(batches[1].countVertices() == 3);
+        }
+
+        const gltf::StaticBatch & batch = batches[0];
+        const gltf::StaticBatch::Attribute & batchPositions = batch.attributes[1];
+        REQUIRE(batchPositions.semantic == "POSITION");
+
+        THEN("Vertices are transformed to world space, and indices offset to their submesh")
+        {
+            // Scene order is depth first: node 0, its child node 3, then node 1.
+            REQUIRE(batch.submeshes[1].node == *scene.find(gltf::Index<gltf::Node>{3}));
+            REQUIRE(readVertex(batchPositions, 1) == std::vector<float>{3.f, 0.f, 0.f});
+            REQUIRE(readVertex(batchPositions, 5) == std::vector<float>{2.f, 2.f, 0.f});
+            REQUIRE(batch.indices == std::vector<std::uint32_t>{0, 1, 2,  3, 4, 5,  6, 8, 7});
+
+            const gltf::StaticBatch::Submesh & child = batch.submeshes[1];
+            REQUIRE(child.firstIndex == 3);
+            REQUIRE(child.firstVertex == 3);
+            REQUIRE(child.bounds.min == std::array<float, 3>{2.f, 1.f, 0.f});
+            REQUIRE(child.bounds.max == std::array<float, 3>{3.f, 2.f, 0.f});
+        }
+
+        THEN("Mirrored instances keep their facing")
+        {
+            REQUIRE(readVertex(batchPositions, 7) == std::vector<float>{-1.f, 0.f, 0.f});
+            // Triangle (6, 8, 7) is counter-clockwise seen from +z once mirrored.
+            REQUIRE(readVertex(batch.attributes[0], 7) == std::vector<float>{0.f, 0.f, 1.f});
+        }
+
+        THEN("Normals are rotated with the instance")
+        {
+            const gltf::StaticBatch::Attribute & normals = batches[1].attributes[0];
+            REQUIRE(normals.semantic == "NORMAL");
+            const std::vector<float> normal = readVertex(normals, 0);
+            REQUIRE(normal[0] == Approx(0.f).margin(1e-6));
+            REQUIRE(normal[1] == Approx(-1.f));
+            REQUIRE(normal[2] == Approx(0.f).margin(1e-6));
+        }
+    }
+}
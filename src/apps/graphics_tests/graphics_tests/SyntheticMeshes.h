@@ -0,0 +1,82 @@
+#pragma once
+
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+
+namespace ad {
+
+
+/// @brief Procedural indexed triangle lists, for geometry processing tests.
+struct Geometry
+{
+    std::vector<std::uint32_t> indices;
+    std::vector<float> positions;
+};
+
+
+// Flat grid of aSize x aSize vertices, in the z = 0 plane.
+inline Geometry makeGrid(std::uint32_t aSize)
+{
+    Geometry grid;
+    for (std::uint32_t y = 0; y != aSize; ++y)
+    {
+        for (std::uint32_t x = 0; x != aSize; ++x)
+        {
+            grid.positions.insert(grid.positions.end(), {(float)x, (float)y, 0.f});
+        }
+    }
+    for (std::uint32_t y = 0; y + 1 != aSize; ++y)
+    {
+        for (std::uint32_t x = 0; x + 1 != aSize; ++x)
+        {
+            std::uint32_t a = y * aSize + x, b = a + 1, c = a + aSize, d = c + 1;
+            grid.indices.insert(grid.indices.end(), {a, b, c, b, d, c});
+        }
+    }
+    return grid;
+}
+
+
+// Closed unit UV sphere, without duplicated vertices.
+inline Geometry makeSphere(std::uint32_t aRings, std::uint32_t aSegments)
+{
+    Geometry sphere;
+    const float pi = std::numbers::pi_v<float>;
+
+    sphere.positions.insert(sphere.positions.end(), {0.f, 0.f, 1.f});
+    for (std::uint32_t ring = 1; ring != aRings; ++ring)
+    {
+        for (std::uint32_t segment = 0; segment != aSegments; ++segment)
+        {
+            float theta = pi * ring / aRings;
+            float phi = 2 * pi * segment / aSegments;
+            sphere.positions.insert(sphere.positions.end(),
+                                    {std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)});
+        }
+    }
+    sphere.positions.insert(sphere.positions.end(), {0.f, 0.f, -1.f});
+
+    const std::uint32_t south = (aRings - 1) * aSegments + 1;
+    auto vertex = [&](std::uint32_t aRing, std::uint32_t aSegment)
+    { return 1 + (aRing - 1) * aSegments + aSegment % aSegments; };
+
+    for (std::uint32_t segment = 0; segment != aSegments; ++segment)
+    {
+        sphere.indices.insert(sphere.indices.end(), {0, vertex(1, segment), vertex(1, segment + 1)});
+        sphere.indices.insert(sphere.indices.end(),
+                              {vertex(aRings - 1, segment), south, vertex(aRings - 1, segment + 1)});
+        for (std::uint32_t ring = 1; ring + 1 != aRings; ++ring)
+        {
+            std::uint32_t a = vertex(ring, segment), b = vertex(ring, segment + 1);
+            std::uint32_t c = vertex(ring + 1, segment), d = vertex(ring + 1, segment + 1);
+            sphere.indices.insert(sphere.indices.end(), {a, c, b, b, c, d});
+        }
+    }
+    return sphere;
+}
+
+} // namespace ad
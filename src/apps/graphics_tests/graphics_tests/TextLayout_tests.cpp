@@ -0,0 +1,407 @@
+#include "catch.hpp"
+
+#include <graphics/detail/TextLayout.h>
+
+#include <test_commons/PathProvider.h>
+
+#include <utf8.h> // utfcpp lib, for the baseline of the benchmark
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics::detail;
+
+
+namespace {
+
+    std::string toString(std::u8string_view aUtf8)
+    {
+        return {reinterpret_cast<const char *>(aUtf8.data()), aUtf8.size()};
+    }
+
+    std::u32string decodeAll(std::string_view aString)
+    {
+        std::u32string result;
+        decodeUtf8(aString, [&result](arte::CharCode aCodePoint){ result.push_back(aCodePoint); });
+        return result;
+    }
+
+    // Typical UI strings, mostly ASCII with a few accented and non-Latin characters.
+    const std::string gUiText = toString(
+        u8"Settings  Audio  Video  Controls  Résumé  Quitter l'application ?  "
+        u8"Score: 12 480  Élan vital  Größe  Ωmega  Привет  Player 1 — Ready");
+    const std::u32string gUiCodePoints =
+        U"Settings  Audio  Video  Controls  Résumé  Quitter l'application ?  "
+        U"Score: 12 480  Élan vital  Größe  Ωmega  Привет  Player 1 — Ready";
+
+
+    struct Font
+    {
+        Font(const arte::Freetype & aFreetype) :
+            face{aFreetype.load(resource::pathFor("fonts/dejavu-fonts-ttf-2.37/DejaVuSans.ttf"))}
+        {
+            face.inverseYAxis(true);
+            face.setPixelHeight(24);
+            kerning = arte::KerningTable{face};
+
+            std::vector<FT_UInt> indices;
+            for (char32_t codePoint : gUiCodePoints)
+            {
+                if (!glyphs.find(codePoint))
+                {
+                    const RasterizedGlyph rasterized = rasterizeGlyph(face, codePoint);
+                    glyphs.insert(codePoint, makeRenderedGlyph(rasterized,
+                                                               {0, 0},
+                                                               TextureRibon::gRecommendedMargins,
+                                                               GlyphRasterization::Coverage,
+                                                               0));
+                    indices.push_back(rasterized.freetypeIndex);
+                }
+            }
+            kerning.addGlyphs(face, indices);
+        }
+
+        const RenderedGlyph & at(arte::CharCode aCodePoint) const
+        { return *glyphs.find(aCodePoint); }
+
+        arte::FontFace face;
+        GlyphMap glyphs;
+        arte::KerningTable kerning;
+    };
+
+
+    // The kerning lookup before the open addressing table, as the baseline of the benchmark.
+    // It is restored from the pairs exported by a table.
+    class MapKerningTable
+    {
+    public:
+        explicit MapKerningTable(const arte::KerningTable & aTable) :
+            mHasKerning{aTable.hasKerning()}
+        {
+            const std::vector<FT_UInt> eagerGlyphs = aTable.getEagerGlyphs();
+            mEagerGlyphs.insert(eagerGlyphs.begin(), eagerGlyphs.end());
+            for (const arte::KerningTable::Pair & pair : aTable.getPairs())
+            {
+                mOffsets.insert_or_assign(makeKey(pair.left, pair.right), pair.offset);
+            }
+        }
+
+        math::Vec<2, float> get(FT_UInt aLeftGlyphIndex,
+                                FT_UInt aRightGlyphIndex,
+                                const arte::FontFace & aFontFace) const
+        {
+            if (!mHasKerning)
+            {
+                return {0.f, 0.f};
+            }
+
+            const std::uint64_t key = makeKey(aLeftGlyphIndex, aRightGlyphIndex);
+            if (auto found = mOffsets.find(key); found != mOffsets.end())
+            {
+                return found->second;
+            }
+            else if (mEagerGlyphs.contains(aLeftGlyphIndex) && mEagerGlyphs.contains(aRightGlyphIndex))
+            {
+                return {0.f, 0.f};
+            }
+            else
+            {
+                return mOffsets.emplace(key, aFontFace.kern(aLeftGlyphIndex, aRightGlyphIndex)).first->second;
+            }
+        }
+
+    private:
+        static std::uint64_t makeKey(FT_UInt aLeftGlyphIndex, FT_UInt aRightGlyphIndex)
+        { return (std::uint64_t{aLeftGlyphIndex} << 32) | aRightGlyphIndex; }
+
+        bool mHasKerning;
+        std::unordered_set<FT_UInt> mEagerGlyphs;
+        mutable std::unordered_map<std::uint64_t, math::Vec<2, float>> mOffsets;
+    };
+
+
+    // The layout loop before the templated core, as the baseline of the benchmark.
+    template <class T_kerning>
+    void forEachGlyphBaseline(const std::string & aString,
+                              math::Position<2, GLfloat> aPenOrigin,
+                              const Font & aFont,
+                              const T_kerning & aKerning,
+                              std::function<void(const RenderedGlyph &, math::Position<2, GLfloat>)> aGlyphCallback)
+    {
+        unsigned int previousIndex = 0;
+        for (std::string::const_iterator it = aString.begin(); it != aString.end(); /* in body */)
+        {
+            arte::CharCode codePoint = utf8::next(it, aString.end());
+            const RenderedGlyph & rendered = aFont.at(codePoint);
+            if (previousIndex != 0)
+            {
+                aPenOrigin += aKerning.get(previousIndex, rendered.freetypeIndex, aFont.face);
+            }
+            previousIndex = rendered.freetypeIndex;
+
+            aGlyphCallback(rendered, aPenOrigin);
+            aPenOrigin += rendered.penAdvance;
+        }
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Decoding UTF-8 strings")
+{
+    GIVEN("Sequences of one to four bytes")
+    {
+        const std::string sequences = toString(u8"é€𝄞x");
+        const std::u32string expected = U"é€𝄞x";
+
+        THEN("They are decoded wherever they fall relative to the ASCII blocks")
+        {
+            std::size_t mismatches = 0;
+            for (std::size_t padding = 0; padding != 2 * gUtf8BlockSize + 1; ++padding)
+            {
+                mismatches += (decodeAll(std::string(padding, 'a') + sequences)
+                               != std::u32string(padding, U'a') + expected) ? 1 : 0;
+                mismatches += (decodeAll(sequences + std::string(padding, 'a'))
+                               != expected + std::u32string(padding, U'a')) ? 1 : 0;
+            }
+            REQUIRE(mismatches == 0);
+            REQUIRE(decodeAll(gUiText) == gUiCodePoints);
+        }
+    }
+
+    GIVEN("Malformed sequences")
+    {
+        const std::string malformed[] = {
+            "\x80",             // Continuation byte without lead.
+            "\xC3",             // Truncated.
+            "\xC3\x28",         // Invalid continuation.
+            "\xC0\xAF",         // Overlong.
+            "\xED\xA0\x80",     // Surrogate.
+            "\xF4\x90\x80\x80", // Above U+10FFFF.
+            "\xFF",
+        };
+
+        THEN("Decoding throws, including after a run of ASCII blocks")
+        {
+            std::size_t accepted = 0;
+            for (const std::string & sequence : malformed)
+            {
+                for (const std::string & string : {sequence, std::string(40, 'a') + sequence})
+                {
+                    try
+                    {
+                        decodeAll(string);
+                        ++accepted;
+                    }
+                    catch (std::invalid_argument &)
+                    {}
+                }
+            }
+            REQUIRE(accepted == 0);
+        }
+    }
+}
+
+
+SCENARIO("Laying out strings")
+{
+    GIVEN("Glyphs rendered from a font face with kerning")
+    {
+        arte::Freetype freetype;
+        const Font font{freetype};
+        REQUIRE(font.kerning.hasKerning());
+
+        const math::Position<2, GLfloat> origin{10.f, 20.f};
+        const math::Vec<2, GLfloat> scale{0.5f, 0.25f};
+        auto lookup = [&font](arte::CharCode aCodePoint) -> const RenderedGlyph & { return font.at(aCodePoint); };
+
+        WHEN("A string is laid out")
+        {
+            std::vector<math::Position<2, GLfloat>> positions;
+            const StringLayout layout = layoutString(gUiText, origin, scale, lookup, font.kerning, font.face,
+                [&positions](const RenderedGlyph &, math::Position<2, GLfloat> aPenPosition)
+                {
+                    positions.push_back(aPenPosition);
+                });
+
+            THEN("Pen positions follow the scaled advances and kerning, and the bounds enclose all glyphs")
+            {
+                math::Position<2, GLfloat> pen = origin;
+                math::Position<2, GLfloat> min = pen;
+                math::Position<2, GLfloat> max = pen;
+                unsigned int previousIndex = 0;
+                std::size_t mismatches = 0;
+                for (std::size_t index = 0; index != gUiCodePoints.size(); ++index)
+                {
+                    const RenderedGlyph & rendered = font.at(gUiCodePoints[index]);
+                    if (previousIndex != 0)
+                    {
+                        pen += font.kerning.get(previousIndex, rendered.freetypeIndex, font.face).cwMul(scale);
+                    }
+                    previousIndex = rendered.freetypeIndex;
+                    mismatches += (positions.at(index) != pen) ? 1 : 0;
+
+                    const math::Position<2, GLfloat> topLeft = pen + rendered.bearing.cwMul(scale);
+                    const math::Position<2, GLfloat> bottomRight =
+                        topLeft + math::Vec<2, GLfloat>{rendered.controlBoxSize.width(),
+                                                        -rendered.controlBoxSize.height()}.cwMul(scale);
+                    if (index == 0)
+                    {
+                        min = max = topLeft;
+                    }
+                    for (std::size_t axis = 0; axis != 2; ++axis)
+                    {
+                        min[axis] = std::min({min[axis], topLeft[axis], bottomRight[axis]});
+                        max[axis] = std::max({max[axis], topLeft[axis], bottomRight[axis]});
+                    }
+
+                    pen += rendered.penAdvance.cwMul(scale);
+                }
+                REQUIRE(mismatches == 0);
+                REQUIRE(positions.size() == gUiCodePoints.size());
+                REQUIRE(layout.glyphCount == gUiCodePoints.size());
+                REQUIRE(layout.penPosition == pen);
+                REQUIRE(layout.boundsMin == min);
+                REQUIRE(layout.boundsMax == max);
+            }
+
+            THEN("The same instances can be written to a caller provided span")
+            {
+                std::vector<math::Position<2, GLfloat>> output(gUiText.size());
+                const StringLayout spanLayout = layoutString(gUiText, origin, scale, lookup, font.kerning, font.face,
+                    std::span{output},
+                    [](const RenderedGlyph &, math::Position<2, GLfloat> aPenPosition){ return aPenPosition; });
+
+                REQUIRE(spanLayout.glyphCount == positions.size());
+                REQUIRE(std::equal(positions.begin(), positions.end(), output.begin()));
+            }
+        }
+
+        WHEN("An empty string is laid out")
+        {
+            const StringLayout layout = layoutString("", origin, scale, lookup, font.kerning, font.face,
+                [](const RenderedGlyph &, math::Position<2, GLfloat>){});
+
+            THEN("The bounds are empty at the pen origin")
+            {
+                REQUIRE(layout.glyphCount == 0);
+                REQUIRE(layout.boundsMin == origin);
+                REQUIRE(layout.boundsMax == origin);
+            }
+        }
+    }
+}
+
+
+TEST_CASE("Laying out UI strings", "[!benchmark]")
+{
+    arte::Freetype freetype;
+    const Font font{freetype};
+    const MapKerningTable mapKerning{font.kerning};
+    auto lookup = [&font](arte::CharCode aCodePoint) -> const RenderedGlyph & { return font.at(aCodePoint); };
+
+    // The glyph pairs looked up when laying out the string.
+    std::vector<std::pair<FT_UInt, FT_UInt>> pairs;
+    for (std::size_t index = 1; index != gUiCodePoints.size(); ++index)
+    {
+        pairs.emplace_back(font.at(gUiCodePoints[index - 1]).freetypeIndex, font.at(gUiCodePoints[index]).freetypeIndex);
+    }
+
+    // Both tables hold the same offsets, so the benchmarks compare the same work.
+    std::size_t mismatches = 0;
+    for (auto [left, right] : pairs)
+    {
+        mismatches += (mapKerning.get(left, right, font.face) != font.kerning.get(left, right, font.face)) ? 1 : 0;
+    }
+    REQUIRE(mismatches == 0);
+
+    BENCHMARK("Kerning lookups, unordered_map")
+    {
+        math::Vec<2, float> sum{0.f, 0.f};
+        for (auto [left, right] : pairs)
+        {
+            sum += mapKerning.get(left, right, font.face);
+        }
+        return sum;
+    };
+
+    BENCHMARK("Kerning lookups, open addressing")
+    {
+        math::Vec<2, float> sum{0.f, 0.f};
+        for (auto [left, right] : pairs)
+        {
+            sum += font.kerning.get(left, right, font.face);
+        }
+        return sum;
+    };
+
+    BENCHMARK("std::function per glyph, utf8::next, unordered_map kerning")
+    {
+        GLfloat sum = 0.f;
+        forEachGlyphBaseline(gUiText, {0.f, 0.f}, font, mapKerning,
+            [&sum](const RenderedGlyph & aRendered, math::Position<2, GLfloat> aPenPosition)
+            {
+                sum += aPenPosition.x() + aRendered.bearing.x();
+            });
+        return sum;
+    };
+
+    BENCHMARK("std::function per glyph, utf8::next, open addressing kerning")
+    {
+        GLfloat sum = 0.f;
+        forEachGlyphBaseline(gUiText, {0.f, 0.f}, font, font.kerning,
+            [&sum](const RenderedGlyph & aRendered, math::Position<2, GLfloat> aPenPosition)
+            {
+                sum += aPenPosition.x() + aRendered.bearing.x();
+            });
+        return sum;
+    };
+
+    BENCHMARK("layoutString")
+    {
+        GLfloat sum = 0.f;
+        layoutString(gUiText, {0.f, 0.f}, {1.f, 1.f}, lookup, font.kerning, font.face,
+            [&sum](const RenderedGlyph & aRendered, math::Position<2, GLfloat> aPenPosition)
+            {
+                sum += aPenPosition.x() + aRendered.bearing.x();
+            });
+        return sum;
+    };
+
+    BENCHMARK("Bounds in two passes, std::function per glyph, unordered_map kerning")
+    {
+        math::Position<2, GLfloat> min{0.f, 0.f};
+        math::Position<2, GLfloat> max{0.f, 0.f};
+        forEachGlyphBaseline(gUiText.substr(0, 1), {0.f, 0.f}, font, mapKerning,
+            [&min, &max](const RenderedGlyph & aRendered, math::Position<2, GLfloat> aPenPosition)
+            {
+                min = max = aPenPosition + aRendered.bearing;
+            });
+        forEachGlyphBaseline(gUiText, {0.f, 0.f}, font, mapKerning,
+            [&min, &max](const RenderedGlyph & aRendered, math::Position<2, GLfloat> aPenPosition)
+            {
+                const math::Position<2, GLfloat> topLeft = aPenPosition + aRendered.bearing;
+                const math::Position<2, GLfloat> bottomRight =
+                    topLeft + math::Vec<2, GLfloat>{aRendered.controlBoxSize.width(), -aRendered.controlBoxSize.height()};
+                for (std::size_t axis = 0; axis != 2; ++axis)
+                {
+                    min[axis] = std::min({min[axis], topLeft[axis], bottomRight[axis]});
+                    max[axis] = std::max({max[axis], topLeft[axis], bottomRight[axis]});
+                }
+            });
+        return max.x() - min.x();
+    };
+
+    BENCHMARK("Bounds in a single layoutString pass")
+    {
+        const StringLayout layout = layoutString(gUiText, {0.f, 0.f}, {1.f, 1.f}, lookup, font.kerning, font.face,
+            [](const RenderedGlyph &, math::Position<2, GLfloat>){});
+        return layout.boundsMax.x() - layout.boundsMin.x();
+    };
+}
@@ -0,0 +1,250 @@
+#include "catch.hpp"
+
+#include <graphics/detail/TextRuns.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics;
+using namespace ad::graphics::detail;
+
+
+namespace {
+
+    /// @brief Only compared, never dereferenced.
+    Texture * fakeTexture(int aId)
+    { return reinterpret_cast<Texture *>(std::uintptr_t{16} * (aId + 1)); }
+
+    /// @brief Glyphs identified by their run and position in the string, alternating between `aTextureCount` textures.
+    void layout(TextRuns::Run & aRun, TextRuns::RunId aRunId, int aGlyphCount, int aTextureCount)
+    {
+        std::vector<std::pair<Texture *, RunGlyph>> placed;
+        for (int glyph = 0; glyph != aGlyphCount; ++glyph)
+        {
+            const int texture = glyph % aTextureCount;
+            placed.push_back({
+                fakeTexture(texture),
+                RunGlyph{
+                    .position_p = {(GLfloat)aRunId, (GLfloat)glyph},
+                    .offsetInTexture_p = {texture, 0},
+                    .boundingBox_p = {1.f, 1.f},
+                    .bearing_p = {0.f, 0.f},
+                    .runIndex = (GLuint)aRunId,
+                },
+            });
+        }
+        aRun.setGlyphs(placed);
+    }
+
+    bool isSame(const RunGlyph & aLhs, const RunGlyph & aRhs)
+    {
+        return aLhs.position_p == aRhs.position_p
+            && aLhs.offsetInTexture_p == aRhs.offsetInTexture_p
+            && aLhs.runIndex == aRhs.runIndex;
+    }
+
+    /// @brief Mirrors the glyph buffer of Texting, on the CPU.
+    struct GlyphBuffer
+    {
+        /// @return true if the runs were repacked.
+        bool upload(TextRuns & aRuns, TextRuns::Run & aRun)
+        {
+            if (!aRuns.reserve(aRun))
+            {
+                glyphs = aRuns.repack();
+                glyphs.resize(aRuns.getGlyphCapacity());
+                return true;
+            }
+            std::copy(aRun.glyphs.begin(), aRun.glyphs.end(), glyphs.begin() + aRun.firstGlyph);
+            return false;
+        }
+
+        std::vector<RunGlyph> glyphs;
+    };
+
+    /// @brief Count the glyphs of alive runs which are not found at their place in the buffer,
+    /// or in a draw of their texture.
+    std::size_t countMisplacedGlyphs(const TextRuns & aRuns,
+                                     const std::vector<TextRuns::RunId> & aAlive,
+                                     const GlyphBuffer & aBuffer)
+    {
+        std::size_t misplaced = 0;
+        std::size_t glyphCount = 0;
+        for (TextRuns::RunId runId : aAlive)
+        {
+            const TextRuns::Run & run = aRuns.at(runId);
+            glyphCount += run.glyphs.size();
+            for (const PerTextureRange & range : run.ranges)
+            {
+                for (GLuint glyph = range.firstInstance; glyph != range.firstInstance + range.instanceCount; ++glyph)
+                {
+                    misplaced += (!isSame(aBuffer.glyphs.at(run.firstGlyph + glyph), run.glyphs[glyph])
+                                  || range.texture != fakeTexture(run.glyphs[glyph].offsetInTexture_p.x())) ? 1 : 0;
+                }
+            }
+        }
+
+        std::vector<PerTextureRange> draws;
+        aRuns.getDraws(draws);
+        std::size_t drawn = 0;
+        for (const PerTextureRange & draw : draws)
+        {
+            for (GLuint instance = draw.firstInstance; instance != draw.firstInstance + draw.instanceCount; ++instance)
+            {
+                const RunGlyph & glyph = aBuffer.glyphs.at(instance);
+                const bool isAlive =
+                    std::find(aAlive.begin(), aAlive.end(), glyph.runIndex) != aAlive.end();
+                misplaced += (!isAlive || draw.texture != fakeTexture(glyph.offsetInTexture_p.x())) ? 1 : 0;
+                ++drawn;
+            }
+        }
+        return misplaced + (drawn != glyphCount ? 1 : 0);
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Text run slots")
+{
+    GIVEN("Three alive runs")
+    {
+        TextRuns runs;
+        REQUIRE(runs.create() == 0);
+        REQUIRE(runs.create() == 1);
+        REQUIRE(runs.create() == 2);
+
+        WHEN("A run is removed")
+        {
+            runs.at(1).string = "removed";
+            runs.remove(1);
+
+            THEN("Its slot is reset, then reused by the next created run")
+            {
+                REQUIRE_FALSE(runs.at(1).alive);
+                REQUIRE(runs.at(1).string.empty());
+
+                REQUIRE(runs.create() == 1);
+                REQUIRE(runs.at(1).alive);
+                REQUIRE(runs.create() == 3);
+            }
+        }
+    }
+
+    GIVEN("The maximum count of alive runs")
+    {
+        TextRuns runs;
+        for (std::size_t run = 0; run != TextRuns::gMaxRuns; ++run)
+        {
+            runs.create();
+        }
+
+        THEN("Creating another run throws")
+        {
+            REQUIRE_THROWS_AS(runs.create(), std::length_error);
+        }
+
+        WHEN("A run is removed")
+        {
+            runs.remove(TextRuns::gMaxRuns / 2);
+
+            THEN("Exactly one run can be created again, in the freed slot")
+            {
+                REQUIRE(runs.create() == TextRuns::gMaxRuns / 2);
+                REQUIRE_THROWS_AS(runs.create(), std::length_error);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Text run glyph regions")
+{
+    GIVEN("Runs uploaded to the glyph buffer")
+    {
+        TextRuns runs;
+        GlyphBuffer buffer;
+        std::vector<TextRuns::RunId> alive;
+        const int glyphCounts[] = {40, 7, 120, 15, 60};
+        for (int glyphCount : glyphCounts)
+        {
+            const TextRuns::RunId runId = runs.create();
+            layout(runs.at(runId), runId, glyphCount, 3);
+            buffer.upload(runs, runs.at(runId));
+            alive.push_back(runId);
+        }
+
+        THEN("The glyphs of each texture are contiguous in each run")
+        {
+            const TextRuns::Run & run = runs.at(2);
+            REQUIRE(run.ranges.size() == 3);
+            REQUIRE(run.ranges[0].instanceCount + run.ranges[1].instanceCount + run.ranges[2].instanceCount == 120);
+            REQUIRE(countMisplacedGlyphs(runs, alive, buffer) == 0);
+        }
+
+        WHEN("Runs are removed, and a run outgrows its region")
+        {
+            runs.remove(1);
+            runs.remove(3);
+            alive = {0, 2, 4};
+            const GLuint previousFirst = runs.at(0).firstGlyph;
+            layout(runs.at(0), 0, 90, 2);
+            REQUIRE_FALSE(buffer.upload(runs, runs.at(0)));
+
+            THEN("It is placed in a new region, without disturbing the other runs")
+            {
+                REQUIRE(runs.at(0).firstGlyph != previousFirst);
+                REQUIRE(countMisplacedGlyphs(runs, alive, buffer) == 0);
+            }
+
+            WHEN("A run grows past the capacity of the glyph buffer")
+            {
+                const std::size_t capacity = runs.getGlyphCapacity();
+                layout(runs.at(4), 4, (int)capacity, 4);
+                REQUIRE(buffer.upload(runs, runs.at(4)));
+
+                THEN("Alive runs are packed contiguously in slot order, with room to grow")
+                {
+                    std::size_t first = 0;
+                    for (TextRuns::RunId runId : alive)
+                    {
+                        REQUIRE(runs.at(runId).firstGlyph == first);
+                        REQUIRE(runs.at(runId).capacity == runs.at(runId).glyphs.size());
+                        first += runs.at(runId).glyphs.size();
+                    }
+                    REQUIRE(runs.getGlyphCapacity() >= 2 * first);
+                    REQUIRE(countMisplacedGlyphs(runs, alive, buffer) == 0);
+                }
+
+                THEN("Runs removed before the repack do not come back")
+                {
+                    std::vector<PerTextureRange> draws;
+                    runs.getDraws(draws);
+                    std::size_t drawn = 0;
+                    for (const PerTextureRange & draw : draws)
+                    {
+                        drawn += draw.instanceCount;
+                    }
+                    REQUIRE(drawn == 90 + 120 + capacity);
+                }
+
+                WHEN("Another run shrinks")
+                {
+                    const GLuint shrunkFirst = runs.at(2).firstGlyph;
+                    layout(runs.at(2), 2, 10, 1);
+                    REQUIRE_FALSE(buffer.upload(runs, runs.at(2)));
+
+                    THEN("It keeps its region")
+                    {
+                        REQUIRE(runs.at(2).firstGlyph == shrunkFirst);
+                        REQUIRE(runs.at(2).capacity == 120);
+                        REQUIRE(countMisplacedGlyphs(runs, alive, buffer) == 0);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,298 @@
+#include "catch.hpp"
+
+#include "GltfBuilder.h"
+
+#include <arte/Logging.h>
+#include <arte/gltf/Gltf.h>
+
+#include <graphics/3d/VertexStream.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+
+using namespace ad;
+using namespace ad::graphics;
+
+
+namespace {
+
+    float fromHalf(std::uint16_t aHalf)
+    {
+        const float sign = (aHalf & 0x8000) ? -1.f : 1.f;
+        const int exponent = (aHalf >> 10) & 0x1F;
+        const int mantissa = aHalf & 0x3FF;
+        if (exponent == 0)
+        {
+            return sign * std::ldexp(static_cast<float>(mantissa), -24);
+        }
+        else if (exponent == 31)
+        {
+            return mantissa == 0 ? sign * std::numeric_limits<float>::infinity()
+                                 : std::numeric_limits<float>::quiet_NaN();
+        }
+        return sign * std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+    }
+
+
+    constexpr std::size_t gVertexCount = 5;
+
+    const std::vector<float> gPositions{
+        -2.f,   10.f,  0.5f,
+        3.f,    10.5f, 0.5f,
+        0.25f,  11.f,  0.5f, // constant z: quantized over a unit extent
+        -1.75f, 12.f,  0.5f,
+        1.f,    10.f,  0.5f,
+    };
+
+    // Unit normals, the last ones being outside [-1, 1] to check the clamping.
+    const std::vector<float> gNormals{
+        0.f,    0.f,    1.f,
+        1.f,    0.f,    0.f,
+        0.6f,   -0.8f,  0.f,
+        -0.48f, 0.6f,   -0.64f,
+        -1.5f,  0.f,    2.f,
+    };
+
+    const std::vector<float> gTexCoords{
+        0.f,    1.f,
+        0.5f,   0.25f,
+        0.125f, 0.75f,
+        1.f,    0.f,
+        0.333f, 0.667f,
+    };
+
+    const std::vector<float> gColors{
+        1.f,  0.f,   0.f,
+        0.f,  1.f,   0.f,
+        0.f,  0.f,   1.f,
+        0.5f, 0.25f, 0.75f,
+        0.2f, 0.4f,  0.6f,
+    };
+
+
+    /// @brief Write a glTF with a single primitive, whose float attributes are in separate buffer views.
+    filesystem::path writePrimitive()
+    {
+        const std::vector<const std::vector<float> *> attributes{&gPositions, &gNormals, &gTexCoords, &gColors};
+        const char * types[] = {"VEC3", "VEC3", "VEC2", "VEC3"};
+
+        GltfBuilder builder;
+        for (std::size_t attributeId = 0; attributeId != attributes.size(); ++attributeId)
+        {
+            builder.addAccessor(R"("bufferView": )" + std::to_string(builder.addView(*attributes[attributeId]))
+                                + R"(, "componentType": 5126, "type": ")" + types[attributeId]
+                                + R"(", "count": )" + std::to_string(gVertexCount));
+        }
+
+        return builder.write("vertex_stream_tests",
+            R"("scene": 0, "scenes": [{"nodes": [0]}], "nodes": [{"mesh": 0}],)"
+            R"("meshes": [{"primitives": [{"attributes": )"
+            R"({"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2, "COLOR_0": 3}}]}])");
+    }
+
+
+    template <class T_value>
+    T_value readAt(const r3d::VertexStream & aStream, std::size_t aVertex, std::size_t aOffset)
+    {
+        T_value result;
+        std::memcpy(&result, aStream.data.data() + aVertex * aStream.stride + aOffset, sizeof(T_value));
+        return result;
+    }
+
+
+    /// @brief Decode a signed normalized 2_10_10_10 component, following the OpenGL conversion.
+    float decodeSnorm(std::uint32_t aPacked, unsigned int aShift, unsigned int aBits)
+    {
+        const std::int32_t value =
+            static_cast<std::int32_t>(aPacked << (32 - aShift - aBits)) >> (32 - aBits);
+        return std::max(static_cast<float>(value) / static_cast<float>((1 << (aBits - 1)) - 1), -1.f);
+    }
+
+} // anonymous namespace
+
+
+SCENARIO("Vertex attribute encodings")
+{
+    GIVEN("Floats covering the encoded ranges, in a count exercising vector and scalar loops")
+    {
+        std::vector<float> values;
+        for (int step = -1100; step <= 1100; ++step)
+        {
+            values.push_back(step / 1000.f);
+        }
+
+        THEN("Half floats are within half a unit in the last place")
+        {
+            std::vector<std::uint16_t> halves(values.size());
+            r3d::detail::encodeHalf(values, halves.data());
+            for (std::size_t index = 0; index != values.size(); ++index)
+            {
+                const float value = values[index];
+                const float ulp = (std::abs(value) < std::ldexp(1.f, -14)) ?
+                    std::ldexp(1.f, -24) : std::ldexp(1.f, std::ilogb(value) - 10);
+                REQUIRE(std::abs(fromHalf(halves[index]) - value) <= ulp / 2);
+            }
+        }
+
+        THEN("Normalized integers are rounded to nearest even, and clamped")
+        {
+            std::vector<std::int16_t> snorm16(values.size());
+            std::vector<std::uint16_t> unorm16(values.size());
+            std::vector<std::int8_t> snorm8(values.size());
+            std::vector<std::uint8_t> unorm8(values.size());
+            r3d::detail::encodeSnorm16(values, snorm16.data());
+            r3d::detail::encodeUnorm16(values, unorm16.data());
+            r3d::detail::encodeSnorm8(values, snorm8.data());
+            r3d::detail::encodeUnorm8(values, unorm8.data());
+
+            for (std::size_t index = 0; index != values.size(); ++index)
+            {
+                const float signedValue = std::clamp(values[index], -1.f, 1.f);
+                const float unsignedValue = std::clamp(values[index], 0.f, 1.f);
+                REQUIRE(snorm16[index] == std::lrint(signedValue * 32767.f));
+                REQUIRE(unorm16[index] == std::lrint(unsignedValue * 65535.f));
+                REQUIRE(snorm8[index] == std::lrint(signedValue * 127.f));
+                REQUIRE(unorm8[index] == std::lrint(unsignedValue * 255.f));
+            }
+        }
+    }
+
+    GIVEN("Special float values")
+    {
+        std::vector<float> values{0.f, -0.f, 65504.f, 65520.f, 1e-8f,
+                                  std::numeric_limits<float>::infinity(),
+                                  std::numeric_limits<float>::quiet_NaN()};
+
+        THEN("Half floats handle them as IEEE conversion does")
+        {
+            std::vector<std::uint16_t> halves(values.size());
+            r3d::detail::encodeHalf(values, halves.data());
+            REQUIRE(halves[0] == 0x0000);
+            REQUIRE(halves[1] == 0x8000);
+            REQUIRE(halves[2] == 0x7BFF); // largest half
+            REQUIRE(halves[3] == 0x7C00); // rounds to infinity
+            REQUIRE(halves[4] == 0x0000); // below the smallest subnormal half
+            REQUIRE(halves[5] == 0x7C00);
+            REQUIRE((halves[6] & 0x7C00) == 0x7C00);
+            REQUIRE((halves[6] & 0x03FF) != 0);
+        }
+    }
+}
+
+
+SCENARIO("Vertex stream building")
+{
+    GIVEN("A glTF primitive with float positions, normals, texture coordinates and colors")
+    {
+        arte::initializeLogging();
+        const arte::Gltf gltf{writePrimitive()};
+        arte::gltf::BufferCache buffers{gltf};
+        const arte::gltf::Primitive & primitive = gltf.get(arte::gltf::Index<arte::gltf::Mesh>{0})->primitives[0];
+
+        WHEN("It is built with compact encodings")
+        {
+            const r3d::VertexStreamBuilder builder{{
+                {"POSITION", 0, r3d::VertexEncoding::Quantized16},
+                {"NORMAL", 1, r3d::VertexEncoding::Snorm2_10_10_10},
+                {"TEXCOORD_0", 2, r3d::VertexEncoding::Half},
+                {"COLOR_0", 3, r3d::VertexEncoding::Unorm8},
+            }};
+            const r3d::VertexStream stream = builder.build(buffers, primitive);
+
+            THEN("Attributes are interleaved at 4-byte aligned offsets")
+            {
+                // 3 x 2 bytes padded to 8, 4 packed bytes, 2 x 2 bytes, 3 x 1 byte padded to 4.
+                REQUIRE(stream.vertexCount == gVertexCount);
+                REQUIRE(stream.stride == 20);
+                REQUIRE(stream.data.size() == 20 * gVertexCount);
+
+                const std::size_t offsets[] = {0, 8, 12, 16};
+                const GLuint dimensions[] = {3, 4, 2, 3};
+                const GLenum types[] = {GL_UNSIGNED_SHORT, GL_INT_2_10_10_10_REV, GL_HALF_FLOAT, GL_UNSIGNED_BYTE};
+                const bool normalized[] = {true, true, false, true};
+                REQUIRE(stream.attributes.size() == 4);
+                for (std::size_t attributeId = 0; attributeId != 4; ++attributeId)
+                {
+                    const AttributeFormat & attribute = stream.attributes[attributeId];
+                    REQUIRE(attribute.mIndex == attributeId);
+                    REQUIRE(attribute.mOffset == offsets[attributeId]);
+                    REQUIRE(attribute.mDimension[0] == dimensions[attributeId]);
+                    REQUIRE(attribute.mComponentType == types[attributeId]);
+                    REQUIRE(attribute.mNormalize == normalized[attributeId]);
+                }
+            }
+
+            THEN("Quantized positions dequantize to the original values")
+            {
+                const r3d::Dequantization & dequantization = stream.dequantizations[0];
+                REQUIRE(dequantization.offset == std::array<float, 4>{-2.f, 10.f, 0.5f, 0.f});
+                REQUIRE(dequantization.scale == std::array<float, 4>{5.f, 2.f, 1.f, 1.f});
+
+                std::size_t mismatches = 0;
+                for (std::size_t vertex = 0; vertex != gVertexCount; ++vertex)
+                {
+                    for (std::size_t component = 0; component != 3; ++component)
+                    {
+                        const float normalizedValue =
+                            readAt<std::uint16_t>(stream, vertex, 2 * component) / 65535.f;
+                        const float value = normalizedValue * dequantization.scale[component]
+                                            + dequantization.offset[component];
+                        // Within half a quantization step.
+                        const float tolerance = 0.5f * dequantization.scale[component] / 65535.f + 1e-6f;
+                        mismatches += (std::abs(value - gPositions[3 * vertex + component]) > tolerance) ? 1 : 0;
+                    }
+                }
+                REQUIRE(mismatches == 0);
+            }
+
+            THEN("Packed normals decode to the clamped values, with a zero w")
+            {
+                std::size_t mismatches = 0;
+                for (std::size_t vertex = 0; vertex != gVertexCount; ++vertex)
+                {
+                    const std::uint32_t packed = readAt<std::uint32_t>(stream, vertex, 8);
+                    for (std::size_t component = 0; component != 3; ++component)
+                    {
+                        const float expected = std::clamp(gNormals[3 * vertex + component], -1.f, 1.f);
+                        const float decoded = decodeSnorm(packed, 10 * static_cast<unsigned int>(component), 10);
+                        mismatches += (std::abs(decoded - expected) > 0.5f / 511.f) ? 1 : 0;
+                    }
+                    mismatches += (decodeSnorm(packed, 30, 2) != 0.f) ? 1 : 0;
+                }
+                REQUIRE(mismatches == 0);
+            }
+
+            THEN("Texture coordinates are halves, and colors normalized bytes")
+            {
+                std::size_t mismatches = 0;
+                for (std::size_t vertex = 0; vertex != gVertexCount; ++vertex)
+                {
+                    for (std::size_t component = 0; component != 2; ++component)
+                    {
+                        const float decoded = fromHalf(readAt<std::uint16_t>(stream, vertex, 12 + 2 * component));
+                        mismatches += (std::abs(decoded - gTexCoords[2 * vertex + component]) > 1.f / 4096.f) ? 1 : 0;
+                    }
+                    for (std::size_t component = 0; component != 3; ++component)
+                    {
+                        const std::uint8_t decoded = readAt<std::uint8_t>(stream, vertex, 16 + component);
+                        mismatches += (decoded != std::lrint(gColors[3 * vertex + component] * 255.f)) ? 1 : 0;
+                    }
+                }
+                REQUIRE(mismatches == 0);
+            }
+        }
+
+        THEN("Building a layout with an attribute missing from the primitive throws")
+        {
+            const r3d::VertexStreamBuilder builder{{
+                {"POSITION", 0, r3d::VertexEncoding::Float},
+                {"TANGENT", 1, r3d::VertexEncoding::Snorm2_10_10_10},
+            }};
+            REQUIRE_THROWS_AS(builder.build(buffers, primitive), std::invalid_argument);
+        }
+    }
+}
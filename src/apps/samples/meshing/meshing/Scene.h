@@ -0,0 +1,79 @@
+#pragma once
+
+
+#include <graphics/CameraUtilities.h>
+#include <graphics/Timer.h>
+#include <graphics/3d/MeshRenderer.h>
+
+#include <arte/gltf/Gltf.h>
+#include <arte/gltf/SceneGraph.h>
+
+#include <math/Angle.h>
+#include <math/Vector.h>
+
+#include <cmath>
+
+
+namespace ad {
+namespace graphics {
+
+
+/// @brief Draws the default scene of a glTF file, seen by a camera orbiting around the origin.
+class Scene
+{
+public:
+    Scene(const filesystem::path & aGltfPath, GLfloat aOrbitRadius, Size2<int> aRenderResolution) :
+        mGltf{aGltfPath},
+        mBuffers{mGltf},
+        mSceneGraph{mGltf, getSceneIndex(mGltf)},
+        mMeshRenderer{mBuffers},
+        mOrbitRadius{aOrbitRadius}
+    {
+        mCameraProjection.setProjectionTransformation(makeProjection(PerspectiveParameters{
+            .mAspectRatio = math::getRatio<GLfloat>(aRenderResolution),
+            .mVerticalFov = math::Radian<GLfloat>{0.9f},
+            .mNearZ = -0.01f * mOrbitRadius,
+            .mFarZ = -10.f * mOrbitRadius,
+        }));
+        // The scene is static, its instances are only set once.
+        mMeshRenderer.resetInstances(mGltf, mSceneGraph);
+    }
+
+    void step(const Timer & aTimer)
+    {
+        const GLfloat angle = 0.5f * static_cast<GLfloat>(aTimer.time());
+        const math::Position<3, GLfloat> position{
+            mOrbitRadius * std::sin(angle),
+            0.3f * mOrbitRadius,
+            mOrbitRadius * std::cos(angle),
+        };
+        mCameraProjection.setCameraTransformation(
+            getCameraTransform(position, -position.as<math::Vec>()));
+    }
+
+    void render() const
+    {
+        mMeshRenderer.render(mCameraProjection);
+    }
+
+private:
+    static arte::gltf::Index<arte::gltf::Scene> getSceneIndex(const arte::Gltf & aGltf)
+    {
+        if (auto scene = aGltf.getDefaultScene())
+        {
+            return scene->id();
+        }
+        return arte::gltf::Index<arte::gltf::Scene>{0};
+    }
+
+    arte::Gltf mGltf;
+    arte::gltf::BufferCache mBuffers;
+    arte::gltf::SceneGraph mSceneGraph;
+    r3d::MeshRenderer mMeshRenderer;
+    CameraProjection mCameraProjection;
+    GLfloat mOrbitRadius;
+};
+
+
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,52 @@
+#include "Scene.h"
+
+#include <graphics/ApplicationGlfw.h>
+#include <graphics/AppInterface.h>
+#include <graphics/Timer.h>
+
+#include <string>
+
+
+using namespace ad;
+using namespace ad::graphics;
+
+// usage: meshing model.gltf [orbit_radius]
+
+int main(int argc, const char * argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " model.gltf [orbit_radius]" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    try
+    {
+        ApplicationGlfw application("Meshing", 800, 600);
+
+        Timer timer{glfwGetTime(), 0.};
+
+        Scene scene{argv[1],
+                    argc > 2 ? std::stof(argv[2]) : 5.f,
+                    application.getAppInterface()->getFramebufferSize()};
+
+        glEnable(GL_DEPTH_TEST);
+
+        while(application.nextFrame())
+        {
+            timer.mark(glfwGetTime());
+            scene.step(timer);
+            application.getAppInterface()->clear();
+            scene.render();
+        }
+    }
+    catch(const std::exception & e)
+    {
+        std::cerr << "Exception:\n"
+                  << e.what()
+                  << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,157 @@
+#include <arte/Freetype.h>
+
+#include <graphics/detail/BakedFont.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+// Usage
+// fontbake <font file> <output file> [--msdf] [--atlas <dimension>] --size <pixel height>... [--range <first>-<last>]...
+//
+// Renders the glyphs of each range (default: printable ASCII), at each pixel height,
+// to a file loaded at runtime with `Texting::loadGlyphs()`.
+// Ranges are inclusive, code points can be given in hexadecimal (e.g. 0xA0-0xFF).
+
+
+using namespace ad;
+
+
+namespace {
+
+    constexpr GLint gDefaultAtlasDimension = 2048; // as used by Texting
+
+    struct Options
+    {
+        filesystem::path font;
+        filesystem::path output;
+        graphics::detail::GlyphRasterization rasterization = graphics::detail::GlyphRasterization::Coverage;
+        GLint atlasDimension = gDefaultAtlasDimension;
+        std::vector<int> pixelHeights;
+        std::vector<graphics::detail::baked::Range> ranges;
+    };
+
+
+    unsigned long parseNumber(const std::string & aArgument)
+    {
+        std::size_t end;
+        const unsigned long result = std::stoul(aArgument, &end, 0);
+        if (end != aArgument.size())
+        {
+            throw std::invalid_argument{"Invalid number: " + aArgument};
+        }
+        return result;
+    }
+
+
+    Options parseOptions(int argc, const char * argv[])
+    {
+        if (argc < 3)
+        {
+            throw std::invalid_argument{"Usage: fontbake <font file> <output file> [--msdf] [--atlas <dimension>] "
+                                        "--size <pixel height>... [--range <first>-<last>]..."};
+        }
+
+        Options options;
+        options.font = argv[1];
+        options.output = argv[2];
+        for (int index = 3; index != argc; ++index)
+        {
+            const std::string argument{argv[index]};
+            auto value = [&]() -> std::string
+            {
+                if (++index == argc)
+                {
+                    throw std::invalid_argument{"Missing value after " + argument};
+                }
+                return argv[index];
+            };
+
+            if (argument == "--msdf")
+            {
+                options.rasterization = graphics::detail::GlyphRasterization::Msdf;
+            }
+            else if (argument == "--atlas")
+            {
+                options.atlasDimension = static_cast<GLint>(parseNumber(value()));
+            }
+            else if (argument == "--size")
+            {
+                options.pixelHeights.push_back(static_cast<int>(parseNumber(value())));
+            }
+            else if (argument == "--range")
+            {
+                const std::string range = value();
+                const std::size_t separator = range.find('-');
+                if (separator == std::string::npos)
+                {
+                    throw std::invalid_argument{"Invalid range: " + range};
+                }
+                options.ranges.push_back({
+                    static_cast<std::uint32_t>(parseNumber(range.substr(0, separator))),
+                    static_cast<std::uint32_t>(parseNumber(range.substr(separator + 1)) + 1),
+                });
+            }
+            else
+            {
+                throw std::invalid_argument{"Unknown option: " + argument};
+            }
+        }
+
+        if (options.pixelHeights.empty())
+        {
+            throw std::invalid_argument{"At least one --size is required."};
+        }
+        if (options.ranges.empty())
+        {
+            options.ranges.push_back({0x20, 0x7F});
+        }
+        return options;
+    }
+
+} // anonymous namespace
+
+
+int main(int argc, const char * argv[])
+{
+    try
+    {
+        const Options options = parseOptions(argc, argv);
+
+        arte::Freetype freetype;
+        arte::FontFace fontFace = freetype.load(options.font);
+        // Same configuration as the Texting face, so the baked glyphs are identical to glyphs rendered on demand.
+        fontFace.inverseYAxis(true);
+
+        std::vector<graphics::detail::BakedFontSize> sizes;
+        std::vector<graphics::detail::BakedFontSizeView> views;
+        for (int pixelHeight : options.pixelHeights)
+        {
+            fontFace.setPixelHeight(pixelHeight);
+            const graphics::detail::BakedFontSize & size = sizes.emplace_back(graphics::detail::bakeFontSize(
+                fontFace,
+                options.ranges,
+                options.rasterization,
+                {options.atlasDimension, options.atlasDimension}));
+            std::cout << "Baked " << size.glyphs.size() << " glyphs on " << size.pages.size()
+                      << " page(s), with " << size.kerningPairs.size() << " kerning pairs, at pixel height "
+                      << pixelHeight << ".\n";
+        }
+
+        for (const graphics::detail::BakedFontSize & size : sizes)
+        {
+            views.push_back(size.view());
+        }
+        graphics::detail::writeBakedFont(options.output, views);
+    }
+    catch(const std::exception & e)
+    {
+        std::cerr << "Exception:\n"
+                  << e.what()
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,661 @@
+// solveCubicNormed(), the edge signedDistance() routines, switchColor() and the simple edge coloring
+// are ported from msdfgen (https://github.com/Chlumsky/msdfgen), distributed under the following license:
+//
+// MIT License
+//
+// Copyright (c) 2014 - 2024 Viktor Chlumsky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "DistanceField.h"
+
+#include FT_OUTLINE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+
+
+namespace ad {
+namespace arte {
+
+
+namespace {
+
+
+    //
+    // Geometry
+    //
+    struct Point
+    {
+        double x, y;
+
+        Point operator+(Point aRhs) const { return {x + aRhs.x, y + aRhs.y}; }
+        Point operator-(Point aRhs) const { return {x - aRhs.x, y - aRhs.y}; }
+        Point operator*(double aFactor) const { return {x * aFactor, y * aFactor}; }
+        bool operator==(const Point &) const = default;
+    };
+
+    double dot(Point aLhs, Point aRhs)
+    { return aLhs.x * aRhs.x + aLhs.y * aRhs.y; }
+
+    double cross(Point aLhs, Point aRhs)
+    { return aLhs.x * aRhs.y - aLhs.y * aRhs.x; }
+
+    double length(Point aPoint)
+    { return std::sqrt(dot(aPoint, aPoint)); }
+
+    Point normalize(Point aPoint)
+    {
+        const double norm = length(aPoint);
+        return norm == 0. ? Point{0., 1.} : aPoint * (1. / norm);
+    }
+
+    Point mix(Point aFrom, Point aTo, double aWeight)
+    { return aFrom * (1. - aWeight) + aTo * aWeight; }
+
+    double nonZeroSign(double aValue)
+    { return aValue > 0. ? 1. : -1.; }
+
+
+    //
+    // Polynomial roots
+    //
+    int solveQuadratic(std::array<double, 3> & aRoots, double a, double b, double c)
+    {
+        if (a == 0. || std::abs(b) > 1e12 * std::abs(a))
+        {
+            if (b == 0.)
+            {
+                return 0;
+            }
+            aRoots[0] = -c / b;
+            return 1;
+        }
+        double discriminant = b * b - 4. * a * c;
+        if (discriminant > 0.)
+        {
+            discriminant = std::sqrt(discriminant);
+            aRoots[0] = (-b + discriminant) / (2. * a);
+            aRoots[1] = (-b - discriminant) / (2. * a);
+            return 2;
+        }
+        else if (discriminant == 0.)
+        {
+            aRoots[0] = -b / (2. * a);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Roots of x^3 + a x^2 + b x + c.
+    int solveCubicNormed(std::array<double, 3> & aRoots, double a, double b, double c)
+    {
+        const double a2 = a * a;
+        double q = (a2 - 3. * b) / 9.;
+        const double r = (a * (2. * a2 - 9. * b) + 27. * c) / 54.;
+        const double r2 = r * r;
+        const double q3 = q * q * q;
+        a /= 3.;
+        if (r2 < q3)
+        {
+            const double t = std::acos(std::clamp(r / std::sqrt(q3), -1., 1.));
+            q = -2. * std::sqrt(q);
+            aRoots[0] = q * std::cos(t / 3.) - a;
+            aRoots[1] = q * std::cos((t + 2. * std::numbers::pi) / 3.) - a;
+            aRoots[2] = q * std::cos((t - 2. * std::numbers::pi) / 3.) - a;
+            return 3;
+        }
+        else
+        {
+            const double u = (r < 0. ? 1. : -1.) * std::cbrt(std::abs(r) + std::sqrt(r2 - q3));
+            const double v = (u == 0.) ? 0. : q / u;
+            aRoots[0] = (u + v) - a;
+            if (u == v || std::abs(u - v) < 1e-12 * std::abs(u + v))
+            {
+                aRoots[1] = -.5 * (u + v) - a;
+                return 2;
+            }
+            return 1;
+        }
+    }
+
+    int solveCubic(std::array<double, 3> & aRoots, double a, double b, double c, double d)
+    {
+        if (a != 0. && std::abs(b / a) < 1e6)
+        {
+            return solveCubicNormed(aRoots, b / a, c / a, d / a);
+        }
+        return solveQuadratic(aRoots, b, c, d);
+    }
+
+
+    //
+    // Edges
+    //
+    enum Color : unsigned char
+    {
+        Black = 0,
+        Red = 1,
+        Green = 2,
+        Yellow = 3,
+        Blue = 4,
+        Magenta = 5,
+        Cyan = 6,
+        White = 7,
+    };
+
+    /// Distances are compared by magnitude first, then by how orthogonal to the edge the direction is.
+    struct SignedDistance
+    {
+        double distance{-std::numeric_limits<double>::max()};
+        double dot{1.};
+
+        bool operator<(const SignedDistance & aRhs) const
+        {
+            return std::abs(distance) < std::abs(aRhs.distance)
+                || (std::abs(distance) == std::abs(aRhs.distance) && dot < aRhs.dot);
+        }
+    };
+
+    /// @brief A Bezier segment of degree 1 (line), 2 (conic) or 3 (cubic).
+    struct Edge
+    {
+        std::array<Point, 4> p;
+        int degree;
+        Color color{White};
+
+        Point point(double t) const
+        {
+            switch (degree)
+            {
+            case 1:
+                return mix(p[0], p[1], t);
+            case 2:
+                return mix(mix(p[0], p[1], t), mix(p[1], p[2], t), t);
+            default:
+            {
+                const Point p12 = mix(p[1], p[2], t);
+                return mix(mix(mix(p[0], p[1], t), p12, t), mix(p12, mix(p[2], p[3], t), t), t);
+            }
+            }
+        }
+
+        Point direction(double t) const
+        {
+            switch (degree)
+            {
+            case 1:
+                return p[1] - p[0];
+            case 2:
+            {
+                const Point tangent = mix(p[1] - p[0], p[2] - p[1], t);
+                return (tangent == Point{0., 0.}) ? p[2] - p[0] : tangent;
+            }
+            default:
+            {
+                const Point tangent = mix(mix(p[1] - p[0], p[2] - p[1], t), mix(p[2] - p[1], p[3] - p[2], t), t);
+                if (tangent == Point{0., 0.})
+                {
+                    if (t == 0.) return p[2] - p[0];
+                    if (t == 1.) return p[3] - p[1];
+                }
+                return tangent;
+            }
+            }
+        }
+
+        const Point & end() const
+        { return p[degree]; }
+
+        /// @brief Split the edge at `t`, with de Casteljau's algorithm.
+        std::pair<Edge, Edge> split(double t) const
+        {
+            Edge first{.p = {}, .degree = degree, .color = color};
+            Edge second{.p = {}, .degree = degree, .color = color};
+            std::array<Point, 4> points = p;
+            for (int level = 0; level <= degree; ++level)
+            {
+                first.p[level] = points[0];
+                second.p[degree - level] = points[degree - level];
+                for (int index = 0; index != degree - level; ++index)
+                {
+                    points[index] = mix(points[index], points[index + 1], t);
+                }
+            }
+            return {first, second};
+        }
+
+        SignedDistance signedDistance(Point aOrigin, double & aParam) const;
+
+        /// @brief Replace the distance by the distance to the edge extension, when the nearest point is an endpoint.
+        void distanceToPseudoDistance(SignedDistance & aDistance, Point aOrigin, double aParam) const
+        {
+            if (aParam < 0.)
+            {
+                const Point dir = normalize(direction(0.));
+                const Point aq = aOrigin - p[0];
+                if (dot(aq, dir) < 0.)
+                {
+                    if (const double pseudo = cross(aq, dir); std::abs(pseudo) <= std::abs(aDistance.distance))
+                    {
+                        aDistance = {pseudo, 0.};
+                    }
+                }
+            }
+            else if (aParam > 1.)
+            {
+                const Point dir = normalize(direction(1.));
+                const Point bq = aOrigin - end();
+                if (dot(bq, dir) > 0.)
+                {
+                    if (const double pseudo = cross(bq, dir); std::abs(pseudo) <= std::abs(aDistance.distance))
+                    {
+                        aDistance = {pseudo, 0.};
+                    }
+                }
+            }
+        }
+    };
+
+
+    SignedDistance Edge::signedDistance(Point aOrigin, double & aParam) const
+    {
+        if (degree == 1)
+        {
+            const Point aq = aOrigin - p[0];
+            const Point ab = p[1] - p[0];
+            aParam = dot(aq, ab) / dot(ab, ab);
+            const Point eq = (aParam > .5 ? p[1] : p[0]) - aOrigin;
+            const double endpointDistance = length(eq);
+            if (aParam > 0. && aParam < 1.)
+            {
+                const Point normal = normalize(Point{ab.y, -ab.x});
+                if (const double orthoDistance = dot(normal, aq); std::abs(orthoDistance) < endpointDistance)
+                {
+                    return {orthoDistance, 0.};
+                }
+            }
+            return {nonZeroSign(cross(aq, ab)) * endpointDistance,
+                    std::abs(dot(normalize(ab), normalize(eq)))};
+        }
+
+        const Point qa = p[0] - aOrigin;
+        const Point ab = p[1] - p[0];
+        const Point br = p[2] - p[1] - ab;
+
+        // Start with the endpoints.
+        Point epDir = direction(0.);
+        double minDistance = nonZeroSign(cross(epDir, qa)) * length(qa);
+        aParam = -dot(qa, epDir) / dot(epDir, epDir);
+        {
+            epDir = direction(1.);
+            const Point eq = end() - aOrigin;
+            if (const double distance = length(eq); distance < std::abs(minDistance))
+            {
+                minDistance = nonZeroSign(cross(epDir, eq)) * distance;
+                aParam = dot(aOrigin - end() + epDir, epDir) / dot(epDir, epDir);
+            }
+        }
+
+        if (degree == 2)
+        {
+            // The nearest point cancels the derivative of the squared distance, a cubic polynomial.
+            std::array<double, 3> roots;
+            const int count = solveCubic(roots,
+                                         dot(br, br),
+                                         3. * dot(ab, br),
+                                         2. * dot(ab, ab) + dot(qa, br),
+                                         dot(qa, ab));
+            for (int index = 0; index != count; ++index)
+            {
+                if (const double t = roots[index]; t > 0. && t < 1.)
+                {
+                    const Point qe = qa + ab * (2. * t) + br * (t * t);
+                    if (const double distance = length(qe); distance <= std::abs(minDistance))
+                    {
+                        minDistance = nonZeroSign(cross(ab + br * t, qe)) * distance;
+                        aParam = t;
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Newton iterations on the derivative of the squared distance, from several starts.
+            constexpr int gSearchStarts = 4;
+            constexpr int gSearchSteps = 4;
+            const Point as = (p[3] - p[2]) - (p[2] - p[1]) - br;
+            for (int start = 0; start <= gSearchStarts; ++start)
+            {
+                double t = double(start) / gSearchStarts;
+                Point qe = qa + ab * (3. * t) + br * (3. * t * t) + as * (t * t * t);
+                for (int step = 0; step != gSearchSteps; ++step)
+                {
+                    const Point d1 = ab * 3. + br * (6. * t) + as * (3. * t * t);
+                    const Point d2 = br * 6. + as * (6. * t);
+                    t -= dot(qe, d1) / (dot(d1, d1) + dot(qe, d2));
+                    if (t <= 0. || t >= 1.)
+                    {
+                        break;
+                    }
+                    qe = qa + ab * (3. * t) + br * (3. * t * t) + as * (t * t * t);
+                    if (const double distance = length(qe); distance < std::abs(minDistance))
+                    {
+                        minDistance = nonZeroSign(cross(d1, qe)) * distance;
+                        aParam = t;
+                    }
+                }
+            }
+        }
+
+        if (aParam >= 0. && aParam <= 1.)
+        {
+            return {minDistance, 0.};
+        }
+        else if (aParam < .5)
+        {
+            return {minDistance, std::abs(dot(normalize(direction(0.)), normalize(qa)))};
+        }
+        else
+        {
+            return {minDistance, std::abs(dot(normalize(direction(1.)), normalize(end() - aOrigin)))};
+        }
+    }
+
+
+    using Contour = std::vector<Edge>;
+
+
+    //
+    // Outline decomposition
+    //
+    struct Decomposition
+    {
+        std::vector<Contour> contours;
+        Point position{0., 0.};
+
+        void add(Edge aEdge)
+        {
+            aEdge.p[0] = position;
+            position = aEdge.end();
+            // Degenerate segments have no direction, and would not contribute to the distance.
+            if (!(aEdge.end() == aEdge.p[0] && aEdge.degree == 1))
+            {
+                contours.back().push_back(aEdge);
+            }
+        }
+    };
+
+    Point toPoint(const FT_Vector * aVector)
+    {
+        // From 26.6 fixed point to pixels.
+        return {aVector->x / 64., aVector->y / 64.};
+    }
+
+    std::vector<Contour> decompose(const FT_Outline & aOutline)
+    {
+        FT_Outline_Funcs functions{
+            .move_to = [](const FT_Vector * aTo, void * aUser) -> int
+            {
+                auto * decomposition = static_cast<Decomposition *>(aUser);
+                decomposition->contours.emplace_back();
+                decomposition->position = toPoint(aTo);
+                return 0;
+            },
+            .line_to = [](const FT_Vector * aTo, void * aUser) -> int
+            {
+                static_cast<Decomposition *>(aUser)->add(Edge{.p = {Point{}, toPoint(aTo)}, .degree = 1});
+                return 0;
+            },
+            .conic_to = [](const FT_Vector * aControl, const FT_Vector * aTo, void * aUser) -> int
+            {
+                static_cast<Decomposition *>(aUser)->add(
+                    Edge{.p = {Point{}, toPoint(aControl), toPoint(aTo)}, .degree = 2});
+                return 0;
+            },
+            .cubic_to = [](const FT_Vector * aControl1, const FT_Vector * aControl2, const FT_Vector * aTo, void * aUser) -> int
+            {
+                static_cast<Decomposition *>(aUser)->add(
+                    Edge{.p = {Point{}, toPoint(aControl1), toPoint(aControl2), toPoint(aTo)}, .degree = 3});
+                return 0;
+            },
+            .shift = 0,
+            .delta = 0,
+        };
+
+        Decomposition decomposition;
+        if (FT_Error error = FT_Outline_Decompose(const_cast<FT_Outline *>(&aOutline), &functions, &decomposition))
+        {
+            throw std::logic_error{"Error " + std::to_string(error) + " while decomposing a glyph outline."};
+        }
+        std::erase_if(decomposition.contours, [](const Contour & aContour){ return aContour.empty(); });
+        return std::move(decomposition.contours);
+    }
+
+
+    //
+    // Edge coloring
+    //
+    /// @brief Change `aColor` to a color with two channels, sharing exactly one channel with the previous one.
+    void switchColor(Color & aColor, unsigned long long & aSeed, Color aBanned = Black)
+    {
+        const Color combined = Color(aColor & aBanned);
+        if (combined == Red || combined == Green || combined == Blue)
+        {
+            aColor = Color(combined ^ White);
+            return;
+        }
+        if (aColor == Black || aColor == White)
+        {
+            constexpr Color gStart[3] = {Cyan, Magenta, Yellow};
+            aColor = gStart[aSeed % 3];
+            aSeed /= 3;
+            return;
+        }
+        const int shifted = aColor << (1 + (aSeed & 1));
+        aColor = Color((shifted | shifted >> 3) & White);
+        aSeed >>= 1;
+    }
+
+    bool isCorner(Point aIncoming, Point aOutgoing, double aCrossThreshold)
+    {
+        return dot(aIncoming, aOutgoing) <= 0. || std::abs(cross(aIncoming, aOutgoing)) > aCrossThreshold;
+    }
+
+    /// @brief Assign colors so that the edges meeting at a corner never share two channels.
+    ///
+    /// This is the "simple" edge coloring of Chlumsky's thesis, a corner being a direction
+    /// change sharper than `aAngleThreshold` (radians).
+    void colorEdges(std::vector<Contour> & aContours, double aAngleThreshold)
+    {
+        const double crossThreshold = std::sin(aAngleThreshold);
+        unsigned long long seed = 0;
+        for (Contour & contour : aContours)
+        {
+            std::vector<std::size_t> corners;
+            Point previousDirection = contour.back().direction(1.);
+            for (std::size_t index = 0; index != contour.size(); ++index)
+            {
+                if (isCorner(normalize(previousDirection), normalize(contour[index].direction(0.)), crossThreshold))
+                {
+                    corners.push_back(index);
+                }
+                previousDirection = contour[index].direction(1.);
+            }
+
+            if (corners.empty())
+            {
+                // Smooth contour: all channels see the same edges.
+                for (Edge & edge : contour)
+                {
+                    edge.color = White;
+                }
+            }
+            else if (corners.size() == 1)
+            {
+                // "Teardrop": the contour is split in three colored parts.
+                Color colors[3] = {White, White, White};
+                switchColor(colors[0], seed);
+                colors[2] = colors[0];
+                switchColor(colors[2], seed);
+
+                const std::size_t corner = corners.front();
+                if (contour.size() >= 3)
+                {
+                    const std::size_t count = contour.size();
+                    for (std::size_t index = 0; index != count; ++index)
+                    {
+                        // Symmetrical trichotomy of the edges, starting at the corner.
+                        const int third = int(3. + 2.875 * index / (count - 1) - 1.4375 + .5) - 3;
+                        contour[(corner + index) % count].color = colors[1 + third];
+                    }
+                }
+                else
+                {
+                    // Less edges than colors: split each edge in thirds.
+                    Contour parts;
+                    for (std::size_t index = 0; index != contour.size(); ++index)
+                    {
+                        const Edge & edge = contour[(corner + index) % contour.size()];
+                        auto [first, rest] = edge.split(1. / 3.);
+                        auto [second, third] = rest.split(.5);
+                        parts.insert(parts.end(), {first, second, third});
+                    }
+                    for (std::size_t index = 0; index != parts.size(); ++index)
+                    {
+                        parts[index].color = colors[index * 3 / parts.size()];
+                    }
+                    contour = std::move(parts);
+                }
+            }
+            else
+            {
+                // Switch color at each corner, the last spline not reusing the first color.
+                std::size_t spline = 0;
+                const std::size_t start = corners.front();
+                Color color = White;
+                switchColor(color, seed);
+                const Color initialColor = color;
+                for (std::size_t offset = 0; offset != contour.size(); ++offset)
+                {
+                    const std::size_t index = (start + offset) % contour.size();
+                    if (spline + 1 < corners.size() && corners[spline + 1] == index)
+                    {
+                        ++spline;
+                        switchColor(color, seed, (spline == corners.size() - 1) ? initialColor : Black);
+                    }
+                    contour[index].color = color;
+                }
+            }
+        }
+    }
+
+
+    std::byte toByte(double aValue)
+    {
+        return std::byte(static_cast<unsigned char>(std::clamp(256. * aValue, 0., 255.)));
+    }
+
+
+} // anonymous namespace
+
+
+GlyphDistanceField generateMsdf(const FontFace & aFontFace, CharCode aCharCode, float aRange)
+{
+    FT_GlyphSlot slot =
+        aFontFace.loadChar(aCharCode, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP | FT_LOAD_IGNORE_TRANSFORM);
+    if (slot->format != FT_GLYPH_FORMAT_OUTLINE)
+    {
+        throw std::invalid_argument{"Distance fields can only be generated for outline glyphs."};
+    }
+
+    std::vector<Contour> contours = decompose(slot->outline);
+    colorEdges(contours, 3.);
+    // The distance sign is positive on the right of edges: reverse it for contours filled on their left.
+    const double sign = (FT_Outline_Get_Orientation(&slot->outline) == FT_ORIENTATION_POSTSCRIPT) ? -1. : 1.;
+
+    // Same pixel grid as the coverage bitmap rendered by FreeType, extended by the padding.
+    FT_BBox box;
+    FT_Outline_Get_CBox(&slot->outline, &box);
+    const int padding = static_cast<int>(std::ceil(aRange / 2.f));
+    const int left = static_cast<int>(std::floor(box.xMin / 64.));
+    const int bottom = static_cast<int>(std::floor(box.yMin / 64.));
+    const math::Size<2, int> resolution{
+        static_cast<int>(std::ceil(box.xMax / 64.)) - left + 2 * padding,
+        static_cast<int>(std::ceil(box.yMax / 64.)) - bottom + 2 * padding,
+    };
+
+    GlyphDistanceField field{
+        .texels = std::vector<std::byte>(GlyphDistanceField::gChannels * resolution.width() * resolution.height()),
+        .resolution = resolution,
+        .origin = {left - padding, bottom - padding},
+        .range = aRange,
+    };
+
+    struct Nearest
+    {
+        SignedDistance distance;
+        const Edge * edge{nullptr};
+        double param{0.};
+    };
+
+    auto texel = field.texels.begin();
+    for (int y = 0; y != resolution.height(); ++y)
+    {
+        for (int x = 0; x != resolution.width(); ++x)
+        {
+            // Distances are evaluated at the texel centers.
+            const Point origin{field.origin.x() + x + .5, field.origin.y() + y + .5};
+            std::array<Nearest, GlyphDistanceField::gChannels> nearest;
+            for (const Contour & contour : contours)
+            {
+                for (const Edge & edge : contour)
+                {
+                    double param;
+                    const SignedDistance distance = edge.signedDistance(origin, param);
+                    for (std::size_t channel = 0; channel != nearest.size(); ++channel)
+                    {
+                        if ((edge.color & (1 << channel)) && distance < nearest[channel].distance)
+                        {
+                            nearest[channel] = {distance, &edge, param};
+                        }
+                    }
+                }
+            }
+
+            for (Nearest & channel : nearest)
+            {
+                if (channel.edge != nullptr)
+                {
+                    channel.edge->distanceToPseudoDistance(channel.distance, origin, channel.param);
+                }
+                *texel++ = toByte(sign * channel.distance.distance / aRange + .5);
+            }
+        }
+    }
+    return field;
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,43 @@
+#pragma once
+
+
+#include "Freetype.h"
+
+#include <math/Vector.h>
+
+#include <cstddef>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief A multi-channel signed distance field (MSDF) of a glyph outline.
+///
+/// Each texel stores three distances (red, green, blue bytes), to the outline edges of the matching color.
+/// The median of the three channels is above one half inside the glyph, and the outline
+/// is reconstructed with sharp corners at any magnification.
+/// A channel value of 0 (resp. 1) maps to `-range / 2` (resp. `+range / 2`) pixels.
+struct GlyphDistanceField
+{
+    static constexpr std::size_t gChannels = 3;
+
+    std::vector<std::byte> texels; // Rows from the bottom of the glyph, tightly packed.
+    math::Size<2, int> resolution;
+    math::Vec<2, int> origin; // The field lower-left corner, relative to the pen position, in pixels.
+    float range;
+};
+
+
+/// \brief Generate the MSDF of the outline of `aCharCode`, at the current pixel size of `aFontFace`.
+///
+/// The field covers the glyph control box, extended by half the range on each side.
+/// Any transform set on the face is ignored: the field is always oriented with y up.
+/// \param aRange The width of the distance ramp, in pixels.
+/// \note Only accesses `aFontFace`, so it can run on any thread owning the face.
+GlyphDistanceField generateMsdf(const FontFace & aFontFace, CharCode aCharCode, float aRange = 4.f);
+
+
+} // namespace arte
+} // namespace ad
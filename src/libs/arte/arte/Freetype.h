@@ -88,6 +88,19 @@ public:
         return setPixelSize({0, aHeight});
     }
 
+    /// \brief Apply the pixel size and transform of `aOther` to this face.
+    ///
+    /// Two faces opened from the same file then render identical glyphs,
+    /// which allows to rasterize from several threads (a face must not be used concurrently).
+    FontFace & matchSettings(const FontFace & aOther)
+    {
+        FT_Matrix matrix;
+        FT_Vector delta;
+        FT_Get_Transform(aOther, &matrix, &delta);
+        FT_Set_Transform(*this, &matrix, &delta);
+        return setPixelSize(aOther.getPixelSize());
+    }
+
     math::Size<2, int> getPixelSize() const
     {
         // Note: this is likely not the real pixel size, but will be revisited
@@ -123,6 +136,17 @@ public:
         return get()->glyph;
     }
 
+    FT_UInt getGlyphIndex(CharCode aCharcode) const
+    {
+        return FT_Get_Char_Index(*this, FT_ULong{aCharcode});
+    }
+
+    /// \brief Whether the face provides kerning information retrievable with `kern()`.
+    bool hasKerning() const
+    {
+        return FT_HAS_KERNING(get());
+    }
+
     math::Vec<2, float> kern(FT_UInt aLeftGlyphIndex,
                              FT_UInt aRightGlyphIndex) const
     {
@@ -0,0 +1,161 @@
+#include "KerningTable.h"
+
+#include <algorithm>
+#include <bit>
+
+
+namespace ad {
+namespace arte {
+
+
+KerningTable::KerningTable(const FontFace & aFontFace) :
+    mHasKerning{aFontFace.hasKerning()}
+{}
+
+
+void KerningTable::addGlyphs(const FontFace & aFontFace, std::span<const FT_UInt> aGlyphIndices)
+{
+    if (!mHasKerning)
+    {
+        return;
+    }
+
+    const std::size_t previousCount = mEagerGlyphs.size();
+    for (FT_UInt glyph : aGlyphIndices)
+    {
+        if (mEagerGlyphs.size() == gMaxEagerGlyphs)
+        {
+            break;
+        }
+        addEagerGlyph(glyph);
+    }
+    const std::span<const FT_UInt> previous = std::span{mEagerGlyphs}.first(previousCount);
+    const std::span<const FT_UInt> added = std::span{mEagerGlyphs}.subspan(previousCount);
+
+    auto store = [&](FT_UInt aLeft, FT_UInt aRight)
+    {
+        math::Vec<2, float> offset = aFontFace.kern(aLeft, aRight);
+        if (offset != math::Vec<2, float>{0.f, 0.f})
+        {
+            storeOffset(makeKey(aLeft, aRight), offset);
+        }
+    };
+
+    for (FT_UInt glyph : added)
+    {
+        for (FT_UInt other : added)
+        {
+            store(glyph, other);
+        }
+        for (FT_UInt other : previous)
+        {
+            store(glyph, other);
+            store(other, glyph);
+        }
+    }
+}
+
+
+void KerningTable::addPairs(std::span<const FT_UInt> aEagerGlyphs, std::span<const Pair> aPairs)
+{
+    mHasKerning = mHasKerning || !aPairs.empty();
+    for (FT_UInt glyph : aEagerGlyphs)
+    {
+        addEagerGlyph(glyph);
+    }
+    for (const Pair & pair : aPairs)
+    {
+        storeOffset(makeKey(pair.left, pair.right), pair.offset);
+    }
+}
+
+
+math::Vec<2, float> KerningTable::memoize(FT_UInt aLeftGlyphIndex,
+                                          FT_UInt aRightGlyphIndex,
+                                          const FontFace & aFontFace) const
+{
+    const math::Vec<2, float> offset = aFontFace.kern(aLeftGlyphIndex, aRightGlyphIndex);
+    // Null offsets are not memoized: the table is then bounded by the pairs in the font kerning data,
+    // instead of growing with each distinct pair of glyphs ever laid out.
+    if (offset != math::Vec<2, float>{0.f, 0.f})
+    {
+        storeOffset(makeKey(aLeftGlyphIndex, aRightGlyphIndex), offset);
+    }
+    return offset;
+}
+
+
+std::vector<FT_UInt> KerningTable::getEagerGlyphs() const
+{
+    return mEagerGlyphs;
+}
+
+
+void KerningTable::setFlag(FT_UInt aGlyphIndex, GlyphFlag aFlag) const
+{
+    if (aGlyphIndex >= mGlyphFlags.size())
+    {
+        mGlyphFlags.resize(aGlyphIndex + 1, 0);
+    }
+    mGlyphFlags[aGlyphIndex] |= aFlag;
+}
+
+
+void KerningTable::addEagerGlyph(FT_UInt aGlyphIndex)
+{
+    if (!hasFlag(aGlyphIndex, Eager))
+    {
+        setFlag(aGlyphIndex, Eager);
+        mEagerGlyphs.push_back(aGlyphIndex);
+    }
+}
+
+
+std::vector<KerningTable::Pair> KerningTable::getPairs() const
+{
+    std::vector<Pair> pairs;
+    pairs.reserve(mOffsetCount);
+    for (const Entry & entry : mOffsets)
+    {
+        if (entry.key != gEmptyKey)
+        {
+            pairs.push_back({
+                .left = static_cast<FT_UInt>(entry.key >> 32),
+                .right = static_cast<FT_UInt>(entry.key & 0xFFFFFFFF),
+                .offset = entry.offset,
+            });
+        }
+    }
+    return pairs;
+}
+
+
+void KerningTable::storeOffset(std::uint64_t aKey, math::Vec<2, float> aOffset) const
+{
+    // Keep the load factor at most 1/2, so probing sequences stay short.
+    if (2 * (mOffsetCount + 1) > mOffsets.size())
+    {
+        std::vector<Entry> previous = std::move(mOffsets);
+        mOffsets.assign(std::max<std::size_t>(16, 2 * previous.size()), Entry{});
+        mHashShift = 64 - std::countr_zero(mOffsets.size());
+        for (const Entry & entry : previous)
+        {
+            if (entry.key != gEmptyKey)
+            {
+                *findEntry(entry.key) = entry;
+            }
+        }
+    }
+
+    Entry * entry = findEntry(aKey);
+    if (entry->key == gEmptyKey)
+    {
+        ++mOffsetCount;
+    }
+    *entry = Entry{aKey, aOffset};
+    setFlag(static_cast<FT_UInt>(aKey >> 32), LeftOfPair);
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,186 @@
+#pragma once
+
+
+#include "Freetype.h"
+
+#include <math/Vector.h>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Kerning offsets between pairs of glyphs, precomputed from a font face,
+/// so layout does not query FreeType for each pair of adjacent glyphs.
+///
+/// The pairs between all glyphs given to `addGlyphs()` are computed eagerly (up to `gMaxEagerGlyphs` glyphs).
+/// Pairs involving other glyphs are queried from the font face on lookup, non-null offsets being memoized.
+/// In both cases, only non-null offsets are stored, so the table size is bounded by the font kerning data.
+/// Null pairs involving a non-eager glyph are queried from the face on each lookup.
+/// \note Offsets are in pixels, for the pixel size of the face when they are computed.
+/// \warning Lookups memoize, so a table must not be used from several threads at once.
+class KerningTable
+{
+public:
+    /// \brief Eager pairs are computed for each couple of glyphs, i.e. up to 512^2 (~260k) FreeType queries
+    /// when the limit is reached. Those are done once, when adding the glyphs (or never, when restored by `addPairs()`).
+    static constexpr std::size_t gMaxEagerGlyphs = 512;
+
+    /// \brief A stored kerning offset, as exported by `getPairs()`.
+    struct Pair
+    {
+        FT_UInt left;
+        FT_UInt right;
+        math::Vec<2, float> offset;
+    };
+
+    /// \brief A table without kerning: all lookups are null.
+    KerningTable() = default;
+
+    /// \brief An empty table for `aFontFace`, detecting up front if the face has no kerning.
+    explicit KerningTable(const FontFace & aFontFace);
+
+    bool hasKerning() const
+    { return mHasKerning; }
+
+    /// \brief Compute the kerning between `aGlyphIndices` and themselves, and with all previously added glyphs.
+    ///
+    /// This is quadratic: adding `n` glyphs to a table with `p` eager glyphs queries `n^2 + 2np` pairs from the face.
+    /// Glyphs beyond `gMaxEagerGlyphs` are not added, their pairs will be queried on lookup.
+    void addGlyphs(const FontFace & aFontFace, std::span<const FT_UInt> aGlyphIndices);
+
+    /// \brief Restore eager glyphs and pairs previously exported from a table,
+    /// without accessing the font face.
+    ///
+    /// The table is considered to have kerning as soon as `aPairs` is not empty.
+    void addPairs(std::span<const FT_UInt> aEagerGlyphs, std::span<const Pair> aPairs);
+
+    /// \brief Kerning offset between the glyphs at `aLeftGlyphIndex` and `aRightGlyphIndex`,
+    /// as returned by `FontFace::kern()`.
+    math::Vec<2, float> get(FT_UInt aLeftGlyphIndex,
+                            FT_UInt aRightGlyphIndex,
+                            const FontFace & aFontFace) const;
+
+    /// \brief Number of stored pairs (non-null eager offsets and non-null memoized lookups).
+    std::size_t size() const
+    { return mOffsetCount; }
+
+    /// \brief The glyphs whose pairs were computed eagerly, in unspecified order.
+    std::vector<FT_UInt> getEagerGlyphs() const;
+
+    /// \brief All stored pairs, in unspecified order.
+    std::vector<Pair> getPairs() const;
+
+private:
+    struct Entry
+    {
+        std::uint64_t key{gEmptyKey};
+        math::Vec<2, float> offset;
+    };
+
+    // Glyph indices are 32 bits, so no pair can have all 64 bits set.
+    static constexpr std::uint64_t gEmptyKey = std::numeric_limits<std::uint64_t>::max();
+
+    static std::uint64_t makeKey(FT_UInt aLeftGlyphIndex, FT_UInt aRightGlyphIndex)
+    { return (std::uint64_t{aLeftGlyphIndex} << 32) | aRightGlyphIndex; }
+
+    enum GlyphFlag : std::uint8_t
+    {
+        Eager = 1 << 0,
+        LeftOfPair = 1 << 1, // The glyph is on the left of at least one stored pair.
+    };
+
+    /// \brief Glyph indices are dense, so the glyphs flags are directly indexed.
+    bool hasFlag(FT_UInt aGlyphIndex, GlyphFlag aFlag) const
+    { return aGlyphIndex < mGlyphFlags.size() && (mGlyphFlags[aGlyphIndex] & aFlag); }
+
+    void setFlag(FT_UInt aGlyphIndex, GlyphFlag aFlag) const;
+
+    void addEagerGlyph(FT_UInt aGlyphIndex);
+
+    /// \brief The entry for `aKey`, or the empty entry where it would be inserted.
+    /// Null while the table is empty.
+    Entry * findEntry(std::uint64_t aKey) const;
+
+    /// \brief Query the offset from the face, and store it if it is not null.
+    math::Vec<2, float> memoize(FT_UInt aLeftGlyphIndex,
+                                FT_UInt aRightGlyphIndex,
+                                const FontFace & aFontFace) const;
+
+    /// \brief Store `aOffset` for `aKey`, replacing the offset already stored if any.
+    void storeOffset(std::uint64_t aKey, math::Vec<2, float> aOffset) const;
+
+    bool mHasKerning{false};
+    std::vector<FT_UInt> mEagerGlyphs;
+    mutable std::vector<std::uint8_t> mGlyphFlags; // Indexed by glyph index.
+    // Open addressing (linear probing), with a power of two size. Mutable to memoize lookups.
+    mutable std::vector<Entry> mOffsets;
+    mutable std::size_t mOffsetCount{0};
+    mutable int mHashShift{64};
+};
+
+
+//
+// Implementations
+//
+// The lookups are inline, as they are done for each pair of adjacent glyphs during layout.
+inline math::Vec<2, float> KerningTable::get(FT_UInt aLeftGlyphIndex,
+                                             FT_UInt aRightGlyphIndex,
+                                             const FontFace & aFontFace) const
+{
+    if (!mHasKerning)
+    {
+        return {0.f, 0.f};
+    }
+
+    const std::uint64_t key = makeKey(aLeftGlyphIndex, aRightGlyphIndex);
+    if (hasFlag(aLeftGlyphIndex, Eager) && hasFlag(aRightGlyphIndex, Eager))
+    {
+        // Eager pairs with a null offset are not stored, and most glyphs are not on the left of any pair.
+        if (hasFlag(aLeftGlyphIndex, LeftOfPair))
+        {
+            if (const Entry * entry = findEntry(key); entry->key == key)
+            {
+                return entry->offset;
+            }
+        }
+        return {0.f, 0.f};
+    }
+    else if (const Entry * entry = findEntry(key); entry != nullptr && entry->key == key)
+    {
+        return entry->offset;
+    }
+    else
+    {
+        return memoize(aLeftGlyphIndex, aRightGlyphIndex, aFontFace);
+    }
+}
+
+
+inline KerningTable::Entry * KerningTable::findEntry(std::uint64_t aKey) const
+{
+    if (mOffsets.empty())
+    {
+        return nullptr;
+    }
+    // Fibonacci hashing, the high bits of the product index the table.
+    for (std::size_t position = (aKey * 0x9E3779B97F4A7C15u) >> mHashShift;
+         ;
+         position = (position + 1) & (mOffsets.size() - 1))
+    {
+        Entry & entry = mOffsets[position];
+        if (entry.key == aKey || entry.key == gEmptyKey)
+        {
+            return &entry;
+        }
+    }
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,155 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace ad {
+namespace arte {
+
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const filesystem::path & aPath)
+{
+    HANDLE file = CreateFileW(aPath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error{"Cannot open file to map: " + aPath.string()};
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        throw std::runtime_error{"Cannot get the size of file to map: " + aPath.string()};
+    }
+    mSize = static_cast<std::size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped, they are represented by an empty span.
+    if (mSize != 0)
+    {
+        mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMapping != nullptr)
+        {
+            mData = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+    // The mapping keeps its own reference to the file.
+    CloseHandle(file);
+
+    if (mSize != 0 && mData == nullptr)
+    {
+        unmap();
+        throw std::runtime_error{"Cannot map file: " + aPath.string()};
+    }
+}
+
+
+void MappedFile::unmap()
+{
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping != nullptr)
+    {
+        CloseHandle(mMapping);
+    }
+    mData = nullptr;
+    mMapping = nullptr;
+    mSize = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const filesystem::path & aPath)
+{
+    int file = ::open(aPath.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+        throw std::runtime_error{"Cannot open file to map: " + aPath.string()};
+    }
+
+    struct stat status;
+    if (::fstat(file, &status) == -1)
+    {
+        ::close(file);
+        throw std::runtime_error{"Cannot get the size of file to map: " + aPath.string()};
+    }
+    mSize = static_cast<std::size_t>(status.st_size);
+
+    // Empty files cannot be mapped, they are represented by an empty span.
+    if (mSize != 0)
+    {
+        void * data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+        mData = (data == MAP_FAILED) ? nullptr : data;
+    }
+    // The mapping keeps its own reference to the file.
+    ::close(file);
+
+    if (mSize != 0 && mData == nullptr)
+    {
+        mSize = 0;
+        throw std::runtime_error{"Cannot map file: " + aPath.string()};
+    }
+}
+
+
+void MappedFile::unmap()
+{
+    if (mData != nullptr)
+    {
+        ::munmap(const_cast<void *>(mData), mSize);
+    }
+    mData = nullptr;
+    mSize = 0;
+}
+
+#endif
+
+
+MappedFile::MappedFile(MappedFile && aOther) noexcept :
+    mData{std::exchange(aOther.mData, nullptr)},
+    mSize{std::exchange(aOther.mSize, 0)}
+#if defined(_WIN32)
+    , mMapping{std::exchange(aOther.mMapping, nullptr)}
+#endif
+{}
+
+
+MappedFile & MappedFile::operator=(MappedFile && aOther) noexcept
+{
+    if (this != &aOther)
+    {
+        unmap();
+        mData = std::exchange(aOther.mData, nullptr);
+        mSize = std::exchange(aOther.mSize, 0);
+#if defined(_WIN32)
+        mMapping = std::exchange(aOther.mMapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,47 @@
+#pragma once
+
+
+#include <platform/Filesystem.h>
+
+#include <cstddef>
+#include <span>
+
+
+namespace ad {
+namespace arte {
+
+
+/// \brief Read-only memory mapping of a whole file.
+///
+/// The pages are loaded by the OS on first access, so mapping a large file is cheap
+/// when only parts of it are read.
+class MappedFile
+{
+public:
+    /// \throw std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const filesystem::path & aPath);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile && aOther) noexcept;
+    MappedFile & operator=(MappedFile && aOther) noexcept;
+
+    ~MappedFile();
+
+    std::span<const std::byte> data() const
+    { return {static_cast<const std::byte *>(mData), mSize}; }
+
+private:
+    void unmap();
+
+    const void * mData{nullptr};
+    std::size_t mSize{0};
+#if defined(_WIN32)
+    void * mMapping{nullptr}; // HANDLE of the file mapping object.
+#endif
+};
+
+
+} // namespace arte
+} // namespace ad
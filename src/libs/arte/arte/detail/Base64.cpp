@@ -0,0 +1,265 @@
+#include "Base64.h"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AD_ARTE_BASE64_X86
+#define AD_ARTE_TARGET(aIsa) __attribute__((target(aIsa)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define AD_ARTE_BASE64_X86
+#define AD_ARTE_TARGET(aIsa)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+namespace {
+
+    constexpr std::uint8_t gInvalid = 0xFF;
+
+    constexpr std::array<std::uint8_t, 256> gDecodingTable = []
+    {
+        std::array<std::uint8_t, 256> table{};
+        table.fill(gInvalid);
+        constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (std::uint8_t value = 0; value != alphabet.size(); ++value)
+        {
+            table[static_cast<unsigned char>(alphabet[value])] = value;
+        }
+        return table;
+    }();
+
+
+    [[noreturn]] void throwInvalid()
+    {
+        throw std::invalid_argument{"Invalid character in base64 data."};
+    }
+
+
+    std::uint32_t decodeCharacter(char aCharacter)
+    {
+        const std::uint8_t value = gDecodingTable[static_cast<unsigned char>(aCharacter)];
+        if (value == gInvalid)
+        {
+            throwInvalid();
+        }
+        return value;
+    }
+
+
+#if defined(AD_ARTE_BASE64_X86)
+
+    // Vectorized decoding after Wojciech Muła & Daniel Lemire, "Faster Base64 Encoding and Decoding
+    // Using AVX2 Instructions" (2018): characters are validated and translated with nibble lookups,
+    // then the 6-bit values are packed with multiply-adds.
+
+    bool detectAvx2()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int registers[4];
+        __cpuid(registers, 1);
+        const bool osSavesYmm = (registers[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(registers, 7, 0);
+        return osSavesYmm && (registers[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool detectSsse3()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int registers[4];
+        __cpuid(registers, 1);
+        return registers[2] & (1 << 9);
+#else
+        return __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    const bool gHasAvx2 = detectAvx2();
+    const bool gHasSsse3 = detectSsse3();
+
+
+    /// @brief Decode 32 characters into 24 bytes, writing 32 bytes.
+    /// @return false if a character is not in the alphabet.
+    AD_ARTE_TARGET("avx2")
+    bool decodeBlockAvx2(const char * aInput, std::byte * aOutput)
+    {
+        const __m256i lutLow = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i lutHigh = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lutRoll = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i mask2F = _mm256_set1_epi8(0x2F);
+
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(aInput));
+        const __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask2F);
+        const __m256i lowNibbles = _mm256_and_si256(input, mask2F);
+        const __m256i high = _mm256_shuffle_epi8(lutHigh, highNibbles);
+        const __m256i low = _mm256_shuffle_epi8(lutLow, lowNibbles);
+        const __m256i valid = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+        if (_mm256_movemask_epi8(valid) != -1)
+        {
+            return false;
+        }
+
+        const __m256i isSlash = _mm256_cmpeq_epi8(input, mask2F);
+        const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(isSlash, highNibbles));
+        const __m256i values = _mm256_add_epi8(input, roll);
+
+        const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(aOutput), packed);
+        return true;
+    }
+
+
+    /// @brief Decode 16 characters into 12 bytes, writing 16 bytes.
+    /// @return false if a character is not in the alphabet.
+    AD_ARTE_TARGET("ssse3")
+    bool decodeBlockSsse3(const char * aInput, std::byte * aOutput)
+    {
+        const __m128i lutLow = _mm_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i lutHigh = _mm_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i mask2F = _mm_set1_epi8(0x2F);
+
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aInput));
+        const __m128i highNibbles = _mm_and_si128(_mm_srli_epi32(input, 4), mask2F);
+        const __m128i lowNibbles = _mm_and_si128(input, mask2F);
+        const __m128i high = _mm_shuffle_epi8(lutHigh, highNibbles);
+        const __m128i low = _mm_shuffle_epi8(lutLow, lowNibbles);
+        const __m128i valid = _mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128());
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+        {
+            return false;
+        }
+
+        const __m128i isSlash = _mm_cmpeq_epi8(input, mask2F);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(isSlash, highNibbles));
+        const __m128i values = _mm_add_epi8(input, roll);
+
+        const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(aOutput), packed);
+        return true;
+    }
+
+#endif // AD_ARTE_BASE64_X86
+
+} // anonymous namespace
+
+
+std::size_t getDecodedSize(std::string_view aBase64)
+{
+    std::size_t length = aBase64.size();
+    for (int padding = 0; padding != 2 && length != 0 && aBase64[length - 1] == '='; ++padding)
+    {
+        --length;
+    }
+    return (length / 4) * 3 + ((length % 4 == 0) ? 0 : length % 4 - 1);
+}
+
+
+std::size_t decodeBase64(std::string_view aBase64, std::span<std::byte> aOutput)
+{
+    std::size_t length = aBase64.size();
+    for (int padding = 0; padding != 2 && length != 0 && aBase64[length - 1] == '='; ++padding)
+    {
+        --length;
+    }
+    if (length % 4 == 1)
+    {
+        throw std::invalid_argument{"Truncated base64 data."};
+    }
+    const std::size_t decodedSize = getDecodedSize(aBase64);
+    if (aOutput.size() < decodedSize)
+    {
+        throw std::invalid_argument{"Output is too small for the decoded base64 data, "
+                                    + std::to_string(decodedSize) + " bytes are required."};
+    }
+
+    const char * input = aBase64.data();
+    const char * const inputEnd = input + length;
+    std::byte * output = aOutput.data();
+    std::byte * const outputEnd = aOutput.data() + aOutput.size();
+
+#if defined(AD_ARTE_BASE64_X86)
+    // Blocks store more bytes than they decode, they stop before overflowing the output.
+    if (gHasAvx2)
+    {
+        while (inputEnd - input >= 32 && outputEnd - output >= 32)
+        {
+            if (!decodeBlockAvx2(input, output))
+            {
+                throwInvalid();
+            }
+            input += 32;
+            output += 24;
+        }
+    }
+    if (gHasSsse3)
+    {
+        while (inputEnd - input >= 16 && outputEnd - output >= 16)
+        {
+            if (!decodeBlockSsse3(input, output))
+            {
+                throwInvalid();
+            }
+            input += 16;
+            output += 12;
+        }
+    }
+#endif
+
+    for (; inputEnd - input >= 4; input += 4, output += 3)
+    {
+        const std::uint32_t packed = (decodeCharacter(input[0]) << 18)
+                                   | (decodeCharacter(input[1]) << 12)
+                                   | (decodeCharacter(input[2]) << 6)
+                                   | decodeCharacter(input[3]);
+        output[0] = static_cast<std::byte>(packed >> 16);
+        output[1] = static_cast<std::byte>(packed >> 8);
+        output[2] = static_cast<std::byte>(packed);
+    }
+
+    // Final 2 or 3 characters, encoding 1 or 2 bytes.
+    if (const std::ptrdiff_t remaining = inputEnd - input; remaining >= 2)
+    {
+        std::uint32_t packed = (decodeCharacter(input[0]) << 18) | (decodeCharacter(input[1]) << 12);
+        *output++ = static_cast<std::byte>(packed >> 16);
+        if (remaining == 3)
+        {
+            packed |= decodeCharacter(input[2]) << 6;
+            *output++ = static_cast<std::byte>(packed >> 8);
+        }
+    }
+
+    return static_cast<std::size_t>(output - aOutput.data());
+}
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
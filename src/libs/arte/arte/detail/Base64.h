@@ -0,0 +1,29 @@
+#pragma once
+
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+/// @brief Number of bytes encoded by the base64 string, accounting for padding.
+std::size_t getDecodedSize(std::string_view aBase64);
+
+
+/// @brief Decode standard base64 (RFC 4648, with optional padding) into aOutput.
+///
+/// Uses AVX2 or SSSE3 when the CPU supports it (detected at runtime), with a scalar fallback.
+/// @param aOutput Must be at least `getDecodedSize(aBase64)` bytes.
+/// @return The number of bytes written.
+/// @throw std::invalid_argument on characters outside of the base64 alphabet (including whitespace).
+std::size_t decodeBase64(std::string_view aBase64, std::span<std::byte> aOutput);
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,75 @@
+#pragma once
+
+
+#include <cstddef>
+#include <istream>
+#include <span>
+#include <streambuf>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+/// @brief Read-only stream buffer over existing memory, which is not copied.
+///
+/// Supports seeking, as required by the image decoders.
+class MemoryStreambuf : public std::streambuf
+{
+public:
+    explicit MemoryStreambuf(std::span<const std::byte> aData)
+    {
+        // std::streambuf only deals with mutable pointers, but the get area is never written to.
+        char * begin = const_cast<char *>(reinterpret_cast<const char *>(aData.data()));
+        setg(begin, begin, begin + aData.size());
+    }
+
+protected:
+    pos_type seekoff(off_type aOffset,
+                     std::ios_base::seekdir aDirection,
+                     std::ios_base::openmode aMode = std::ios_base::in) override
+    {
+        if ((aMode & std::ios_base::in) == 0)
+        {
+            return pos_type(off_type(-1));
+        }
+
+        char * reference = (aDirection == std::ios_base::beg) ? eback()
+                         : (aDirection == std::ios_base::cur) ? gptr()
+                         : egptr();
+        const off_type target = (reference - eback()) + aOffset;
+        if (target < 0 || target > egptr() - eback())
+        {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + target, egptr());
+        return pos_type(target);
+    }
+
+    pos_type seekpos(pos_type aPosition, std::ios_base::openmode aMode = std::ios_base::in) override
+    {
+        return seekoff(off_type(aPosition), std::ios_base::beg, aMode);
+    }
+};
+
+
+/// @brief Input stream reading from memory, e.g. to decode images embedded in glTF buffers.
+class MemoryIstream : public std::istream
+{
+public:
+    explicit MemoryIstream(std::span<const std::byte> aData) :
+        std::istream{nullptr},
+        mBuffer{aData}
+    {
+        rdbuf(&mBuffer);
+    }
+
+private:
+    MemoryStreambuf mBuffer;
+};
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
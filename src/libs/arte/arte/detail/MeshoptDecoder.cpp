@@ -0,0 +1,1000 @@
+#include "MeshoptDecoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AD_ARTE_MESHOPT_X86
+#define AD_ARTE_TARGET(aIsa) __attribute__((target(aIsa)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define AD_ARTE_MESHOPT_X86
+#define AD_ARTE_TARGET(aIsa)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+namespace {
+
+    constexpr std::uint8_t gVertexHeader = 0xa0;
+    constexpr std::uint8_t gTriangleHeader = 0xe0;
+    constexpr std::uint8_t gSequenceHeader = 0xd0;
+
+    // Vertex codec
+    constexpr std::size_t gByteGroupSize = 16;
+    // The vectorized group decoding reads up to this many bytes (packed selectors and up to 16 sentinels).
+    constexpr std::size_t gByteGroupDecodeLimit = 24;
+    constexpr std::size_t gVertexBlockSizeBytes = 8192;
+    constexpr std::size_t gVertexBlockMaxSize = 256;
+    constexpr std::size_t gTailMinSize = 32;
+    constexpr std::size_t gMaxVertexStride = 256;
+
+    // Index codec, the codeaux table closes the stream.
+    constexpr std::size_t gCodeAuxTableSize = 16;
+    // Index sequence codec, the stream is closed by a padding tail.
+    constexpr std::size_t gSequenceTailSize = 4;
+
+
+    [[noreturn]] void throwMalformed(const char * aStream)
+    {
+        throw std::invalid_argument{std::string{"Malformed meshopt "} + aStream + " stream."};
+    }
+
+
+    std::uint8_t readByte(const std::byte * aAddress)
+    {
+        return std::to_integer<std::uint8_t>(*aAddress);
+    }
+
+
+    //
+    // Vertex codec
+    //
+
+    /// @brief Decode a group of 16 bytes, each encoded on N_bits, values saturating the bits
+    /// being escapes to a full byte stored after the packed selectors.
+    template <unsigned int N_bits>
+    const std::byte * decodeBitsGroupScalar(const std::byte * aData, const std::byte * aEnd, std::uint8_t * aOutput)
+    {
+        constexpr std::size_t packedSize = gByteGroupSize * N_bits / 8;
+        constexpr unsigned int escape = (1u << N_bits) - 1;
+
+        if (static_cast<std::size_t>(aEnd - aData) < packedSize)
+        {
+            throwMalformed("vertex");
+        }
+
+        const std::byte * sentinels = aData + packedSize;
+        for (std::size_t value = 0; value != gByteGroupSize; ++value)
+        {
+            // Values are packed from the most significant bits.
+            const unsigned int packed = readByte(aData + value * N_bits / 8);
+            const unsigned int selector = (packed >> (8 - N_bits - (value * N_bits) % 8)) & escape;
+            if (selector == escape)
+            {
+                if (sentinels == aEnd)
+                {
+                    throwMalformed("vertex");
+                }
+                aOutput[value] = readByte(sentinels++);
+            }
+            else
+            {
+                aOutput[value] = static_cast<std::uint8_t>(selector);
+            }
+        }
+        return sentinels;
+    }
+
+
+    const std::byte * decodeBytesGroupScalar(const std::byte * aData,
+                                             const std::byte * aEnd,
+                                             std::uint8_t * aOutput,
+                                             unsigned int aMode)
+    {
+        switch(aMode)
+        {
+            case 0:
+                std::fill_n(aOutput, gByteGroupSize, std::uint8_t{0});
+                return aData;
+            case 1:
+                return decodeBitsGroupScalar<2>(aData, aEnd, aOutput);
+            case 2:
+                return decodeBitsGroupScalar<4>(aData, aEnd, aOutput);
+            default:
+                if (static_cast<std::size_t>(aEnd - aData) < gByteGroupSize)
+                {
+                    throwMalformed("vertex");
+                }
+                std::memcpy(aOutput, aData, gByteGroupSize);
+                return aData + gByteGroupSize;
+        }
+    }
+
+
+    /// @brief Add the 4 bytes packed in each operand independently (without carry between bytes).
+    std::uint32_t addBytes(std::uint32_t aLeft, std::uint32_t aRight)
+    {
+        constexpr std::uint32_t highBits = 0x80808080u;
+        return ((aLeft & ~highBits) + (aRight & ~highBits)) ^ ((aLeft ^ aRight) & highBits);
+    }
+
+
+    using DeltaChannels = std::array<std::array<std::uint8_t, gVertexBlockMaxSize>, 4>;
+
+    /// @brief Reconstruct 4 consecutive bytes of each vertex of a block, from their zigzag encoded deltas.
+    /// @param aLast The 4 bytes of the previous vertex, updated to the bytes of the last vertex of the block.
+    void accumulateDeltas(const DeltaChannels & aDeltas,
+                          std::size_t aCount,
+                          std::uint8_t * aLast,
+                          std::byte * aOutput,
+                          std::size_t aStride)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, aLast, sizeof(value));
+        for (std::size_t vertex = 0; vertex != aCount; ++vertex)
+        {
+            std::array<std::uint8_t, 4> packed;
+            for (std::size_t channel = 0; channel != 4; ++channel)
+            {
+                const std::uint8_t delta = aDeltas[channel][vertex];
+                packed[channel] = static_cast<std::uint8_t>((delta >> 1) ^ (0u - (delta & 1)));
+            }
+            std::uint32_t delta;
+            std::memcpy(&delta, packed.data(), sizeof(delta));
+            value = addBytes(value, delta);
+            std::memcpy(aOutput + vertex * aStride, &value, sizeof(value));
+        }
+        std::memcpy(aLast, &value, sizeof(value));
+    }
+
+
+#if defined(AD_ARTE_MESHOPT_X86)
+
+    bool detectSsse3()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int registers[4];
+        __cpuid(registers, 1);
+        return registers[2] & (1 << 9);
+#else
+        return __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    const bool gHasSsse3 = detectSsse3();
+
+
+    /// @brief For each mask of 8 escaped values, the shuffle gathering consecutive sentinels
+    /// into the escaped positions, and the count of sentinels consumed.
+    struct SentinelShuffles
+    {
+        std::array<std::array<std::uint8_t, 8>, 256> shuffles;
+        std::array<std::uint8_t, 256> counts;
+    };
+
+    constexpr SentinelShuffles makeSentinelShuffles()
+    {
+        SentinelShuffles result{};
+        for (unsigned int mask = 0; mask != 256; ++mask)
+        {
+            std::uint8_t count = 0;
+            for (unsigned int bit = 0; bit != 8; ++bit)
+            {
+                // Setting the high bit of a shuffle index zeroes the byte.
+                result.shuffles[mask][bit] = (mask & (1u << bit)) ? count++ : 0x80;
+            }
+            result.counts[mask] = count;
+        }
+        return result;
+    }
+
+    constexpr SentinelShuffles gSentinelShuffles = makeSentinelShuffles();
+
+
+    /// @brief Replace the escaped selectors with the successive sentinel bytes.
+    /// @return The number of sentinels consumed.
+    AD_ARTE_TARGET("ssse3")
+    std::size_t substituteSentinels(__m128i & aSelectors, __m128i aEscape, const std::byte * aSentinels)
+    {
+        const __m128i escaped = _mm_cmpeq_epi8(aSelectors, aEscape);
+        const int mask = _mm_movemask_epi8(escaped);
+        const unsigned int lowMask = mask & 0xff;
+        const unsigned int highMask = (mask >> 8) & 0xff;
+
+        const __m128i lowShuffle = _mm_loadl_epi64(
+            reinterpret_cast<const __m128i *>(gSentinelShuffles.shuffles[lowMask].data()));
+        // The high half continues with the sentinels following those consumed by the low half.
+        const __m128i highShuffle = _mm_add_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(gSentinelShuffles.shuffles[highMask].data())),
+            _mm_set1_epi8(static_cast<char>(gSentinelShuffles.counts[lowMask])));
+        const __m128i shuffle = _mm_unpacklo_epi64(lowShuffle, highShuffle);
+
+        const __m128i sentinels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aSentinels));
+        aSelectors = _mm_or_si128(_mm_shuffle_epi8(sentinels, shuffle), _mm_andnot_si128(escaped, aSelectors));
+        return gSentinelShuffles.counts[lowMask] + gSentinelShuffles.counts[highMask];
+    }
+
+
+    /// @brief Vectorized equivalent of decodeBytesGroupScalar().
+    /// @note Reads up to gByteGroupDecodeLimit bytes from aData.
+    AD_ARTE_TARGET("ssse3")
+    const std::byte * decodeBytesGroupSsse3(const std::byte * aData, std::uint8_t * aOutput, unsigned int aMode)
+    {
+        __m128i * output = reinterpret_cast<__m128i *>(aOutput);
+        switch(aMode)
+        {
+            case 0:
+            {
+                _mm_storeu_si128(output, _mm_setzero_si128());
+                return aData;
+            }
+            case 1:
+            {
+                std::uint32_t packed;
+                std::memcpy(&packed, aData, sizeof(packed));
+                // Spread the 2-bit selectors to one byte each, most significant bits first.
+                const __m128i selectors2 = _mm_cvtsi32_si128(static_cast<int>(packed));
+                const __m128i selectors4 = _mm_unpacklo_epi8(_mm_srli_epi16(selectors2, 4), selectors2);
+                const __m128i selectors8 = _mm_unpacklo_epi8(_mm_srli_epi16(selectors4, 2), selectors4);
+                const __m128i escape = _mm_set1_epi8(3);
+                __m128i values = _mm_and_si128(selectors8, escape);
+                const std::size_t consumed = substituteSentinels(values, escape, aData + 4);
+                _mm_storeu_si128(output, values);
+                return aData + 4 + consumed;
+            }
+            case 2:
+            {
+                const __m128i selectors4 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(aData));
+                const __m128i selectors8 = _mm_unpacklo_epi8(_mm_srli_epi16(selectors4, 4), selectors4);
+                const __m128i escape = _mm_set1_epi8(15);
+                __m128i values = _mm_and_si128(selectors8, escape);
+                const std::size_t consumed = substituteSentinels(values, escape, aData + 8);
+                _mm_storeu_si128(output, values);
+                return aData + 8 + consumed;
+            }
+            default:
+            {
+                _mm_storeu_si128(output, _mm_loadu_si128(reinterpret_cast<const __m128i *>(aData)));
+                return aData + gByteGroupSize;
+            }
+        }
+    }
+
+    /// @brief Decode the groups with decodeBytesGroupSsse3() while enough bytes remain readable.
+    /// @param aGroup The first group to decode, updated to the first group left undecoded.
+    AD_ARTE_TARGET("ssse3")
+    const std::byte * decodeBytesGroupsSsse3(const std::byte * aData,
+                                             const std::byte * aEnd,
+                                             const std::byte * aHeader,
+                                             std::uint8_t * aOutput,
+                                             std::size_t aGroupCount,
+                                             std::size_t & aGroup)
+    {
+        for (; aGroup != aGroupCount && static_cast<std::size_t>(aEnd - aData) >= gByteGroupDecodeLimit; ++aGroup)
+        {
+            const unsigned int mode = (readByte(aHeader + aGroup / 4) >> ((aGroup % 4) * 2)) & 3;
+            aData = decodeBytesGroupSsse3(aData, aOutput + aGroup * gByteGroupSize, mode);
+        }
+        return aData;
+    }
+
+
+    AD_ARTE_TARGET("ssse3")
+    __m128i unzigzag8(__m128i aValues)
+    {
+        const __m128i shifted = _mm_and_si128(_mm_srli_epi16(aValues, 1), _mm_set1_epi8(0x7f));
+        const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(aValues, _mm_set1_epi8(1)));
+        return _mm_xor_si128(shifted, sign);
+    }
+
+
+    /// @brief Vectorized equivalent of accumulateDeltas().
+    ///
+    /// The 4 channels of 16 vertices are transposed to 4 vertices per register,
+    /// where a prefix sum accumulates the deltas.
+    AD_ARTE_TARGET("ssse3")
+    void accumulateDeltasSsse3(const DeltaChannels & aDeltas,
+                               std::size_t aCount,
+                               std::uint8_t * aLast,
+                               std::byte * aOutput,
+                               std::size_t aStride)
+    {
+        std::uint32_t lastValue;
+        std::memcpy(&lastValue, aLast, sizeof(lastValue));
+        __m128i last = _mm_set1_epi32(static_cast<int>(lastValue));
+
+        for (std::size_t first = 0; first < aCount; first += gByteGroupSize)
+        {
+            auto load = [&](std::size_t aChannel)
+            {
+                return unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(aDeltas[aChannel].data() + first)));
+            };
+            const __m128i channel0 = load(0);
+            const __m128i channel1 = load(1);
+            const __m128i channel2 = load(2);
+            const __m128i channel3 = load(3);
+
+            const __m128i low01 = _mm_unpacklo_epi8(channel0, channel1);
+            const __m128i high01 = _mm_unpackhi_epi8(channel0, channel1);
+            const __m128i low23 = _mm_unpacklo_epi8(channel2, channel3);
+            const __m128i high23 = _mm_unpackhi_epi8(channel2, channel3);
+            const __m128i vertices[4]{
+                _mm_unpacklo_epi16(low01, low23),
+                _mm_unpackhi_epi16(low01, low23),
+                _mm_unpacklo_epi16(high01, high23),
+                _mm_unpackhi_epi16(high01, high23),
+            };
+
+            for (std::size_t quad = 0; quad != 4; ++quad)
+            {
+                const std::size_t vertex = first + quad * 4;
+                if (vertex >= aCount)
+                {
+                    break;
+                }
+
+                __m128i values = vertices[quad];
+                values = _mm_add_epi8(values, _mm_slli_si128(values, 4));
+                values = _mm_add_epi8(values, _mm_slli_si128(values, 8));
+                values = _mm_add_epi8(values, last);
+                last = _mm_shuffle_epi32(values, 0xff);
+
+                if (aStride == 4 && vertex + 4 <= aCount)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(aOutput + vertex * 4), values);
+                }
+                else
+                {
+                    std::array<std::uint32_t, 4> stored;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(stored.data()), values);
+                    for (std::size_t offset = 0; offset != std::min<std::size_t>(4, aCount - vertex); ++offset)
+                    {
+                        std::memcpy(aOutput + (vertex + offset) * aStride, &stored[offset], sizeof(std::uint32_t));
+                    }
+                }
+            }
+        }
+
+        // When the block does not end on a full quad, the last vertex is not in the broadcast lane.
+        std::memcpy(aLast, aOutput + (aCount - 1) * aStride, sizeof(lastValue));
+    }
+
+#endif // AD_ARTE_MESHOPT_X86
+
+
+    /// @brief Decode the zigzag deltas of one byte of the vertex, for all vertices of a block.
+    /// @param aAlignedCount The count of vertices in the block, rounded up to a multiple of the group size.
+    const std::byte * decodeBytes(const std::byte * aData,
+                                  const std::byte * aEnd,
+                                  std::uint8_t * aOutput,
+                                  std::size_t aAlignedCount)
+    {
+        const std::size_t groupCount = aAlignedCount / gByteGroupSize;
+        // Two bits of mode per group.
+        const std::size_t headerSize = (groupCount + 3) / 4;
+        if (static_cast<std::size_t>(aEnd - aData) < headerSize)
+        {
+            throwMalformed("vertex");
+        }
+
+        const std::byte * header = aData;
+        aData += headerSize;
+        std::size_t group = 0;
+#if defined(AD_ARTE_MESHOPT_X86)
+        if (gHasSsse3)
+        {
+            aData = decodeBytesGroupsSsse3(aData, aEnd, header, aOutput, groupCount, group);
+        }
+#endif
+        // Scalar decoding of the remaining groups, which might be too close to the end for the vectorized decoding.
+        for (; group != groupCount; ++group)
+        {
+            const unsigned int mode = (readByte(header + group / 4) >> ((group % 4) * 2)) & 3;
+            aData = decodeBytesGroupScalar(aData, aEnd, aOutput + group * gByteGroupSize, mode);
+        }
+        return aData;
+    }
+
+
+    std::size_t getVertexBlockSize(std::size_t aStride)
+    {
+        return std::min((gVertexBlockSizeBytes / aStride) & ~(gByteGroupSize - 1), gVertexBlockMaxSize);
+    }
+
+
+    //
+    // Index codecs
+    //
+    std::uint32_t decodeVByte(const std::byte *& aData)
+    {
+        const std::uint32_t lead = readByte(aData++);
+        if (lead < 128)
+        {
+            return lead;
+        }
+
+        // Varint, 7 bits per byte, least significant group first.
+        std::uint32_t result = lead & 127;
+        for (unsigned int shift = 7; shift != 35; shift += 7)
+        {
+            const std::uint32_t group = readByte(aData++);
+            result |= (group & 127) << shift;
+            if (group < 128)
+            {
+                break;
+            }
+        }
+        return result;
+    }
+
+
+    std::uint32_t unzigzag(std::uint32_t aValue)
+    {
+        return (aValue >> 1) ^ (0u - (aValue & 1));
+    }
+
+
+    void writeIndex(std::byte * aOutput, std::size_t aPosition, std::size_t aIndexSize, std::uint32_t aIndex)
+    {
+        if (aIndexSize == 2)
+        {
+            const auto index = static_cast<std::uint16_t>(aIndex);
+            std::memcpy(aOutput + aPosition * 2, &index, sizeof(index));
+        }
+        else
+        {
+            std::memcpy(aOutput + aPosition * 4, &aIndex, sizeof(aIndex));
+        }
+    }
+
+
+    void checkIndexArguments(std::size_t aCount, std::size_t aIndexSize, std::span<std::byte> aOutput)
+    {
+        if (aIndexSize != 2 && aIndexSize != 4)
+        {
+            throw std::invalid_argument{"Meshopt indices must be 2 or 4 bytes, not "
+                                        + std::to_string(aIndexSize) + "."};
+        }
+        if (aOutput.size() < aCount * aIndexSize)
+        {
+            throw std::invalid_argument{"Output is too small for the decoded meshopt indices."};
+        }
+    }
+
+
+    /// @brief The last 16 decoded vertices (the most recent being just before the offset).
+    struct VertexFifo
+    {
+        std::uint32_t operator[](std::size_t aDistance) const
+        { return entries[(offset - aDistance) & 15]; }
+
+        void push(std::uint32_t aVertex, bool aCondition = true)
+        {
+            entries[offset] = aVertex;
+            offset = (offset + aCondition) & 15;
+        }
+
+        std::array<std::uint32_t, 16> entries;
+        std::size_t offset{0};
+    };
+
+
+    /// @brief The last 16 edges of decoded triangles.
+    struct EdgeFifo
+    {
+        const std::array<std::uint32_t, 2> & operator[](std::size_t aDistance) const
+        { return entries[(offset - aDistance) & 15]; }
+
+        void push(std::uint32_t aFirst, std::uint32_t aSecond)
+        {
+            entries[offset] = {aFirst, aSecond};
+            offset = (offset + 1) & 15;
+        }
+
+        std::array<std::array<std::uint32_t, 2>, 16> entries;
+        std::size_t offset{0};
+    };
+
+
+    //
+    // Filters
+    //
+
+    /// @brief Round to nearest, away from zero on ties.
+    /// @note Unlike std::lround, it is not a library call and does not prevent vectorization.
+    int roundToInt(float aValue)
+    {
+        return static_cast<int>(aValue + (aValue >= 0.f ? 0.5f : -0.5f));
+    }
+
+
+#if defined(AD_ARTE_MESHOPT_X86)
+
+    AD_ARTE_TARGET("ssse3")
+    __m128i roundScaled(__m128 aValue, __m128 aScale)
+    {
+        const __m128 scaled = _mm_mul_ps(aValue, aScale);
+        const __m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(scaled, _mm_set1_ps(-0.f)));
+        return _mm_cvttps_epi32(_mm_add_ps(scaled, half));
+    }
+
+
+    /// @brief Vectorized equivalent of the scalar octahedral decoding (with the same results),
+    /// for 4 elements with their components sign extended to 32 bits.
+    AD_ARTE_TARGET("ssse3")
+    void decodeOctahedralSsse3(__m128i & aX, __m128i & aY, __m128i & aZ, float aMax)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.f);
+        __m128 x = _mm_cvtepi32_ps(aX);
+        __m128 y = _mm_cvtepi32_ps(aY);
+        const __m128 z = _mm_sub_ps(_mm_sub_ps(_mm_cvtepi32_ps(aZ), _mm_andnot_ps(signMask, x)),
+                                    _mm_andnot_ps(signMask, y));
+
+        const __m128 t = _mm_min_ps(z, _mm_setzero_ps());
+        x = _mm_add_ps(x, _mm_xor_ps(t, _mm_and_ps(x, signMask)));
+        y = _mm_add_ps(y, _mm_xor_ps(t, _mm_and_ps(y, signMask)));
+
+        const __m128 squaredLength =
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        const __m128 scale = _mm_div_ps(_mm_set1_ps(aMax), _mm_sqrt_ps(squaredLength));
+        aX = roundScaled(x, scale);
+        aY = roundScaled(y, scale);
+        aZ = roundScaled(z, scale);
+    }
+
+
+    /// @return The number of elements filtered, a multiple of 4.
+    AD_ARTE_TARGET("ssse3")
+    std::size_t applyOctahedralSsse3(std::int8_t * aData, std::size_t aCount)
+    {
+        const __m128i byteMask = _mm_set1_epi32(0xff);
+        std::size_t element = 0;
+        for (; element + 4 <= aCount; element += 4)
+        {
+            auto * address = reinterpret_cast<__m128i *>(aData + element * 4);
+            const __m128i packed = _mm_loadu_si128(address);
+            __m128i x = _mm_srai_epi32(_mm_slli_epi32(packed, 24), 24);
+            __m128i y = _mm_srai_epi32(_mm_slli_epi32(packed, 16), 24);
+            __m128i z = _mm_srai_epi32(_mm_slli_epi32(packed, 8), 24);
+            decodeOctahedralSsse3(x, y, z, 127.f);
+
+            // The fourth component is preserved.
+            __m128i result = _mm_andnot_si128(_mm_set1_epi32(0x00ffffff), packed);
+            result = _mm_or_si128(result, _mm_and_si128(x, byteMask));
+            result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(y, byteMask), 8));
+            result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(z, byteMask), 16));
+            _mm_storeu_si128(address, result);
+        }
+        return element;
+    }
+
+
+    /// @return The number of elements filtered, a multiple of 4.
+    AD_ARTE_TARGET("ssse3")
+    std::size_t applyOctahedralSsse3(std::int16_t * aData, std::size_t aCount)
+    {
+        const __m128i shortMask = _mm_set1_epi32(0xffff);
+        std::size_t element = 0;
+        for (; element + 4 <= aCount; element += 4)
+        {
+            auto * address = reinterpret_cast<__m128i *>(aData + element * 4);
+            const __m128 first = _mm_castsi128_ps(_mm_loadu_si128(address));
+            const __m128 second = _mm_castsi128_ps(_mm_loadu_si128(address + 1));
+            // Gather the (x, y) and (z, w) pairs of the 4 elements.
+            const __m128i xy = _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i zw = _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+            __m128i x = _mm_srai_epi32(_mm_slli_epi32(xy, 16), 16);
+            __m128i y = _mm_srai_epi32(xy, 16);
+            __m128i z = _mm_srai_epi32(_mm_slli_epi32(zw, 16), 16);
+            decodeOctahedralSsse3(x, y, z, 32767.f);
+
+            const __m128i resultXy = _mm_or_si128(_mm_and_si128(x, shortMask), _mm_slli_epi32(y, 16));
+            // The fourth component is preserved.
+            const __m128i resultZw = _mm_or_si128(_mm_and_si128(z, shortMask), _mm_andnot_si128(shortMask, zw));
+            _mm_storeu_si128(address, _mm_unpacklo_epi32(resultXy, resultZw));
+            _mm_storeu_si128(address + 1, _mm_unpackhi_epi32(resultXy, resultZw));
+        }
+        return element;
+    }
+
+#endif // AD_ARTE_MESHOPT_X86
+
+
+    template <class T_component>
+    void applyOctahedral(T_component * aData, std::size_t aCount)
+    {
+        constexpr float max = static_cast<float>((1 << (sizeof(T_component) * 8 - 1)) - 1);
+
+        std::size_t first = 0;
+#if defined(AD_ARTE_MESHOPT_X86)
+        if (gHasSsse3)
+        {
+            first = applyOctahedralSsse3(aData, aCount);
+        }
+#endif
+
+        for (std::size_t element = first; element != aCount; ++element)
+        {
+            T_component * components = aData + element * 4;
+            // The third component encodes 1.f at the same scale as x and y.
+            float x = components[0];
+            float y = components[1];
+            const float z = components[2] - std::abs(x) - std::abs(y);
+
+            // Unfold the lower hemisphere.
+            const float t = std::min(z, 0.f);
+            x += (x >= 0.f) ? t : -t;
+            y += (y >= 0.f) ? t : -t;
+
+            const float scale = max / std::sqrt(x * x + y * y + z * z);
+            components[0] = static_cast<T_component>(roundToInt(x * scale));
+            components[1] = static_cast<T_component>(roundToInt(y * scale));
+            components[2] = static_cast<T_component>(roundToInt(z * scale));
+        }
+    }
+
+} // anonymous namespace
+
+
+void decodeMeshoptVertices(std::span<const std::byte> aEncoded,
+                           std::size_t aCount,
+                           std::size_t aStride,
+                           std::span<std::byte> aOutput)
+{
+    if (aStride == 0 || aStride % 4 != 0 || aStride > gMaxVertexStride)
+    {
+        throw std::invalid_argument{"Meshopt vertex stride must be a multiple of 4 up to 256, not "
+                                    + std::to_string(aStride) + "."};
+    }
+    if (aOutput.size() < aCount * aStride)
+    {
+        throw std::invalid_argument{"Output is too small for the decoded meshopt vertices."};
+    }
+
+    // The stream ends with a tail, padded to a minimal size, storing the initial value of each byte.
+    const std::size_t tailSize = std::max(aStride, gTailMinSize);
+    if (aEncoded.size() < 1 + tailSize)
+    {
+        throwMalformed("vertex");
+    }
+    if ((readByte(aEncoded.data()) & 0xf0) != gVertexHeader)
+    {
+        throwMalformed("vertex");
+    }
+    if (const unsigned int version = readByte(aEncoded.data()) & 0x0f; version != 0)
+    {
+        throw std::invalid_argument{"Unsupported meshopt vertex codec version " + std::to_string(version) + "."};
+    }
+
+    const std::byte * data = aEncoded.data() + 1;
+    const std::byte * const end = aEncoded.data() + aEncoded.size();
+    const std::byte * const blocksEnd = end - tailSize;
+
+    std::array<std::uint8_t, gMaxVertexStride> lastVertex;
+    std::memcpy(lastVertex.data(), end - aStride, aStride);
+
+    // The deltas of 4 consecutive bytes of the vertex, so they are accumulated and written together.
+    DeltaChannels deltas;
+    const std::size_t blockSize = getVertexBlockSize(aStride);
+    for (std::size_t first = 0; first < aCount; first += blockSize)
+    {
+        const std::size_t count = std::min(blockSize, aCount - first);
+        const std::size_t alignedCount = (count + gByteGroupSize - 1) & ~(gByteGroupSize - 1);
+        std::byte * block = aOutput.data() + first * aStride;
+
+        // Each byte of the vertex is stored as a separate stream, zigzag delta encoded from the previous vertex.
+        for (std::size_t byte = 0; byte != aStride; byte += 4)
+        {
+            for (std::array<std::uint8_t, gVertexBlockMaxSize> & channel : deltas)
+            {
+                data = decodeBytes(data, blocksEnd, channel.data(), alignedCount);
+            }
+
+#if defined(AD_ARTE_MESHOPT_X86)
+            if (gHasSsse3)
+            {
+                accumulateDeltasSsse3(deltas, count, lastVertex.data() + byte, block + byte, aStride);
+                continue;
+            }
+#endif
+            accumulateDeltas(deltas, count, lastVertex.data() + byte, block + byte, aStride);
+        }
+    }
+
+    if (data != blocksEnd)
+    {
+        throwMalformed("vertex");
+    }
+}
+
+
+void decodeMeshoptTriangles(std::span<const std::byte> aEncoded,
+                            std::size_t aCount,
+                            std::size_t aIndexSize,
+                            std::span<std::byte> aOutput)
+{
+    checkIndexArguments(aCount, aIndexSize, aOutput);
+    if (aCount % 3 != 0)
+    {
+        throw std::invalid_argument{"Meshopt triangles index count must be a multiple of 3."};
+    }
+
+    // Header, one code per triangle, and the codeaux table.
+    if (aEncoded.size() < 1 + aCount / 3 + gCodeAuxTableSize
+        || (readByte(aEncoded.data()) & 0xf0) != gTriangleHeader)
+    {
+        throwMalformed("triangles");
+    }
+    const unsigned int version = readByte(aEncoded.data()) & 0x0f;
+    if (version > 1)
+    {
+        throw std::invalid_argument{"Unsupported meshopt index codec version " + std::to_string(version) + "."};
+    }
+    // Version 1 uses the codes 13 and 14 for free indices adjacent to the last one.
+    const unsigned int fecMax = (version >= 1) ? 13 : 15;
+
+    const std::byte * code = aEncoded.data() + 1;
+    const std::byte * data = code + aCount / 3;
+    const std::byte * const dataSafeEnd = aEncoded.data() + aEncoded.size() - gCodeAuxTableSize;
+    const std::byte * const codeAuxTable = dataSafeEnd;
+
+    VertexFifo vertexFifo;
+    vertexFifo.entries.fill(~0u);
+    EdgeFifo edgeFifo;
+    edgeFifo.entries.fill({~0u, ~0u});
+
+    std::uint32_t next = 0;
+    std::uint32_t last = 0;
+
+    auto decodeFreeIndex = [&]()
+    {
+        last += unzigzag(decodeVByte(data));
+        return last;
+    };
+
+    for (std::size_t triangle = 0; triangle != aCount; triangle += 3)
+    {
+        // A triangle reads at most 16 bytes of data (a codeaux byte and 3 varints of 5 bytes),
+        // which are guaranteed by the codeaux table closing the stream.
+        if (data > dataSafeEnd)
+        {
+            throwMalformed("triangles");
+        }
+
+        std::uint32_t a, b, c;
+        const unsigned int codeTri = readByte(code++);
+        if (codeTri < 0xf0)
+        {
+            // The first two vertices are an edge from the fifo.
+            const std::array<std::uint32_t, 2> & edge = edgeFifo[1 + (codeTri >> 4)];
+            a = edge[0];
+            b = edge[1];
+
+            const unsigned int fec = codeTri & 15;
+            if (fec < fecMax)
+            {
+                c = (fec == 0) ? next++ : vertexFifo[1 + fec];
+                vertexFifo.push(c, fec == 0);
+            }
+            else
+            {
+                // 13 and 14 decode to last - 1 and last + 1.
+                c = (fec != 15) ? (last += (fec == 13 ? -1 : 1)) : decodeFreeIndex();
+                vertexFifo.push(c);
+            }
+
+            edgeFifo.push(c, b);
+            edgeFifo.push(a, c);
+        }
+        else
+        {
+            unsigned int fea, feb, fec;
+            if (codeTri < 0xfe)
+            {
+                // The table does not contain free indices.
+                const unsigned int codeAux = readByte(codeAuxTable + (codeTri & 15));
+                fea = 0;
+                feb = codeAux >> 4;
+                fec = codeAux & 15;
+            }
+            else
+            {
+                const unsigned int codeAux = readByte(data++);
+                fea = (codeTri == 0xfe) ? 0 : 15;
+                feb = codeAux >> 4;
+                fec = codeAux & 15;
+                // Reset, encoded out of the table.
+                if (codeAux == 0)
+                {
+                    next = 0;
+                }
+            }
+
+            // All vertices take the next index before free indices are decoded, as the encoder does.
+            a = (fea == 0) ? next++ : 0;
+            b = (feb == 0) ? next++ : vertexFifo[feb];
+            c = (fec == 0) ? next++ : vertexFifo[fec];
+
+            if (fea == 15)
+            {
+                a = decodeFreeIndex();
+            }
+            if (feb == 15)
+            {
+                b = decodeFreeIndex();
+            }
+            if (fec == 15)
+            {
+                c = decodeFreeIndex();
+            }
+
+            vertexFifo.push(a);
+            vertexFifo.push(b, feb == 0 || feb == 15);
+            vertexFifo.push(c, fec == 0 || fec == 15);
+
+            edgeFifo.push(b, a);
+            edgeFifo.push(c, b);
+            edgeFifo.push(a, c);
+        }
+
+        writeIndex(aOutput.data(), triangle + 0, aIndexSize, a);
+        writeIndex(aOutput.data(), triangle + 1, aIndexSize, b);
+        writeIndex(aOutput.data(), triangle + 2, aIndexSize, c);
+    }
+
+    if (data != dataSafeEnd)
+    {
+        throwMalformed("triangles");
+    }
+}
+
+
+void decodeMeshoptIndices(std::span<const std::byte> aEncoded,
+                          std::size_t aCount,
+                          std::size_t aIndexSize,
+                          std::span<std::byte> aOutput)
+{
+    checkIndexArguments(aCount, aIndexSize, aOutput);
+
+    // Header, at least one byte per index, and the tail.
+    if (aEncoded.size() < 1 + aCount + gSequenceTailSize
+        || (readByte(aEncoded.data()) & 0xf0) != gSequenceHeader)
+    {
+        throwMalformed("indices");
+    }
+    if (const unsigned int version = readByte(aEncoded.data()) & 0x0f; version > 1)
+    {
+        throw std::invalid_argument{"Unsupported meshopt index sequence version " + std::to_string(version) + "."};
+    }
+
+    const std::byte * data = aEncoded.data() + 1;
+    const std::byte * const dataSafeEnd = aEncoded.data() + aEncoded.size() - gSequenceTailSize;
+
+    // Deltas are relative to one of two baselines, selected by the low bit.
+    std::array<std::uint32_t, 2> last{0, 0};
+    for (std::size_t position = 0; position != aCount; ++position)
+    {
+        // A varint is at most 5 bytes, which are guaranteed by the tail.
+        if (data >= dataSafeEnd)
+        {
+            throwMalformed("indices");
+        }
+        const std::uint32_t value = decodeVByte(data);
+        std::uint32_t & baseline = last[value & 1];
+        baseline += unzigzag(value >> 1);
+        writeIndex(aOutput.data(), position, aIndexSize, baseline);
+    }
+
+    if (data != dataSafeEnd)
+    {
+        throwMalformed("indices");
+    }
+}
+
+
+void applyMeshoptOctahedralFilter(std::span<std::byte> aData, std::size_t aCount, std::size_t aStride)
+{
+    if (aData.size() < aCount * aStride)
+    {
+        throw std::invalid_argument{"Data is too small for the meshopt octahedral filter."};
+    }
+
+    if (aStride == 4)
+    {
+        applyOctahedral(reinterpret_cast<std::int8_t *>(aData.data()), aCount);
+    }
+    else if (aStride == 8)
+    {
+        applyOctahedral(reinterpret_cast<std::int16_t *>(aData.data()), aCount);
+    }
+    else
+    {
+        throw std::invalid_argument{"Meshopt octahedral filter requires a stride of 4 or 8, not "
+                                    + std::to_string(aStride) + "."};
+    }
+}
+
+
+void applyMeshoptQuaternionFilter(std::span<std::byte> aData, std::size_t aCount, std::size_t aStride)
+{
+    if (aStride != 8)
+    {
+        throw std::invalid_argument{"Meshopt quaternion filter requires a stride of 8, not "
+                                    + std::to_string(aStride) + "."};
+    }
+    if (aData.size() < aCount * aStride)
+    {
+        throw std::invalid_argument{"Data is too small for the meshopt quaternion filter."};
+    }
+
+    const float scale = 1.f / std::sqrt(2.f);
+    auto * components = reinterpret_cast<std::int16_t *>(aData.data());
+    for (std::size_t element = 0; element != aCount; ++element)
+    {
+        std::int16_t * quaternion = components + element * 4;
+        // The fourth component stores the scale in its high bits, and the index of the largest component.
+        const int encoded = quaternion[3];
+        const float componentScale = scale / static_cast<float>(encoded | 3);
+
+        const float x = quaternion[0] * componentScale;
+        const float y = quaternion[1] * componentScale;
+        const float z = quaternion[2] * componentScale;
+        // The largest component is reconstructed from the unit length, clamped against precision errors.
+        const float w = std::sqrt(std::max(1.f - x * x - y * y - z * z, 0.f));
+
+        const int largest = encoded & 3;
+        quaternion[(largest + 1) & 3] = static_cast<std::int16_t>(roundToInt(x * 32767.f));
+        quaternion[(largest + 2) & 3] = static_cast<std::int16_t>(roundToInt(y * 32767.f));
+        quaternion[(largest + 3) & 3] = static_cast<std::int16_t>(roundToInt(z * 32767.f));
+        quaternion[largest] = static_cast<std::int16_t>(roundToInt(w * 32767.f));
+    }
+}
+
+
+void applyMeshoptExponentialFilter(std::span<std::byte> aData, std::size_t aCount, std::size_t aStride)
+{
+    if (aStride % 4 != 0)
+    {
+        throw std::invalid_argument{"Meshopt exponential filter requires a stride multiple of 4, not "
+                                    + std::to_string(aStride) + "."};
+    }
+    if (aData.size() < aCount * aStride)
+    {
+        throw std::invalid_argument{"Data is too small for the meshopt exponential filter."};
+    }
+
+    auto * values = reinterpret_cast<std::uint32_t *>(aData.data());
+    const std::size_t valueCount = aCount * aStride / 4;
+    // Branchless, so the compiler can vectorize it.
+    for (std::size_t valueId = 0; valueId != valueCount; ++valueId)
+    {
+        const std::uint32_t encoded = values[valueId];
+        // 24 bits signed mantissa, 8 bits signed exponent.
+        const auto mantissa = static_cast<std::int32_t>(encoded << 8) >> 8;
+        const auto exponent = static_cast<std::int32_t>(encoded) >> 24;
+
+        // ldexp(mantissa, exponent), by constructing the power of two.
+        const std::uint32_t powerBits = static_cast<std::uint32_t>(exponent + 127) << 23;
+        float power;
+        std::memcpy(&power, &powerBits, sizeof(power));
+        const float decoded = power * static_cast<float>(mantissa);
+        std::memcpy(&values[valueId], &decoded, sizeof(decoded));
+    }
+}
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
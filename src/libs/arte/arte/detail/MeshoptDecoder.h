@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include <cstddef>
+#include <span>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+// Decoders for the bitstreams of the EXT_meshopt_compression glTF extension (meshoptimizer codecs).
+// see: https://github.com/KhronosGroup/glTF/tree/main/extensions/2.0/Vendor/EXT_meshopt_compression
+//
+// All decoders throw std::invalid_argument when the encoded data is malformed,
+// or when it does not match the announced element count and stride.
+
+
+/// @brief Decode an "ATTRIBUTES" mode stream (vertex codec, version 0).
+///
+/// Byte groups are unpacked, and deltas accumulated, with SSSE3 when the CPU supports it (detected at runtime),
+/// with a scalar fallback.
+/// @param aStride Size of an element in bytes, a multiple of 4 up to 256.
+/// @param aOutput Must be at least `aCount * aStride` bytes.
+void decodeMeshoptVertices(std::span<const std::byte> aEncoded,
+                           std::size_t aCount,
+                           std::size_t aStride,
+                           std::span<std::byte> aOutput);
+
+/// @brief Decode a "TRIANGLES" mode stream (index codec, versions 0 and 1).
+/// @param aCount Number of indices, a multiple of 3.
+/// @param aIndexSize 2 or 4.
+/// @param aOutput Must be at least `aCount * aIndexSize` bytes.
+void decodeMeshoptTriangles(std::span<const std::byte> aEncoded,
+                            std::size_t aCount,
+                            std::size_t aIndexSize,
+                            std::span<std::byte> aOutput);
+
+/// @brief Decode an "INDICES" mode stream (index sequence codec).
+/// @param aIndexSize 2 or 4.
+/// @param aOutput Must be at least `aCount * aIndexSize` bytes.
+void decodeMeshoptIndices(std::span<const std::byte> aEncoded,
+                          std::size_t aCount,
+                          std::size_t aIndexSize,
+                          std::span<std::byte> aOutput);
+
+
+/// @brief Reconstruct unit vectors from the octahedral encoding, in place.
+/// @param aStride 4 (signed bytes) or 8 (signed shorts), the fourth component is preserved.
+/// @note Vectorized with SSSE3 when available, with results identical to the scalar fallback.
+void applyMeshoptOctahedralFilter(std::span<std::byte> aData, std::size_t aCount, std::size_t aStride);
+
+/// @brief Reconstruct unit quaternions from the "three smallest components" encoding, in place.
+/// @param aStride Must be 8 (4 signed shorts).
+void applyMeshoptQuaternionFilter(std::span<std::byte> aData, std::size_t aCount, std::size_t aStride);
+
+/// @brief Reconstruct floats from their shared exponent encoding, in place.
+/// @param aStride A multiple of 4.
+void applyMeshoptExponentialFilter(std::span<std::byte> aData, std::size_t aCount, std::size_t aStride);
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,91 @@
+#pragma once
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace detail {
+
+
+/// @brief The number of threads the parallel helpers will use (always at least 1).
+inline unsigned int getWorkerCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+/// @brief Invoke `aFunction(i)` for each `i` in [0, aCount[, distributing the indices over worker threads.
+///
+/// Indices are handed out dynamically by chunks of `aGrain`, which balances the load
+/// when individual invocations have very different costs (e.g. subtrees of varying size).
+/// The calling thread takes part in the work, and the function returns once all invocations completed.
+/// @note If any invocation throws, the first exception caught is rethrown on the calling thread
+/// (the remaining chunks might still have been processed).
+template <class T_function>
+void parallelFor(std::size_t aCount, T_function && aFunction, std::size_t aGrain = 1)
+{
+    aGrain = std::max<std::size_t>(1, aGrain);
+    const std::size_t chunkCount = (aCount + aGrain - 1) / aGrain;
+    const std::size_t workerCount = std::min<std::size_t>(getWorkerCount(), chunkCount);
+
+    if (workerCount <= 1)
+    {
+        for (std::size_t index = 0; index != aCount; ++index)
+        {
+            aFunction(index);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> nextChunk{0};
+    std::vector<std::exception_ptr> exceptions(workerCount);
+
+    auto work = [&](std::size_t aWorkerId)
+    {
+        try
+        {
+            for (std::size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+            {
+                const std::size_t end = std::min(aCount, (chunk + 1) * aGrain);
+                for (std::size_t index = chunk * aGrain; index != end; ++index)
+                {
+                    aFunction(index);
+                }
+            }
+        }
+        catch(...)
+        {
+            exceptions[aWorkerId] = std::current_exception();
+        }
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(workerCount - 1);
+        for (std::size_t workerId = 1; workerId != workerCount; ++workerId)
+        {
+            threads.emplace_back(work, workerId);
+        }
+        work(0);
+    } // jthreads join on destruction
+
+    for (const std::exception_ptr & exception : exceptions)
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+
+} // namespace detail
+} // namespace arte
+} // namespace ad
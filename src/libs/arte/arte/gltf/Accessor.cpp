@@ -0,0 +1,596 @@
+#include "Accessor.h"
+
+#include "../detail/Base64.h"
+#include "../detail/MeshoptDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    template <class T_component>
+    T_component readRaw(const std::byte * aAddress)
+    {
+        T_component result;
+        std::memcpy(&result, aAddress, sizeof(T_component));
+        return result;
+    }
+
+
+    constexpr std::string_view gDataUriScheme = "data:";
+    constexpr std::string_view gBase64Parameter = ";base64";
+
+
+    /// @brief Decode the base64 payload of the data uri, without copying the payload itself.
+    std::vector<std::byte> decodeDataUri(std::string_view aDataUri)
+    {
+        const std::size_t comma = aDataUri.find(',');
+        if (aDataUri.rfind(gDataUriScheme, 0) != 0 || comma == std::string_view::npos)
+        {
+            throw std::invalid_argument{"Malformed data uri."};
+        }
+        if (!aDataUri.substr(0, comma).ends_with(gBase64Parameter))
+        {
+            throw std::runtime_error{"Only base64 data uris are supported."};
+        }
+
+        const std::string_view payload = aDataUri.substr(comma + 1);
+        std::vector<std::byte> result(detail::getDecodedSize(payload));
+        detail::decodeBase64(payload, result);
+        return result;
+    }
+
+
+    std::vector<std::byte> readFile(const filesystem::path & aPath)
+    {
+        std::ifstream input{aPath, std::ios::binary | std::ios::ate};
+        if (!input)
+        {
+            throw std::runtime_error{"Cannot open glTF file: " + aPath.string()};
+        }
+        std::vector<std::byte> result(static_cast<std::size_t>(input.tellg()));
+        input.seekg(0);
+        input.read(reinterpret_cast<char *>(result.data()), result.size());
+        return result;
+    }
+
+
+    std::vector<std::byte> readFile(const filesystem::path & aPath, std::size_t aByteLength)
+    {
+        std::ifstream input{aPath, std::ios::binary};
+        if (!input)
+        {
+            throw std::runtime_error{"Cannot open glTF buffer file: " + aPath.string()};
+        }
+        std::vector<std::byte> result(aByteLength);
+        input.read(reinterpret_cast<char *>(result.data()), aByteLength);
+        if (static_cast<std::size_t>(input.gcount()) != aByteLength)
+        {
+            throw std::runtime_error{"glTF buffer file is shorter than its byteLength: " + aPath.string()};
+        }
+        return result;
+    }
+
+
+    /// @brief Convert a component to float, applying normalization when requested.
+    /// see: https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#animations (normalization equations)
+    template <class T_component>
+    float toFloat(T_component aValue, bool aNormalized)
+    {
+        if constexpr(std::is_floating_point_v<T_component>)
+        {
+            return aValue;
+        }
+        else
+        {
+            constexpr float max = static_cast<float>(std::numeric_limits<T_component>::max());
+            const float value = static_cast<float>(aValue);
+            if (!aNormalized)
+            {
+                return value;
+            }
+            if constexpr(std::is_signed_v<T_component>)
+            {
+                return std::max(value / max, -1.f);
+            }
+            else
+            {
+                return value / max;
+            }
+        }
+    }
+
+
+    /// @brief Convert all the components of the view, the component type being resolved once for the whole view.
+    template <class T_component>
+    void convertComponents(const AccessorView & aView, float * aOutput)
+    {
+        const std::size_t columns = aView.componentCount / aView.rows;
+        for (std::size_t element = 0; element != aView.count; ++element)
+        {
+            const std::byte * elementAddress = aView.data + element * aView.stride;
+            for (std::size_t column = 0; column != columns; ++column)
+            {
+                const std::byte * columnAddress = elementAddress + column * aView.columnStride;
+                for (std::size_t row = 0; row != aView.rows; ++row)
+                {
+                    *aOutput++ = toFloat(readRaw<T_component>(columnAddress + row * sizeof(T_component)),
+                                         aView.normalized);
+                }
+            }
+        }
+    }
+
+
+    /// @brief Size of an element stored tightly packed, matrix columns being aligned on 4 bytes.
+    std::size_t getPackedElementSize(const AccessorView & aView)
+    {
+        const std::size_t columns = aView.componentCount / aView.rows;
+        return (columns == 1) ? aView.rows * getComponentSize(aView.componentType) : columns * aView.columnStride;
+    }
+
+
+    /// @brief Views over the indices and the (tightly packed) values of a sparse accessor.
+    struct SparseViews
+    {
+        AccessorView indices;
+        AccessorView values;
+    };
+
+    SparseViews makeSparseViews(BufferCache & aBuffers,
+                                const accessor::Sparse & aSparse,
+                                const AccessorView & aDenseView)
+    {
+        AccessorView values = aDenseView;
+        values.data = aBuffers.get(aSparse.values.bufferView).data() + aSparse.values.byteOffset;
+        values.stride = getPackedElementSize(aDenseView);
+        values.count = aSparse.count;
+
+        return {
+            .indices = AccessorView{
+                .data = aBuffers.get(aSparse.indices.bufferView).data() + aSparse.indices.byteOffset,
+                .stride = getComponentSize(aSparse.indices.componentType),
+                .count = aSparse.count,
+                .componentCount = 1,
+                .componentType = aSparse.indices.componentType,
+                .columnStride = getComponentSize(aSparse.indices.componentType),
+                .rows = 1,
+            },
+            .values = values,
+        };
+    }
+
+
+    void decodeMeshopt(std::span<const std::byte> aEncoded,
+                       const bufferview::MeshoptCompression & aCompression,
+                       std::span<std::byte> aOutput)
+    {
+        using Compression = bufferview::MeshoptCompression;
+
+        switch(aCompression.mode)
+        {
+            case Compression::Mode::Attributes:
+                detail::decodeMeshoptVertices(aEncoded, aCompression.count, aCompression.byteStride, aOutput);
+                break;
+            case Compression::Mode::Triangles:
+                detail::decodeMeshoptTriangles(aEncoded, aCompression.count, aCompression.byteStride, aOutput);
+                break;
+            case Compression::Mode::Indices:
+                detail::decodeMeshoptIndices(aEncoded, aCompression.count, aCompression.byteStride, aOutput);
+                break;
+        }
+
+        switch(aCompression.filter)
+        {
+            case Compression::Filter::None:
+                break;
+            case Compression::Filter::Octahedral:
+                detail::applyMeshoptOctahedralFilter(aOutput, aCompression.count, aCompression.byteStride);
+                break;
+            case Compression::Filter::Quaternion:
+                detail::applyMeshoptQuaternionFilter(aOutput, aCompression.count, aCompression.byteStride);
+                break;
+            case Compression::Filter::Exponential:
+                detail::applyMeshoptExponentialFilter(aOutput, aCompression.count, aCompression.byteStride);
+                break;
+        }
+    }
+
+
+    std::size_t countRows(Accessor::ElementType aElementType)
+    {
+        switch(aElementType)
+        {
+            case Accessor::ElementType::Mat2: return 2;
+            case Accessor::ElementType::Mat3: return 3;
+            case Accessor::ElementType::Mat4: return 4;
+            default: return countComponents(aElementType);
+        }
+    }
+
+} // anonymous namespace
+
+
+std::size_t getComponentSize(EnumType aComponentType)
+{
+    switch(aComponentType)
+    {
+        case component::Byte:
+        case component::UnsignedByte:
+            return 1;
+        case component::Short:
+        case component::UnsignedShort:
+            return 2;
+        case component::UnsignedInt:
+        case component::Float:
+            return 4;
+        default:
+            throw std::invalid_argument{"Invalid accessor component type: " + std::to_string(aComponentType)};
+    }
+}
+
+
+std::size_t countComponents(Accessor::ElementType aElementType)
+{
+    switch(aElementType)
+    {
+        case Accessor::ElementType::Scalar: return 1;
+        case Accessor::ElementType::Vec2:   return 2;
+        case Accessor::ElementType::Vec3:   return 3;
+        case Accessor::ElementType::Vec4:   return 4;
+        case Accessor::ElementType::Mat2:   return 4;
+        case Accessor::ElementType::Mat3:   return 9;
+        case Accessor::ElementType::Mat4:   return 16;
+    }
+    throw std::invalid_argument{"Invalid accessor element type."};
+}
+
+
+//
+// BufferCache
+//
+BufferCache::BufferCache(const Gltf & aGltf) :
+    mGltf{aGltf},
+    mBuffers(aGltf.countBuffers()),
+    mImages(aGltf.countImages()),
+    mBufferViews(aGltf.countBufferViews())
+{}
+
+
+std::span<const std::byte> BufferCache::get(Index<Buffer> aBufferIndex)
+{
+    std::lock_guard<std::mutex> lock{mLoadMutex};
+
+    std::unique_ptr<std::vector<std::byte>> & entry = mBuffers.at(aBufferIndex);
+    if (!entry)
+    {
+        const Buffer & buffer = mGltf.get(aBufferIndex);
+        if (!buffer.uri)
+        {
+            throw std::runtime_error{"Buffers without uri (binary glTF chunk) are not supported."};
+        }
+        else if (buffer.uri->type == Uri::Type::Data)
+        {
+            entry = std::make_unique<std::vector<std::byte>>(decodeDataUri(buffer.uri->string));
+            if (entry->size() < buffer.byteLength)
+            {
+                entry.reset();
+                throw std::runtime_error{"glTF buffer data uri is shorter than its byteLength."};
+            }
+        }
+        else
+        {
+            entry = std::make_unique<std::vector<std::byte>>(
+                readFile(mGltf.getPathFor(*buffer.uri), buffer.byteLength));
+        }
+    }
+    return *entry;
+}
+
+
+std::span<const std::byte> BufferCache::get(Index<BufferView> aBufferViewIndex)
+{
+    const BufferView & view = mGltf.get(aBufferViewIndex);
+    if (view.meshoptCompression)
+    {
+        return getDecoded(aBufferViewIndex, *view.meshoptCompression);
+    }
+
+    std::span<const std::byte> buffer = get(view.buffer);
+    if (view.byteOffset + view.byteLength > buffer.size())
+    {
+        throw std::out_of_range{"Buffer view " + std::to_string(aBufferViewIndex) + " exceeds its buffer."};
+    }
+    return buffer.subspan(view.byteOffset, view.byteLength);
+}
+
+
+std::span<const std::byte> BufferCache::getDecoded(Index<BufferView> aBufferViewIndex,
+                                                   const bufferview::MeshoptCompression & aCompression)
+{
+    {
+        std::lock_guard<std::mutex> lock{mLoadMutex};
+        if (const Entry & entry = mBufferViews.at(aBufferViewIndex))
+        {
+            return *entry;
+        }
+    }
+
+    const BufferView & view = mGltf.get(aBufferViewIndex);
+    if (aCompression.count * aCompression.byteStride != view.byteLength)
+    {
+        throw std::runtime_error{"Compressed buffer view " + std::to_string(aBufferViewIndex)
+                                 + " byteLength does not match its decoded size."};
+    }
+
+    // The lock is not held while loading the compressed buffer (which takes it) and decoding.
+    std::span<const std::byte> buffer = get(aCompression.buffer);
+    if (aCompression.byteOffset + aCompression.byteLength > buffer.size())
+    {
+        throw std::out_of_range{"Compressed buffer view " + std::to_string(aBufferViewIndex)
+                                + " exceeds its buffer."};
+    }
+    auto decoded = std::make_unique<std::vector<std::byte>>(view.byteLength);
+    decodeMeshopt(buffer.subspan(aCompression.byteOffset, aCompression.byteLength), aCompression, *decoded);
+
+    std::lock_guard<std::mutex> lock{mLoadMutex};
+    Entry & entry = mBufferViews.at(aBufferViewIndex);
+    // A concurrent reader might have decoded the view meanwhile, the first entry is kept.
+    if (!entry)
+    {
+        entry = std::move(decoded);
+    }
+    return *entry;
+}
+
+
+std::span<const std::byte> BufferCache::getImageData(Index<Image> aImageIndex)
+{
+    const Image & image = mGltf.get(aImageIndex);
+    if (const auto * bufferView = std::get_if<Index<BufferView>>(&image.dataSource))
+    {
+        return get(*bufferView);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{mLoadMutex};
+        if (const Entry & entry = mImages.at(aImageIndex))
+        {
+            return *entry;
+        }
+    }
+
+    // The lock is not held while decoding the data uri or reading the file.
+    const Uri & uri = std::get<Uri>(image.dataSource);
+    auto data = std::make_unique<std::vector<std::byte>>(
+        uri.type == Uri::Type::Data ? decodeDataUri(uri.string) : readFile(mGltf.getPathFor(uri)));
+
+    std::lock_guard<std::mutex> lock{mLoadMutex};
+    Entry & entry = mImages.at(aImageIndex);
+    // A concurrent reader might have loaded the image meanwhile, the first entry is kept.
+    if (!entry)
+    {
+        entry = std::move(data);
+    }
+    return *entry;
+}
+
+
+//
+// AccessorView
+//
+float AccessorView::readFloat(std::size_t aElement, std::size_t aComponent) const
+{
+    if (data == nullptr)
+    {
+        return 0.f;
+    }
+
+    const std::byte * address = data + aElement * stride
+        + (aComponent / rows) * columnStride
+        + (aComponent % rows) * getComponentSize(componentType);
+
+    switch(componentType)
+    {
+        case component::Float:
+            return readRaw<float>(address);
+        case component::Byte:
+            return toFloat(readRaw<std::int8_t>(address), normalized);
+        case component::UnsignedByte:
+            return toFloat(readRaw<std::uint8_t>(address), normalized);
+        case component::Short:
+            return toFloat(readRaw<std::int16_t>(address), normalized);
+        case component::UnsignedShort:
+            return toFloat(readRaw<std::uint16_t>(address), normalized);
+        case component::UnsignedInt:
+            return toFloat(readRaw<std::uint32_t>(address), normalized);
+    }
+    throw std::invalid_argument{"Invalid accessor component type: " + std::to_string(componentType)};
+}
+
+
+std::uint32_t AccessorView::readUnsigned(std::size_t aElement, std::size_t aComponent) const
+{
+    if (data == nullptr)
+    {
+        return 0;
+    }
+
+    const std::byte * address = data + aElement * stride + aComponent * getComponentSize(componentType);
+    switch(componentType)
+    {
+        case component::UnsignedByte:
+            return readRaw<std::uint8_t>(address);
+        case component::UnsignedShort:
+            return readRaw<std::uint16_t>(address);
+        case component::UnsignedInt:
+            return readRaw<std::uint32_t>(address);
+        default:
+            throw std::invalid_argument{"Component type is not an unsigned integer: " + std::to_string(componentType)};
+    }
+}
+
+
+AccessorView makeView(BufferCache & aBuffers, const Accessor & aAccessor)
+{
+    const std::size_t componentSize = getComponentSize(aAccessor.componentType);
+    const std::size_t rows = countRows(aAccessor.type);
+    const std::size_t columns = countComponents(aAccessor.type) / rows;
+    // Each matrix column starts on a 4-byte boundary
+    const std::size_t columnStride = (rows * componentSize + 3) & ~std::size_t{3};
+    const std::size_t elementSize = (columns == 1) ? rows * componentSize : columns * columnStride;
+
+    AccessorView view{
+        .stride = elementSize,
+        .count = aAccessor.count,
+        .componentCount = countComponents(aAccessor.type),
+        .componentType = aAccessor.componentType,
+        .normalized = aAccessor.normalized,
+        .columnStride = columnStride,
+        .rows = rows,
+    };
+
+    if (aAccessor.bufferView)
+    {
+        std::span<const std::byte> bytes = aBuffers.get(*aAccessor.bufferView);
+        const BufferView & bufferView = aBuffers.getGltf().get(*aAccessor.bufferView);
+        view.stride = bufferView.byteStride.value_or(elementSize);
+
+        if (aAccessor.count != 0
+            && aAccessor.byteOffset + (aAccessor.count - 1) * view.stride + elementSize > bytes.size())
+        {
+            throw std::out_of_range{"Accessor '" + std::string{aAccessor.name} + "' exceeds its buffer view."};
+        }
+        view.data = bytes.data() + aAccessor.byteOffset;
+    }
+
+    return view;
+}
+
+
+std::vector<float> readAsFloats(BufferCache & aBuffers, const Accessor & aAccessor)
+{
+    AccessorView view = makeView(aBuffers, aAccessor);
+
+    std::vector<float> result(view.count * view.componentCount, 0.f);
+    if (view.data != nullptr)
+    {
+        if (view.componentType == component::Float && view.stride == view.componentCount * sizeof(float))
+        {
+            // Tightly packed floats, the common case.
+            std::memcpy(result.data(), view.data, result.size() * sizeof(float));
+        }
+        else
+        {
+            // Quantized attributes (KHR_mesh_quantization), strided or padded matrices.
+            switch(view.componentType)
+            {
+                case component::Float:
+                    convertComponents<float>(view, result.data());
+                    break;
+                case component::Byte:
+                    convertComponents<std::int8_t>(view, result.data());
+                    break;
+                case component::UnsignedByte:
+                    convertComponents<std::uint8_t>(view, result.data());
+                    break;
+                case component::Short:
+                    convertComponents<std::int16_t>(view, result.data());
+                    break;
+                case component::UnsignedShort:
+                    convertComponents<std::uint16_t>(view, result.data());
+                    break;
+                case component::UnsignedInt:
+                    convertComponents<std::uint32_t>(view, result.data());
+                    break;
+                default:
+                    throw std::invalid_argument{"Invalid accessor component type: "
+                                                + std::to_string(view.componentType)};
+            }
+        }
+    }
+
+    if (aAccessor.sparse)
+    {
+        const SparseViews sparse = makeSparseViews(aBuffers, *aAccessor.sparse, view);
+        for (std::size_t substitution = 0; substitution != sparse.indices.count; ++substitution)
+        {
+            std::size_t target = sparse.indices.readUnsigned(substitution);
+            for (std::size_t componentId = 0; componentId != view.componentCount; ++componentId)
+            {
+                result.at(target * view.componentCount + componentId) =
+                    sparse.values.readFloat(substitution, componentId);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+std::vector<std::byte> readElements(BufferCache & aBuffers, const Accessor & aAccessor)
+{
+    const AccessorView view = makeView(aBuffers, aAccessor);
+    const std::size_t elementSize = getPackedElementSize(view);
+
+    std::vector<std::byte> result(view.count * elementSize);
+    if (view.data != nullptr)
+    {
+        for (std::size_t element = 0; element != view.count; ++element)
+        {
+            std::memcpy(result.data() + element * elementSize, view.data + element * view.stride, elementSize);
+        }
+    }
+
+    if (aAccessor.sparse)
+    {
+        const SparseViews sparse = makeSparseViews(aBuffers, *aAccessor.sparse, view);
+        for (std::size_t substitution = 0; substitution != sparse.indices.count; ++substitution)
+        {
+            const std::size_t target = sparse.indices.readUnsigned(substitution);
+            if (target >= view.count)
+            {
+                throw std::out_of_range{"Accessor '" + std::string{aAccessor.name}
+                                        + "' has a sparse index beyond its count."};
+            }
+            std::memcpy(result.data() + target * elementSize,
+                        sparse.values.data + substitution * elementSize,
+                        elementSize);
+        }
+    }
+
+    return result;
+}
+
+
+std::vector<std::uint32_t> readAsIndices(BufferCache & aBuffers, const Accessor & aAccessor)
+{
+    if (aAccessor.type != Accessor::ElementType::Scalar)
+    {
+        throw std::invalid_argument{"Indices accessor must be scalar."};
+    }
+
+    AccessorView view = makeView(aBuffers, aAccessor);
+    std::vector<std::uint32_t> result(view.count);
+    for (std::size_t element = 0; element != view.count; ++element)
+    {
+        result[element] = view.readUnsigned(element);
+    }
+    return result;
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
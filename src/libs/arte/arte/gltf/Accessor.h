@@ -0,0 +1,114 @@
+#pragma once
+
+
+#include "Gltf.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Component types of accessors, with the values of the matching GL enumerators.
+namespace component {
+    constexpr EnumType Byte          = 5120; // GL_BYTE
+    constexpr EnumType UnsignedByte  = 5121; // GL_UNSIGNED_BYTE
+    constexpr EnumType Short         = 5122; // GL_SHORT
+    constexpr EnumType UnsignedShort = 5123; // GL_UNSIGNED_SHORT
+    constexpr EnumType UnsignedInt   = 5125; // GL_UNSIGNED_INT
+    constexpr EnumType Float         = 5126; // GL_FLOAT
+} // namespace component
+
+
+std::size_t getComponentSize(EnumType aComponentType);
+
+std::size_t countComponents(Accessor::ElementType aElementType);
+
+
+/// @brief Loads the binary content of the glTF buffers on first access, then keeps it around.
+///
+/// Base64 data uris are decoded directly into the cache entries.
+/// Buffer views compressed with EXT_meshopt_compression are decoded on first access, into their own entries.
+/// Spans returned by the cache stay valid for the lifetime of the cache.
+/// @note Loading is synchronized, so a cache can be shared by concurrent readers.
+class BufferCache
+{
+public:
+    explicit BufferCache(const Gltf & aGltf);
+
+    std::span<const std::byte> get(Index<Buffer> aBuffer);
+
+    /// @brief The bytes of the buffer view (a sub-span of its buffer, or its decoded content).
+    std::span<const std::byte> get(Index<BufferView> aBufferView);
+
+    /// @brief The encoded content of the image (e.g. a PNG file), whatever its data source.
+    std::span<const std::byte> getImageData(Index<Image> aImage);
+
+    const Gltf & getGltf() const
+    { return mGltf; }
+
+private:
+    using Entry = std::unique_ptr<std::vector<std::byte>>;
+
+    std::span<const std::byte> getDecoded(Index<BufferView> aBufferView,
+                                          const bufferview::MeshoptCompression & aCompression);
+
+    const Gltf & mGltf;
+    std::mutex mLoadMutex;
+    // unique_ptr so the cache entries are never relocated.
+    std::vector<Entry> mBuffers;
+    std::vector<Entry> mImages; // only used for images with an uri
+    std::vector<Entry> mBufferViews; // only used for compressed buffer views
+};
+
+
+/// @brief Strided view over the elements of an accessor.
+///
+/// This is a view of the data as stored in the buffer: it does not apply sparse substitutions.
+struct AccessorView
+{
+    /// @brief Read component `aComponent` of element `aElement` as float,
+    /// applying normalization when the accessor is normalized.
+    float readFloat(std::size_t aElement, std::size_t aComponent) const;
+
+    /// @brief Read component `aComponent` of element `aElement` as an unsigned integer
+    /// (intended for indices).
+    std::uint32_t readUnsigned(std::size_t aElement, std::size_t aComponent = 0) const;
+
+    const std::byte * data{nullptr}; // first element, nullptr when the accessor has no buffer view.
+    std::size_t stride{0};
+    std::size_t count{0};
+    std::size_t componentCount{0};
+    EnumType componentType{component::Float};
+    bool normalized{false};
+    // Matrix columns of small components are padded to 4 bytes.
+    std::size_t columnStride{0};
+    std::size_t rows{0};
+};
+
+
+AccessorView makeView(BufferCache & aBuffers, const Accessor & aAccessor);
+
+
+/// @brief Read all elements of the accessor as floats, applying normalization and sparse substitutions.
+/// @return `count * componentCount` floats.
+std::vector<float> readAsFloats(BufferCache & aBuffers, const Accessor & aAccessor);
+
+/// @brief Read all elements of the accessor in their stored component type, applying sparse substitutions.
+/// @return `count` tightly packed elements (matrix columns keep their 4-byte alignment).
+std::vector<std::byte> readElements(BufferCache & aBuffers, const Accessor & aAccessor);
+
+/// @brief Read a scalar accessor of unsigned integer components (e.g. primitive indices).
+std::vector<std::uint32_t> readAsIndices(BufferCache & aBuffers, const Accessor & aAccessor);
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,193 @@
+#pragma once
+
+
+#include <math/Homogeneous.h>
+
+#include <array>
+#include <cstddef>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define AD_ARTE_AFFINE_SSE
+#include <xmmintrin.h>
+#endif
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Compact affine transformation, stored as the 4 rows x 3 columns of a row-vector affine matrix.
+///
+/// This is the memory layout of `math::Matrix<4, 3, float>`: rows 0 to 2 hold the linear part,
+/// row 3 holds the translation, the implicit 4th column being [0, 0, 0, 1].
+/// It is trivially copyable, so contiguous arrays of it can be copied (or uploaded) as-is.
+struct Affine
+{
+    static constexpr std::size_t gColumns = 3;
+
+    float & at(std::size_t aRow, std::size_t aColumn)
+    { return elements[aRow * gColumns + aColumn]; }
+
+    float at(std::size_t aRow, std::size_t aColumn) const
+    { return elements[aRow * gColumns + aColumn]; }
+
+    static constexpr Affine Identity()
+    {
+        return Affine{{
+            1.f, 0.f, 0.f,
+            0.f, 1.f, 0.f,
+            0.f, 0.f, 1.f,
+            0.f, 0.f, 0.f,
+        }};
+    }
+
+    std::array<float, 12> elements;
+};
+
+
+/// @brief Compose two transformations, `aFirst` being applied before `aThen`.
+///
+/// With the row-vector convention, this is the product `aFirst * aThen`.
+/// Each result row is a linear combination of the rows of `aThen`, computed 4 lanes at a time.
+inline Affine compose(const Affine & aFirst, const Affine & aThen)
+{
+    Affine result;
+#if defined(AD_ARTE_AFFINE_SSE)
+    const float * a = aFirst.elements.data();
+    const float * b = aThen.elements.data();
+    // The 4th lane of each row is never stored: it holds the first element of the next row.
+    const __m128 then0 = _mm_loadu_ps(b);
+    const __m128 then1 = _mm_loadu_ps(b + 3);
+    const __m128 then2 = _mm_loadu_ps(b + 6);
+    // Load the last 4 elements, so the read does not go past the end of aThen.
+    const __m128 last = _mm_loadu_ps(b + 8);
+    const __m128 then3 = _mm_shuffle_ps(last, last, _MM_SHUFFLE(3, 3, 2, 1));
+
+    __m128 rows[4];
+    for (std::size_t row = 0; row != 4; ++row)
+    {
+        const float * left = a + 3 * row;
+        rows[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(left[0]), then0),
+                                          _mm_mul_ps(_mm_set1_ps(left[1]), then1)),
+                               _mm_mul_ps(_mm_set1_ps(left[2]), then2));
+    }
+    // Only the translation row picks the translation of aThen (homogeneous coordinate is 1).
+    rows[3] = _mm_add_ps(rows[3], then3);
+
+    // Pack the 4 rows of 3 elements into 3 registers of 4 elements.
+    const __m128 row1x_row0z = _mm_shuffle_ps(rows[1], rows[0], _MM_SHUFFLE(2, 2, 0, 0));
+    const __m128 row2z_row3x = _mm_shuffle_ps(rows[2], rows[3], _MM_SHUFFLE(0, 0, 2, 2));
+    float * output = result.elements.data();
+    _mm_storeu_ps(output,     _mm_shuffle_ps(rows[0], row1x_row0z, _MM_SHUFFLE(0, 2, 1, 0)));
+    _mm_storeu_ps(output + 4, _mm_shuffle_ps(rows[1], rows[2], _MM_SHUFFLE(1, 0, 2, 1)));
+    _mm_storeu_ps(output + 8, _mm_shuffle_ps(row2z_row3x, rows[3], _MM_SHUFFLE(2, 1, 2, 0)));
+#else
+    for (std::size_t row = 0; row != 4; ++row)
+    {
+        const float a0 = aFirst.at(row, 0);
+        const float a1 = aFirst.at(row, 1);
+        const float a2 = aFirst.at(row, 2);
+        // Only the translation row picks the translation of aThen (homogeneous coordinate is 1).
+        const float homogeneous = (row == 3) ? 1.f : 0.f;
+        for (std::size_t column = 0; column != 3; ++column)
+        {
+            result.at(row, column) = a0 * aThen.at(0, column)
+                                   + a1 * aThen.at(1, column)
+                                   + a2 * aThen.at(2, column)
+                                   + homogeneous * aThen.at(3, column);
+        }
+    }
+#endif
+    return result;
+}
+
+
+/// @brief Make the transformation scaling, then rotating, then translating.
+/// @param aRotation unit quaternion, in glTF component order (x, y, z, w).
+inline Affine makeAffine(const std::array<float, 3> & aTranslation,
+                         const std::array<float, 4> & aRotation,
+                         const std::array<float, 3> & aScale)
+{
+    const auto [x, y, z, w] = aRotation;
+    // Each row of the rotation (row-vector convention) is scaled by the matching scale factor.
+    return Affine{{
+        aScale[0] * (1.f - 2.f * (y*y + z*z)), aScale[0] * (2.f * (x*y + z*w)),       aScale[0] * (2.f * (x*z - y*w)),
+        aScale[1] * (2.f * (x*y - z*w)),       aScale[1] * (1.f - 2.f * (x*x + z*z)), aScale[1] * (2.f * (y*z + x*w)),
+        aScale[2] * (2.f * (x*z + y*w)),       aScale[2] * (2.f * (y*z - x*w)),       aScale[2] * (1.f - 2.f * (x*x + y*y)),
+        aTranslation[0],                       aTranslation[1],                       aTranslation[2],
+    }};
+}
+
+
+/// @brief Transform the position `aPosition` by `aTransformation`.
+inline std::array<float, 3> transformPosition(const Affine & aTransformation,
+                                              const std::array<float, 3> & aPosition)
+{
+    std::array<float, 3> result;
+    for (std::size_t column = 0; column != 3; ++column)
+    {
+        result[column] = aPosition[0] * aTransformation.at(0, column)
+                       + aPosition[1] * aTransformation.at(1, column)
+                       + aPosition[2] * aTransformation.at(2, column)
+                       + aTransformation.at(3, column);
+    }
+    return result;
+}
+
+
+/// @brief The 3x3 matrix transforming normals under `aTransformation`, i.e. the inverse transpose of its linear part.
+///
+/// Stored row-major, in the same row-vector convention as `Affine`.
+/// It is computed as the cofactor matrix over the determinant, the cofactor matrix alone for singular transformations.
+inline std::array<float, 9> getNormalMatrix(const Affine & aTransformation)
+{
+    const auto & e = aTransformation.elements;
+    std::array<float, 9> result{
+        e[4] * e[8] - e[5] * e[7], e[5] * e[6] - e[3] * e[8], e[3] * e[7] - e[4] * e[6],
+        e[2] * e[7] - e[1] * e[8], e[0] * e[8] - e[2] * e[6], e[1] * e[6] - e[0] * e[7],
+        e[1] * e[5] - e[2] * e[4], e[2] * e[3] - e[0] * e[5], e[0] * e[4] - e[1] * e[3],
+    };
+    const float determinant = e[0] * result[0] + e[1] * result[1] + e[2] * result[2];
+    if (determinant != 0.f)
+    {
+        for (float & element : result)
+        {
+            element /= determinant;
+        }
+    }
+    return result;
+}
+
+
+inline math::AffineMatrix<4, float> toMatrix(const Affine & aAffine)
+{
+    const auto & e = aAffine.elements;
+    return math::AffineMatrix<4, float>{
+        math::Matrix<4, 3, float>{
+            e[0], e[1],  e[2],
+            e[3], e[4],  e[5],
+            e[6], e[7],  e[8],
+            e[9], e[10], e[11],
+        }
+    };
+}
+
+
+inline Affine toAffine(const math::AffineMatrix<4, float> & aMatrix)
+{
+    Affine result;
+    for (std::size_t row = 0; row != 4; ++row)
+    {
+        for (std::size_t column = 0; column != 3; ++column)
+        {
+            result.at(row, column) = aMatrix.at(row, column);
+        }
+    }
+    return result;
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,382 @@
+#include "AnimationEngine.h"
+
+#include "../detail/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    // Above this count of forward steps, the cursor jumps with a binary search instead.
+    constexpr std::uint32_t gMaxLinearSteps = 8;
+
+    // Instances evaluated by each parallel task.
+    constexpr std::size_t gInstancesGrain = 16;
+
+
+    /// @brief Returns the last keyframe whose time is <= aTime (or 0 if aTime precedes all keyframes).
+    std::uint32_t advanceCursor(const std::vector<float> & aTimes, std::uint32_t aCursor, float aTime)
+    {
+        const auto count = static_cast<std::uint32_t>(aTimes.size());
+        if (aCursor < count && aTimes[aCursor] <= aTime)
+        {
+            // Sequential playback: usually stays on the same key, or moves to the next one.
+            std::uint32_t steps = 0;
+            while (aCursor + 1 < count && aTimes[aCursor + 1] <= aTime && steps++ != gMaxLinearSteps)
+            {
+                ++aCursor;
+            }
+            if (aCursor + 1 == count || aTimes[aCursor + 1] > aTime)
+            {
+                return aCursor;
+            }
+        }
+        // Time moved backward (e.g. looping), or far forward.
+        auto found = std::upper_bound(aTimes.begin(), aTimes.end(), aTime);
+        return (found == aTimes.begin()) ? 0 : static_cast<std::uint32_t>(found - aTimes.begin() - 1);
+    }
+
+
+    /// @brief Pending rotations, interpolated in a batch after all tracks of an instance were visited.
+    struct RotationBatch
+    {
+        void clear()
+        {
+            for (std::vector<float> * component : {&ax, &ay, &az, &aw, &bx, &by, &bz, &bw, &u})
+            {
+                component->clear();
+            }
+            targets.clear();
+        }
+
+        void push(const float * aFrom, const float * aTo, float aU, SceneGraph::NodeId aTarget)
+        {
+            ax.push_back(aFrom[0]); ay.push_back(aFrom[1]); az.push_back(aFrom[2]); aw.push_back(aFrom[3]);
+            bx.push_back(aTo[0]); by.push_back(aTo[1]); bz.push_back(aTo[2]); bw.push_back(aTo[3]);
+            u.push_back(aU);
+            targets.push_back(aTarget);
+        }
+
+        std::vector<float> ax, ay, az, aw;
+        std::vector<float> bx, by, bz, bw;
+        std::vector<float> u;
+        std::vector<SceneGraph::NodeId> targets;
+    };
+
+
+    /// @brief Shortest path normalized linear interpolation, in place into the `a` components.
+    /// Straight-line code over SoA arrays, so it vectorizes.
+    void nlerp(RotationBatch & aBatch)
+    {
+        const std::size_t count = aBatch.u.size();
+        float * ax = aBatch.ax.data(); float * ay = aBatch.ay.data();
+        float * az = aBatch.az.data(); float * aw = aBatch.aw.data();
+        const float * bx = aBatch.bx.data(); const float * by = aBatch.by.data();
+        const float * bz = aBatch.bz.data(); const float * bw = aBatch.bw.data();
+        const float * u = aBatch.u.data();
+
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            const float dot = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+            const float wa = 1.f - u[i];
+            const float wb = (dot < 0.f) ? -u[i] : u[i];
+            const float x = wa * ax[i] + wb * bx[i];
+            const float y = wa * ay[i] + wb * by[i];
+            const float z = wa * az[i] + wb * bz[i];
+            const float w = wa * aw[i] + wb * bw[i];
+            const float inverseNorm = 1.f / std::sqrt(x*x + y*y + z*z + w*w);
+            ax[i] = x * inverseNorm;
+            ay[i] = y * inverseNorm;
+            az[i] = z * inverseNorm;
+            aw[i] = w * inverseNorm;
+        }
+    }
+
+
+    /// @brief Shortest path spherical linear interpolation, in place into the `a` components.
+    void slerp(RotationBatch & aBatch)
+    {
+        const std::size_t count = aBatch.u.size();
+        float * ax = aBatch.ax.data(); float * ay = aBatch.ay.data();
+        float * az = aBatch.az.data(); float * aw = aBatch.aw.data();
+        const float * bx = aBatch.bx.data(); const float * by = aBatch.by.data();
+        const float * bz = aBatch.bz.data(); const float * bw = aBatch.bw.data();
+        const float * u = aBatch.u.data();
+
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            const float dot = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+            const float cosine = std::abs(dot);
+            const float sign = (dot < 0.f) ? -1.f : 1.f;
+
+            float wa = 1.f - u[i];
+            float wb = u[i];
+            // Close rotations fall back to the linear weights (sin(theta) vanishes).
+            if (cosine < 0.9995f)
+            {
+                const float theta = std::acos(cosine);
+                const float inverseSine = 1.f / std::sin(theta);
+                wa = std::sin(wa * theta) * inverseSine;
+                wb = std::sin(wb * theta) * inverseSine;
+            }
+            wb *= sign;
+
+            const float x = wa * ax[i] + wb * bx[i];
+            const float y = wa * ay[i] + wb * by[i];
+            const float z = wa * az[i] + wb * bz[i];
+            const float w = wa * aw[i] + wb * bw[i];
+            const float inverseNorm = 1.f / std::sqrt(x*x + y*y + z*z + w*w);
+            ax[i] = x * inverseNorm;
+            ay[i] = y * inverseNorm;
+            az[i] = z * inverseNorm;
+            aw[i] = w * inverseNorm;
+        }
+    }
+
+
+    void write(SceneGraph & aScene,
+               SceneGraph::NodeId aTarget,
+               animation::Target::Path aPath,
+               const float * aValue)
+    {
+        switch(aPath)
+        {
+            case animation::Target::Path::Translation:
+                aScene.setTranslation(aTarget, aValue[0], aValue[1], aValue[2]);
+                break;
+            case animation::Target::Path::Rotation:
+                aScene.setRotation(aTarget, aValue[0], aValue[1], aValue[2], aValue[3]);
+                break;
+            case animation::Target::Path::Scale:
+                aScene.setScale(aTarget, aValue[0], aValue[1], aValue[2]);
+                break;
+            case animation::Target::Path::Weights:
+                break;
+        }
+    }
+
+} // anonymous namespace
+
+
+AnimationEngine::AnimationEngine(const Gltf & aGltf, BufferCache & aBuffers)
+{
+    for (Const_Owned<Animation> animation : aGltf.getAnimations())
+    {
+        Clip & clip = mClips.emplace_back();
+        for (const animation::Channel & channel : animation->channels)
+        {
+            const animation::Sampler & sampler = animation->samplers.at(channel.sampler);
+            const Accessor & input = aGltf.get(sampler.input);
+            const Accessor & output = aGltf.get(sampler.output);
+
+            Track track{
+                .path = channel.target.path,
+                .interpolation = sampler.interpolation,
+                .node = channel.target.node,
+                .componentCount = 0, // deduced below
+                .times = readAsFloats(aBuffers, input),
+                .values = readAsFloats(aBuffers, output),
+            };
+
+            const std::size_t keyframes = track.times.size();
+            const std::size_t valuesPerKeyframe =
+                (track.interpolation == animation::Sampler::Interpolation::CubicSpline) ? 3 : 1;
+            if (keyframes == 0 || track.values.size() % (keyframes * valuesPerKeyframe) != 0)
+            {
+                throw std::invalid_argument{"Animation '" + std::string{animation->name}
+                                            + "' has a sampler with mismatched input and output counts."};
+            }
+            track.componentCount =
+                static_cast<std::uint32_t>(track.values.size() / (keyframes * valuesPerKeyframe));
+
+            clip.duration = std::max(clip.duration, track.times.back());
+            clip.tracks.push_back(std::move(track));
+        }
+    }
+}
+
+
+AnimationEngine::Instance AnimationEngine::instantiate(Index<Animation> aAnimation, SceneGraph & aScene) const
+{
+    const Clip & clip = getClip(aAnimation);
+
+    Instance instance{
+        .animation = aAnimation,
+        .scene = &aScene,
+        .targets = {},
+        .cursors = {},
+        .weightOffsets = {},
+        .weights = {},
+    };
+
+    for (const Track & track : clip.tracks)
+    {
+        std::optional<SceneGraph::NodeId> target = track.node ? aScene.find(*track.node) : std::nullopt;
+        instance.targets.push_back(target.value_or(SceneGraph::gNoParent));
+        instance.cursors.push_back(0);
+        instance.weightOffsets.push_back(static_cast<std::uint32_t>(instance.weights.size()));
+        if (track.path == animation::Target::Path::Weights)
+        {
+            instance.weights.resize(instance.weights.size() + track.componentCount, 0.f);
+        }
+    }
+
+    return instance;
+}
+
+
+void AnimationEngine::evaluate(std::span<Instance> aInstances, bool aParallel) const
+{
+    if (aParallel)
+    {
+        detail::parallelFor(aInstances.size(),
+                            [&](std::size_t aIndex){ evaluate(aInstances[aIndex]); },
+                            gInstancesGrain);
+    }
+    else
+    {
+        for (Instance & instance : aInstances)
+        {
+            evaluate(instance);
+        }
+    }
+}
+
+
+void AnimationEngine::evaluate(Instance & aInstance) const
+{
+    using Interpolation = animation::Sampler::Interpolation;
+    using Path = animation::Target::Path;
+
+    // Reused between evaluations on the same thread, to avoid allocations.
+    thread_local RotationBatch rotations;
+    thread_local std::vector<float> result;
+    rotations.clear();
+
+    const Clip & clip = getClip(aInstance.animation);
+    SceneGraph & scene = *aInstance.scene;
+    const float time = aInstance.time;
+
+    for (std::size_t trackId = 0; trackId != clip.tracks.size(); ++trackId)
+    {
+        const Track & track = clip.tracks[trackId];
+        const SceneGraph::NodeId target = aInstance.targets[trackId];
+        if (target == SceneGraph::gNoParent && track.path != Path::Weights)
+        {
+            continue;
+        }
+
+        const std::uint32_t keyframe = advanceCursor(track.times, aInstance.cursors[trackId], time);
+        aInstance.cursors[trackId] = keyframe;
+
+        const std::size_t components = track.componentCount;
+        const bool isCubic = track.interpolation == Interpolation::CubicSpline;
+        const std::size_t keyframeStride = components * (isCubic ? 3 : 1);
+        // Skip the in-tangent to get the value of a cubic spline keyframe.
+        const std::size_t valueOffset = isCubic ? components : 0;
+        auto value = [&](std::size_t aKeyframe) -> const float *
+        {
+            return track.values.data() + aKeyframe * keyframeStride + valueOffset;
+        };
+
+        result.resize(components);
+        float * output = result.data();
+
+        const bool isClamped = time <= track.times.front() || keyframe + 1 == track.times.size();
+        if (isClamped || track.interpolation == Interpolation::Step)
+        {
+            std::copy_n(value(keyframe), components, output);
+        }
+        else
+        {
+            const float t0 = track.times[keyframe];
+            const float delta = track.times[keyframe + 1] - t0;
+            const float u = (time - t0) / delta;
+            const float * from = value(keyframe);
+            const float * to = value(keyframe + 1);
+
+            if (track.interpolation == Interpolation::Linear)
+            {
+                if (track.path == Path::Rotation)
+                {
+                    rotations.push(from, to, u, target);
+                    continue;
+                }
+                for (std::size_t componentId = 0; componentId != components; ++componentId)
+                {
+                    output[componentId] = from[componentId] + u * (to[componentId] - from[componentId]);
+                }
+            }
+            else // Cubic Hermite spline
+            {
+                // see: https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#interpolation-cubic
+                const float * outTangent = from + components;
+                const float * inTangent = to - components;
+                const float u2 = u * u;
+                const float u3 = u2 * u;
+                const float h00 = 2.f * u3 - 3.f * u2 + 1.f;
+                const float h10 = (u3 - 2.f * u2 + u) * delta;
+                const float h01 = -2.f * u3 + 3.f * u2;
+                const float h11 = (u3 - u2) * delta;
+                for (std::size_t componentId = 0; componentId != components; ++componentId)
+                {
+                    output[componentId] = h00 * from[componentId] + h10 * outTangent[componentId]
+                                        + h01 * to[componentId] + h11 * inTangent[componentId];
+                }
+                if (track.path == Path::Rotation)
+                {
+                    const float inverseNorm = 1.f / std::sqrt(output[0] * output[0] + output[1] * output[1]
+                                                              + output[2] * output[2] + output[3] * output[3]);
+                    for (std::size_t componentId = 0; componentId != 4; ++componentId)
+                    {
+                        output[componentId] *= inverseNorm;
+                    }
+                }
+            }
+        }
+
+        if (track.path == Path::Weights)
+        {
+            std::copy_n(output, components, aInstance.weights.begin() + aInstance.weightOffsets[trackId]);
+        }
+        else
+        {
+            write(scene, target, track.path, output);
+        }
+    }
+
+    //
+    // Batched rotation interpolation, written directly in the scene SoA arrays.
+    //
+    if (rotationInterpolation == RotationInterpolation::Nlerp)
+    {
+        nlerp(rotations);
+    }
+    else
+    {
+        slerp(rotations);
+    }
+
+    SceneGraph::TrsArrays & poses = scene.accessLocalPoses();
+    for (std::size_t rotationId = 0; rotationId != rotations.targets.size(); ++rotationId)
+    {
+        const SceneGraph::NodeId target = rotations.targets[rotationId];
+        poses.rx[target] = rotations.ax[rotationId];
+        poses.ry[target] = rotations.ay[rotationId];
+        poses.rz[target] = rotations.az[rotationId];
+        poses.rw[target] = rotations.aw[rotationId];
+        scene.markLocalDirty(target);
+    }
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
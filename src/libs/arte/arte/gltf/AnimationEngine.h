@@ -0,0 +1,91 @@
+#pragma once
+
+
+#include "Accessor.h"
+#include "Gltf.h"
+#include "SceneGraph.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Evaluates glTF animations, writing the animated poses into SceneGraph local TRS arrays.
+///
+/// Keyframe times and values are extracted once from the accessors at construction.
+/// Each playing animation is an `Instance`, keeping a cursor per channel to the current keyframe:
+/// when the time advances monotonically, finding the keyframe is O(1) (amortized).
+class AnimationEngine
+{
+public:
+    enum class RotationInterpolation
+    {
+        Nlerp, // Faster, and indistinguishable for dense keyframes.
+        Slerp,
+    };
+
+    /// @brief Extracted data of an animation channel.
+    struct Track
+    {
+        animation::Target::Path path;
+        animation::Sampler::Interpolation interpolation;
+        std::optional<Index<Node>> node;
+        // 3 for translation & scale, 4 for rotation, the number of morph targets for weights.
+        std::uint32_t componentCount;
+        std::vector<float> times;
+        // keyframes * componentCount values.
+        // For cubic spline, each keyframe is the triplet (in-tangent, value, out-tangent).
+        std::vector<float> values;
+    };
+
+    struct Clip
+    {
+        std::vector<Track> tracks;
+        float duration{0.f};
+    };
+
+    /// @brief A playing animation, bound to a SceneGraph.
+    struct Instance
+    {
+        Index<Animation> animation;
+        SceneGraph * scene;
+        float time{0.f};
+        // Per track
+        std::vector<SceneGraph::NodeId> targets; // gNoParent when the target is not in the scene.
+        std::vector<std::uint32_t> cursors;      // keyframe at, or just before, the last evaluated time.
+        std::vector<std::uint32_t> weightOffsets; // offset in `weights` (only meaningful for Weights tracks).
+        /// @brief Morph target weights of all Weights tracks, concatenated.
+        std::vector<float> weights;
+    };
+
+    AnimationEngine(const Gltf & aGltf, BufferCache & aBuffers);
+
+    const Clip & getClip(Index<Animation> aAnimation) const
+    { return mClips.at(aAnimation); }
+
+    Instance instantiate(Index<Animation> aAnimation, SceneGraph & aScene) const;
+
+    /// @brief Evaluate each instance at its current `time`, writing into its scene local poses.
+    ///
+    /// Times before the first keyframe (resp. after the last) are clamped to it.
+    /// @param aParallel If true, instances are distributed over worker threads.
+    /// @attention When evaluating in parallel, distinct instances must not animate the same nodes.
+    void evaluate(std::span<Instance> aInstances, bool aParallel = true) const;
+
+    RotationInterpolation rotationInterpolation{RotationInterpolation::Nlerp};
+
+private:
+    void evaluate(Instance & aInstance) const;
+
+    std::vector<Clip> mClips;
+};
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,759 @@
+#include "Bvh.h"
+
+#include "../detail/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    constexpr std::size_t gBinCount = 16;
+    constexpr std::uint32_t gMaxLeafSize = 4;
+    // SAH cost of traversing a node, relative to testing a box.
+    constexpr float gTraversalCost = 1.f;
+    // Subtrees smaller than this are built by a single worker.
+    constexpr std::uint32_t gMinimumTaskSize = 1024;
+    // Boxes whose world bounds are recomputed by each parallel task.
+    constexpr std::size_t gBoundsGrain = 1024;
+    // Traversals only allocate for hierarchies deeper than this (e.g. very unevenly distributed boxes).
+    constexpr std::size_t gInlineStackSize = 32;
+
+    constexpr std::uint32_t gAllPlanes = 0b111111;
+
+
+    float centroid(const Aabb & aBox, std::size_t aAxis)
+    { return 0.5f * (aBox.min[aAxis] + aBox.max[aAxis]); }
+
+
+    /// @brief Traversal stack stored inline up to gInlineStackSize entries, then growing on the heap.
+    template <class T_entry>
+    class TraversalStack
+    {
+    public:
+        bool empty() const
+        { return mSize == 0; }
+
+        void push(T_entry aEntry)
+        {
+            if (mSize < gInlineStackSize)
+            {
+                mInline[mSize] = aEntry;
+            }
+            else
+            {
+                mDeep.push_back(aEntry);
+            }
+            ++mSize;
+        }
+
+        T_entry pop()
+        {
+            if (--mSize < gInlineStackSize)
+            {
+                return mInline[mSize];
+            }
+            T_entry entry = mDeep.back();
+            mDeep.pop_back();
+            return entry;
+        }
+
+    private:
+        std::array<T_entry, gInlineStackSize> mInline;
+        std::vector<T_entry> mDeep;
+        std::size_t mSize{0};
+    };
+
+
+    class Builder
+    {
+    public:
+        Builder(std::span<const Aabb> aBoxes, std::vector<std::uint32_t> & aOrder) :
+            mBoxes{aBoxes},
+            mOrder{aOrder}
+        {}
+
+        /// @brief Build the subtree of the order range, appending its nodes depth-first to aNodes.
+        /// @param aTasks If not null, ranges below gMinimumTaskSize are not built, but recorded as tasks
+        /// (their placeholder node has the `right` member set to gTaskNode).
+        std::uint32_t build(std::vector<Bvh::Node> & aNodes,
+                            std::uint32_t aFirst,
+                            std::uint32_t aCount,
+                            std::vector<std::pair<std::uint32_t, std::uint32_t>> * aTasks);
+
+        static constexpr std::uint32_t gTaskNode = std::numeric_limits<std::uint32_t>::max();
+
+    private:
+        /// @return The count of boxes going to the left child, 0 if the range should stay a leaf.
+        std::uint32_t split(std::uint32_t aFirst, std::uint32_t aCount, const Aabb & aBounds);
+
+        std::span<const Aabb> mBoxes;
+        std::vector<std::uint32_t> & mOrder;
+    };
+
+
+    std::uint32_t Builder::build(std::vector<Bvh::Node> & aNodes,
+                                 std::uint32_t aFirst,
+                                 std::uint32_t aCount,
+                                 std::vector<std::pair<std::uint32_t, std::uint32_t>> * aTasks)
+    {
+        const auto nodeIndex = static_cast<std::uint32_t>(aNodes.size());
+        Bvh::Node node{.bounds = Aabb::Empty(), .first = aFirst, .count = aCount, .right = 0};
+        for (std::uint32_t position = aFirst; position != aFirst + aCount; ++position)
+        {
+            node.bounds.extend(mBoxes[mOrder[position]]);
+        }
+        aNodes.push_back(node);
+
+        if (aTasks != nullptr && aCount < gMinimumTaskSize)
+        {
+            aNodes[nodeIndex].right = gTaskNode;
+            aTasks->emplace_back(aFirst, aCount);
+            return nodeIndex;
+        }
+
+        if (std::uint32_t leftCount = split(aFirst, aCount, node.bounds); leftCount != 0)
+        {
+            build(aNodes, aFirst, leftCount, aTasks);
+            const std::uint32_t right = build(aNodes, aFirst + leftCount, aCount - leftCount, aTasks);
+            aNodes[nodeIndex].right = right;
+        }
+        return nodeIndex;
+    }
+
+
+    std::uint32_t Builder::split(std::uint32_t aFirst, std::uint32_t aCount, const Aabb & aBounds)
+    {
+        if (aCount <= 1)
+        {
+            return 0;
+        }
+
+        Aabb centroids = Aabb::Empty();
+        for (std::uint32_t position = aFirst; position != aFirst + aCount; ++position)
+        {
+            const Aabb & box = mBoxes[mOrder[position]];
+            for (std::size_t axis = 0; axis != 3; ++axis)
+            {
+                const float value = centroid(box, axis);
+                centroids.min[axis] = std::min(centroids.min[axis], value);
+                centroids.max[axis] = std::max(centroids.max[axis], value);
+            }
+        }
+
+        struct Bin
+        {
+            Aabb bounds = Aabb::Empty();
+            std::uint32_t count = 0;
+        };
+
+        float bestCost = std::numeric_limits<float>::max();
+        std::size_t bestAxis = 0;
+        std::size_t bestBin = 0;
+        for (std::size_t axis = 0; axis != 3; ++axis)
+        {
+            const float extent = centroids.max[axis] - centroids.min[axis];
+            if (extent <= 0.f)
+            {
+                continue;
+            }
+            const float scale = gBinCount / extent;
+
+            std::array<Bin, gBinCount> bins;
+            for (std::uint32_t position = aFirst; position != aFirst + aCount; ++position)
+            {
+                const Aabb & box = mBoxes[mOrder[position]];
+                auto binId = std::min(gBinCount - 1,
+                                      static_cast<std::size_t>((centroid(box, axis) - centroids.min[axis]) * scale));
+                bins[binId].bounds.extend(box);
+                ++bins[binId].count;
+            }
+
+            // Sweep from the right to get the cost of each right side, then from the left.
+            std::array<float, gBinCount> rightCosts;
+            Aabb accumulated = Aabb::Empty();
+            std::uint32_t count = 0;
+            for (std::size_t binId = gBinCount - 1; binId != 0; --binId)
+            {
+                accumulated.extend(bins[binId].bounds);
+                count += bins[binId].count;
+                rightCosts[binId] = (count == 0) ? 0.f : accumulated.surfaceArea() * count;
+            }
+            accumulated = Aabb::Empty();
+            count = 0;
+            for (std::size_t binId = 0; binId != gBinCount - 1; ++binId)
+            {
+                accumulated.extend(bins[binId].bounds);
+                count += bins[binId].count;
+                const float cost = ((count == 0) ? 0.f : accumulated.surfaceArea() * count) + rightCosts[binId + 1];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = binId;
+                }
+            }
+        }
+
+        const float leafCost = aBounds.surfaceArea() * aCount;
+        if (aCount <= gMaxLeafSize && leafCost <= bestCost + gTraversalCost * aBounds.surfaceArea())
+        {
+            return 0;
+        }
+
+        std::uint32_t * begin = mOrder.data() + aFirst;
+        std::uint32_t * end = begin + aCount;
+        std::uint32_t * middle = end;
+        if (bestCost != std::numeric_limits<float>::max())
+        {
+            const float extent = centroids.max[bestAxis] - centroids.min[bestAxis];
+            const float scale = gBinCount / extent;
+            middle = std::partition(begin, end, [&](std::uint32_t aBox)
+            {
+                auto binId = std::min(gBinCount - 1,
+                                      static_cast<std::size_t>((centroid(mBoxes[aBox], bestAxis)
+                                                                - centroids.min[bestAxis]) * scale));
+                return binId <= bestBin;
+            });
+        }
+        if (middle == begin || middle == end)
+        {
+            // All centroids coincide (or fell in the same bin): median split, to guarantee progress.
+            middle = begin + aCount / 2;
+        }
+        return static_cast<std::uint32_t>(middle - begin);
+    }
+
+
+    /// @brief Test a box against the planes of aMask.
+    /// @return -1 if outside, otherwise the mask of planes intersecting the box (0 when fully inside).
+    int classify(const Aabb & aBox, const Frustum & aFrustum, std::uint32_t aMask)
+    {
+        std::uint32_t intersecting = 0;
+        for (std::size_t planeId = 0; planeId != 6; ++planeId)
+        {
+            if ((aMask & (1u << planeId)) == 0)
+            {
+                continue;
+            }
+            const auto & [a, b, c, d] = aFrustum.planes[planeId];
+            // Corner furthest along the plane normal, and the opposite one.
+            const float farthest = a * (a >= 0.f ? aBox.max[0] : aBox.min[0])
+                                 + b * (b >= 0.f ? aBox.max[1] : aBox.min[1])
+                                 + c * (c >= 0.f ? aBox.max[2] : aBox.min[2]) + d;
+            if (farthest < 0.f)
+            {
+                return -1;
+            }
+            const float nearest = a * (a >= 0.f ? aBox.min[0] : aBox.max[0])
+                                + b * (b >= 0.f ? aBox.min[1] : aBox.max[1])
+                                + c * (c >= 0.f ? aBox.min[2] : aBox.max[2]) + d;
+            if (nearest < 0.f)
+            {
+                intersecting |= (1u << planeId);
+            }
+        }
+        return static_cast<int>(intersecting);
+    }
+
+
+    /// @brief Slab test, returns the entry distance or a negative value when missed.
+    float intersect(const Aabb & aBox, const Ray & aRay, const std::array<float, 3> & aInverseDirection, float aMaxDistance)
+    {
+        float near = 0.f;
+        float far = aMaxDistance;
+        for (std::size_t axis = 0; axis != 3; ++axis)
+        {
+            float t0 = (aBox.min[axis] - aRay.origin[axis]) * aInverseDirection[axis];
+            float t1 = (aBox.max[axis] - aRay.origin[axis]) * aInverseDirection[axis];
+            if (t0 > t1)
+            {
+                std::swap(t0, t1);
+            }
+            // NaN (0 * infinity, when the origin lies on a slab with a parallel direction) is ignored.
+            near = (t0 > near) ? t0 : near;
+            far = (t1 < far) ? t1 : far;
+            if (near > far)
+            {
+                return -1.f;
+            }
+        }
+        return near;
+    }
+
+} // anonymous namespace
+
+
+//
+// Aabb
+//
+void Aabb::extend(const Aabb & aOther)
+{
+    for (std::size_t axis = 0; axis != 3; ++axis)
+    {
+        min[axis] = std::min(min[axis], aOther.min[axis]);
+        max[axis] = std::max(max[axis], aOther.max[axis]);
+    }
+}
+
+
+float Aabb::surfaceArea() const
+{
+    const float x = max[0] - min[0];
+    const float y = max[1] - min[1];
+    const float z = max[2] - min[2];
+    return (x < 0.f) ? 0.f : 2.f * (x * y + y * z + z * x);
+}
+
+
+Aabb transform(const Aabb & aLocal, const Affine & aTransformation)
+{
+    Aabb result{
+        {aTransformation.at(3, 0), aTransformation.at(3, 1), aTransformation.at(3, 2)},
+        {aTransformation.at(3, 0), aTransformation.at(3, 1), aTransformation.at(3, 2)},
+    };
+    for (std::size_t row = 0; row != 3; ++row)
+    {
+        for (std::size_t column = 0; column != 3; ++column)
+        {
+            const float a = aTransformation.at(row, column) * aLocal.min[row];
+            const float b = aTransformation.at(row, column) * aLocal.max[row];
+            result.min[column] += std::min(a, b);
+            result.max[column] += std::max(a, b);
+        }
+    }
+    return result;
+}
+
+
+//
+// Frustum
+//
+Frustum Frustum::FromViewProjection(std::span<const float, 16> aViewProjection)
+{
+    // Row-vector convention: clip coordinate j is the dot product with column j.
+    auto column = [&](std::size_t aColumn)
+    {
+        return std::array<float, 4>{
+            aViewProjection[aColumn], aViewProjection[4 + aColumn],
+            aViewProjection[8 + aColumn], aViewProjection[12 + aColumn]
+        };
+    };
+    const std::array<float, 4> w = column(3);
+
+    Frustum result;
+    for (std::size_t axis = 0; axis != 3; ++axis)
+    {
+        const std::array<float, 4> coordinate = column(axis);
+        for (std::size_t component = 0; component != 4; ++component)
+        {
+            result.planes[2 * axis][component] = w[component] + coordinate[component];     // -w <= coordinate
+            result.planes[2 * axis + 1][component] = w[component] - coordinate[component]; // coordinate <= w
+        }
+    }
+
+    // Normalization makes the plane equations distances (useful for bounding spheres tests).
+    for (std::array<float, 4> & plane : result.planes)
+    {
+        const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.f)
+        {
+            for (float & component : plane)
+            {
+                component /= length;
+            }
+        }
+    }
+    return result;
+}
+
+
+//
+// Bvh
+//
+Bvh::Bvh(std::span<const Aabb> aBoxes) :
+    mOrder(aBoxes.size())
+{
+    if (aBoxes.size() >= std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::length_error{"Too many boxes for the BVH."};
+    }
+    if (aBoxes.empty())
+    {
+        return;
+    }
+    std::iota(mOrder.begin(), mOrder.end(), 0);
+
+    Builder builder{aBoxes, mOrder};
+    const auto count = static_cast<std::uint32_t>(aBoxes.size());
+
+    if (count < gMinimumTaskSize)
+    {
+        builder.build(mNodes, 0, count, nullptr);
+        linkNodes();
+        return;
+    }
+
+    //
+    // Top levels on the calling thread, until subtrees are small enough to become tasks.
+    // Tasks work on disjoint ranges of the order, so they can partition it concurrently.
+    //
+    std::vector<Node> top;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> tasks;
+    builder.build(top, 0, count, &tasks);
+
+    std::vector<std::vector<Node>> subtrees(tasks.size());
+    detail::parallelFor(tasks.size(), [&](std::size_t aTaskId)
+    {
+        Builder{aBoxes, mOrder}.build(subtrees[aTaskId], tasks[aTaskId].first, tasks[aTaskId].second, nullptr);
+    });
+
+    //
+    // Splice the subtrees in place of their placeholders, keeping the depth-first layout.
+    //
+    mNodes.reserve(top.size() + std::accumulate(subtrees.begin(), subtrees.end(), std::size_t{0},
+                                                [](std::size_t aSum, const auto & aSubtree)
+                                                { return aSum + aSubtree.size(); }));
+    std::size_t nextTask = 0; // Placeholders are met in the same depth-first order as the tasks were recorded.
+    auto emit = [&](auto & aSelf, std::uint32_t aTopIndex) -> void
+    {
+        const Node & node = top[aTopIndex];
+        if (node.right == Builder::gTaskNode)
+        {
+            const auto offset = static_cast<std::uint32_t>(mNodes.size());
+            for (Node subtreeNode : subtrees[nextTask++])
+            {
+                if (subtreeNode.right != 0)
+                {
+                    subtreeNode.right += offset;
+                }
+                mNodes.push_back(subtreeNode);
+            }
+        }
+        else
+        {
+            const auto index = static_cast<std::uint32_t>(mNodes.size());
+            mNodes.push_back(node);
+            if (node.right != 0)
+            {
+                aSelf(aSelf, aTopIndex + 1);
+                mNodes[index].right = static_cast<std::uint32_t>(mNodes.size());
+                aSelf(aSelf, node.right);
+            }
+        }
+    };
+    emit(emit, 0);
+    linkNodes();
+}
+
+
+void Bvh::linkNodes()
+{
+    mParents.assign(mNodes.size(), gNoParent);
+    mLeaves.resize(mOrder.size());
+    mQueuedNodes.assign(mNodes.size(), 0);
+    for (std::uint32_t nodeIndex = 0; nodeIndex != mNodes.size(); ++nodeIndex)
+    {
+        const Node & node = mNodes[nodeIndex];
+        if (node.right == 0)
+        {
+            for (std::uint32_t position = node.first; position != node.first + node.count; ++position)
+            {
+                mLeaves[mOrder[position]] = nodeIndex;
+            }
+        }
+        else
+        {
+            mParents[nodeIndex + 1] = nodeIndex;
+            mParents[node.right] = nodeIndex;
+        }
+    }
+}
+
+
+Aabb Bvh::computeBounds(std::uint32_t aNodeIndex, std::span<const Aabb> aBoxes) const
+{
+    const Node & node = mNodes[aNodeIndex];
+    Aabb bounds = Aabb::Empty();
+    if (node.right == 0)
+    {
+        for (std::uint32_t position = node.first; position != node.first + node.count; ++position)
+        {
+            bounds.extend(aBoxes[mOrder[position]]);
+        }
+    }
+    else
+    {
+        bounds = mNodes[aNodeIndex + 1].bounds;
+        bounds.extend(mNodes[node.right].bounds);
+    }
+    return bounds;
+}
+
+
+void Bvh::refit(std::span<const Aabb> aBoxes, std::span<const std::uint32_t> aChangedBoxes)
+{
+    // Children always follow their parent.
+    if (aChangedBoxes.size() * gFullRefitRatio > mNodes.size())
+    {
+        // Most paths are dirty: a single backward sweep is cheaper than maintaining the heap.
+        for (std::size_t nodeIndex = mNodes.size(); nodeIndex-- != 0;)
+        {
+            mNodes[nodeIndex].bounds = computeBounds(static_cast<std::uint32_t>(nodeIndex), aBoxes);
+        }
+        return;
+    }
+
+    // Popping the largest pending index first recomputes all the pending children of a node
+    // before the node itself.
+    auto enqueue = [this](std::uint32_t aNodeIndex)
+    {
+        if (mQueuedNodes[aNodeIndex] == 0)
+        {
+            mQueuedNodes[aNodeIndex] = 1;
+            mPendingNodes.push_back(aNodeIndex);
+            std::push_heap(mPendingNodes.begin(), mPendingNodes.end());
+        }
+    };
+
+    for (std::uint32_t box : aChangedBoxes)
+    {
+        enqueue(mLeaves[box]);
+    }
+
+    while (!mPendingNodes.empty())
+    {
+        std::pop_heap(mPendingNodes.begin(), mPendingNodes.end());
+        const std::uint32_t nodeIndex = mPendingNodes.back();
+        mPendingNodes.pop_back();
+        mQueuedNodes[nodeIndex] = 0;
+
+        const Aabb bounds = computeBounds(nodeIndex, aBoxes);
+        if (bounds != mNodes[nodeIndex].bounds)
+        {
+            mNodes[nodeIndex].bounds = bounds;
+            if (mParents[nodeIndex] != gNoParent)
+            {
+                enqueue(mParents[nodeIndex]);
+            }
+        }
+    }
+}
+
+
+void Bvh::cull(const Frustum & aFrustum, std::span<const Aabb> aBoxes, std::vector<std::uint32_t> & aVisible) const
+{
+    if (mNodes.empty())
+    {
+        return;
+    }
+
+    struct Entry
+    {
+        std::uint32_t node;
+        std::uint32_t planes; // planes the parent intersected, the only ones left to test
+    };
+    TraversalStack<Entry> stack;
+    stack.push({0, gAllPlanes});
+
+    while (!stack.empty())
+    {
+        const Entry entry = stack.pop();
+        const Node & node = mNodes[entry.node];
+        const int classification = classify(node.bounds, aFrustum, entry.planes);
+        if (classification < 0)
+        {
+            continue;
+        }
+        if (classification == 0)
+        {
+            // Fully inside: the whole subtree is visible.
+            aVisible.insert(aVisible.end(), mOrder.begin() + node.first, mOrder.begin() + node.first + node.count);
+        }
+        else if (node.right == 0)
+        {
+            for (std::uint32_t position = node.first; position != node.first + node.count; ++position)
+            {
+                if (classify(aBoxes[mOrder[position]], aFrustum, static_cast<std::uint32_t>(classification)) >= 0)
+                {
+                    aVisible.push_back(mOrder[position]);
+                }
+            }
+        }
+        else
+        {
+            stack.push({node.right, static_cast<std::uint32_t>(classification)});
+            stack.push({entry.node + 1, static_cast<std::uint32_t>(classification)});
+        }
+    }
+}
+
+
+std::optional<Bvh::Hit> Bvh::pick(const Ray & aRay, std::span<const Aabb> aBoxes) const
+{
+    if (mNodes.empty())
+    {
+        return std::nullopt;
+    }
+
+    const std::array<float, 3> inverseDirection{1.f / aRay.direction[0], 1.f / aRay.direction[1], 1.f / aRay.direction[2]};
+
+    std::optional<Hit> closest;
+    float closestDistance = std::numeric_limits<float>::infinity();
+
+    TraversalStack<std::uint32_t> stack;
+    if (intersect(mNodes[0].bounds, aRay, inverseDirection, closestDistance) >= 0.f)
+    {
+        stack.push(0);
+    }
+
+    while (!stack.empty())
+    {
+        const Node & node = mNodes[stack.pop()];
+        if (node.right == 0)
+        {
+            for (std::uint32_t position = node.first; position != node.first + node.count; ++position)
+            {
+                const float distance = intersect(aBoxes[mOrder[position]], aRay, inverseDirection, closestDistance);
+                if (distance >= 0.f && distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    closest = Hit{.box = mOrder[position], .distance = distance};
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearest child first, so the farther one is more likely to be pruned.
+        const std::uint32_t left = static_cast<std::uint32_t>(&node - mNodes.data()) + 1;
+        const float leftDistance = intersect(mNodes[left].bounds, aRay, inverseDirection, closestDistance);
+        const float rightDistance = intersect(mNodes[node.right].bounds, aRay, inverseDirection, closestDistance);
+        const bool leftFirst = leftDistance >= 0.f && (rightDistance < 0.f || leftDistance <= rightDistance);
+        if (leftFirst)
+        {
+            if (rightDistance >= 0.f) { stack.push(node.right); }
+            stack.push(left);
+        }
+        else
+        {
+            if (leftDistance >= 0.f) { stack.push(left); }
+            if (rightDistance >= 0.f) { stack.push(node.right); }
+        }
+    }
+
+    return closest;
+}
+
+
+//
+// SceneBvh
+//
+SceneBvh::SceneBvh(BufferCache & aBuffers, const SceneGraph & aScene) :
+    mScene{aScene}
+{
+    const Gltf & gltf = aBuffers.getGltf();
+
+    std::map<std::size_t, Aabb> meshBounds;
+    auto getMeshBounds = [&](Index<Mesh> aMesh) -> const Aabb &
+    {
+        auto [found, inserted] = meshBounds.try_emplace(aMesh, Aabb::Empty());
+        if (inserted)
+        {
+            for (const Primitive & primitive : gltf.get(aMesh)->primitives)
+            {
+                auto position = primitive.attributes.find("POSITION");
+                if (position == primitive.attributes.end())
+                {
+                    continue;
+                }
+                const Accessor & accessor = gltf.get(position->second);
+                using MinMax = Accessor::MinMax<float>;
+                if (const MinMax * minMax = accessor.bounds ? std::get_if<MinMax>(&*accessor.bounds) : nullptr;
+                    minMax != nullptr && minMax->min.size() == 3 && minMax->max.size() == 3)
+                {
+                    found->second.extend({{minMax->min[0], minMax->min[1], minMax->min[2]},
+                                          {minMax->max[0], minMax->max[1], minMax->max[2]}});
+                }
+                else
+                {
+                    // Bounds are mandatory for POSITION, but be lenient with non-float (e.g. quantized) ones.
+                    std::vector<float> positions = readAsFloats(aBuffers, accessor);
+                    for (std::size_t vertex = 0; vertex + 2 < positions.size(); vertex += 3)
+                    {
+                        found->second.extend({{positions[vertex], positions[vertex + 1], positions[vertex + 2]},
+                                              {positions[vertex], positions[vertex + 1], positions[vertex + 2]}});
+                    }
+                }
+            }
+        }
+        return found->second;
+    };
+
+    for (SceneGraph::NodeId id = 0; id != aScene.size(); ++id)
+    {
+        if (std::optional<Index<Mesh>> mesh = gltf.get(aScene.getNode(id))->mesh)
+        {
+            mInstances.push_back({id, *mesh});
+            mLocalBounds.push_back(getMeshBounds(*mesh));
+        }
+    }
+
+    mWorldBounds.resize(mInstances.size());
+    mChanged.resize(mInstances.size(), 0);
+    rebuild();
+}
+
+
+void SceneBvh::rebuild()
+{
+    detail::parallelFor(mInstances.size(), [this](std::size_t aInstance)
+    {
+        mWorldBounds[aInstance] =
+            transform(mLocalBounds[aInstance], mScene.getWorldTransformation(mInstances[aInstance].node));
+    }, gBoundsGrain);
+    mBvh = Bvh{mWorldBounds};
+}
+
+
+void SceneBvh::refit()
+{
+    detail::parallelFor(mInstances.size(), [this](std::size_t aInstance)
+    {
+        const SceneGraph::NodeId node = mInstances[aInstance].node;
+        mChanged[aInstance] = mScene.isWorldChanged(node);
+        if (mChanged[aInstance])
+        {
+            mWorldBounds[aInstance] = transform(mLocalBounds[aInstance], mScene.getWorldTransformation(node));
+        }
+    }, gBoundsGrain);
+
+    mChangedInstances.clear();
+    for (std::uint32_t instance = 0; instance != mInstances.size(); ++instance)
+    {
+        if (mChanged[instance] != 0)
+        {
+            mChangedInstances.push_back(instance);
+        }
+    }
+    mBvh.refit(mWorldBounds, mChangedInstances);
+}
+
+
+void SceneBvh::cull(const Frustum & aFrustum, std::vector<std::uint32_t> & aVisible) const
+{
+    aVisible.clear();
+    mBvh.cull(aFrustum, mWorldBounds, aVisible);
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,175 @@
+#pragma once
+
+
+#include "Accessor.h"
+#include "Gltf.h"
+#include "SceneGraph.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+struct Aabb
+{
+    static constexpr Aabb Empty()
+    {
+        constexpr float infinity = std::numeric_limits<float>::infinity();
+        return {{infinity, infinity, infinity}, {-infinity, -infinity, -infinity}};
+    }
+
+    void extend(const Aabb & aOther);
+
+    float surfaceArea() const;
+
+    bool operator==(const Aabb &) const = default;
+
+    std::array<float, 3> min;
+    std::array<float, 3> max;
+};
+
+
+/// @brief Axis aligned bounding box of `aLocal` once transformed by `aTransformation` (Arvo's method).
+Aabb transform(const Aabb & aLocal, const Affine & aTransformation);
+
+
+/// @brief Six planes `(a, b, c, d)`, a point being inside when `a*x + b*y + c*z + d >= 0` for all of them.
+struct Frustum
+{
+    /// @brief Extract the planes from a view-projection matrix (Gribb & Hartmann).
+    /// @param aViewProjection Row-major row-vector matrix (the layout of `math::Matrix<4, 4, float>::data()`),
+    /// mapping world space to clip space with OpenGL conventions.
+    static Frustum FromViewProjection(std::span<const float, 16> aViewProjection);
+
+    std::array<std::array<float, 4>, 6> planes;
+};
+
+
+struct Ray
+{
+    std::array<float, 3> origin;
+    std::array<float, 3> direction;
+};
+
+
+/// @brief Bounding volume hierarchy over boxes, built with binned surface area heuristic.
+///
+/// Nodes are stored depth-first: the left child immediately follows its parent,
+/// and the boxes of a subtree are a contiguous range of `getOrder()`.
+class Bvh
+{
+public:
+    struct Node
+    {
+        Aabb bounds;
+        std::uint32_t first; // first position in the order of the subtree boxes
+        std::uint32_t count; // count of boxes in the subtree
+        std::uint32_t right; // index of the right child, 0 for leaves
+    };
+
+    struct Hit
+    {
+        std::uint32_t box;
+        float distance; // along the ray, in units of the ray direction length
+    };
+
+    Bvh() = default;
+
+    /// @brief Build the hierarchy, the top levels being split on the calling thread, then subtrees on workers.
+    explicit Bvh(std::span<const Aabb> aBoxes);
+
+    /// @brief Update node bounds after boxes moved, keeping the topology.
+    ///
+    /// Only the leaves containing the changed boxes and their ancestors are visited,
+    /// the propagation stopping at nodes whose bounds did not change.
+    /// When a large share of the boxes changed, all nodes are recomputed in a single sweep instead.
+    /// @param aChangedBoxes Indices of the boxes that changed since the last build or refit.
+    void refit(std::span<const Aabb> aBoxes, std::span<const std::uint32_t> aChangedBoxes);
+
+    /// @brief Append the indices of the boxes intersecting the frustum (conservatively) to aVisible.
+    void cull(const Frustum & aFrustum, std::span<const Aabb> aBoxes, std::vector<std::uint32_t> & aVisible) const;
+
+    /// @brief Closest box hit by the ray, if any.
+    std::optional<Hit> pick(const Ray & aRay, std::span<const Aabb> aBoxes) const;
+
+    std::span<const Node> getNodes() const
+    { return mNodes; }
+
+    std::span<const std::uint32_t> getOrder() const
+    { return mOrder; }
+
+private:
+    /// @brief Compute the parent of each node and the leaf of each box, used by refit().
+    void linkNodes();
+
+    Aabb computeBounds(std::uint32_t aNodeIndex, std::span<const Aabb> aBoxes) const;
+
+    static constexpr std::uint32_t gNoParent = std::numeric_limits<std::uint32_t>::max();
+    /// @brief refit() sweeps all nodes above one changed box per this many nodes.
+    static constexpr std::size_t gFullRefitRatio = 32;
+
+    std::vector<Node> mNodes;
+    std::vector<std::uint32_t> mOrder; // box indices, in leaf order
+    std::vector<std::uint32_t> mParents; // per node, gNoParent for the root
+    std::vector<std::uint32_t> mLeaves; // per box, the leaf containing it
+    // Reused by refit(), so it does not allocate.
+    std::vector<std::uint32_t> mPendingNodes; // max-heap
+    std::vector<std::uint8_t> mQueuedNodes;
+};
+
+
+/// @brief A world space BVH over the mesh instances of a SceneGraph.
+///
+/// Local bounds are the union of the POSITION accessor bounds of the mesh primitives.
+/// @note Skinned and morphed meshes are bounded by their rest pose.
+class SceneBvh
+{
+public:
+    struct Instance
+    {
+        SceneGraph::NodeId node;
+        Index<Mesh> mesh;
+    };
+
+    SceneBvh(BufferCache & aBuffers, const SceneGraph & aScene);
+
+    /// @brief Refit the hierarchy to the world transforms that changed during the last `SceneGraph::update()`.
+    void refit();
+
+    /// @brief Rebuild the hierarchy from the current world bounds, e.g. when refitting degraded it too much.
+    void rebuild();
+
+    /// @brief Write the indices (in `getInstances()`) of the instances intersecting the frustum.
+    void cull(const Frustum & aFrustum, std::vector<std::uint32_t> & aVisible) const;
+
+    std::optional<Bvh::Hit> pick(const Ray & aRay) const
+    { return mBvh.pick(aRay, mWorldBounds); }
+
+    std::span<const Instance> getInstances() const
+    { return mInstances; }
+
+    std::span<const Aabb> getWorldBounds() const
+    { return mWorldBounds; }
+
+private:
+    const SceneGraph & mScene;
+    std::vector<Instance> mInstances;
+    std::vector<Aabb> mLocalBounds;
+    std::vector<Aabb> mWorldBounds;
+    std::vector<std::uint8_t> mChanged;
+    std::vector<std::uint32_t> mChangedInstances;
+    Bvh mBvh;
+};
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,321 @@
+#include "Decomposition.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    // Transformations decomposed together, one per lane of the structure-of-arrays.
+    constexpr std::size_t gLanes = 8;
+    // The scaled Newton iteration converges in less than 10 iterations for condition numbers up to 1e8.
+    constexpr int gMaxIterations = 20;
+    // Squared Frobenius norm of the change of an iteration, below which it has converged.
+    constexpr float gTolerance = 1e-12f;
+    // Below this ratio of the determinant to the product of the row norms, a transformation is singular.
+    constexpr float gSingularity = 1e-6f;
+
+    // Cofactor (row * 3 + column) is x[a] * x[b] - x[p] * x[q], for the element indices {a, b, p, q}.
+    constexpr std::size_t gCofactorTerms[9][4] = {
+        {4, 8, 5, 7}, {5, 6, 3, 8}, {3, 7, 4, 6},
+        {7, 2, 8, 1}, {8, 0, 6, 2}, {6, 1, 7, 0},
+        {1, 5, 2, 4}, {2, 3, 0, 5}, {0, 4, 1, 3},
+    };
+
+    using Vec3 = std::array<float, 3>;
+
+    Vec3 cross(const Vec3 & aLhs, const Vec3 & aRhs)
+    {
+        return {
+            aLhs[1] * aRhs[2] - aLhs[2] * aRhs[1],
+            aLhs[2] * aRhs[0] - aLhs[0] * aRhs[2],
+            aLhs[0] * aRhs[1] - aLhs[1] * aRhs[0],
+        };
+    }
+
+    float dot(const Vec3 & aLhs, const Vec3 & aRhs)
+    { return aLhs[0] * aRhs[0] + aLhs[1] * aRhs[1] + aLhs[2] * aRhs[2]; }
+
+    Vec3 normalize(const Vec3 & aVector)
+    {
+        const float norm = std::sqrt(dot(aVector, aVector));
+        return {aVector[0] / norm, aVector[1] / norm, aVector[2] / norm};
+    }
+
+
+    /// @brief Replace the rows of a singular linear part by orthonormal rows with a positive determinant,
+    /// keeping the directions of its largest rows.
+    void completeRotation(std::array<Vec3, 3> & aRows)
+    {
+        const std::array<float, 3> norms{
+            std::sqrt(dot(aRows[0], aRows[0])),
+            std::sqrt(dot(aRows[1], aRows[1])),
+            std::sqrt(dot(aRows[2], aRows[2])),
+        };
+        std::array<std::size_t, 3> order{0, 1, 2};
+        std::sort(order.begin(), order.end(),
+                  [&](std::size_t aLhs, std::size_t aRhs){ return norms[aLhs] > norms[aRhs]; });
+
+        if (norms[order[0]] == 0.f)
+        {
+            aRows = {Vec3{1.f, 0.f, 0.f}, Vec3{0.f, 1.f, 0.f}, Vec3{0.f, 0.f, 1.f}};
+            return;
+        }
+
+        const Vec3 first = normalize(aRows[order[0]]);
+        auto orthogonalize = [&first](const Vec3 & aVector) -> Vec3
+        {
+            const float projection = dot(aVector, first);
+            return {aVector[0] - projection * first[0],
+                    aVector[1] - projection * first[1],
+                    aVector[2] - projection * first[2]};
+        };
+
+        Vec3 second = orthogonalize(aRows[order[1]]);
+        if (std::sqrt(dot(second, second)) <= gSingularity * norms[order[0]])
+        {
+            // Collapsed to a line: any direction orthogonal to it, starting from the least aligned axis.
+            const std::size_t axis = static_cast<std::size_t>(
+                std::min_element(first.begin(), first.end(),
+                                 [](float aLhs, float aRhs){ return std::abs(aLhs) < std::abs(aRhs); })
+                - first.begin());
+            Vec3 unit{0.f, 0.f, 0.f};
+            unit[axis] = 1.f;
+            second = orthogonalize(unit);
+        }
+        second = normalize(second);
+
+        aRows[order[0]] = first;
+        aRows[order[1]] = second;
+        aRows[order[2]] = cross(first, second);
+        // The sign of the collapsed axis is arbitrary, its scale is null.
+        if (dot(aRows[0], cross(aRows[1], aRows[2])) < 0.f)
+        {
+            for (float & component : aRows[order[2]])
+            {
+                component = -component;
+            }
+        }
+    }
+
+
+    /// @brief Unit quaternion of a rotation given by its rows (row-vector convention), with Shepperd's method.
+    std::array<float, 4> toQuaternion(const std::array<Vec3, 3> & m)
+    {
+        float x, y, z, w;
+        const float trace = m[0][0] + m[1][1] + m[2][2];
+        if (trace > 0.f)
+        {
+            const float s = 2.f * std::sqrt(trace + 1.f);
+            w = 0.25f * s;
+            x = (m[1][2] - m[2][1]) / s;
+            y = (m[2][0] - m[0][2]) / s;
+            z = (m[0][1] - m[1][0]) / s;
+        }
+        else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+        {
+            const float s = 2.f * std::sqrt(1.f + m[0][0] - m[1][1] - m[2][2]);
+            w = (m[1][2] - m[2][1]) / s;
+            x = 0.25f * s;
+            y = (m[0][1] + m[1][0]) / s;
+            z = (m[0][2] + m[2][0]) / s;
+        }
+        else if (m[1][1] > m[2][2])
+        {
+            const float s = 2.f * std::sqrt(1.f + m[1][1] - m[0][0] - m[2][2]);
+            w = (m[2][0] - m[0][2]) / s;
+            x = (m[0][1] + m[1][0]) / s;
+            y = 0.25f * s;
+            z = (m[1][2] + m[2][1]) / s;
+        }
+        else
+        {
+            const float s = 2.f * std::sqrt(1.f + m[2][2] - m[0][0] - m[1][1]);
+            w = (m[0][1] - m[1][0]) / s;
+            x = (m[0][2] + m[2][0]) / s;
+            y = (m[1][2] + m[2][1]) / s;
+            z = 0.25f * s;
+        }
+
+        // Both q and -q are the same rotation, keep the positive w so results are comparable.
+        const float norm = std::copysign(std::sqrt(x * x + y * y + z * z + w * w), w);
+        return {x / norm, y / norm, z / norm, w / norm};
+    }
+
+
+    /// @brief Decompose up to gLanes transformations.
+    void decomposeGroup(const Affine * aTransformations, std::size_t aCount, Trs * aOutput)
+    {
+        // Element (row * 3 + column) of the lane transformation is at [row * 3 + column][lane].
+        float linear[9][gLanes];
+        float x[9][gLanes];
+
+        // Start from a positive determinant, the mirroring being moved to the x axis.
+        for (std::size_t lane = 0; lane != gLanes; ++lane)
+        {
+            const Affine & transformation = (lane < aCount) ? aTransformations[lane] : Affine::Identity();
+            std::array<Vec3, 3> rows;
+            for (std::size_t row = 0; row != 3; ++row)
+            {
+                for (std::size_t column = 0; column != 3; ++column)
+                {
+                    rows[row][column] = linear[row * 3 + column][lane] = transformation.at(row, column);
+                }
+            }
+
+            const float determinant = dot(rows[0], cross(rows[1], rows[2]));
+            const float bound = std::sqrt(dot(rows[0], rows[0]))
+                              * std::sqrt(dot(rows[1], rows[1]))
+                              * std::sqrt(dot(rows[2], rows[2]));
+            if (std::abs(determinant) <= gSingularity * bound)
+            {
+                completeRotation(rows);
+            }
+            else if (determinant < 0.f)
+            {
+                rows[0] = {-rows[0][0], -rows[0][1], -rows[0][2]};
+            }
+
+            for (std::size_t element = 0; element != 9; ++element)
+            {
+                x[element][lane] = rows[element / 3][element % 3];
+            }
+        }
+
+        // Scaled Newton iteration X <- (gamma * X + X^-T / gamma) / 2 (Higham, 1986), branchless across lanes:
+        // each step is a loop over the contiguous lanes, so the compiler vectorizes it.
+        // Converged lanes are frozen, so the result of a lane does not depend on the others.
+        bool converged[gLanes] = {};
+        for (int iteration = 0; iteration != gMaxIterations; ++iteration)
+        {
+            // Cofactors, i.e. the inverse transpose times the determinant: rows are cross products of rows.
+            float c[9][gLanes];
+            for (std::size_t element = 0; element != 9; ++element)
+            {
+                const auto [a, b, p, q] = gCofactorTerms[element];
+                for (std::size_t lane = 0; lane != gLanes; ++lane)
+                {
+                    c[element][lane] = x[a][lane] * x[b][lane] - x[p][lane] * x[q][lane];
+                }
+            }
+
+            float determinant[gLanes];
+            float norm[gLanes] = {};
+            float cofactorNorm[gLanes] = {};
+            for (std::size_t lane = 0; lane != gLanes; ++lane)
+            {
+                determinant[lane] = x[0][lane] * c[0][lane] + x[1][lane] * c[1][lane] + x[2][lane] * c[2][lane];
+            }
+            for (std::size_t element = 0; element != 9; ++element)
+            {
+                for (std::size_t lane = 0; lane != gLanes; ++lane)
+                {
+                    norm[lane] += x[element][lane] * x[element][lane];
+                    cofactorNorm[lane] += c[element][lane] * c[element][lane];
+                }
+            }
+
+            // gamma = sqrt(|X^-1| / |X|) with Frobenius norms, where |X^-1| = |C| / determinant.
+            float scale[gLanes];
+            float cofactorScale[gLanes];
+            for (std::size_t lane = 0; lane != gLanes; ++lane)
+            {
+                const float gamma = std::sqrt(std::sqrt(cofactorNorm[lane] / norm[lane]) / determinant[lane]);
+                // A converged lane is frozen by the identity update X <- 1 * X + 0 * C.
+                scale[lane] = converged[lane] ? 1.f : 0.5f * gamma;
+                cofactorScale[lane] = converged[lane] ? 0.f : 0.5f / (gamma * determinant[lane]);
+            }
+
+            float delta[gLanes] = {};
+            for (std::size_t element = 0; element != 9; ++element)
+            {
+                for (std::size_t lane = 0; lane != gLanes; ++lane)
+                {
+                    const float current = x[element][lane];
+                    const float next = scale[lane] * current + cofactorScale[lane] * c[element][lane];
+                    delta[lane] += (next - current) * (next - current);
+                    x[element][lane] = next;
+                }
+            }
+
+            bool allConverged = true;
+            for (std::size_t lane = 0; lane != gLanes; ++lane)
+            {
+                converged[lane] = converged[lane] || delta[lane] <= gTolerance;
+                allConverged = allConverged && converged[lane];
+            }
+            if (allConverged)
+            {
+                break;
+            }
+        }
+
+        for (std::size_t lane = 0; lane != aCount; ++lane)
+        {
+            std::array<Vec3, 3> rotation;
+            for (std::size_t element = 0; element != 9; ++element)
+            {
+                rotation[element / 3][element % 3] = x[element][lane];
+            }
+
+            const Affine & transformation = aTransformations[lane];
+            Trs & trs = aOutput[lane];
+            trs.translation = {transformation.at(3, 0), transformation.at(3, 1), transformation.at(3, 2)};
+            trs.rotation = toQuaternion(rotation);
+            // Diagonal of linear * rotation^T: each row of the linear part is a scaled row of the rotation.
+            for (std::size_t row = 0; row != 3; ++row)
+            {
+                trs.scale[row] = linear[row * 3][lane] * rotation[row][0]
+                               + linear[row * 3 + 1][lane] * rotation[row][1]
+                               + linear[row * 3 + 2][lane] * rotation[row][2];
+            }
+        }
+    }
+
+} // anonymous namespace
+
+
+Trs decompose(const Affine & aTransformation)
+{
+    Trs result;
+    decomposeGroup(&aTransformation, 1, &result);
+    return result;
+}
+
+
+void decompose(std::span<const Affine> aTransformations, SceneGraph::TrsArrays & aOutput)
+{
+    aOutput.resize(aTransformations.size());
+
+    Trs group[gLanes];
+    for (std::size_t first = 0; first < aTransformations.size(); first += gLanes)
+    {
+        const std::size_t count = std::min(gLanes, aTransformations.size() - first);
+        decomposeGroup(aTransformations.data() + first, count, group);
+        for (std::size_t lane = 0; lane != count; ++lane)
+        {
+            const std::size_t index = first + lane;
+            const Trs & trs = group[lane];
+            aOutput.tx[index] = trs.translation[0];
+            aOutput.ty[index] = trs.translation[1];
+            aOutput.tz[index] = trs.translation[2];
+            aOutput.rx[index] = trs.rotation[0];
+            aOutput.ry[index] = trs.rotation[1];
+            aOutput.rz[index] = trs.rotation[2];
+            aOutput.rw[index] = trs.rotation[3];
+            aOutput.sx[index] = trs.scale[0];
+            aOutput.sy[index] = trs.scale[1];
+            aOutput.sz[index] = trs.scale[2];
+        }
+    }
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
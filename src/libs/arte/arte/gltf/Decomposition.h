@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include "Affine.h"
+#include "SceneGraph.h"
+
+#include <array>
+#include <span>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Translation, rotation and scale, composing as `makeAffine()`.
+struct Trs
+{
+    std::array<float, 3> translation;
+    std::array<float, 4> rotation; // unit quaternion (x, y, z, w), with w >= 0
+    std::array<float, 3> scale;
+};
+
+
+/// @brief Decompose an affine transformation into translation, rotation and scale.
+///
+/// The rotation is the orthogonal factor of the polar decomposition of the linear part
+/// (i.e. the closest rotation), computed with the scaled Newton iteration,
+/// and each scale component is the extent of the linear part along the matching rotated axis.
+/// This is exact for transformations composed from a TRS, and drops the shear of others.
+/// * A mirroring transformation gets a negative x scale.
+/// * A singular transformation gets a null scale on its collapsed axes.
+Trs decompose(const Affine & aTransformation);
+
+/// @brief Decompose each transformation, as the single transformation overload does.
+///
+/// Transformations are processed by groups, in structure-of-arrays, so the iteration vectorizes across them.
+/// @param aOutput Resized to the number of transformations.
+void decompose(std::span<const Affine> aTransformations, SceneGraph::TrsArrays & aOutput);
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,59 @@
+#include "DocumentArena.h"
+
+#include <cstring>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+void * DocumentArena::Counting::do_allocate(std::size_t aBytes, std::size_t aAlignment)
+{
+    void * result = mForward.allocate(aBytes, aAlignment);
+    mBytes += aBytes;
+    if (mBlocks)
+    {
+        ++*mBlocks;
+    }
+    return result;
+}
+
+
+void DocumentArena::Counting::do_deallocate(void * aPointer, std::size_t aBytes, std::size_t aAlignment)
+{
+    mBytes -= aBytes;
+    if (mBlocks)
+    {
+        --*mBlocks;
+    }
+    mForward.deallocate(aPointer, aBytes, aAlignment);
+}
+
+
+DocumentArena::DocumentArena(std::size_t aInitialSize) :
+    mResource{aInitialSize, &mUpstream}
+{}
+
+
+std::string_view DocumentArena::intern(std::string_view aString)
+{
+    if (aString.empty())
+    {
+        return {};
+    }
+
+    if (auto found = mInterned.find(aString); found != mInterned.end())
+    {
+        return *found;
+    }
+
+    auto * characters = static_cast<char *>(mUsed.allocate(aString.size(), alignof(char)));
+    std::memcpy(characters, aString.data(), aString.size());
+    return *mInterned.emplace(characters, aString.size()).first;
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,114 @@
+#pragma once
+
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Monotonic storage for the small variable-length members of a glTF document
+/// (names, index lists, mesh primitives and their attributes), so they do not each require a heap allocation.
+///
+/// Successive arrays are carved out of the same few memory blocks,
+/// which are only released when the arena is destroyed.
+/// Strings are interned: all equal strings share the same storage.
+class DocumentArena
+{
+public:
+    explicit DocumentArena(std::size_t aInitialSize = 16 * 1024);
+
+    DocumentArena(const DocumentArena &) = delete;
+    DocumentArena & operator=(const DocumentArena &) = delete;
+
+    /// @brief Return a view of `aString` stored in the arena, valid for the lifetime of the arena.
+    std::string_view intern(std::string_view aString);
+
+    /// @brief Store the values obtained by applying `aProjection` to each entry of `aRange`
+    /// as a contiguous array in the arena.
+    /// @note The arena never calls destructors, so the values must be trivially destructible.
+    template <class T_value, class T_range, class T_projection>
+    std::span<T_value> makeArray(const T_range & aRange, T_projection && aProjection);
+
+    /// @brief Total size of the memory blocks obtained from the heap.
+    std::size_t getReservedBytes() const
+    { return mReservedBytes; }
+
+    /// @brief Count of the memory blocks obtained from the heap.
+    std::size_t getReservedBlocks() const
+    { return mReservedBlocks; }
+
+    /// @brief Total size of the live allocations made in the blocks, including the interning set.
+    std::size_t getUsedBytes() const
+    { return mUsedBytes; }
+
+private:
+    /// @brief Forwards to another resource, counting the allocated bytes and blocks.
+    class Counting : public std::pmr::memory_resource
+    {
+    public:
+        Counting(std::pmr::memory_resource & aForward, std::size_t & aBytes, std::size_t * aBlocks = nullptr) :
+            mForward{aForward},
+            mBytes{aBytes},
+            mBlocks{aBlocks}
+        {}
+
+    private:
+        void * do_allocate(std::size_t aBytes, std::size_t aAlignment) override;
+        void do_deallocate(void * aPointer, std::size_t aBytes, std::size_t aAlignment) override;
+        bool do_is_equal(const std::pmr::memory_resource & aOther) const noexcept override
+        { return this == &aOther; }
+
+        std::pmr::memory_resource & mForward;
+        std::size_t & mBytes;
+        std::size_t * mBlocks;
+    };
+
+    std::size_t mReservedBytes{0};
+    std::size_t mReservedBlocks{0};
+    std::size_t mUsedBytes{0};
+    Counting mUpstream{*std::pmr::new_delete_resource(), mReservedBytes, &mReservedBlocks};
+    std::pmr::monotonic_buffer_resource mResource;
+    Counting mUsed{mResource, mUsedBytes};
+    // The interned strings are the keys, the set itself is also stored in the arena.
+    std::pmr::unordered_set<std::string_view> mInterned{&mUsed};
+};
+
+
+//
+// Implementations
+//
+template <class T_value, class T_range, class T_projection>
+std::span<T_value> DocumentArena::makeArray(const T_range & aRange, T_projection && aProjection)
+{
+    static_assert(std::is_trivially_destructible_v<T_value>,
+                  "DocumentArena does not destroy the values it stores.");
+
+    const auto count = static_cast<std::size_t>(std::distance(std::begin(aRange), std::end(aRange)));
+    if (count == 0)
+    {
+        return {};
+    }
+
+    auto * values = static_cast<T_value *>(mUsed.allocate(count * sizeof(T_value), alignof(T_value)));
+    T_value * constructed = values;
+    for (const auto & entry : aRange)
+    {
+        std::construct_at(constructed++, aProjection(entry));
+    }
+    return {values, count};
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -8,11 +8,19 @@
 #include <math/Homogeneous.h>
 #include <math/Quaternion.h>
 
+#include "DocumentArena.h"
+
 #include <platform/Filesystem.h>
 
+#include <array>
 #include <functional>
-#include <map>
+#include <memory>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -69,10 +77,16 @@ namespace gltf {
         Value_t value;
     };
 
+    template <class T_indexed>
+    std::ostream & operator<<(std::ostream & aOut, std::span<const T_indexed> aIndices);
+
     template <class T_indexed>
     std::ostream & operator<<(std::ostream & aOut, const std::vector<T_indexed> & aIndexVector);
 
 
+    // Note: the names, index lists and mesh primitives are views into the DocumentArena
+    // of the owning Gltf, they are valid as long as the Gltf instance.
+
     struct Camera
     {
         enum class Type
@@ -97,7 +111,7 @@ namespace gltf {
             float znear;
         };
 
-        std::string name;
+        std::string_view name;
         Type type;
         std::variant<Orthographic, Perspective> projection;
     };
@@ -107,10 +121,10 @@ namespace gltf {
 
     struct Skin
     {
-        std::string name;
+        std::string_view name;
         std::optional<Index<Accessor>> inverseBindMatrices;
         std::optional<Index<Node>> skeleton;
-        std::vector<Index<Node>> joints;
+        std::span<const Index<Node>> joints;
     };
 
     namespace texture
@@ -118,7 +132,7 @@ namespace gltf {
 
         struct Sampler
         {
-            std::string name;
+            std::string_view name;
             std::optional<EnumType> magFilter;
             std::optional<EnumType> minFilter;
             EnumType wrapS{10497};
@@ -138,14 +152,14 @@ namespace gltf {
             ImagePng,
         };
 
-        std::string name;
+        std::string_view name;
         std::variant<Uri, Index<BufferView>> dataSource; // correspond to either uri or bufferView.
         std::optional<MimeType> mimeType;
     };
 
     struct Texture
     {
-        std::string name;
+        std::string_view name;
         std::optional<Index<Image>> source;
         std::optional<Index<texture::Sampler>> sampler;
     };
@@ -194,7 +208,7 @@ namespace gltf {
             Blend,
         };
 
-        std::string name;
+        std::string_view name;
         std::optional<material::PbrMetallicRoughness> pbrMetallicRoughness;
         std::optional<NormalTextureInfo> normalTexture;
         std::optional<OcclusionTextureInfo> occlusionTexture;
@@ -245,28 +259,63 @@ namespace gltf {
 
     struct Animation
     {
-        std::string name;
+        std::string_view name;
         std::vector<animation::Channel> channels;
         std::vector<animation::Sampler> samplers;
     };
 
     struct Buffer
     {
-        std::string name;
+        std::string_view name;
         // see: https://github.com/KhronosGroup/glTF/issues/828#issuecomment-277317217
         std::optional<Uri> uri;
         std::size_t byteLength;
     };
 
+    namespace bufferview {
+        /// @brief EXT_meshopt_compression extension of a buffer view.
+        /// see: https://github.com/KhronosGroup/glTF/tree/main/extensions/2.0/Vendor/EXT_meshopt_compression
+        struct MeshoptCompression
+        {
+            enum class Mode
+            {
+                Attributes,
+                Triangles,
+                Indices,
+            };
+
+            enum class Filter
+            {
+                None,
+                Octahedral,
+                Quaternion,
+                Exponential,
+            };
+
+            // The compressed bitstream.
+            Index<Buffer> buffer;
+            std::size_t byteOffset;
+            std::size_t byteLength;
+            // Size of the decoded elements, and count of elements.
+            std::size_t byteStride;
+            std::size_t count;
+            Mode mode;
+            Filter filter{Filter::None};
+        };
+    } // namespace bufferview
+
     struct BufferView
     {
-        std::string name;
+        std::string_view name;
+        // When the view is compressed, this is usually a fallback buffer without data.
         Index<Buffer> buffer;
         std::size_t byteOffset;
         std::size_t byteLength;
         std::optional<std::size_t> byteStride;
         // see: https://github.com/KhronosGroup/glTF/issues/1440
         std::optional<EnumType> target;
+        // The decoded content replaces the content of the view in buffer.
+        std::optional<bufferview::MeshoptCompression> meshoptCompression;
     };
 
     namespace accessor {
@@ -316,7 +365,7 @@ namespace gltf {
 
         using Bounds_t = std::variant<MinMax<float>, MinMax<int>, MinMax<unsigned int>>;
 
-        std::string name;
+        std::string_view name;
         // When absent, the accessor must be initialized with zeros
         // (which can be overrided by sparse or extensions)
         std::optional<Index<BufferView>> bufferView;
@@ -329,18 +378,57 @@ namespace gltf {
         std::optional<accessor::Sparse> sparse;
     };
 
+    /// @brief Map from attribute semantic to accessor, viewing an array sorted by semantic.
+    ///
+    /// Provides the subset of the std::map interface used for lookups and iteration.
+    class PrimitiveAttributes
+    {
+    public:
+        using value_type = std::pair<std::string_view, Index<Accessor>>;
+        using const_iterator = const value_type *;
+        using iterator = const_iterator;
+
+        PrimitiveAttributes() = default;
+
+        /// @brief Sort the entries by semantic, and view them.
+        /// @param aEntries must outlive this object, as must their semantics (typically both stored in the DocumentArena).
+        /// @throw std::invalid_argument if a semantic is duplicated.
+        explicit PrimitiveAttributes(std::span<value_type> aEntries);
+
+        const_iterator find(std::string_view aSemantic) const;
+
+        bool contains(std::string_view aSemantic) const
+        { return find(aSemantic) != end(); }
+
+        /// @throw std::out_of_range if the semantic is not present.
+        Index<Accessor> at(std::string_view aSemantic) const;
+
+        const_iterator begin() const
+        { return mEntries.data(); }
+        const_iterator end() const
+        { return mEntries.data() + mEntries.size(); }
+
+        std::size_t size() const
+        { return mEntries.size(); }
+        bool empty() const
+        { return mEntries.empty(); }
+
+    private:
+        std::span<const value_type> mEntries;
+    };
+
     struct Primitive
     {
         EnumType mode;
-        std::map<std::string, Index<Accessor>> attributes;
+        PrimitiveAttributes attributes;
         std::optional<Index<Accessor>> indices;
         std::optional<Index<Material>> material;
     };
 
     struct Mesh
     {
-        std::vector<Primitive> primitives;
-        std::string name;
+        std::span<const Primitive> primitives;
+        std::string_view name;
     };
 
     struct Node
@@ -353,9 +441,9 @@ namespace gltf {
             math::Vec<3, float> scale;
         };
 
-        std::string name;
+        std::string_view name;
         std::optional<Index<Camera>> camera;
-        std::vector<Index<Node>> children;
+        std::span<const Index<Node>> children;
         std::variant<Matrix, TRS> transformation;
         std::optional<Index<Mesh>> mesh;
         std::optional<Index<Skin>> skin;
@@ -366,8 +454,8 @@ namespace gltf {
 
     struct Scene
     {
-        std::string name;
-        std::vector<Index<Node>> nodes; // root nodes of the scene
+        std::string_view name;
+        std::span<const Index<Node>> nodes; // root nodes of the scene
     };
 
     std::ostream & operator<<(std::ostream & aOut, const Scene & aScene);
@@ -377,6 +465,7 @@ namespace gltf {
     Node::Matrix getTransformationAsMatrix(const Node & aNode);
 
     /// @brief Helper function, returning the pose of a Node as a Translation/Rotation/Scale struct.
+    /// @note A matrix is decomposed, see `decompose()` in Decomposition.h.
     Node::TRS getTransformationAsTRS(const Node & aNode);
 
     // TODO helpers to get parts of the pose (should decompose the matrix when needed)
@@ -399,6 +488,23 @@ class Owned;
 template <class T_element>
 class Const_Owned;
 
+class Gltf;
+
+template <class T_owned, class T_gltf, class T_stored>
+class OwnedSequence;
+
+/// @brief Lazy range over elements stored in the Gltf.
+template <class T_element>
+using OwnedRange = OwnedSequence<Owned<T_element>, Gltf, T_element>;
+template <class T_element>
+using Const_OwnedRange = OwnedSequence<Const_Owned<T_element>, const Gltf, const T_element>;
+
+/// @brief Lazy range over the elements designated by a vector of indices.
+template <class T_element>
+using OwnedIndexRange = OwnedSequence<Owned<T_element>, Gltf, const gltf::Index<T_element>>;
+template <class T_element>
+using Const_OwnedIndexRange = OwnedSequence<Const_Owned<T_element>, const Gltf, const gltf::Index<T_element>>;
+
 
 class Gltf
 {
@@ -409,18 +515,38 @@ public:
     std::optional<Const_Owned<gltf::Scene>> getDefaultScene() const;
     std::size_t countScenes() const;
 
-    std::vector<Owned<gltf::Animation>> getAnimations();
-    std::vector<Const_Owned<gltf::Animation>> getAnimations() const;
+    std::span<const gltf::Scene> getSceneSpan() const
+    { return mScenes; }
+
+    // The get*() ranges are lazy: they yield an Owned for each element, without allocating.
+    // The get*Span() accessors directly expose the underlying elements.
 
-    std::vector<Owned<gltf::Mesh>> getMeshes();
-    std::vector<Const_Owned<gltf::Mesh>> getMeshes() const;
+    OwnedRange<gltf::Animation> getAnimations();
+    Const_OwnedRange<gltf::Animation> getAnimations() const;
+    std::span<const gltf::Animation> getAnimationSpan() const
+    { return mAnimations; }
 
-    std::vector<Owned<gltf::Node>> getNodes();
-    std::vector<Const_Owned<gltf::Node>> getNodes() const;
+    OwnedRange<gltf::Mesh> getMeshes();
+    Const_OwnedRange<gltf::Mesh> getMeshes() const;
+    std::span<const gltf::Mesh> getMeshSpan() const
+    { return mMeshes; }
+
+    OwnedRange<gltf::Node> getNodes();
+    Const_OwnedRange<gltf::Node> getNodes() const;
+    std::span<const gltf::Node> getNodeSpan() const
+    { return mNodes; }
     std::size_t countNodes() const;
 
-    std::vector<Owned<gltf::Skin>> getSkins();
-    std::vector<Const_Owned<gltf::Skin>> getSkins() const;
+    std::size_t countBuffers() const;
+
+    std::size_t countBufferViews() const;
+
+    std::size_t countImages() const;
+
+    OwnedRange<gltf::Skin> getSkins();
+    Const_OwnedRange<gltf::Skin> getSkins() const;
+    std::span<const gltf::Skin> getSkinSpan() const
+    { return mSkins; }
 
     Owned<gltf::Accessor> get(gltf::Index<gltf::Accessor> aAccessorIndex);
     Const_Owned<gltf::Accessor> get(gltf::Index<gltf::Accessor> aAccessorIndex) const;
@@ -463,10 +589,22 @@ public:
 
     filesystem::path getPathFor(gltf::Uri aFileUri) const;
 
+    /// @brief The names of the extensions used by the document.
+    std::span<const std::string_view> getExtensionsUsed() const
+    { return mExtensionsUsed; }
+
+    /// @brief The arena storing the names and index lists of the document.
+    const gltf::DocumentArena & getArena() const
+    { return *mArena; }
+
 private:
     filesystem::path mPath;
 
+    // Behind a pointer, so the views into the arena stay valid when the Gltf is moved.
+    std::unique_ptr<gltf::DocumentArena> mArena;
+
     std::optional<gltf::Index<gltf::Scene>> mDefaultScene;
+    std::span<const std::string_view> mExtensionsUsed;
 
     // the order in which they appear in Triangle.gltf sample
     std::vector<gltf::Scene> mScenes;
@@ -1,5 +1,7 @@
 #include "Gltf.h"
 
+#include "Decomposition.h"
+
 #include "../Logging.h"
 
 #include "../detail/Json.h"
@@ -7,7 +9,9 @@
 
 #include <math/Transformations.h>
 
+#include <algorithm>
 #include <fstream>
+#include <map>
 
 
 namespace ad {
@@ -41,6 +45,10 @@ constexpr const char * gTagBaseColorTexture     = "baseColorTexture";
 constexpr const char * gTagCount                = "count";
 constexpr const char * gTagComponentType        = "componentType";
 constexpr const char * gTagDoubleSided          = "doubleSided";
+constexpr const char * gTagExtensions           = "extensions";
+constexpr const char * gTagExtensionsRequired   = "extensionsRequired";
+constexpr const char * gTagExtensionsUsed       = "extensionsUsed";
+constexpr const char * gTagFilter               = "filter";
 constexpr const char * gTagImages               = "images";
 constexpr const char * gTagIndex                = "index";
 constexpr const char * gTagIndices              = "indices";
@@ -101,6 +109,16 @@ constexpr const char * gTagYMag                 = "ymag";
 constexpr const char * gTagZFar                 = "zfar";
 constexpr const char * gTagZNear                = "znear";
 
+constexpr const char * gExtMeshQuantization     = "KHR_mesh_quantization";
+constexpr const char * gExtMeshoptCompression   = "EXT_meshopt_compression";
+
+// Extensions that may appear in extensionsRequired.
+// KHR_mesh_quantization only widens the accepted accessor types, which the accessor readers handle.
+constexpr std::array<std::string_view, 2> gSupportedExtensions{
+    gExtMeshQuantization,
+    gExtMeshoptCompression,
+};
+
 } // namespace anonymous
 
 
@@ -192,6 +210,20 @@ const std::map<std::string, gltf::Camera::Type> gStringToCameraType{
     {"perspective",  Camera::Type::Perspective},
 };
 
+const std::map<std::string, bufferview::MeshoptCompression::Mode> gStringToMeshoptMode{
+    {"ATTRIBUTES", bufferview::MeshoptCompression::Mode::Attributes},
+    {"TRIANGLES",  bufferview::MeshoptCompression::Mode::Triangles},
+    {"INDICES",    bufferview::MeshoptCompression::Mode::Indices},
+};
+
+const std::map<std::string, bufferview::MeshoptCompression::Filter> gStringToMeshoptFilter{
+    {"NONE",        bufferview::MeshoptCompression::Filter::None},
+    {"OCTAHEDRAL",  bufferview::MeshoptCompression::Filter::Octahedral},
+    {"QUATERNION",  bufferview::MeshoptCompression::Filter::Quaternion},
+    {"EXPONENTIAL", bufferview::MeshoptCompression::Filter::Exponential},
+};
+
+
 const std::array<std::string, 2> gCameraTypeToString{
     "orthographic",
     "perspective",
@@ -209,25 +241,28 @@ std::string to_string(gltf::Camera::Type aCameraType)
 // Helpers
 //
 template <class T_index>
-std::vector<T_index> makeIndicesVector(const Json & aArray)
-{
-    std::vector<T_index> result;
-    // Is that a bug? the predicate seems strangej
-    // Anyway, such syntax makes no sense
-    //std::ranges::copy_if(aArray, std::back_inserter(result),
-    //                     [](auto){return true;},
-    //                     [](const auto & entry)->T_index{return entry.get<typename T_index::Value_t>();});
-    for (typename T_index::Value_t index : aArray)
+std::span<const T_index> makeIndicesSpan(const Json & aArray, DocumentArena & aArena)
+{
+    return aArena.makeArray<T_index>(
+        aArray,
+        [](const Json & aEntry) -> T_index{ return aEntry.get<typename T_index::Value_t>(); });
+}
+
+
+/// @brief Intern the name of the object, without an intermediary std::string.
+std::string_view loadName(const Json & aObject, DocumentArena & aArena)
+{
+    if (auto found = aObject.find(gTagName); found != aObject.end())
     {
-        result.push_back(index);
+        return aArena.intern(found->get_ref<const Json::string_t &>());
     }
-    return result;
+    return {};
 }
 
 
 // Note: Could not find a way to achieve it directly with json.value
 template <class T_value, class T_tag>
-std::optional<T_value> getOptional(Json aObject, T_tag && aTag)
+std::optional<T_value> getOptional(const Json & aObject, T_tag && aTag)
 {
     if (aObject.contains(std::forward<T_tag>(aTag)))
     {
@@ -237,10 +272,17 @@ std::optional<T_value> getOptional(Json aObject, T_tag && aTag)
 }
 
 
+/// @brief Return the array under `aKey`, or an empty array if absent.
+/// @note Returns a reference, the array is not copied.
 template <class T_key>
-Json getOptionalArray(const Json & aObject, T_key && aKey)
+const Json & getOptionalArray(const Json & aObject, T_key && aKey)
 {
-    return aObject.value(std::forward<T_key>(aKey), Json::array());
+    static const Json gEmptyArray = Json::array();
+    if (auto found = aObject.find(std::forward<T_key>(aKey)); found != aObject.end())
+    {
+        return *found;
+    }
+    return gEmptyArray;
 }
 
 
@@ -251,7 +293,7 @@ template <class T_object, class ... VT_args>
 T_object load(const Json & aObjectJson, VT_args && ... vaArgs);
 
 template <class T_value, class T_tag>
-std::optional<T_value> loadOptional(Json aObject, T_tag && aTag)
+std::optional<T_value> loadOptional(const Json & aObject, T_tag && aTag)
 {
     if (aObject.contains(std::forward<T_tag>(aTag)))
     {
@@ -265,7 +307,7 @@ template <class T_object, class T_tag, class ... VT_args>
 void populateVector(const Json & aJson, std::vector<T_object> & aVector, T_tag && aTag, VT_args && ... vaArgs)
 {
     aVector.reserve(aJson.at(std::forward<T_tag>(aTag)).size());
-    for (auto object : aJson.at(aTag))
+    for (const Json & object : aJson.at(aTag))
     {
         aVector.push_back(load<T_object>(object, std::forward<VT_args>(vaArgs)...));
     }
@@ -284,17 +326,17 @@ void populateVectorIfPresent(const Json & aJson, std::vector<T_object> & aVector
 
 
 template <>
-Scene load(const Json & aJson)
+Scene load(const Json & aJson, DocumentArena & aArena)
 {
     return{
-        .name = aJson.value(gTagName, ""),
-        .nodes = makeIndicesVector<Index<Node>>(getOptionalArray(aJson, gTagNodes)),
+        .name = loadName(aJson, aArena),
+        .nodes = makeIndicesSpan<Index<Node>>(getOptionalArray(aJson, gTagNodes), aArena),
     };
 }
  
 
 template <>
-Node load(const Json & aNodeObject)
+Node load(const Json & aNodeObject, DocumentArena & aArena)
 {
     auto handleTransformation = [](const Json & aNodeObject) -> std::variant<Node::Matrix, Node::TRS>
     {
@@ -315,9 +357,9 @@ Node load(const Json & aNodeObject)
     };
 
     return Node{
-        .name = aNodeObject.value(gTagName, ""),
+        .name = loadName(aNodeObject, aArena),
         .camera = getOptional<Index<Camera>>(aNodeObject, gTagCamera),
-        .children = makeIndicesVector<Index<Node>>(getOptionalArray(aNodeObject, gTagChildren)),
+        .children = makeIndicesSpan<Index<Node>>(getOptionalArray(aNodeObject, gTagChildren), aArena),
         .transformation = handleTransformation(aNodeObject),
         .mesh = getOptional<Index<Mesh>>(aNodeObject, gTagMesh),
         .skin = getOptional<Index<Skin>>(aNodeObject, gTagSkin),
@@ -326,19 +368,17 @@ Node load(const Json & aNodeObject)
 
 
 template <>
-Primitive load(const Json & aPrimitiveObject)
+Primitive load(const Json & aPrimitiveObject, DocumentArena & aArena)
 {
     return Primitive{
         .mode = aPrimitiveObject.value<EnumType>(gTagMode, 4), // 4 is the default mode
-        .attributes = [attributes = aPrimitiveObject.at(gTagAttributes)]()
+        .attributes = PrimitiveAttributes{aArena.makeArray<PrimitiveAttributes::value_type>(
+            aPrimitiveObject.at(gTagAttributes).items(),
+            [&aArena](const auto & aAttribute)
             {
-                std::map<std::string, Index<Accessor>> result;
-                for (auto attribute : attributes.items())
-                {
-                    result.emplace(attribute.key(), attribute.value().get<Index<Accessor>::Value_t>());
-                }
-                return result;
-            }(),
+                return PrimitiveAttributes::value_type{aArena.intern(aAttribute.key()),
+                                                       aAttribute.value().template get<Index<Accessor>::Value_t>()};
+            })},
         .indices = getOptional<Index<Accessor>>(aPrimitiveObject, gTagIndices),
         .material = getOptional<Index<Material>>(aPrimitiveObject, gTagMaterial),
     };
@@ -346,26 +386,22 @@ Primitive load(const Json & aPrimitiveObject)
 
 
 template <>
-Mesh load(const Json & aMeshObject)
+Mesh load(const Json & aMeshObject, DocumentArena & aArena)
 {
-    std::vector<Primitive> primitives;
-    for (auto primitive : aMeshObject.at(gTagPrimitives))
-    {
-        primitives.push_back(load<Primitive>(primitive));
-    }
-
     return Mesh{
-        .primitives = std::move(primitives),
-        .name = aMeshObject.value(gTagName, ""),
+        .primitives = aArena.makeArray<Primitive>(
+            aMeshObject.at(gTagPrimitives),
+            [&aArena](const Json & aPrimitive){ return load<Primitive>(aPrimitive, aArena); }),
+        .name = loadName(aMeshObject, aArena),
     };
 }
 
 
 template <>
-Buffer load(const Json & aJson)
+Buffer load(const Json & aJson, DocumentArena & aArena)
 {
     return{
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .uri = getOptional<Uri>(aJson, gTagUri),
         .byteLength = aJson.at(gTagByteLength),
     };
@@ -373,16 +409,39 @@ Buffer load(const Json & aJson)
 
 
 template <>
-BufferView load(const Json & aJson)
+bufferview::MeshoptCompression load(const Json & aJson)
 {
     return{
-        .name = aJson.value(gTagName, ""),
+        .buffer = aJson.at(gTagBuffer).get<Index<Buffer>::Value_t>(),
+        .byteOffset = aJson.value<std::size_t>(gTagByteOffset, 0),
+        .byteLength = aJson.at(gTagByteLength),
+        .byteStride = aJson.at(gTagByteStride),
+        .count = aJson.at(gTagCount),
+        .mode = gStringToMeshoptMode.at(aJson.at(gTagMode)),
+        .filter = gStringToMeshoptFilter.at(aJson.value(gTagFilter, "NONE")),
+    };
+}
+
+
+template <>
+BufferView load(const Json & aJson, DocumentArena & aArena)
+{
+    BufferView result{
+        .name = loadName(aJson, aArena),
         .buffer = aJson.at(gTagBuffer).get<Index<Buffer>::Value_t>(),
         .byteOffset = aJson.value<std::size_t>(gTagByteOffset, 0),
         .byteLength = aJson.at(gTagByteLength),
         .byteStride = getOptional<std::size_t>(aJson, gTagByteStride),
         .target = getOptional<EnumType>(aJson, gTagTarget),
+        .meshoptCompression = std::nullopt,
     };
+
+    if (auto extensions = aJson.find(gTagExtensions); extensions != aJson.end())
+    {
+        result.meshoptCompression =
+            loadOptional<bufferview::MeshoptCompression>(*extensions, gExtMeshoptCompression);
+    }
+    return result;
 }
 
 
@@ -425,10 +484,10 @@ Accessor::MinMax<T_stored> makeMinMax(const Json & aJson)
 
 
 template <>
-Accessor load(const Json & aJson)
+Accessor load(const Json & aJson, DocumentArena & aArena)
 {
     Accessor result{
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .bufferView = getOptional<Index<BufferView>>(aJson, gTagBufferView),
         .byteOffset = aJson.value<std::size_t>(gTagByteOffset, 0),
         .type = gStringToElementType.at(aJson.at(gTagType)),
@@ -464,10 +523,10 @@ Accessor load(const Json & aJson)
 
 
 template <>
-Animation load(const Json & aJson)
+Animation load(const Json & aJson, DocumentArena & aArena)
 {
     Animation animation{
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
     };
 
     populateVector(aJson, animation.channels, gTagChannels);
@@ -480,7 +539,7 @@ Animation load(const Json & aJson)
 template <>
 animation::Channel load(const Json & aJson)
 {
-    Json target = aJson.at(gTagTarget);
+    const Json & target = aJson.at(gTagTarget);
 
     return {
         .sampler = aJson.at(gTagSampler).get<Index<animation::Sampler>>(),
@@ -551,10 +610,10 @@ material::PbrMetallicRoughness load(const Json & aJson)
 
 
 template <>
-Material load(const Json & aJson)
+Material load(const Json & aJson, DocumentArena & aArena)
 {
     Material result{
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .pbrMetallicRoughness = 
             loadOptional<material::PbrMetallicRoughness>(aJson, gTagPbrMetallicRoughness),
         .normalTexture = loadOptional<NormalTextureInfo>(aJson, gTagNormalTexture),
@@ -573,10 +632,10 @@ Material load(const Json & aJson)
 
 
 template <>
-Texture load(const Json & aJson)
+Texture load(const Json & aJson, DocumentArena & aArena)
 {
     return {
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .source = getOptional<Index<Image>>(aJson, gTagSource),
         .sampler = getOptional<Index<texture::Sampler>>(aJson, gTagSampler),
     };
@@ -584,7 +643,7 @@ Texture load(const Json & aJson)
 
 
 template <>
-Image load(const Json & aJson)
+Image load(const Json & aJson, DocumentArena & aArena)
 {
     auto handleDataSource = [](const Json & aJson) -> std::variant<Uri, Index<BufferView>>
     {
@@ -599,7 +658,7 @@ Image load(const Json & aJson)
     };
     
     Image image{
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .dataSource = handleDataSource(aJson),
     };
 
@@ -613,10 +672,10 @@ Image load(const Json & aJson)
 
 
 template <>
-texture::Sampler load(const Json & aJson)
+texture::Sampler load(const Json & aJson, DocumentArena & aArena)
 {
     return {
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .magFilter = getOptional<EnumType>(aJson, gTagMagFilter),
         .minFilter = getOptional<EnumType>(aJson, gTagMinFilter),
         .wrapS = aJson.value(gTagWrapS, texture::gDefaultSampler.wrapS),
@@ -626,13 +685,13 @@ texture::Sampler load(const Json & aJson)
 
 
 template <>
-Skin load(const Json & aJson, Gltf & aGltf)
+Skin load(const Json & aJson, DocumentArena & aArena, Gltf & aGltf)
 {
     Skin result{
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .inverseBindMatrices = getOptional<Index<Accessor>>(aJson, gTagInverseBindMatrices),
         .skeleton = getOptional<Index<Node>>(aJson, gTagSkeleton),
-        .joints = makeIndicesVector<Index<Node>>(getOptionalArray(aJson, gTagJoints)),
+        .joints = makeIndicesSpan<Index<Node>>(getOptionalArray(aJson, gTagJoints), aArena),
     };
 
     for (auto joint : result.joints)
@@ -645,10 +704,10 @@ Skin load(const Json & aJson, Gltf & aGltf)
 
 
 template <>
-Camera load(const Json & aJson)
+Camera load(const Json & aJson, DocumentArena & aArena)
 {
     Camera result{
-        .name = aJson.value(gTagName, ""),
+        .name = loadName(aJson, aArena),
         .type = gStringToCameraType.at(aJson.at(gTagType)),
     };
 
@@ -656,7 +715,7 @@ Camera load(const Json & aJson)
     {
     case Camera::Type::Orthographic:
     {
-        auto proj = aJson.at(gTagOrthographic);
+        const Json & proj = aJson.at(gTagOrthographic);
         result.projection = Camera::Orthographic{
             .xmag = proj.at(gTagXMag),
             .ymag = proj.at(gTagYMag),
@@ -667,7 +726,7 @@ Camera load(const Json & aJson)
     }
     case Camera::Type::Perspective:
     {
-        auto proj = aJson.at(gTagPerspective);
+        const Json & proj = aJson.at(gTagPerspective);
         result.projection = Camera::Perspective{
             .aspectRatio = getOptional<float>(proj, gTagAspectRatio),
             .yfov = proj.at(gTagYFov),
@@ -699,6 +758,40 @@ std::string prependNotEmpty(std::string_view aString, std::string aPrefix = " ")
 
 namespace gltf {
 
+    PrimitiveAttributes::PrimitiveAttributes(std::span<value_type> aEntries)
+    {
+        std::sort(aEntries.begin(), aEntries.end(),
+                  [](const value_type & aLhs, const value_type & aRhs){ return aLhs.first < aRhs.first; });
+        auto duplicate = std::adjacent_find(aEntries.begin(), aEntries.end(),
+                                            [](const value_type & aLhs, const value_type & aRhs)
+                                            { return aLhs.first == aRhs.first; });
+        if (duplicate != aEntries.end())
+        {
+            throw std::invalid_argument{"Primitive attribute '" + std::string{duplicate->first} + "' is duplicated."};
+        }
+        mEntries = aEntries;
+    }
+
+
+    PrimitiveAttributes::const_iterator PrimitiveAttributes::find(std::string_view aSemantic) const
+    {
+        auto found = std::lower_bound(begin(), end(), aSemantic,
+                                      [](const value_type & aEntry, std::string_view aKey)
+                                      { return aEntry.first < aKey; });
+        return (found != end() && found->first == aSemantic) ? found : end();
+    }
+
+
+    Index<Accessor> PrimitiveAttributes::at(std::string_view aSemantic) const
+    {
+        if (auto found = find(aSemantic); found != end())
+        {
+            return found->second;
+        }
+        throw std::out_of_range{"Primitive has no attribute '" + std::string{aSemantic} + "'."};
+    }
+
+
     std::ostream & operator<<(std::ostream & aOut, const Scene & aScene)
     {
         return aOut 
@@ -739,8 +832,12 @@ namespace gltf {
                 using T = std::decay_t<decltype(transformation)>;
                 if constexpr (std::is_same_v<T, Node::Matrix>)
                 {
-                    // TODO implement decomposition logic
-                    throw std::logic_error{"Decomposition from matrix to TRS not implemented."};
+                    const Trs trs = decompose(toAffine(transformation));
+                    return Node::TRS{
+                        .translation = {trs.translation[0], trs.translation[1], trs.translation[2]},
+                        .rotation = {trs.rotation[0], trs.rotation[1], trs.rotation[2], trs.rotation[3]},
+                        .scale = {trs.scale[0], trs.scale[1], trs.scale[2]},
+                    };
                 }
                 else if constexpr (std::is_same_v<T, Node::TRS>)
                 {
@@ -756,27 +853,42 @@ namespace gltf {
 // Gltf member functions
 //
 Gltf::Gltf(const filesystem::path & aGltfJson) :
-    mPath{aGltfJson}
+    mPath{aGltfJson},
+    mArena{std::make_unique<DocumentArena>()}
 {
     std::ifstream jsonInput{aGltfJson.string()};
     Json json;
     jsonInput >> json;
 
+    DocumentArena & arena = *mArena;
+
+    for (const Json & required : getOptionalArray(json, gTagExtensionsRequired))
+    {
+        const auto & name = required.get_ref<const Json::string_t &>();
+        if (std::find(gSupportedExtensions.begin(), gSupportedExtensions.end(), name) == gSupportedExtensions.end())
+        {
+            throw std::runtime_error{"glTF file requires unsupported extension '" + name + "'."};
+        }
+    }
+    mExtensionsUsed = arena.makeArray<std::string_view>(
+        getOptionalArray(json, gTagExtensionsUsed),
+        [&arena](const Json & aName){ return arena.intern(aName.get_ref<const Json::string_t &>()); });
+
     mDefaultScene = getOptional<Index<Scene>>(json, gTagScene);
 
-    populateVector(json, mScenes, gTagScenes);
-    populateVector(json, mNodes, gTagNodes);
-    populateVector(json, mMeshes, gTagMeshes);
-    populateVectorIfPresent(json, mAnimations, gTagAnimations);
-    populateVector(json, mBuffers, gTagBuffers);
-    populateVector(json, mBufferViews, gTagBufferViews);
-    populateVector(json, mAccessors, gTagAccessors);
-    populateVectorIfPresent(json, mMaterials, gTagMaterials);
-    populateVectorIfPresent(json, mImages, gTagImages);
-    populateVectorIfPresent(json, mTextures, gTagTextures);
-    populateVectorIfPresent(json, mSamplers, gTagSamplers);
-    populateVectorIfPresent(json, mSkins, gTagSkins, *this);
-    populateVectorIfPresent(json, mCameras, gTagCameras);
+    populateVector(json, mScenes, gTagScenes, arena);
+    populateVector(json, mNodes, gTagNodes, arena);
+    populateVector(json, mMeshes, gTagMeshes, arena);
+    populateVectorIfPresent(json, mAnimations, gTagAnimations, arena);
+    populateVector(json, mBuffers, gTagBuffers, arena);
+    populateVector(json, mBufferViews, gTagBufferViews, arena);
+    populateVector(json, mAccessors, gTagAccessors, arena);
+    populateVectorIfPresent(json, mMaterials, gTagMaterials, arena);
+    populateVectorIfPresent(json, mImages, gTagImages, arena);
+    populateVectorIfPresent(json, mTextures, gTagTextures, arena);
+    populateVectorIfPresent(json, mSamplers, gTagSamplers, arena);
+    populateVectorIfPresent(json, mSkins, gTagSkins, arena, *this);
+    populateVectorIfPresent(json, mCameras, gTagCameras, arena);
 
     ADLOG(gMainLogger, info)("Loaded glTF file with {} scene(s), {} node(s), {} meshe(s), {} material(s), {} animation(s), {} skin(s), {} camera(s), {} buffer(s).",
                              mScenes.size(), mNodes.size(), mMeshes.size(), mMaterials.size(), mAnimations.size(), mSkins.size(), mCameras.size(), mBuffers.size());
@@ -807,67 +919,37 @@ std::size_t Gltf::countScenes() const
 }
 
 
-std::vector<Owned<gltf::Animation>> Gltf::getAnimations()
+OwnedRange<gltf::Animation> Gltf::getAnimations()
 {
-    std::vector<Owned<gltf::Animation>> result;
-    for (std::size_t id = 0; id != mAnimations.size(); ++id)
-    {
-        result.emplace_back(*this, mAnimations[id], id);
-    }
-    return result;
+    return {*this, mAnimations};
 }
 
-std::vector<Const_Owned<gltf::Animation>> Gltf::getAnimations() const
+Const_OwnedRange<gltf::Animation> Gltf::getAnimations() const
 {
-    std::vector<Const_Owned<gltf::Animation>> result;
-    for (std::size_t id = 0; id != mAnimations.size(); ++id)
-    {
-        result.emplace_back(*this, mAnimations[id], id);
-    }
-    return result;
+    return {*this, mAnimations};
 }
 
 
-std::vector<Owned<gltf::Mesh>> Gltf::getMeshes()
+OwnedRange<gltf::Mesh> Gltf::getMeshes()
 {
-    std::vector<Owned<gltf::Mesh>> result;
-    for (std::size_t id = 0; id != mMeshes.size(); ++id)
-    {
-        result.emplace_back(*this, mMeshes[id], id);
-    }
-    return result;
+    return {*this, mMeshes};
 }
 
-std::vector<Const_Owned<gltf::Mesh>> Gltf::getMeshes() const
+Const_OwnedRange<gltf::Mesh> Gltf::getMeshes() const
 {
-    std::vector<Const_Owned<gltf::Mesh>> result;
-    for (std::size_t id = 0; id != mMeshes.size(); ++id)
-    {
-        result.emplace_back(*this, mMeshes[id], id);
-    }
-    return result;
+    return {*this, mMeshes};
 }
 
 
-std::vector<Owned<gltf::Node>> Gltf::getNodes()
+OwnedRange<gltf::Node> Gltf::getNodes()
 {
-    std::vector<Owned<gltf::Node>> result;
-    for (std::size_t id = 0; id != mNodes.size(); ++id)
-    {
-        result.emplace_back(*this, mNodes[id], id);
-    }
-    return result;
+    return {*this, mNodes};
 }
 
 
-std::vector<Const_Owned<gltf::Node>> Gltf::getNodes() const
+Const_OwnedRange<gltf::Node> Gltf::getNodes() const
 {
-    std::vector<Const_Owned<gltf::Node>> result;
-    for (std::size_t id = 0; id != mNodes.size(); ++id)
-    {
-        result.emplace_back(*this, mNodes[id], id);
-    }
-    return result;
+    return {*this, mNodes};
 }
 
 
@@ -877,25 +959,33 @@ std::size_t Gltf::countNodes() const
 }
 
 
-std::vector<Owned<gltf::Skin>> Gltf::getSkins()
+std::size_t Gltf::countBuffers() const
 {
-    std::vector<Owned<gltf::Skin>> result;
-    for (std::size_t id = 0; id != mSkins.size(); ++id)
-    {
-        result.emplace_back(*this, mSkins[id], id);
-    }
-    return result;
+    return mBuffers.size();
 }
 
 
-std::vector<Const_Owned<gltf::Skin>> Gltf::getSkins() const
+std::size_t Gltf::countBufferViews() const
 {
-    std::vector<Const_Owned<gltf::Skin>> result;
-    for (std::size_t id = 0; id != mSkins.size(); ++id)
-    {
-        result.emplace_back(*this, mSkins[id], id);
-    }
-    return result;
+    return mBufferViews.size();
+}
+
+
+std::size_t Gltf::countImages() const
+{
+    return mImages.size();
+}
+
+
+OwnedRange<gltf::Skin> Gltf::getSkins()
+{
+    return {*this, mSkins};
+}
+
+
+Const_OwnedRange<gltf::Skin> Gltf::getSkins() const
+{
+    return {*this, mSkins};
 }
 
 
@@ -0,0 +1,73 @@
+#include "Images.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    constexpr std::string_view gDataUriScheme = "data:";
+
+} // anonymous namespace
+
+
+std::string_view getDataUriMediaType(std::string_view aDataUri)
+{
+    if (aDataUri.rfind(gDataUriScheme, 0) != 0)
+    {
+        throw std::invalid_argument{"Not a data uri."};
+    }
+    std::string_view header = aDataUri.substr(gDataUriScheme.size());
+    return header.substr(0, std::min(header.find(';'), header.find(',')));
+}
+
+
+ImageFormat getImageFormat(const Gltf & aGltf, Index<Image> aImageIndex)
+{
+    const Image & image = aGltf.get(aImageIndex);
+
+    std::optional<Image::MimeType> mimeType = image.mimeType;
+    if (!mimeType)
+    {
+        // The mimeType is only required for buffer view sources, otherwise it comes from the uri.
+        if (const Uri * uri = std::get_if<Uri>(&image.dataSource))
+        {
+            if (uri->type == Uri::Type::File)
+            {
+                filesystem::path extension = filesystem::path{uri->string}.extension();
+                return from_extension(extension == ".jpeg" ? ".jpg" : extension);
+            }
+            std::string_view mediaType = getDataUriMediaType(uri->string);
+            if (mediaType == "image/png")
+            {
+                mimeType = Image::MimeType::ImagePng;
+            }
+            else if (mediaType == "image/jpeg")
+            {
+                mimeType = Image::MimeType::ImageJpeg;
+            }
+        }
+    }
+
+    if (!mimeType)
+    {
+        throw std::runtime_error{"Cannot deduce the format of glTF image " + std::to_string(aImageIndex) + "."};
+    }
+    switch(*mimeType)
+    {
+        case Image::MimeType::ImageJpeg: return ImageFormat::Jpg;
+        case Image::MimeType::ImagePng: return ImageFormat::Png;
+    }
+    throw std::invalid_argument{"Invalid image mime type."};
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
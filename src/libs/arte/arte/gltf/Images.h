@@ -0,0 +1,42 @@
+#pragma once
+
+
+#include "Accessor.h"
+
+#include "../Image.h"
+
+#include "../detail/MemoryStream.h"
+
+#include <string_view>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Media type of a data uri, e.g. "image/png" (empty if the uri does not specify it).
+std::string_view getDataUriMediaType(std::string_view aDataUri);
+
+
+/// @brief The format of the encoded image, from its mimeType, or from its uri otherwise.
+ImageFormat getImageFormat(const Gltf & aGltf, Index<Image> aImage);
+
+
+/// @brief Decode an image of the glTF.
+///
+/// The encoded data is read from the buffer cache memory, so embedded images are never copied to a stream.
+template <class T_pixelFormat>
+arte::Image<T_pixelFormat> readImage(BufferCache & aBuffers,
+                                     Index<Image> aImage,
+                                     ImageOrientation aOrientation = ImageOrientation::Unchanged)
+{
+    return arte::Image<T_pixelFormat>::Read(getImageFormat(aBuffers.getGltf(), aImage),
+                                            detail::MemoryIstream{aBuffers.getImageData(aImage)},
+                                            aOrientation);
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
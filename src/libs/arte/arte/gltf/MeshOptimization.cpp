@@ -0,0 +1,510 @@
+#include "MeshOptimization.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    constexpr EnumType gTrianglesMode = 4; // GL_TRIANGLES
+
+
+    /// @brief For each vertex, the list of triangles referencing it (compressed sparse rows).
+    struct Adjacency
+    {
+        Adjacency(std::span<const std::uint32_t> aIndices, std::size_t aVertexCount) :
+            offsets(aVertexCount + 1, 0),
+            triangles(aIndices.size())
+        {
+            for (std::uint32_t index : aIndices)
+            {
+                ++offsets[index + 1];
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            std::vector<std::uint32_t> cursors{offsets.begin(), offsets.end() - 1};
+            for (std::size_t corner = 0; corner != aIndices.size(); ++corner)
+            {
+                triangles[cursors[aIndices[corner]]++] = static_cast<std::uint32_t>(corner / 3);
+            }
+        }
+
+        std::span<const std::uint32_t> of(std::uint32_t aVertex) const
+        {
+            return {triangles.data() + offsets[aVertex], triangles.data() + offsets[aVertex + 1]};
+        }
+
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> triangles;
+    };
+
+
+    /// @brief Simulated FIFO post-transform cache.
+    class FifoCache
+    {
+    public:
+        FifoCache(std::size_t aVertexCount, std::size_t aCacheSize) :
+            mTimestamps(aVertexCount, 0),
+            mCacheSize{aCacheSize}
+        {}
+
+        /// @return true on a cache miss.
+        bool access(std::uint32_t aVertex)
+        {
+            if (mTimestamps[aVertex] == 0 || mTime - mTimestamps[aVertex] > mCacheSize)
+            {
+                mTimestamps[aVertex] = mTime++;
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        std::vector<std::size_t> mTimestamps;
+        std::size_t mCacheSize;
+        std::size_t mTime{1};
+    };
+
+
+    void checkIndices(std::span<const std::uint32_t> aIndices, std::size_t aVertexCount)
+    {
+        if (aIndices.size() % 3 != 0)
+        {
+            throw std::invalid_argument{"Index count must be a multiple of 3 for triangle lists."};
+        }
+        if (std::any_of(aIndices.begin(), aIndices.end(),
+                        [aVertexCount](std::uint32_t aIndex){ return aIndex >= aVertexCount; }))
+        {
+            throw std::out_of_range{"Index exceeds the vertex count."};
+        }
+    }
+
+} // anonymous namespace
+
+
+CacheStatistics computeCacheStatistics(std::span<const std::uint32_t> aIndices,
+                                       std::size_t aVertexCount,
+                                       std::size_t aCacheSize)
+{
+    checkIndices(aIndices, aVertexCount);
+    if (aIndices.empty())
+    {
+        return {};
+    }
+
+    FifoCache cache{aVertexCount, aCacheSize};
+    std::vector<bool> referenced(aVertexCount, false);
+    std::size_t misses = 0;
+    std::size_t uniqueVertices = 0;
+    for (std::uint32_t index : aIndices)
+    {
+        misses += cache.access(index);
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++uniqueVertices;
+        }
+    }
+
+    return {
+        .acmr = static_cast<double>(misses) / static_cast<double>(aIndices.size() / 3),
+        .atvr = static_cast<double>(misses) / static_cast<double>(uniqueVertices),
+    };
+}
+
+
+std::vector<std::uint32_t> optimizeVertexCache(std::span<const std::uint32_t> aIndices,
+                                               std::size_t aVertexCount,
+                                               std::size_t aCacheSize)
+{
+    checkIndices(aIndices, aVertexCount);
+
+    const Adjacency adjacency{aIndices, aVertexCount};
+    const std::size_t cacheSize = aCacheSize;
+
+    // Count of triangles not yet emitted, per vertex.
+    std::vector<std::uint32_t> liveTriangles(aVertexCount);
+    for (std::uint32_t vertex = 0; vertex != aVertexCount; ++vertex)
+    {
+        liveTriangles[vertex] = static_cast<std::uint32_t>(adjacency.of(vertex).size());
+    }
+    std::vector<std::size_t> cacheTimestamps(aVertexCount, 0);
+    std::vector<bool> emitted(aIndices.size() / 3, false);
+    std::vector<std::uint32_t> deadEnds;
+    std::vector<std::uint32_t> candidates;
+
+    std::vector<std::uint32_t> result;
+    result.reserve(aIndices.size());
+
+    std::size_t time = cacheSize + 1;
+    std::uint32_t scanCursor = 0;
+
+    // Dead-end: pop the recently used vertices still having live triangles, or scan for the next one in input order.
+    auto skipDeadEnd = [&]() -> std::int64_t
+    {
+        while (!deadEnds.empty())
+        {
+            std::uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0)
+            {
+                return vertex;
+            }
+        }
+        for (; scanCursor < aVertexCount; ++scanCursor)
+        {
+            if (liveTriangles[scanCursor] > 0)
+            {
+                return scanCursor;
+            }
+        }
+        return -1;
+    };
+
+    for (std::int64_t fanning = skipDeadEnd(); fanning >= 0; /* in body */)
+    {
+        candidates.clear();
+        for (std::uint32_t triangle : adjacency.of(static_cast<std::uint32_t>(fanning)))
+        {
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            for (std::size_t corner = 0; corner != 3; ++corner)
+            {
+                const std::uint32_t vertex = aIndices[3 * triangle + corner];
+                result.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+                if (time - cacheTimestamps[vertex] > cacheSize)
+                {
+                    cacheTimestamps[vertex] = time++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // Select the candidate that will still be in cache when all its live triangles are emitted,
+        // preferring the oldest in cache.
+        std::int64_t next = -1;
+        std::size_t bestPriority = 0;
+        for (std::uint32_t vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+            std::size_t priority = 0;
+            if (time - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+            {
+                priority = time - cacheTimestamps[vertex];
+            }
+            if (next == -1 || priority > bestPriority)
+            {
+                next = vertex;
+                bestPriority = priority;
+            }
+        }
+        fanning = (next != -1) ? next : skipDeadEnd();
+    }
+
+    return result;
+}
+
+
+std::vector<std::uint32_t> optimizeOverdraw(std::span<const std::uint32_t> aIndices,
+                                            std::span<const float> aPositions,
+                                            float aThreshold,
+                                            std::size_t aCacheSize)
+{
+    const std::size_t vertexCount = aPositions.size() / 3;
+    checkIndices(aIndices, vertexCount);
+    const std::size_t triangleCount = aIndices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return {};
+    }
+
+    //
+    // Clusters start at the triangles missing the cache on all 3 vertices (the cache was flushed).
+    //
+    std::vector<std::size_t> clusterStarts;
+    {
+        FifoCache cache{vertexCount, aCacheSize};
+        for (std::size_t triangle = 0; triangle != triangleCount; ++triangle)
+        {
+            int misses = 0;
+            for (std::size_t corner = 0; corner != 3; ++corner)
+            {
+                misses += cache.access(aIndices[3 * triangle + corner]);
+            }
+            if (misses == 3 || triangle == 0)
+            {
+                clusterStarts.push_back(triangle);
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+    const std::size_t clusterCount = clusterStarts.size() - 1;
+
+    auto position = [&](std::uint32_t aVertex)
+    {
+        return std::array<float, 3>{aPositions[3 * aVertex], aPositions[3 * aVertex + 1], aPositions[3 * aVertex + 2]};
+    };
+
+    // Mesh centroid, weighted by triangle area.
+    std::array<double, 3> meshCentroid{0., 0., 0.};
+    double meshArea = 0.;
+    struct Cluster
+    {
+        std::array<double, 3> centroid{0., 0., 0.};
+        std::array<double, 3> normal{0., 0., 0.}; // area weighted
+        double area{0.};
+        double sortKey{0.};
+    };
+    std::vector<Cluster> clusters(clusterCount);
+
+    for (std::size_t clusterId = 0; clusterId != clusterCount; ++clusterId)
+    {
+        Cluster & cluster = clusters[clusterId];
+        for (std::size_t triangle = clusterStarts[clusterId]; triangle != clusterStarts[clusterId + 1]; ++triangle)
+        {
+            const auto a = position(aIndices[3 * triangle]);
+            const auto b = position(aIndices[3 * triangle + 1]);
+            const auto c = position(aIndices[3 * triangle + 2]);
+            const double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            const double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            // Cross product is twice the area-weighted normal.
+            const double normal[3] = {
+                ab[1] * ac[2] - ab[2] * ac[1],
+                ab[2] * ac[0] - ab[0] * ac[2],
+                ab[0] * ac[1] - ab[1] * ac[0],
+            };
+            const double area = 0.5 * std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (std::size_t axis = 0; axis != 3; ++axis)
+            {
+                const double centroid = (a[axis] + b[axis] + c[axis]) / 3.;
+                cluster.centroid[axis] += centroid * area;
+                cluster.normal[axis] += normal[axis];
+                meshCentroid[axis] += centroid * area;
+            }
+            cluster.area += area;
+            meshArea += area;
+        }
+    }
+
+    if (meshArea > 0.)
+    {
+        for (double & coordinate : meshCentroid)
+        {
+            coordinate /= meshArea;
+        }
+    }
+
+    for (Cluster & cluster : clusters)
+    {
+        if (cluster.area > 0.)
+        {
+            double dot = 0.;
+            for (std::size_t axis = 0; axis != 3; ++axis)
+            {
+                dot += (cluster.centroid[axis] / cluster.area - meshCentroid[axis]) * cluster.normal[axis];
+            }
+            const double normalLength = std::sqrt(cluster.normal[0] * cluster.normal[0]
+                                                  + cluster.normal[1] * cluster.normal[1]
+                                                  + cluster.normal[2] * cluster.normal[2]);
+            cluster.sortKey = (normalLength > 0.) ? dot / normalLength : 0.;
+        }
+    }
+
+    // Outward facing clusters first, they are likely to occlude the rest.
+    // Stable sort keeps the result deterministic, and preserves input order among equals.
+    std::vector<std::size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t aLhs, std::size_t aRhs)
+                     { return clusters[aLhs].sortKey > clusters[aRhs].sortKey; });
+
+    std::vector<std::uint32_t> result;
+    result.reserve(aIndices.size());
+    for (std::size_t clusterId : order)
+    {
+        result.insert(result.end(),
+                      aIndices.begin() + 3 * clusterStarts[clusterId],
+                      aIndices.begin() + 3 * clusterStarts[clusterId + 1]);
+    }
+
+    if (computeCacheStatistics(result, vertexCount, aCacheSize).acmr
+        > aThreshold * computeCacheStatistics(aIndices, vertexCount, aCacheSize).acmr)
+    {
+        return {aIndices.begin(), aIndices.end()};
+    }
+    return result;
+}
+
+
+std::vector<std::uint32_t> computeFetchRemap(std::span<const std::uint32_t> aIndices,
+                                             std::size_t aVertexCount)
+{
+    checkIndices(aIndices, aVertexCount);
+
+    std::vector<std::uint32_t> remap(aVertexCount, gUnusedVertex);
+    std::uint32_t nextVertex = 0;
+    for (std::uint32_t index : aIndices)
+    {
+        if (remap[index] == gUnusedVertex)
+        {
+            remap[index] = nextVertex++;
+        }
+    }
+    return remap;
+}
+
+
+OptimizedPrimitive optimize(BufferCache & aBuffers,
+                            const Primitive & aPrimitive,
+                            const MeshOptimizationOptions & aOptions)
+{
+    const Gltf & gltf = aBuffers.getGltf();
+
+    if (aPrimitive.mode != gTrianglesMode)
+    {
+        throw std::invalid_argument{"Only triangle list primitives can be optimized."};
+    }
+    if (aPrimitive.attributes.empty())
+    {
+        throw std::invalid_argument{"Primitive has no attributes."};
+    }
+
+    const std::size_t vertexCount = gltf.get(aPrimitive.attributes.begin()->second)->count;
+
+    std::vector<std::uint32_t> indices;
+    if (aPrimitive.indices)
+    {
+        indices = readAsIndices(aBuffers, gltf.get(*aPrimitive.indices));
+    }
+    else
+    {
+        indices.resize(vertexCount);
+        std::iota(indices.begin(), indices.end(), 0);
+    }
+
+    OptimizedPrimitive result{
+        .attributes = {},
+        .indices = {},
+        .indexComponentType = component::UnsignedInt,
+        .indexCount = indices.size(),
+        .vertexCount = 0,
+        .before = computeCacheStatistics(indices, vertexCount, aOptions.cacheSize),
+        .after = {},
+    };
+
+    indices = optimizeVertexCache(indices, vertexCount, aOptions.cacheSize);
+
+    if (aOptions.optimizeOverdraw)
+    {
+        if (auto found = aPrimitive.attributes.find("POSITION"); found != aPrimitive.attributes.end())
+        {
+            const Accessor & positions = gltf.get(found->second);
+            if (positions.type == Accessor::ElementType::Vec3)
+            {
+                indices = optimizeOverdraw(indices,
+                                           readAsFloats(aBuffers, positions),
+                                           aOptions.overdrawThreshold,
+                                           aOptions.cacheSize);
+            }
+        }
+    }
+
+    //
+    // Vertex fetch: vertices are renumbered in their order of first use.
+    //
+    const std::vector<std::uint32_t> remap = computeFetchRemap(indices, vertexCount);
+    for (std::uint32_t & index : indices)
+    {
+        index = remap[index];
+    }
+    result.vertexCount = vertexCount
+        - static_cast<std::size_t>(std::count(remap.begin(), remap.end(), gUnusedVertex));
+
+    for (const auto & [semantic, accessorIndex] : aPrimitive.attributes)
+    {
+        const Accessor & accessor = gltf.get(accessorIndex);
+        if (accessor.count != vertexCount)
+        {
+            throw std::invalid_argument{"Attribute '" + std::string{semantic} + "' count does not match the vertex count."};
+        }
+
+        AccessorView view = makeView(aBuffers, accessor);
+        const std::size_t elementSize = (view.componentCount / view.rows == 1) ?
+            view.rows * getComponentSize(view.componentType)
+            : (view.componentCount / view.rows) * view.columnStride;
+
+        // Sparse accessors are densified first, then remapped as any tightly packed accessor.
+        std::vector<std::byte> densified;
+        if (accessor.sparse)
+        {
+            densified = readElements(aBuffers, accessor);
+            view.data = densified.data();
+            view.stride = elementSize;
+        }
+
+        OptimizedPrimitive::Attribute & attribute = result.attributes.emplace_back(OptimizedPrimitive::Attribute{
+            .semantic = std::string{semantic},
+            .source = accessorIndex,
+            .elementSize = elementSize,
+            .data = std::vector<std::byte>(result.vertexCount * elementSize),
+        });
+
+        if (view.data != nullptr)
+        {
+            for (std::size_t vertex = 0; vertex != vertexCount; ++vertex)
+            {
+                if (remap[vertex] != gUnusedVertex)
+                {
+                    std::memcpy(attribute.data.data() + remap[vertex] * elementSize,
+                                view.data + vertex * view.stride,
+                                elementSize);
+                }
+            }
+        }
+    }
+
+    result.after = computeCacheStatistics(indices, result.vertexCount, aOptions.cacheSize);
+
+    //
+    // Index buffer, the maximal value of a type is reserved for primitive restart.
+    //
+    if (aOptions.downsizeIndices && result.vertexCount < 0xFFFF)
+    {
+        result.indexComponentType = component::UnsignedShort;
+        result.indices.resize(indices.size() * sizeof(std::uint16_t));
+        for (std::size_t position = 0; position != indices.size(); ++position)
+        {
+            const auto index = static_cast<std::uint16_t>(indices[position]);
+            std::memcpy(result.indices.data() + position * sizeof(std::uint16_t), &index, sizeof(index));
+        }
+    }
+    else
+    {
+        result.indices.resize(indices.size() * sizeof(std::uint32_t));
+        std::memcpy(result.indices.data(), indices.data(), result.indices.size());
+    }
+
+    return result;
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
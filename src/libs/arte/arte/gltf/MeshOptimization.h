@@ -0,0 +1,102 @@
+#pragma once
+
+
+#include "Accessor.h"
+#include "Gltf.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Post-transform vertex cache efficiency of an index sequence, simulated with a FIFO cache.
+struct CacheStatistics
+{
+    /// @brief Average Cache Miss Ratio: transformed vertices per triangle (in [0.5, 3], lower is better).
+    double acmr{0.};
+    /// @brief Average Transform to Vertex Ratio: transformed vertices per referenced vertex (1 is optimal).
+    double atvr{0.};
+};
+
+CacheStatistics computeCacheStatistics(std::span<const std::uint32_t> aIndices,
+                                       std::size_t aVertexCount,
+                                       std::size_t aCacheSize = 16);
+
+
+/// @brief Reorder triangles for post-transform vertex cache efficiency, with Tipsify (Sander et al., 2007).
+/// @return The reordered triangle list.
+std::vector<std::uint32_t> optimizeVertexCache(std::span<const std::uint32_t> aIndices,
+                                               std::size_t aVertexCount,
+                                               std::size_t aCacheSize = 16);
+
+/// @brief Reorder clusters of triangles, so surfaces facing outward from the mesh center are drawn first.
+///
+/// Expects a cache optimized triangle list: clusters are delimited where the cache was flushed,
+/// so reordering them barely affects cache efficiency.
+/// @param aPositions 3 floats per vertex.
+/// @param aThreshold The reordering is discarded if it degrades ACMR by more than this factor.
+std::vector<std::uint32_t> optimizeOverdraw(std::span<const std::uint32_t> aIndices,
+                                            std::span<const float> aPositions,
+                                            float aThreshold = 1.05f,
+                                            std::size_t aCacheSize = 16);
+
+/// @brief Compute the vertex remapping placing vertices in their order of first use by the indices.
+/// @return For each source vertex, its new index (or gUnusedVertex if it is not referenced).
+std::vector<std::uint32_t> computeFetchRemap(std::span<const std::uint32_t> aIndices,
+                                             std::size_t aVertexCount);
+
+constexpr std::uint32_t gUnusedVertex = 0xFFFFFFFF;
+
+
+struct MeshOptimizationOptions
+{
+    std::size_t cacheSize{16};
+    bool optimizeOverdraw{true};
+    float overdrawThreshold{1.05f};
+    /// @brief Write 16 bits indices when all indices fit.
+    bool downsizeIndices{true};
+};
+
+
+/// @brief New buffers for a triangle primitive, after optimization.
+struct OptimizedPrimitive
+{
+    struct Attribute
+    {
+        std::string semantic;
+        Index<Accessor> source; // Component and element types are unchanged.
+        std::size_t elementSize;
+        std::vector<std::byte> data; // Tightly packed, in the remapped vertex order.
+    };
+
+    std::vector<Attribute> attributes;
+    std::vector<std::byte> indices;
+    EnumType indexComponentType; // component::UnsignedShort or component::UnsignedInt
+    std::size_t indexCount;
+    std::size_t vertexCount;
+
+    CacheStatistics before;
+    CacheStatistics after;
+};
+
+
+/// @brief Optimize a triangle list primitive for vertex cache, overdraw, then vertex fetch.
+///
+/// The source buffers are not modified, the result is written to new buffers.
+/// Sparse attributes are densified.
+/// @throw std::invalid_argument if the primitive is not a triangle list.
+OptimizedPrimitive optimize(BufferCache & aBuffers,
+                            const Primitive & aPrimitive,
+                            const MeshOptimizationOptions & aOptions = {});
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,515 @@
+#include "MeshSimplification.h"
+
+#include "../detail/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    constexpr EnumType gTrianglesMode = 4; // GL_TRIANGLES
+
+    // A triangle whose doubled area falls below this fraction of its original value is considered degenerate.
+    constexpr double gDegenerateRatio = 1e-6;
+
+
+    using Vec3 = std::array<double, 3>;
+
+    Vec3 operator-(const Vec3 & aLhs, const Vec3 & aRhs)
+    { return {aLhs[0] - aRhs[0], aLhs[1] - aRhs[1], aLhs[2] - aRhs[2]}; }
+
+    Vec3 cross(const Vec3 & aLhs, const Vec3 & aRhs)
+    {
+        return {
+            aLhs[1] * aRhs[2] - aLhs[2] * aRhs[1],
+            aLhs[2] * aRhs[0] - aLhs[0] * aRhs[2],
+            aLhs[0] * aRhs[1] - aLhs[1] * aRhs[0],
+        };
+    }
+
+    double dot(const Vec3 & aLhs, const Vec3 & aRhs)
+    { return aLhs[0] * aRhs[0] + aLhs[1] * aRhs[1] + aLhs[2] * aRhs[2]; }
+
+
+    /// @brief Symmetric 4x4 quadric, with the accumulated weight of its planes.
+    struct Quadric
+    {
+        /// @brief Quadric of the squared distance to the plane `aNormal . x + aD = 0`, aNormal being unit length.
+        static Quadric FromPlane(const Vec3 & aNormal, double aD, double aWeight)
+        {
+            const auto [a, b, c] = aNormal;
+            const double w = aWeight;
+            return Quadric{
+                {w*a*a, w*a*b, w*a*c, w*a*aD, w*b*b, w*b*c, w*b*aD, w*c*c, w*c*aD, w*aD*aD},
+                aWeight
+            };
+        }
+
+        Quadric & operator+=(const Quadric & aRhs)
+        {
+            for (std::size_t i = 0; i != q.size(); ++i)
+            {
+                q[i] += aRhs.q[i];
+            }
+            weight += aRhs.weight;
+            return *this;
+        }
+
+        /// @brief Weighted sum of squared distances from aPoint to the planes.
+        double evaluate(const Vec3 & aPoint) const
+        {
+            const auto [x, y, z] = aPoint;
+            return q[0]*x*x + 2*q[1]*x*y + 2*q[2]*x*z + 2*q[3]*x
+                 + q[4]*y*y + 2*q[5]*y*z + 2*q[6]*y
+                 + q[7]*z*z + 2*q[8]*z
+                 + q[9];
+        }
+
+        // a2, ab, ac, ad, b2, bc, bd, c2, cd, d2
+        std::array<double, 10> q{};
+        double weight{0.};
+    };
+
+
+    struct Collapse
+    {
+        double cost;
+        std::uint32_t from;
+        std::uint32_t to;
+        std::uint32_t fromVersion;
+        std::uint32_t toVersion;
+
+        // Min-heap on cost, ties broken by vertex indices for determinism.
+        bool operator<(const Collapse & aRhs) const
+        {
+            return std::tie(cost, from, to) > std::tie(aRhs.cost, aRhs.from, aRhs.to);
+        }
+    };
+
+
+    class Simplifier
+    {
+    public:
+        Simplifier(std::span<const std::uint32_t> aIndices, std::span<const float> aPositions);
+
+        Lod run(std::size_t aTargetIndexCount, double aMaximumError);
+
+    private:
+        Vec3 position(std::uint32_t aVertex) const
+        {
+            return {mPositions[3 * aVertex], mPositions[3 * aVertex + 1], mPositions[3 * aVertex + 2]};
+        }
+
+        void lockSeamsAndBorders();
+
+        /// @brief Remove dead triangles from the vertex triangle list, and return it.
+        std::vector<std::uint32_t> & aliveTriangles(std::uint32_t aVertex);
+
+        void pushCollapses(std::uint32_t aVertex);
+
+        double cost(std::uint32_t aFrom, std::uint32_t aTo) const;
+
+        bool isValid(std::uint32_t aFrom, std::uint32_t aTo);
+
+        void collapse(std::uint32_t aFrom, std::uint32_t aTo);
+
+        std::span<const float> mPositions;
+        std::vector<std::uint32_t> mIndices;
+        std::vector<bool> mTriangleAlive;
+        std::vector<double> mTriangleAreas; // twice the original area
+        std::size_t mAliveTriangleCount;
+
+        std::vector<std::vector<std::uint32_t>> mVertexTriangles;
+        std::vector<Quadric> mQuadrics;
+        std::vector<bool> mLocked;
+        std::vector<std::uint32_t> mVersions;
+
+        std::priority_queue<Collapse> mQueue;
+    };
+
+
+    Simplifier::Simplifier(std::span<const std::uint32_t> aIndices, std::span<const float> aPositions) :
+        mPositions{aPositions},
+        mIndices{aIndices.begin(), aIndices.end()},
+        mTriangleAlive(aIndices.size() / 3, true),
+        mTriangleAreas(aIndices.size() / 3, 0.),
+        mAliveTriangleCount{aIndices.size() / 3},
+        mVertexTriangles(aPositions.size() / 3),
+        mQuadrics(aPositions.size() / 3),
+        mLocked(aPositions.size() / 3, false),
+        mVersions(aPositions.size() / 3, 0)
+    {
+        const std::size_t vertexCount = aPositions.size() / 3;
+        if (aIndices.size() % 3 != 0)
+        {
+            throw std::invalid_argument{"Index count must be a multiple of 3 for triangle lists."};
+        }
+        if (std::any_of(aIndices.begin(), aIndices.end(),
+                        [vertexCount](std::uint32_t aIndex){ return aIndex >= vertexCount; }))
+        {
+            throw std::out_of_range{"Index exceeds the vertex count."};
+        }
+
+        for (std::uint32_t triangle = 0; triangle != mTriangleAlive.size(); ++triangle)
+        {
+            const std::uint32_t * corners = &mIndices[3 * triangle];
+            const Vec3 a = position(corners[0]);
+            const Vec3 normal = cross(position(corners[1]) - a, position(corners[2]) - a);
+            const double length = std::sqrt(dot(normal, normal));
+            mTriangleAreas[triangle] = length;
+            for (std::size_t corner = 0; corner != 3; ++corner)
+            {
+                mVertexTriangles[corners[corner]].push_back(triangle);
+            }
+            if (length > 0.)
+            {
+                const Vec3 unit{normal[0] / length, normal[1] / length, normal[2] / length};
+                const Quadric plane = Quadric::FromPlane(unit, -dot(unit, a), 0.5 * length);
+                for (std::size_t corner = 0; corner != 3; ++corner)
+                {
+                    mQuadrics[corners[corner]] += plane;
+                }
+            }
+        }
+
+        lockSeamsAndBorders();
+    }
+
+
+    void Simplifier::lockSeamsAndBorders()
+    {
+        const std::size_t vertexCount = mLocked.size();
+
+        // Weld vertices by exact position, group ids are assigned in vertex order.
+        std::map<std::array<float, 3>, std::uint32_t> positionToGroup;
+        std::vector<std::uint32_t> groups(vertexCount);
+        std::vector<std::uint32_t> groupSizes;
+        for (std::uint32_t vertex = 0; vertex != vertexCount; ++vertex)
+        {
+            std::array<float, 3> key{mPositions[3 * vertex], mPositions[3 * vertex + 1], mPositions[3 * vertex + 2]};
+            auto [found, inserted] = positionToGroup.try_emplace(key, static_cast<std::uint32_t>(groupSizes.size()));
+            if (inserted)
+            {
+                groupSizes.push_back(0);
+            }
+            groups[vertex] = found->second;
+            ++groupSizes[found->second];
+        }
+
+        // Attribute seams: distinct vertices share the position.
+        for (std::uint32_t vertex = 0; vertex != vertexCount; ++vertex)
+        {
+            if (groupSizes[groups[vertex]] > 1)
+            {
+                mLocked[vertex] = true;
+            }
+        }
+
+        // Borders and non-manifold edges of the welded topology: not shared by exactly 2 triangles.
+        std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> edgeUses;
+        for (std::size_t corner = 0; corner != mIndices.size(); ++corner)
+        {
+            const std::uint32_t a = groups[mIndices[corner]];
+            const std::uint32_t b = groups[mIndices[corner - corner % 3 + (corner % 3 + 1) % 3]];
+            ++edgeUses[std::minmax(a, b)];
+        }
+        std::vector<bool> lockedGroups(groupSizes.size(), false);
+        for (const auto & [edge, uses] : edgeUses)
+        {
+            if (uses != 2)
+            {
+                lockedGroups[edge.first] = true;
+                lockedGroups[edge.second] = true;
+            }
+        }
+        for (std::uint32_t vertex = 0; vertex != vertexCount; ++vertex)
+        {
+            if (lockedGroups[groups[vertex]])
+            {
+                mLocked[vertex] = true;
+            }
+        }
+    }
+
+
+    std::vector<std::uint32_t> & Simplifier::aliveTriangles(std::uint32_t aVertex)
+    {
+        std::vector<std::uint32_t> & triangles = mVertexTriangles[aVertex];
+        std::erase_if(triangles, [this](std::uint32_t aTriangle){ return !mTriangleAlive[aTriangle]; });
+        return triangles;
+    }
+
+
+    double Simplifier::cost(std::uint32_t aFrom, std::uint32_t aTo) const
+    {
+        Quadric quadric = mQuadrics[aFrom];
+        quadric += mQuadrics[aTo];
+        return (quadric.weight > 0.) ? std::max(0., quadric.evaluate(position(aTo)) / quadric.weight) : 0.;
+    }
+
+
+    void Simplifier::pushCollapses(std::uint32_t aVertex)
+    {
+        for (std::uint32_t triangle : aliveTriangles(aVertex))
+        {
+            for (std::size_t corner = 0; corner != 3; ++corner)
+            {
+                const std::uint32_t other = mIndices[3 * triangle + corner];
+                if (other == aVertex)
+                {
+                    continue;
+                }
+                // Both directions of the edge, unless the moving vertex is locked.
+                if (!mLocked[aVertex])
+                {
+                    mQueue.push({cost(aVertex, other), aVertex, other, mVersions[aVertex], mVersions[other]});
+                }
+                if (!mLocked[other])
+                {
+                    mQueue.push({cost(other, aVertex), other, aVertex, mVersions[other], mVersions[aVertex]});
+                }
+            }
+        }
+    }
+
+
+    bool Simplifier::isValid(std::uint32_t aFrom, std::uint32_t aTo)
+    {
+        // Link condition: the common neighbours of both vertices are exactly the apices of the shared triangles.
+        auto neighbours = [this](std::uint32_t aVertex)
+        {
+            std::vector<std::uint32_t> result;
+            for (std::uint32_t triangle : aliveTriangles(aVertex))
+            {
+                for (std::size_t corner = 0; corner != 3; ++corner)
+                {
+                    if (mIndices[3 * triangle + corner] != aVertex)
+                    {
+                        result.push_back(mIndices[3 * triangle + corner]);
+                    }
+                }
+            }
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+            return result;
+        };
+        std::vector<std::uint32_t> fromNeighbours = neighbours(aFrom);
+        std::vector<std::uint32_t> toNeighbours = neighbours(aTo);
+        std::vector<std::uint32_t> common;
+        std::set_intersection(fromNeighbours.begin(), fromNeighbours.end(),
+                              toNeighbours.begin(), toNeighbours.end(),
+                              std::back_inserter(common));
+
+        std::size_t sharedTriangles = 0;
+        for (std::uint32_t triangle : mVertexTriangles[aFrom])
+        {
+            const std::uint32_t * corners = &mIndices[3 * triangle];
+            if (corners[0] == aTo || corners[1] == aTo || corners[2] == aTo)
+            {
+                ++sharedTriangles;
+            }
+        }
+        if (sharedTriangles == 0 || common.size() != sharedTriangles)
+        {
+            return false;
+        }
+
+        // Moving aFrom onto aTo must neither flip nor degenerate the remaining triangles.
+        const Vec3 target = position(aTo);
+        for (std::uint32_t triangle : mVertexTriangles[aFrom])
+        {
+            const std::uint32_t * corners = &mIndices[3 * triangle];
+            if (corners[0] == aTo || corners[1] == aTo || corners[2] == aTo)
+            {
+                continue;
+            }
+            Vec3 before[3], after[3];
+            for (std::size_t corner = 0; corner != 3; ++corner)
+            {
+                before[corner] = position(corners[corner]);
+                after[corner] = (corners[corner] == aFrom) ? target : before[corner];
+            }
+            const Vec3 normalBefore = cross(before[1] - before[0], before[2] - before[0]);
+            const Vec3 normalAfter = cross(after[1] - after[0], after[2] - after[0]);
+            if (dot(normalBefore, normalAfter) <= 0.
+                || std::sqrt(dot(normalAfter, normalAfter)) < gDegenerateRatio * mTriangleAreas[triangle])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    void Simplifier::collapse(std::uint32_t aFrom, std::uint32_t aTo)
+    {
+        for (std::uint32_t triangle : mVertexTriangles[aFrom])
+        {
+            std::uint32_t * corners = &mIndices[3 * triangle];
+            if (corners[0] == aTo || corners[1] == aTo || corners[2] == aTo)
+            {
+                mTriangleAlive[triangle] = false;
+                --mAliveTriangleCount;
+            }
+            else
+            {
+                std::replace(corners, corners + 3, aFrom, aTo);
+                mVertexTriangles[aTo].push_back(triangle);
+            }
+        }
+        mVertexTriangles[aFrom].clear();
+        mQuadrics[aTo] += mQuadrics[aFrom];
+
+        // Invalidate queued collapses involving either vertex.
+        ++mVersions[aFrom];
+        ++mVersions[aTo];
+        // aFrom is now unreferenced, make sure it never moves again.
+        mLocked[aFrom] = true;
+    }
+
+
+    Lod Simplifier::run(std::size_t aTargetIndexCount, double aMaximumError)
+    {
+        for (std::uint32_t vertex = 0; vertex != mVertexTriangles.size(); ++vertex)
+        {
+            if (!mLocked[vertex])
+            {
+                for (std::uint32_t triangle : mVertexTriangles[vertex])
+                {
+                    for (std::size_t corner = 0; corner != 3; ++corner)
+                    {
+                        const std::uint32_t other = mIndices[3 * triangle + corner];
+                        if (other != vertex)
+                        {
+                            mQueue.push({cost(vertex, other), vertex, other, mVersions[vertex], mVersions[other]});
+                        }
+                    }
+                }
+            }
+        }
+
+        const double maximumSquaredError = aMaximumError * aMaximumError;
+        double reachedError = 0.;
+        while (3 * mAliveTriangleCount > aTargetIndexCount && !mQueue.empty())
+        {
+            Collapse candidate = mQueue.top();
+            mQueue.pop();
+
+            if (mLocked[candidate.from]
+                || candidate.fromVersion != mVersions[candidate.from]
+                || candidate.toVersion != mVersions[candidate.to])
+            {
+                continue; // stale
+            }
+            if (candidate.cost > maximumSquaredError)
+            {
+                break;
+            }
+            if (!isValid(candidate.from, candidate.to))
+            {
+                continue;
+            }
+
+            collapse(candidate.from, candidate.to);
+            reachedError = std::max(reachedError, candidate.cost);
+            pushCollapses(candidate.to);
+        }
+
+        Lod result{.indices = {}, .error = static_cast<float>(std::sqrt(reachedError))};
+        result.indices.reserve(3 * mAliveTriangleCount);
+        for (std::uint32_t triangle = 0; triangle != mTriangleAlive.size(); ++triangle)
+        {
+            if (mTriangleAlive[triangle])
+            {
+                result.indices.insert(result.indices.end(), &mIndices[3 * triangle], &mIndices[3 * triangle] + 3);
+            }
+        }
+        return result;
+    }
+
+} // anonymous namespace
+
+
+Lod simplify(std::span<const std::uint32_t> aIndices,
+             std::span<const float> aPositions,
+             std::size_t aTargetIndexCount,
+             float aMaximumError)
+{
+    return Simplifier{aIndices, aPositions}.run(aTargetIndexCount, aMaximumError);
+}
+
+
+std::vector<Lod> generateLodChain(std::span<const std::uint32_t> aIndices,
+                                  std::span<const float> aPositions,
+                                  const LodOptions & aOptions)
+{
+    std::vector<Lod> chain;
+    chain.push_back(Lod{.indices = {aIndices.begin(), aIndices.end()}, .error = 0.f});
+
+    while (chain.size() < aOptions.maximumLevels)
+    {
+        const Lod & previous = chain.back();
+        const std::size_t target =
+            3 * static_cast<std::size_t>(static_cast<float>(previous.indices.size() / 3) * aOptions.reductionRatio);
+        if (target < 3 * aOptions.minimumTriangles)
+        {
+            break;
+        }
+
+        Lod next = simplify(previous.indices, aPositions, target);
+        // Not worth a level if it did not get close to the target (e.g. too many locked vertices).
+        if (next.indices.size() > (previous.indices.size() + target) / 2)
+        {
+            break;
+        }
+        // The deviation from the previous level adds up to the deviation of the previous level.
+        next.error += previous.error;
+        chain.push_back(std::move(next));
+    }
+
+    return chain;
+}
+
+
+std::vector<MeshLods> generateLods(BufferCache & aBuffers, const LodOptions & aOptions)
+{
+    const Gltf & gltf = aBuffers.getGltf();
+    const std::span<const Mesh> meshes = gltf.getMeshSpan();
+
+    std::vector<MeshLods> result(meshes.size());
+    detail::parallelFor(meshes.size(), [&](std::size_t aMeshId)
+    {
+        const Mesh & mesh = meshes[aMeshId];
+        MeshLods & lods = result[aMeshId];
+        lods.resize(mesh.primitives.size());
+        for (std::size_t primitiveId = 0; primitiveId != mesh.primitives.size(); ++primitiveId)
+        {
+            const Primitive & primitive = mesh.primitives[primitiveId];
+            auto position = primitive.attributes.find("POSITION");
+            if (primitive.mode != gTrianglesMode || !primitive.indices || position == primitive.attributes.end())
+            {
+                continue;
+            }
+            lods[primitiveId] = generateLodChain(readAsIndices(aBuffers, gltf.get(*primitive.indices)),
+                                                 readAsFloats(aBuffers, gltf.get(position->second)),
+                                                 aOptions);
+        }
+    });
+    return result;
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
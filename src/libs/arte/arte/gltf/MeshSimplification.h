@@ -0,0 +1,76 @@
+#pragma once
+
+
+#include "Accessor.h"
+#include "Gltf.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief A level of detail of a triangle list, indexing the same vertices as the source.
+struct Lod
+{
+    std::vector<std::uint32_t> indices;
+    /// @brief Approximate geometric deviation from the full resolution mesh, in model space units.
+    /// Projected to screen space, it allows to select the coarsest acceptable level.
+    float error{0.f};
+};
+
+
+/// @brief Simplify a triangle list with quadric error metrics (Garland & Heckbert, 1997).
+///
+/// Edges are collapsed onto one of their existing vertices (half-edge collapse), so no vertex is created
+/// and the vertex attributes stay valid. Vertices on attribute seams (sharing a position with other vertices),
+/// on open borders and on non-manifold edges are locked.
+/// Collapses flipping a triangle, or breaking the manifold topology, are rejected.
+/// The result is deterministic.
+///
+/// @param aPositions 3 floats per vertex.
+/// @param aTargetIndexCount Stop when the index count is at most this value.
+/// @param aMaximumError Stop before a collapse would exceed this error (see Lod::error).
+Lod simplify(std::span<const std::uint32_t> aIndices,
+             std::span<const float> aPositions,
+             std::size_t aTargetIndexCount,
+             float aMaximumError = std::numeric_limits<float>::max());
+
+
+struct LodOptions
+{
+    /// @brief Target index count of each level, relative to the previous level.
+    float reductionRatio{0.5f};
+    /// @brief Maximal number of levels, including the full resolution level 0.
+    std::size_t maximumLevels{8};
+    /// @brief No level is generated below this count of triangles.
+    std::size_t minimumTriangles{32};
+};
+
+
+/// @brief Generate levels of decreasing detail, starting with the source triangles as level 0.
+///
+/// Each level simplifies the previous one, and records its accumulated error.
+/// The chain stops early when simplification cannot make enough progress (e.g. because of locked vertices).
+std::vector<Lod> generateLodChain(std::span<const std::uint32_t> aIndices,
+                                  std::span<const float> aPositions,
+                                  const LodOptions & aOptions = {});
+
+
+/// @brief LOD chain of each primitive of a mesh, empty for primitives that are not indexed triangle lists.
+using MeshLods = std::vector<std::vector<Lod>>;
+
+/// @brief Generate the LOD chains of all meshes of the glTF, meshes being processed in parallel.
+/// @return One entry per mesh, in the glTF order.
+std::vector<MeshLods> generateLods(BufferCache & aBuffers, const LodOptions & aOptions = {});
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,440 @@
+#include "Meshlets.h"
+
+#include "../detail/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    constexpr EnumType gTrianglesMode = 4; // GL_TRIANGLES
+
+    constexpr char gMagic[4] = {'M', 'S', 'H', 'L'};
+    constexpr std::uint32_t gVersion = 1;
+
+    // Below this value, the normals are too spread for the cone to ever cull.
+    constexpr float gMinimumConeSpread = 0.1f;
+
+    using Vec3 = std::array<float, 3>;
+
+    Vec3 operator-(const Vec3 & aLhs, const Vec3 & aRhs)
+    { return {aLhs[0] - aRhs[0], aLhs[1] - aRhs[1], aLhs[2] - aRhs[2]}; }
+
+    float dot(const Vec3 & aLhs, const Vec3 & aRhs)
+    { return aLhs[0] * aRhs[0] + aLhs[1] * aRhs[1] + aLhs[2] * aRhs[2]; }
+
+    float length(const Vec3 & aVec)
+    { return std::sqrt(dot(aVec, aVec)); }
+
+
+    /// @brief Ritter's bounding sphere, from the meshlet vertices.
+    void computeSphere(Meshlet & aMeshlet, std::span<const std::uint32_t> aVertices, std::span<const float> aPositions)
+    {
+        auto position = [&](std::uint32_t aLocal) -> Vec3
+        {
+            const float * p = &aPositions[3 * aVertices[aLocal]];
+            return {p[0], p[1], p[2]};
+        };
+        auto farthest = [&](const Vec3 & aFrom)
+        {
+            std::uint32_t result = 0;
+            float distance = -1.f;
+            for (std::uint32_t local = 0; local != aVertices.size(); ++local)
+            {
+                if (float candidate = length(position(local) - aFrom); candidate > distance)
+                {
+                    distance = candidate;
+                    result = local;
+                }
+            }
+            return position(result);
+        };
+
+        const Vec3 a = farthest(position(0));
+        const Vec3 b = farthest(a);
+        Vec3 center{(a[0] + b[0]) / 2.f, (a[1] + b[1]) / 2.f, (a[2] + b[2]) / 2.f};
+        float radius = length(b - a) / 2.f;
+
+        for (std::uint32_t local = 0; local != aVertices.size(); ++local)
+        {
+            const Vec3 offset = position(local) - center;
+            if (const float distance = length(offset); distance > radius)
+            {
+                // Grow the sphere to just enclose the point.
+                const float newRadius = (radius + distance) / 2.f;
+                const float shift = (newRadius - radius) / distance;
+                for (std::size_t axis = 0; axis != 3; ++axis)
+                {
+                    center[axis] += offset[axis] * shift;
+                }
+                radius = newRadius;
+            }
+        }
+
+        aMeshlet.center = center;
+        aMeshlet.radius = radius;
+    }
+
+
+    /// @brief Normal cone of the meshlet triangles, requires the bounding sphere.
+    void computeCone(Meshlet & aMeshlet,
+                     std::span<const std::uint32_t> aVertices,
+                     std::span<const std::uint8_t> aTriangles,
+                     std::span<const float> aPositions)
+    {
+        std::vector<Vec3> normals;
+        std::vector<Vec3> corners;
+        Vec3 sum{0.f, 0.f, 0.f};
+        for (std::size_t triangle = 0; triangle != aTriangles.size() / 3; ++triangle)
+        {
+            Vec3 p[3];
+            for (std::size_t corner = 0; corner != 3; ++corner)
+            {
+                const float * source = &aPositions[3 * aVertices[aTriangles[3 * triangle + corner]]];
+                p[corner] = {source[0], source[1], source[2]};
+            }
+            const Vec3 ab = p[1] - p[0];
+            const Vec3 ac = p[2] - p[0];
+            Vec3 normal{ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+            const float area = length(normal);
+            if (area == 0.f)
+            {
+                continue; // degenerate triangles are never visible
+            }
+            for (float & coordinate : normal)
+            {
+                coordinate /= area;
+            }
+            normals.push_back(normal);
+            corners.push_back(p[0]);
+            for (std::size_t axis = 0; axis != 3; ++axis)
+            {
+                sum[axis] += normal[axis];
+            }
+        }
+
+        aMeshlet.coneApex = aMeshlet.center;
+        aMeshlet.coneAxis = {0.f, 0.f, 1.f};
+        aMeshlet.coneCutoff = 1.f;
+
+        const float sumLength = length(sum);
+        if (sumLength == 0.f)
+        {
+            return;
+        }
+        const Vec3 axis{sum[0] / sumLength, sum[1] / sumLength, sum[2] / sumLength};
+
+        float minimumDot = 1.f;
+        for (const Vec3 & normal : normals)
+        {
+            minimumDot = std::min(minimumDot, dot(axis, normal));
+        }
+        aMeshlet.coneAxis = axis;
+        if (minimumDot <= gMinimumConeSpread)
+        {
+            return;
+        }
+
+        // Move the apex back along the axis, until all triangle planes are in front of it.
+        float maximumOffset = 0.f;
+        for (std::size_t triangle = 0; triangle != normals.size(); ++triangle)
+        {
+            const float offset = dot(aMeshlet.center - corners[triangle], normals[triangle])
+                                 / dot(axis, normals[triangle]);
+            maximumOffset = std::max(maximumOffset, offset);
+        }
+        for (std::size_t coordinate = 0; coordinate != 3; ++coordinate)
+        {
+            aMeshlet.coneApex[coordinate] = aMeshlet.center[coordinate] - axis[coordinate] * maximumOffset;
+        }
+        // Sine of the cone half angle.
+        aMeshlet.coneCutoff = std::sqrt(1.f - minimumDot * minimumDot);
+    }
+
+
+    template <class T_value>
+    void writeRaw(std::ostream & aOut, const T_value & aValue)
+    {
+        aOut.write(reinterpret_cast<const char *>(&aValue), sizeof(T_value));
+    }
+
+    template <class T_value>
+    void writeVector(std::ostream & aOut, const std::vector<T_value> & aValues)
+    {
+        writeRaw(aOut, static_cast<std::uint64_t>(aValues.size()));
+        aOut.write(reinterpret_cast<const char *>(aValues.data()), aValues.size() * sizeof(T_value));
+    }
+
+    template <class T_value>
+    T_value readRaw(std::istream & aIn)
+    {
+        T_value value;
+        if (!aIn.read(reinterpret_cast<char *>(&value), sizeof(T_value)))
+        {
+            throw std::runtime_error{"Unexpected end of serialized meshlets."};
+        }
+        return value;
+    }
+
+    template <class T_value>
+    std::vector<T_value> readVector(std::istream & aIn)
+    {
+        std::vector<T_value> values(readRaw<std::uint64_t>(aIn));
+        if (!aIn.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(T_value)))
+        {
+            throw std::runtime_error{"Unexpected end of serialized meshlets."};
+        }
+        return values;
+    }
+
+} // anonymous namespace
+
+
+bool isBackFacing(const Meshlet & aMeshlet, const std::array<float, 3> & aEye)
+{
+    if (aMeshlet.coneCutoff >= 1.f)
+    {
+        return false;
+    }
+    const Vec3 direction = aMeshlet.coneApex - aEye;
+    return dot(direction, aMeshlet.coneAxis) >= aMeshlet.coneCutoff * length(direction);
+}
+
+
+void Meshlets::write(std::ostream & aOut) const
+{
+    aOut.write(gMagic, sizeof(gMagic));
+    writeRaw(aOut, gVersion);
+    writeVector(aOut, meshlets);
+    writeVector(aOut, vertices);
+    writeVector(aOut, triangles);
+}
+
+
+Meshlets Meshlets::Read(std::istream & aIn)
+{
+    char magic[sizeof(gMagic)];
+    if (!aIn.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(gMagic)))
+    {
+        throw std::runtime_error{"Stream does not contain serialized meshlets."};
+    }
+    if (auto version = readRaw<std::uint32_t>(aIn); version != gVersion)
+    {
+        throw std::runtime_error{"Unsupported serialized meshlets version: " + std::to_string(version) + "."};
+    }
+
+    Meshlets result;
+    result.meshlets = readVector<Meshlet>(aIn);
+    result.vertices = readVector<std::uint32_t>(aIn);
+    result.triangles = readVector<std::uint8_t>(aIn);
+    return result;
+}
+
+
+Meshlets buildMeshlets(std::span<const std::uint32_t> aIndices,
+                       std::span<const float> aPositions,
+                       std::size_t aMaxVertices,
+                       std::size_t aMaxTriangles)
+{
+    const std::size_t vertexCount = aPositions.size() / 3;
+    const std::size_t triangleCount = aIndices.size() / 3;
+    if (aIndices.size() % 3 != 0)
+    {
+        throw std::invalid_argument{"Index count must be a multiple of 3 for triangle lists."};
+    }
+    if (aMaxVertices < 3 || aMaxVertices > 255 || aMaxTriangles == 0)
+    {
+        throw std::invalid_argument{"Meshlet limits must allow 3 to 255 vertices, and at least one triangle."};
+    }
+    if (std::any_of(aIndices.begin(), aIndices.end(),
+                    [vertexCount](std::uint32_t aIndex){ return aIndex >= vertexCount; }))
+    {
+        throw std::out_of_range{"Index exceeds the vertex count."};
+    }
+
+    // Triangles referencing each vertex (compressed sparse rows).
+    std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::vector<std::uint32_t> adjacency(aIndices.size());
+    for (std::uint32_t index : aIndices)
+    {
+        ++adjacencyOffsets[index + 1];
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+    {
+        std::vector<std::uint32_t> cursors{adjacencyOffsets.begin(), adjacencyOffsets.end() - 1};
+        for (std::size_t corner = 0; corner != aIndices.size(); ++corner)
+        {
+            adjacency[cursors[aIndices[corner]]++] = static_cast<std::uint32_t>(corner / 3);
+        }
+    }
+
+    Meshlets result;
+    std::vector<bool> emitted(triangleCount, false);
+    constexpr std::uint8_t gAbsent = 0xFF;
+    std::vector<std::uint8_t> localIndices(vertexCount, gAbsent);
+
+    Meshlet current{};
+    auto currentVertices = [&]()
+    { return std::span<const std::uint32_t>{result.vertices}.subspan(current.vertexOffset); };
+
+    auto countNewVertices = [&](std::uint32_t aTriangle)
+    {
+        std::size_t count = 0;
+        for (std::size_t corner = 0; corner != 3; ++corner)
+        {
+            count += (localIndices[aIndices[3 * aTriangle + corner]] == gAbsent);
+        }
+        return count;
+    };
+
+    auto flush = [&]()
+    {
+        if (current.triangleCount == 0)
+        {
+            return;
+        }
+        std::span<const std::uint32_t> vertices = currentVertices();
+        for (std::uint32_t vertex : vertices)
+        {
+            localIndices[vertex] = gAbsent;
+        }
+        computeSphere(current, vertices, aPositions);
+        computeCone(current,
+                    vertices,
+                    std::span<const std::uint8_t>{result.triangles}.subspan(current.triangleOffset),
+                    aPositions);
+        result.meshlets.push_back(current);
+        current = Meshlet{};
+        current.vertexOffset = static_cast<std::uint32_t>(result.vertices.size());
+        current.triangleOffset = static_cast<std::uint32_t>(result.triangles.size());
+    };
+
+    auto append = [&](std::uint32_t aTriangle)
+    {
+        for (std::size_t corner = 0; corner != 3; ++corner)
+        {
+            std::uint8_t & local = localIndices[aIndices[3 * aTriangle + corner]];
+            if (local == gAbsent)
+            {
+                local = static_cast<std::uint8_t>(current.vertexCount++);
+                result.vertices.push_back(aIndices[3 * aTriangle + corner]);
+            }
+            result.triangles.push_back(local);
+        }
+        ++current.triangleCount;
+        emitted[aTriangle] = true;
+    };
+
+    std::uint32_t scanCursor = 0;
+    for (std::size_t emittedCount = 0; emittedCount != triangleCount; ++emittedCount)
+    {
+        // Grow through the meshlet vertices: prefer the triangle adding the fewest vertices.
+        std::int64_t best = -1;
+        std::size_t bestNewVertices = 4;
+        for (std::uint32_t vertex : currentVertices())
+        {
+            for (std::uint32_t offset = adjacencyOffsets[vertex]; offset != adjacencyOffsets[vertex + 1]; ++offset)
+            {
+                const std::uint32_t triangle = adjacency[offset];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+                const std::size_t newVertices = countNewVertices(triangle);
+                if (newVertices < bestNewVertices && current.vertexCount + newVertices <= aMaxVertices)
+                {
+                    best = triangle;
+                    bestNewVertices = newVertices;
+                }
+            }
+            if (bestNewVertices == 0)
+            {
+                break;
+            }
+        }
+
+        // Not connected to the current meshlet: start a new meshlet from the next triangle in input order.
+        if (best == -1)
+        {
+            flush();
+            while (emitted[scanCursor])
+            {
+                ++scanCursor;
+            }
+            best = scanCursor;
+        }
+
+        append(static_cast<std::uint32_t>(best));
+        if (current.triangleCount == aMaxTriangles || current.vertexCount == aMaxVertices)
+        {
+            flush();
+        }
+    }
+    flush();
+
+    return result;
+}
+
+
+std::vector<MeshMeshlets> buildMeshlets(BufferCache & aBuffers)
+{
+    const Gltf & gltf = aBuffers.getGltf();
+    const std::span<const Mesh> meshes = gltf.getMeshSpan();
+
+    struct Task
+    {
+        std::size_t mesh;
+        std::size_t primitive;
+    };
+    std::vector<Task> tasks;
+    std::vector<MeshMeshlets> result(meshes.size());
+    for (std::size_t meshId = 0; meshId != meshes.size(); ++meshId)
+    {
+        result[meshId].resize(meshes[meshId].primitives.size());
+        for (std::size_t primitiveId = 0; primitiveId != meshes[meshId].primitives.size(); ++primitiveId)
+        {
+            tasks.push_back({meshId, primitiveId});
+        }
+    }
+
+    detail::parallelFor(tasks.size(), [&](std::size_t aTaskId)
+    {
+        const Task task = tasks[aTaskId];
+        const Primitive & primitive = meshes[task.mesh].primitives[task.primitive];
+        auto position = primitive.attributes.find("POSITION");
+        if (primitive.mode != gTrianglesMode || position == primitive.attributes.end())
+        {
+            return;
+        }
+
+        const Accessor & positions = gltf.get(position->second);
+        std::vector<std::uint32_t> indices;
+        if (primitive.indices)
+        {
+            indices = readAsIndices(aBuffers, gltf.get(*primitive.indices));
+        }
+        else
+        {
+            indices.resize(positions.count);
+            std::iota(indices.begin(), indices.end(), 0);
+        }
+        result[task.mesh][task.primitive] = buildMeshlets(indices, readAsFloats(aBuffers, positions));
+    });
+
+    return result;
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,86 @@
+#pragma once
+
+
+#include "Accessor.h"
+#include "Gltf.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+constexpr std::size_t gMeshletMaxVertices = 64;
+constexpr std::size_t gMeshletMaxTriangles = 124;
+
+
+struct Meshlet
+{
+    std::uint32_t vertexOffset;   // first entry in Meshlets::vertices
+    std::uint32_t triangleOffset; // first entry in Meshlets::triangles (3 entries per triangle)
+    std::uint32_t vertexCount;
+    std::uint32_t triangleCount;
+
+    /// @brief Bounding sphere.
+    std::array<float, 3> center;
+    float radius;
+
+    /// @brief Normal cone: all triangles are back facing for a viewer at `aEye` when
+    /// `dot(normalize(coneApex - aEye), coneAxis) >= coneCutoff`.
+    /// The cutoff is 1 (never culled) when the normals spread too much.
+    std::array<float, 3> coneApex;
+    std::array<float, 3> coneAxis;
+    float coneCutoff;
+};
+
+
+/// @brief Test the meshlet normal cone, true if all its triangles are back facing from `aEye`.
+bool isBackFacing(const Meshlet & aMeshlet, const std::array<float, 3> & aEye);
+
+
+/// @brief A triangle list partitioned into meshlets.
+///
+/// Each meshlet references a contiguous range of `vertices` (indices into the primitive vertices),
+/// and a contiguous range of `triangles`, made of 8-bit local indices into the meshlet vertex range.
+struct Meshlets
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<std::uint32_t> vertices;
+    std::vector<std::uint8_t> triangles;
+
+    /// @brief Binary serialization, in native endianness.
+    void write(std::ostream & aOut) const;
+
+    /// @throw std::runtime_error if the stream does not contain serialized meshlets.
+    static Meshlets Read(std::istream & aIn);
+};
+
+
+/// @brief Partition a triangle list into meshlets, growing each meshlet through shared vertices.
+///
+/// Meshlets follow the order of the input triangles, so a vertex cache optimized input gives better locality.
+/// @param aPositions 3 floats per vertex, used to compute the bounds.
+Meshlets buildMeshlets(std::span<const std::uint32_t> aIndices,
+                       std::span<const float> aPositions,
+                       std::size_t aMaxVertices = gMeshletMaxVertices,
+                       std::size_t aMaxTriangles = gMeshletMaxTriangles);
+
+
+/// @brief Meshlets of each primitive of a mesh, empty for primitives that are not triangle lists.
+using MeshMeshlets = std::vector<Meshlets>;
+
+/// @brief Build the meshlets of all primitives of the glTF, primitives being processed in parallel.
+/// @return One entry per mesh, in the glTF order.
+std::vector<MeshMeshlets> buildMeshlets(BufferCache & aBuffers);
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
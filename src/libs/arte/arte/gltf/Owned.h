@@ -7,8 +7,12 @@
 
 #include <platform/Filesystem.h>
 
+#include <compare>
 #include <iostream>
+#include <iterator>
 #include <optional>
+#include <span>
+#include <type_traits>
 #include <vector>
 
 #include <cassert>
@@ -92,27 +96,32 @@ public:
     //Owned<T_indexed> value_or(std::optional<gltf::Index<T_indexed>> T_element::* aDataMember, const? T_indexed & aDefaultElement) const
 
     template <class T_member>
-    std::vector<Owned<T_member>>
+    OwnedIndexRange<T_member>
     iterate(std::vector<gltf::Index<T_member>> T_element::* aMemberIndexVector)
     {
-        std::vector<Owned<T_member>> result;
-        for (gltf::Index<T_member> index : mElement.*aMemberIndexVector)
-        {
-            result.emplace_back(mOwningGltf.get(index));
-        }
-        return result;
+        return {mOwningGltf, mElement.*aMemberIndexVector};
     }
 
-    // TODO make lazy iteration
     template <class T_member>
-    std::vector<Owned<T_member>> iterate(std::vector<T_member> T_element::* aMemberVector)
+    OwnedIndexRange<T_member>
+    iterate(std::span<const gltf::Index<T_member>> T_element::* aMemberIndexSpan)
     {
-        std::vector<Owned<T_member>> result;
-        for (std::size_t id = 0; id != (mElement.*aMemberVector).size(); ++id)
-        {
-            result.emplace_back(mOwningGltf, (mElement.*aMemberVector)[id], id);
-        }
-        return result;
+        return {mOwningGltf, mElement.*aMemberIndexSpan};
+    }
+
+    template <class T_member>
+    OwnedRange<T_member> iterate(std::vector<T_member> T_element::* aMemberVector)
+    {
+        return {mOwningGltf, mElement.*aMemberVector};
+    }
+
+    /// @note Span members view arrays allocated by the DocumentArena, which are mutable storage:
+    /// their elements are iterated as Owned, as when they were stored in vectors.
+    template <class T_member>
+    OwnedRange<T_member> iterate(std::span<const T_member> T_element::* aMemberSpan)
+    {
+        const std::span<const T_member> members = mElement.*aMemberSpan;
+        return {mOwningGltf, std::span<T_member>{const_cast<T_member *>(members.data()), members.size()}};
     }
 
     filesystem::path getFilePath(gltf::Uri aUri) const
@@ -214,27 +223,29 @@ public:
     }
 
     template <class T_member>
-    std::vector<Const_Owned<T_member>>
+    Const_OwnedIndexRange<T_member>
     iterate(std::vector<gltf::Index<T_member>> T_element::* aMemberIndexVector) const
     {
-        std::vector<Const_Owned<T_member>> result;
-        for (gltf::Index<T_member> index : mElement.*aMemberIndexVector)
-        {
-            result.emplace_back(mOwningGltf.get(index));
-        }
-        return result;
+        return {mOwningGltf, mElement.*aMemberIndexVector};
     }
 
-    // TODO make lazy iteration
     template <class T_member>
-    std::vector<Const_Owned<T_member>> iterate(std::vector<T_member> T_element::* aMemberVector) const
+    Const_OwnedIndexRange<T_member>
+    iterate(std::span<const gltf::Index<T_member>> T_element::* aMemberIndexSpan) const
     {
-        std::vector<Const_Owned<T_member>> result;
-        for (std::size_t id = 0; id != (mElement.*aMemberVector).size(); ++id)
-        {
-            result.emplace_back(mOwningGltf, (mElement.*aMemberVector)[id], id);
-        }
-        return result;
+        return {mOwningGltf, mElement.*aMemberIndexSpan};
+    }
+
+    template <class T_member>
+    Const_OwnedRange<T_member> iterate(std::vector<T_member> T_element::* aMemberVector) const
+    {
+        return {mOwningGltf, mElement.*aMemberVector};
+    }
+
+    template <class T_member>
+    Const_OwnedRange<T_member> iterate(std::span<const T_member> T_element::* aMemberSpan) const
+    {
+        return {mOwningGltf, mElement.*aMemberSpan};
     }
 
     filesystem::path getFilePath(gltf::Uri aUri) const
@@ -260,6 +271,131 @@ private:
 };
 
 
+namespace detail {
+
+    template <class T>
+    struct is_index : std::false_type
+    {};
+
+    template <class T_indexed>
+    struct is_index<gltf::Index<T_indexed>> : std::true_type
+    {};
+
+} // namespace detail
+
+
+/// @brief Random access range producing owned handles on the fly.
+///
+/// T_stored is either the element type, when the range spans elements of a vector,
+/// or an Index, when it spans a vector of indices into the Gltf.
+/// @note The range does not own the storage: it is invalidated with the vector it spans.
+template <class T_owned, class T_gltf, class T_stored>
+class OwnedSequence
+{
+    static T_owned make(T_gltf & aGltf, T_stored * aStored, std::size_t aPosition)
+    {
+        if constexpr (detail::is_index<std::remove_const_t<T_stored>>::value)
+        {
+            return aGltf.get(aStored[aPosition]);
+        }
+        else
+        {
+            return {aGltf, aStored[aPosition], aPosition};
+        }
+    }
+
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T_owned;
+        using difference_type = std::ptrdiff_t;
+        using reference = T_owned;
+        using pointer = void;
+
+        Iterator() = default;
+
+        Iterator(T_gltf * aGltf, T_stored * aStored, std::size_t aPosition) :
+            mGltf{aGltf},
+            mStored{aStored},
+            mPosition{aPosition}
+        {}
+
+        T_owned operator*() const
+        { return make(*mGltf, mStored, mPosition); }
+
+        T_owned operator[](difference_type aOffset) const
+        { return make(*mGltf, mStored, mPosition + aOffset); }
+
+        Iterator & operator++()
+        { ++mPosition; return *this; }
+
+        Iterator operator++(int)
+        { Iterator previous = *this; ++mPosition; return previous; }
+
+        Iterator & operator--()
+        { --mPosition; return *this; }
+
+        Iterator operator--(int)
+        { Iterator previous = *this; --mPosition; return previous; }
+
+        Iterator & operator+=(difference_type aOffset)
+        { mPosition += aOffset; return *this; }
+
+        Iterator & operator-=(difference_type aOffset)
+        { mPosition -= aOffset; return *this; }
+
+        Iterator operator+(difference_type aOffset) const
+        { return Iterator{*this} += aOffset; }
+
+        friend Iterator operator+(difference_type aOffset, const Iterator & aIterator)
+        { return aIterator + aOffset; }
+
+        Iterator operator-(difference_type aOffset) const
+        { return Iterator{*this} -= aOffset; }
+
+        difference_type operator-(const Iterator & aRhs) const
+        { return static_cast<difference_type>(mPosition) - static_cast<difference_type>(aRhs.mPosition); }
+
+        bool operator==(const Iterator & aRhs) const
+        { return mPosition == aRhs.mPosition; }
+
+        auto operator<=>(const Iterator & aRhs) const
+        { return mPosition <=> aRhs.mPosition; }
+
+    private:
+        T_gltf * mGltf{nullptr};
+        T_stored * mStored{nullptr};
+        std::size_t mPosition{0};
+    };
+
+    OwnedSequence(T_gltf & aGltf, std::span<T_stored> aStored) :
+        mGltf{&aGltf},
+        mStored{aStored}
+    {}
+
+    T_owned operator[](std::size_t aPosition) const
+    { return make(*mGltf, mStored.data(), aPosition); }
+
+    std::size_t size() const
+    { return mStored.size(); }
+
+    bool empty() const
+    { return mStored.empty(); }
+
+    Iterator begin() const
+    { return {mGltf, mStored.data(), 0}; }
+
+    Iterator end() const
+    { return {mGltf, mStored.data(), size()}; }
+
+private:
+    T_gltf * mGltf;
+    std::span<T_stored> mStored;
+};
+
+
 //
 // Implementations
 //
@@ -270,8 +406,15 @@ namespace gltf
     template <class T_indexed>
     std::ostream & operator<<(std::ostream & aOut, const std::vector<T_indexed> & aIndexVector)
     {
-        auto begin = std::begin(aIndexVector);
-        auto end = std::end(aIndexVector);
+        return aOut << std::span<const T_indexed>{aIndexVector};
+    }
+
+
+    template <class T_indexed>
+    std::ostream & operator<<(std::ostream & aOut, std::span<const T_indexed> aIndices)
+    {
+        auto begin = std::begin(aIndices);
+        auto end = std::end(aIndices);
 
         aOut << "[";
         if (begin != end)
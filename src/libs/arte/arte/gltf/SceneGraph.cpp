@@ -0,0 +1,296 @@
+#include "SceneGraph.h"
+
+#include "Decomposition.h"
+#include "SceneTraversal.h"
+
+#include "../detail/Parallel.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    // Below this node count, the update is done on the calling thread only.
+    constexpr std::size_t gMinimumParallelSize = 1024;
+
+
+    /// @brief Compose the local transformations of [aFirst, aLast[ from their TRS.
+    ///
+    /// Straight-line arithmetic over the SoA arrays, without branches,
+    /// so the compiler can vectorize it across nodes.
+    void composeLocalTransformations(const SceneGraph::TrsArrays & aTrs,
+                                     SceneGraph::NodeId aFirst,
+                                     SceneGraph::NodeId aLast,
+                                     Affine * aOutput)
+    {
+        const float * tx = aTrs.tx.data(); const float * ty = aTrs.ty.data(); const float * tz = aTrs.tz.data();
+        const float * rx = aTrs.rx.data(); const float * ry = aTrs.ry.data();
+        const float * rz = aTrs.rz.data(); const float * rw = aTrs.rw.data();
+        const float * sx = aTrs.sx.data(); const float * sy = aTrs.sy.data(); const float * sz = aTrs.sz.data();
+
+        for (SceneGraph::NodeId id = aFirst; id != aLast; ++id)
+        {
+            const float x = rx[id], y = ry[id], z = rz[id], w = rw[id];
+            float * e = aOutput[id].elements.data();
+            // See makeAffine(), row i of the rotation is scaled by scale component i.
+            e[0]  = sx[id] * (1.f - 2.f * (y*y + z*z));
+            e[1]  = sx[id] * (2.f * (x*y + z*w));
+            e[2]  = sx[id] * (2.f * (x*z - y*w));
+            e[3]  = sy[id] * (2.f * (x*y - z*w));
+            e[4]  = sy[id] * (1.f - 2.f * (x*x + z*z));
+            e[5]  = sy[id] * (2.f * (y*z + x*w));
+            e[6]  = sz[id] * (2.f * (x*z + y*w));
+            e[7]  = sz[id] * (2.f * (y*z - x*w));
+            e[8]  = sz[id] * (1.f - 2.f * (x*x + y*y));
+            e[9]  = tx[id];
+            e[10] = ty[id];
+            e[11] = tz[id];
+        }
+    }
+
+} // anonymous namespace
+
+
+void SceneGraph::TrsArrays::resize(std::size_t aSize)
+{
+    // New poses are identity.
+    for (std::vector<float> * component : {&tx, &ty, &tz, &rx, &ry, &rz})
+    {
+        component->resize(aSize, 0.f);
+    }
+    for (std::vector<float> * component : {&rw, &sx, &sy, &sz})
+    {
+        component->resize(aSize, 1.f);
+    }
+}
+
+
+SceneGraph::SceneGraph(const Gltf & aGltf, Index<Scene> aScene) :
+    mNodeToId(aGltf.countNodes(), gNoParent)
+{
+    //
+    // Depth-first pre-order flattening.
+    //
+    for (const SceneTraversal::Visit & visit : SceneTraversal{aGltf, aScene})
+    {
+        const Index<Node> node = visit.node.id();
+        if (mNodeToId.at(node) != gNoParent)
+        {
+            throw std::logic_error{"Node " + std::to_string(node)
+                                   + " appears several times in the hierarchy of scene "
+                                   + std::to_string(aScene) + "."};
+        }
+        mNodeToId[node] = static_cast<NodeId>(mNodes.size());
+        mNodes.push_back(node);
+        mParents.push_back(visit.parent ? mNodeToId[*visit.parent] : gNoParent);
+    }
+
+    // Subtrees are contiguous in pre-order: a node subtree ends where its last descendant subtree ends.
+    mSubtreeEnds.resize(size());
+    for (NodeId id = static_cast<NodeId>(size()); id-- != 0;)
+    {
+        mSubtreeEnds[id] = std::max(mSubtreeEnds[id], id + 1);
+        if (NodeId parent = mParents[id]; parent != gNoParent)
+        {
+            mSubtreeEnds[parent] = std::max(mSubtreeEnds[parent], mSubtreeEnds[id]);
+        }
+    }
+
+    //
+    // Initial poses
+    //
+    mLocal.resize(size());
+    mLocalTransformations.resize(size(), Affine::Identity());
+    mWorld.resize(size(), Affine::Identity());
+    mLocalDirty.resize(size(), gPoseChanged);
+    mWorldChanged.resize(size(), 0);
+
+    // Nodes specified by a matrix are decomposed once, so all local poses can be animated as TRS.
+    std::vector<NodeId> matrixNodes;
+    std::vector<Affine> matrices;
+    for (NodeId id = 0; id != size(); ++id)
+    {
+        const Node & node = aGltf.get(mNodes[id]);
+        if (const Node::TRS * trs = std::get_if<Node::TRS>(&node.transformation))
+        {
+            setTranslation(id, trs->translation.x(), trs->translation.y(), trs->translation.z());
+            setRotation(id, trs->rotation.x(), trs->rotation.y(), trs->rotation.z(), trs->rotation.w());
+            setScale(id, trs->scale.x(), trs->scale.y(), trs->scale.z());
+        }
+        else
+        {
+            matrixNodes.push_back(id);
+            matrices.push_back(toAffine(std::get<Node::Matrix>(node.transformation)));
+        }
+    }
+
+    TrsArrays decomposed;
+    decompose(matrices, decomposed);
+    for (std::size_t matrix = 0; matrix != matrixNodes.size(); ++matrix)
+    {
+        const NodeId id = matrixNodes[matrix];
+        setTranslation(id, decomposed.tx[matrix], decomposed.ty[matrix], decomposed.tz[matrix]);
+        setRotation(id, decomposed.rx[matrix], decomposed.ry[matrix], decomposed.rz[matrix], decomposed.rw[matrix]);
+        setScale(id, decomposed.sx[matrix], decomposed.sy[matrix], decomposed.sz[matrix]);
+    }
+
+    std::vector<NodeId> rootIds;
+    for (Index<Node> root : aGltf.get(aScene)->nodes)
+    {
+        rootIds.push_back(mNodeToId[root]);
+    }
+    prepareTasks(rootIds);
+
+    update();
+}
+
+
+std::optional<SceneGraph::NodeId> SceneGraph::find(Index<Node> aNode) const
+{
+    if (aNode < mNodeToId.size() && mNodeToId[aNode] != gNoParent)
+    {
+        return mNodeToId[aNode];
+    }
+    return std::nullopt;
+}
+
+
+void SceneGraph::setTranslation(NodeId aId, float aX, float aY, float aZ)
+{
+    mLocal.tx[aId] = aX;
+    mLocal.ty[aId] = aY;
+    mLocal.tz[aId] = aZ;
+    mLocalDirty[aId] = gPoseChanged;
+}
+
+
+void SceneGraph::setRotation(NodeId aId, float aX, float aY, float aZ, float aW)
+{
+    mLocal.rx[aId] = aX;
+    mLocal.ry[aId] = aY;
+    mLocal.rz[aId] = aZ;
+    mLocal.rw[aId] = aW;
+    mLocalDirty[aId] = gPoseChanged;
+}
+
+
+void SceneGraph::setScale(NodeId aId, float aX, float aY, float aZ)
+{
+    mLocal.sx[aId] = aX;
+    mLocal.sy[aId] = aY;
+    mLocal.sz[aId] = aZ;
+    mLocalDirty[aId] = gPoseChanged;
+}
+
+
+void SceneGraph::prepareTasks(std::span<const NodeId> aRoots)
+{
+    mTasks.assign(aRoots.begin(), aRoots.end());
+    if (size() < gMinimumParallelSize)
+    {
+        return;
+    }
+
+    // Expand the largest subtree until there are enough tasks to keep all workers busy.
+    // The expanded roots have to be updated before their children tasks, so they become serial.
+    const std::size_t targetCount = 4 * detail::getWorkerCount();
+    auto subtreeSize = [this](NodeId aId){ return mSubtreeEnds[aId] - aId; };
+    while (mTasks.size() < targetCount)
+    {
+        auto largest = std::max_element(mTasks.begin(), mTasks.end(),
+                                        [&](NodeId aLhs, NodeId aRhs)
+                                        { return subtreeSize(aLhs) < subtreeSize(aRhs); });
+        if (largest == mTasks.end() || subtreeSize(*largest) < gMinimumParallelSize / 8)
+        {
+            break;
+        }
+
+        NodeId expanded = *largest;
+        mTasks.erase(largest);
+        mSerialNodes.push_back(expanded);
+        for (NodeId child = expanded + 1; child != mSubtreeEnds[expanded]; child = mSubtreeEnds[child])
+        {
+            mTasks.push_back(child);
+        }
+    }
+
+    // Pre-order guarantees ancestors are updated first.
+    std::sort(mSerialNodes.begin(), mSerialNodes.end());
+}
+
+
+void SceneGraph::updateRange(NodeId aFirst, NodeId aLast)
+{
+    // Recompose local transformations by runs of consecutive changed poses.
+    for (NodeId id = aFirst; id != aLast; /* in body */)
+    {
+        if (mLocalDirty[id] != gPoseChanged)
+        {
+            ++id;
+            continue;
+        }
+        NodeId runEnd = id + 1;
+        while (runEnd != aLast && mLocalDirty[runEnd] == gPoseChanged)
+        {
+            ++runEnd;
+        }
+        composeLocalTransformations(mLocal, id, runEnd, mLocalTransformations.data());
+        id = runEnd;
+    }
+
+    // Propagate in pre-order: a parent is always visited before its children.
+    for (NodeId id = aFirst; id != aLast; ++id)
+    {
+        const NodeId parent = mParents[id];
+        const bool parentChanged = (parent != gNoParent) && mWorldChanged[parent];
+        if (mLocalDirty[id] != gClean || parentChanged)
+        {
+            mWorld[id] = (parent == gNoParent) ?
+                mLocalTransformations[id]
+                : compose(mLocalTransformations[id], mWorld[parent]);
+            mWorldChanged[id] = 1;
+        }
+        else
+        {
+            mWorldChanged[id] = 0;
+        }
+        mLocalDirty[id] = gClean;
+    }
+}
+
+
+void SceneGraph::update()
+{
+    for (NodeId serial : mSerialNodes)
+    {
+        updateRange(serial, serial + 1);
+    }
+
+    if (size() < gMinimumParallelSize)
+    {
+        for (NodeId task : mTasks)
+        {
+            updateRange(task, mSubtreeEnds[task]);
+        }
+    }
+    else
+    {
+        detail::parallelFor(mTasks.size(), [this](std::size_t aTaskIndex)
+        {
+            NodeId task = mTasks[aTaskIndex];
+            updateRange(task, mSubtreeEnds[task]);
+        });
+    }
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,133 @@
+#pragma once
+
+
+#include "Affine.h"
+#include "Gltf.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Runtime representation of a glTF scene, flattened in parent-before-child order.
+///
+/// The nodes reachable from the scene roots are stored in depth-first pre-order,
+/// so the descendants of any node are the contiguous range [id + 1, getSubtreeEnd(id)[.
+/// The local poses are kept as Translation/Rotation/Scale in structure-of-arrays,
+/// and the world transformations are only recomputed for the subtrees which changed
+/// since the previous call to `update()`.
+class SceneGraph
+{
+public:
+    /// @brief Position of a node in the flattened order (not to be confused with the glTF node Index).
+    using NodeId = std::uint32_t;
+
+    static constexpr NodeId gNoParent = std::numeric_limits<NodeId>::max();
+
+    /// @brief Local poses, as structure-of-arrays indexed by NodeId.
+    struct TrsArrays
+    {
+        void resize(std::size_t aSize);
+
+        std::vector<float> tx, ty, tz;
+        std::vector<float> rx, ry, rz, rw; // unit quaternion
+        std::vector<float> sx, sy, sz;
+    };
+
+    /// @brief Flatten the nodes reachable from the roots of `aScene`.
+    SceneGraph(const Gltf & aGltf, Index<Scene> aScene);
+
+    std::size_t size() const
+    { return mNodes.size(); }
+
+    Index<Node> getNode(NodeId aId) const
+    { return mNodes[aId]; }
+
+    NodeId getParent(NodeId aId) const
+    { return mParents[aId]; }
+
+    /// @brief One past the last descendant of `aId`.
+    NodeId getSubtreeEnd(NodeId aId) const
+    { return mSubtreeEnds[aId]; }
+
+    /// @brief Find the flattened id of a glTF node, if it is part of this scene.
+    std::optional<NodeId> find(Index<Node> aNode) const;
+
+    //
+    // Local pose
+    //
+    void setTranslation(NodeId aId, float aX, float aY, float aZ);
+    void setRotation(NodeId aId, float aX, float aY, float aZ, float aW);
+    void setScale(NodeId aId, float aX, float aY, float aZ);
+
+    /// @brief Direct access to the local poses, for writers updating many nodes at once.
+    /// @attention Each node written this way has to be flagged via `markLocalDirty()`.
+    TrsArrays & accessLocalPoses()
+    { return mLocal; }
+
+    const TrsArrays & getLocalPoses() const
+    { return mLocal; }
+
+    void markLocalDirty(NodeId aId)
+    { mLocalDirty[aId] = gPoseChanged; }
+
+    //
+    // World transformations
+    //
+    /// @brief Recompute the world transformation of all nodes whose local pose, or an ancestor's, changed.
+    ///
+    /// Independent subtrees are processed in parallel.
+    void update();
+
+    const Affine & getWorldTransformation(NodeId aId) const
+    { return mWorld[aId]; }
+
+    /// @brief Indexed by NodeId, suitable for a direct upload.
+    std::span<const Affine> getWorldTransformations() const
+    { return mWorld; }
+
+    /// @brief Returns true if the world transformation of `aId` was recomputed by the last `update()`.
+    bool isWorldChanged(NodeId aId) const
+    { return mWorldChanged[aId] != 0; }
+
+private:
+    // Values of the local dirty flags.
+    static constexpr std::uint8_t gClean = 0;
+    static constexpr std::uint8_t gPoseChanged = 1; // The TRS changed, local transformation must be recomposed.
+
+    /// @brief Update the nodes in [aFirst, aLast[,
+    /// where the world transformation of the parent of `aFirst` (if any) is already up to date.
+    void updateRange(NodeId aFirst, NodeId aLast);
+
+    /// @brief Split the flattened hierarchy into subtrees that can be updated concurrently.
+    void prepareTasks(std::span<const NodeId> aRoots);
+
+    std::vector<Index<Node>> mNodes;
+    std::vector<NodeId> mParents;
+    std::vector<NodeId> mSubtreeEnds;
+    std::vector<NodeId> mNodeToId; // indexed by glTF node index, gNoParent when absent from the scene.
+
+    TrsArrays mLocal;
+    std::vector<Affine> mLocalTransformations;
+    std::vector<Affine> mWorld;
+    // Note: std::uint8_t instead of bool, so concurrent tasks can write distinct elements.
+    std::vector<std::uint8_t> mLocalDirty;
+    std::vector<std::uint8_t> mWorldChanged;
+
+    // The top of the hierarchy, updated serially (in order) before the tasks.
+    std::vector<NodeId> mSerialNodes;
+    // Roots of the subtrees updated concurrently.
+    std::vector<NodeId> mTasks;
+};
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,90 @@
+#include "SceneTraversal.h"
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+SceneTraversal::SceneTraversal(const Gltf & aGltf, Index<Scene> aScene) :
+    SceneTraversal{aGltf, aGltf.get(aScene)->nodes}
+{}
+
+
+SceneTraversal::SceneTraversal(const Gltf & aGltf, std::span<const Index<Node>> aRoots) :
+    mGltf{aGltf},
+    mRoots{aRoots}
+{}
+
+
+SceneTraversal::Iterator SceneTraversal::begin()
+{
+    mDepth = 0;
+    mDeepFrames.clear();
+    push(mRoots);
+    return Iterator{this};
+}
+
+
+void SceneTraversal::push(std::span<const Index<Node>> aSiblings)
+{
+    if (aSiblings.empty())
+    {
+        return;
+    }
+
+    const Frame pushed{aSiblings.data(), aSiblings.data() + aSiblings.size()};
+    if (mDepth < gInlineDepth)
+    {
+        mInlineFrames[mDepth] = pushed;
+    }
+    else
+    {
+        mDeepFrames.resize(mDepth - gInlineDepth);
+        mDeepFrames.push_back(pushed);
+    }
+    ++mDepth;
+}
+
+
+SceneTraversal::Visit SceneTraversal::current() const
+{
+    std::optional<Index<Node>> parent;
+    if (mDepth > 1)
+    {
+        // A parent frame stays on its node until the node subtree is done.
+        parent = *frame(mDepth - 2).current;
+    }
+    return Visit{
+        .node = mGltf.get(*frame(mDepth - 1).current),
+        .parent = parent,
+        .depth = mDepth - 1,
+    };
+}
+
+
+void SceneTraversal::advance()
+{
+    const std::size_t depthBefore = mDepth;
+    push(mGltf.get(*frame(mDepth - 1).current)->children);
+    if (mDepth != depthBefore)
+    {
+        return;
+    }
+
+    // Leaf: move to the next sibling, or to the next sibling of the closest ancestor which has one.
+    while (mDepth != 0)
+    {
+        Frame & top = frame(mDepth - 1);
+        if (++top.current != top.end)
+        {
+            return;
+        }
+        --mDepth;
+    }
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,104 @@
+#pragma once
+
+
+#include "Gltf.h"
+
+#include <array>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Depth-first pre-order traversal of the node hierarchy of a scene, without recursion.
+///
+/// Children are visited in the order of `Node::children`.
+/// The traversal stack is stored inline for hierarchies up to `gInlineDepth` levels,
+/// so iterating does not allocate unless the hierarchy is deeper.
+/// @note This is an input range: `begin()` restarts the traversal, invalidating previous iterators.
+class SceneTraversal
+{
+public:
+    static constexpr std::size_t gInlineDepth = 32;
+
+    struct Visit
+    {
+        Const_Owned<Node> node;
+        std::optional<Index<Node>> parent; // empty for the scene roots
+        std::size_t depth;                 // 0 for the scene roots
+    };
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Visit;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(SceneTraversal * aTraversal) :
+            mTraversal{aTraversal}
+        {}
+
+        Visit operator*() const
+        { return mTraversal->current(); }
+
+        Iterator & operator++()
+        { mTraversal->advance(); return *this; }
+
+        void operator++(int)
+        { mTraversal->advance(); }
+
+        bool operator==(std::default_sentinel_t) const
+        { return mTraversal->mDepth == 0; }
+
+    private:
+        SceneTraversal * mTraversal{nullptr};
+    };
+
+    SceneTraversal(const Gltf & aGltf, Index<Scene> aScene);
+
+    SceneTraversal(const Gltf & aGltf, std::span<const Index<Node>> aRoots);
+
+    Iterator begin();
+
+    std::default_sentinel_t end() const
+    { return {}; }
+
+private:
+    /// @brief The siblings remaining to be visited at one level of the hierarchy.
+    struct Frame
+    {
+        const Index<Node> * current;
+        const Index<Node> * end;
+    };
+
+    Frame & frame(std::size_t aLevel)
+    { return aLevel < gInlineDepth ? mInlineFrames[aLevel] : mDeepFrames[aLevel - gInlineDepth]; }
+
+    const Frame & frame(std::size_t aLevel) const
+    { return aLevel < gInlineDepth ? mInlineFrames[aLevel] : mDeepFrames[aLevel - gInlineDepth]; }
+
+    void push(std::span<const Index<Node>> aSiblings);
+
+    Visit current() const;
+
+    void advance();
+
+    const Gltf & mGltf;
+    std::span<const Index<Node>> mRoots;
+    std::array<Frame, gInlineDepth> mInlineFrames;
+    std::vector<Frame> mDeepFrames;
+    std::size_t mDepth{0}; // count of frames in the stack, 0 when the traversal is over.
+};
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
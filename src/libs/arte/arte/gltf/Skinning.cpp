@@ -0,0 +1,250 @@
+#include "Skinning.h"
+
+#include "../detail/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define AD_ARTE_SKINNING_SSE
+#include <xmmintrin.h>
+#endif
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    // Skin instances computed by each parallel task.
+    constexpr std::size_t gInstancesGrain = 4;
+
+    constexpr float gIdentity[Skinning::gMatrixSize] = {
+        1.f, 0.f, 0.f, 0.f,
+        0.f, 1.f, 0.f, 0.f,
+        0.f, 0.f, 1.f, 0.f,
+        0.f, 0.f, 0.f, 1.f,
+    };
+
+
+    /// @brief Writes the 4x4 product `aLeft * aRight` to `aOutput`, aRight being completed to 4x4.
+    void multiply(const float * aLeft, const Affine & aRight, float * aOutput)
+    {
+        const float * r = aRight.elements.data();
+#if defined(AD_ARTE_SKINNING_SSE)
+        const __m128 row0 = _mm_setr_ps(r[0], r[1],  r[2],  0.f);
+        const __m128 row1 = _mm_setr_ps(r[3], r[4],  r[5],  0.f);
+        const __m128 row2 = _mm_setr_ps(r[6], r[7],  r[8],  0.f);
+        const __m128 row3 = _mm_setr_ps(r[9], r[10], r[11], 1.f);
+        for (std::size_t row = 0; row != 4; ++row)
+        {
+            const float * left = aLeft + 4 * row;
+            __m128 result = _mm_mul_ps(_mm_set1_ps(left[0]), row0);
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(left[1]), row1));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(left[2]), row2));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(left[3]), row3));
+            _mm_storeu_ps(aOutput + 4 * row, result);
+        }
+#else
+        for (std::size_t row = 0; row != 4; ++row)
+        {
+            const float * left = aLeft + 4 * row;
+            for (std::size_t column = 0; column != 3; ++column)
+            {
+                aOutput[4 * row + column] = left[0] * r[column]
+                                          + left[1] * r[3 + column]
+                                          + left[2] * r[6 + column]
+                                          + left[3] * r[9 + column];
+            }
+            aOutput[4 * row + 3] = left[3];
+        }
+#endif
+    }
+
+
+    /// @brief Writes the unit dual quaternion of the rigid part of a 4x4 row-vector matrix.
+    void toDualQuaternion(const float * aMatrix, float * aOutput)
+    {
+        // Remove scaling: with the row-vector convention, each row of the linear part is scaled.
+        float m[3][3];
+        for (std::size_t row = 0; row != 3; ++row)
+        {
+            const float * source = aMatrix + 4 * row;
+            const float inverseNorm =
+                1.f / std::sqrt(source[0] * source[0] + source[1] * source[1] + source[2] * source[2]);
+            for (std::size_t column = 0; column != 3; ++column)
+            {
+                m[row][column] = source[column] * inverseNorm;
+            }
+        }
+
+        // Shepperd's method, on the transposed (column-vector) rotation matrix.
+        float x, y, z, w;
+        const float trace = m[0][0] + m[1][1] + m[2][2];
+        if (trace > 0.f)
+        {
+            const float s = 2.f * std::sqrt(trace + 1.f);
+            w = 0.25f * s;
+            x = (m[1][2] - m[2][1]) / s;
+            y = (m[2][0] - m[0][2]) / s;
+            z = (m[0][1] - m[1][0]) / s;
+        }
+        else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+        {
+            const float s = 2.f * std::sqrt(1.f + m[0][0] - m[1][1] - m[2][2]);
+            w = (m[1][2] - m[2][1]) / s;
+            x = 0.25f * s;
+            y = (m[0][1] + m[1][0]) / s;
+            z = (m[0][2] + m[2][0]) / s;
+        }
+        else if (m[1][1] > m[2][2])
+        {
+            const float s = 2.f * std::sqrt(1.f + m[1][1] - m[0][0] - m[2][2]);
+            w = (m[2][0] - m[0][2]) / s;
+            x = (m[0][1] + m[1][0]) / s;
+            y = 0.25f * s;
+            z = (m[1][2] + m[2][1]) / s;
+        }
+        else
+        {
+            const float s = 2.f * std::sqrt(1.f + m[2][2] - m[0][0] - m[1][1]);
+            w = (m[0][1] - m[1][0]) / s;
+            x = (m[0][2] + m[2][0]) / s;
+            y = (m[1][2] + m[2][1]) / s;
+            z = 0.25f * s;
+        }
+
+        // Dual part is 0.5 * translation * real, the translation being the pure quaternion (tx, ty, tz, 0).
+        const float tx = aMatrix[12], ty = aMatrix[13], tz = aMatrix[14];
+        aOutput[0] = x;
+        aOutput[1] = y;
+        aOutput[2] = z;
+        aOutput[3] = w;
+        aOutput[4] = 0.5f * ( tx * w + ty * z - tz * y);
+        aOutput[5] = 0.5f * (-tx * z + ty * w + tz * x);
+        aOutput[6] = 0.5f * ( tx * y - ty * x + tz * w);
+        aOutput[7] = 0.5f * (-tx * x - ty * y - tz * z);
+    }
+
+} // anonymous namespace
+
+
+Skinning::Skinning(const Gltf & aGltf, BufferCache & aBuffers)
+{
+    for (Const_Owned<Skin> skin : aGltf.getSkins())
+    {
+        mJoints.emplace_back(skin->joints.begin(), skin->joints.end());
+        std::vector<float> & inverseBinds = mInverseBindMatrices.emplace_back();
+        if (skin->inverseBindMatrices)
+        {
+            const Accessor & accessor = aGltf.get(*skin->inverseBindMatrices);
+            if (accessor.type != Accessor::ElementType::Mat4 || accessor.count < skin->joints.size())
+            {
+                throw std::invalid_argument{"Skin '" + std::string{skin->name}
+                                            + "' inverse bind matrices must be at least one MAT4 per joint."};
+            }
+            // glTF stores column-major column-vector matrices:
+            // it is the same memory layout as row-major row-vector matrices.
+            inverseBinds = readAsFloats(aBuffers, accessor);
+            inverseBinds.resize(skin->joints.size() * gMatrixSize);
+        }
+        else
+        {
+            for (std::size_t jointId = 0; jointId != skin->joints.size(); ++jointId)
+            {
+                inverseBinds.insert(inverseBinds.end(), std::begin(gIdentity), std::end(gIdentity));
+            }
+        }
+    }
+}
+
+
+Skinning::Instance Skinning::instantiate(Index<Skin> aSkin,
+                                         const SceneGraph & aScene,
+                                         bool aDualQuaternions) const
+{
+    const std::vector<Index<Node>> & joints = mJoints.at(aSkin);
+
+    Instance instance{
+        .skin = aSkin,
+        .scene = &aScene,
+        .joints = {},
+        .palette = std::vector<float>(joints.size() * gMatrixSize),
+        .dualQuaternions = std::vector<float>(aDualQuaternions ? joints.size() * gDualQuaternionSize : 0),
+    };
+
+    for (Index<Node> joint : joints)
+    {
+        if (std::optional<SceneGraph::NodeId> id = aScene.find(joint))
+        {
+            instance.joints.push_back(*id);
+        }
+        else
+        {
+            throw std::logic_error{"Joint node " + std::to_string(joint) + " of skin "
+                                   + std::to_string(aSkin) + " is not part of the scene."};
+        }
+    }
+
+    return instance;
+}
+
+
+void Skinning::update(std::span<Instance> aInstances, bool aParallel) const
+{
+    if (aParallel)
+    {
+        detail::parallelFor(aInstances.size(),
+                            [&](std::size_t aIndex){ update(aInstances[aIndex]); },
+                            gInstancesGrain);
+    }
+    else
+    {
+        for (Instance & instance : aInstances)
+        {
+            update(instance);
+        }
+    }
+}
+
+
+void Skinning::update(Instance & aInstance) const
+{
+    const SceneGraph & scene = *aInstance.scene;
+
+    aInstance.changed = aInstance.forceUpdate
+        || std::any_of(aInstance.joints.begin(), aInstance.joints.end(),
+                       [&](SceneGraph::NodeId aJoint){ return scene.isWorldChanged(aJoint); });
+    if (!aInstance.changed)
+    {
+        return;
+    }
+    aInstance.forceUpdate = false;
+
+    const float * inverseBinds = mInverseBindMatrices[aInstance.skin].data();
+    float * palette = aInstance.palette.data();
+    for (std::size_t jointId = 0; jointId != aInstance.joints.size(); ++jointId)
+    {
+        multiply(inverseBinds + jointId * gMatrixSize,
+                 scene.getWorldTransformation(aInstance.joints[jointId]),
+                 palette + jointId * gMatrixSize);
+    }
+
+    if (!aInstance.dualQuaternions.empty())
+    {
+        for (std::size_t jointId = 0; jointId != aInstance.joints.size(); ++jointId)
+        {
+            toDualQuaternion(palette + jointId * gMatrixSize,
+                             aInstance.dualQuaternions.data() + jointId * gDualQuaternionSize);
+        }
+    }
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
@@ -0,0 +1,71 @@
+#pragma once
+
+
+#include "Accessor.h"
+#include "Gltf.h"
+#include "SceneGraph.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Computes the joint matrix palettes of skins, from the world transformations of a SceneGraph.
+///
+/// Each palette entry is `inverseBind * jointWorld` (row-vector convention, i.e. `jointWorld * inverseBind`
+/// with column vectors). The node instantiating the skinned mesh does not contribute, as required by glTF.
+class Skinning
+{
+public:
+    /// @brief Number of floats of a palette matrix.
+    static constexpr std::size_t gMatrixSize = 16;
+    /// @brief Number of floats of a palette dual quaternion: real part then dual part, each (x, y, z, w).
+    static constexpr std::size_t gDualQuaternionSize = 8;
+
+    /// @brief A skin bound to a SceneGraph, owning its palettes.
+    struct Instance
+    {
+        Index<Skin> skin;
+        const SceneGraph * scene;
+        std::vector<SceneGraph::NodeId> joints;
+        /// @brief gMatrixSize floats per joint.
+        /// Row-major storage of row-vector matrices, so it can be uploaded untransposed to GLSL `mat4`
+        /// (the same layout as `math::Matrix<4, 4, float>`).
+        std::vector<float> palette;
+        /// @brief gDualQuaternionSize floats per joint, left empty unless requested at instantiation.
+        /// @note Dual quaternions only encode rigid transformations: scaling is discarded.
+        std::vector<float> dualQuaternions;
+        /// @brief Set by update(), true when the palettes were recomputed (so they have to be uploaded).
+        bool changed{false};
+        /// @brief Forces the next update() to recompute the palettes.
+        bool forceUpdate{true};
+    };
+
+    Skinning(const Gltf & aGltf, BufferCache & aBuffers);
+
+    /// @throw std::logic_error if a joint of the skin is not part of the scene.
+    Instance instantiate(Index<Skin> aSkin, const SceneGraph & aScene, bool aDualQuaternions = false) const;
+
+    /// @brief Recompute the palettes of the instances for which at least one joint changed its world transform.
+    ///
+    /// Must be called after each `SceneGraph::update()`, since changes are only flagged for the last update.
+    /// @param aParallel If true, instances are distributed over worker threads.
+    void update(std::span<Instance> aInstances, bool aParallel = true) const;
+
+private:
+    void update(Instance & aInstance) const;
+
+    std::vector<std::vector<Index<Node>>> mJoints;
+    // Per skin, gMatrixSize floats per joint (identity when the skin does not provide them).
+    std::vector<std::vector<float>> mInverseBindMatrices;
+};
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
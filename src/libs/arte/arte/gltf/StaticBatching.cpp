@@ -0,0 +1,277 @@
+#include "StaticBatching.h"
+
+#include "../detail/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+namespace {
+
+    constexpr EnumType gTrianglesMode = 4; // GL_TRIANGLES
+
+    constexpr std::size_t gMaxBatchSize = std::numeric_limits<std::uint32_t>::max();
+
+    using Vec3 = std::array<float, 3>;
+
+    float dot(const Vec3 & aLhs, const Vec3 & aRhs)
+    { return aLhs[0] * aRhs[0] + aLhs[1] * aRhs[1] + aLhs[2] * aRhs[2]; }
+
+
+    /// @brief Transform the 3 floats at `aVector` by the row-major 3x3 matrix `aMatrix` (row-vector convention),
+    /// in place.
+    void transformVector(const float * aMatrix, float * aVector, bool aNormalize)
+    {
+        Vec3 result;
+        for (std::size_t column = 0; column != 3; ++column)
+        {
+            result[column] = aVector[0] * aMatrix[column]
+                           + aVector[1] * aMatrix[3 + column]
+                           + aVector[2] * aMatrix[6 + column];
+        }
+        if (aNormalize)
+        {
+            if (const float length = std::sqrt(dot(result, result)); length > 0.f)
+            {
+                for (float & component : result)
+                {
+                    component /= length;
+                }
+            }
+        }
+        std::copy(result.begin(), result.end(), aVector);
+    }
+
+
+    /// @brief True if the transformation reverses orientations, i.e. the determinant of its linear part is negative.
+    bool isMirroring(const Affine & aTransformation)
+    {
+        const auto & e = aTransformation.elements;
+        return e[0] * (e[4] * e[8] - e[5] * e[7])
+             + e[1] * (e[5] * e[6] - e[3] * e[8])
+             + e[2] * (e[3] * e[7] - e[4] * e[6]) < 0.f;
+    }
+
+
+    /// @brief Primitives can be batched together if they have the same key.
+    struct BatchKey
+    {
+        std::size_t material; // 0 when there is no material, index + 1 otherwise.
+        std::vector<std::pair<std::string_view, std::size_t>> attributes; // semantic and component count
+
+        auto operator<=>(const BatchKey &) const = default;
+    };
+
+
+    void transformAttribute(const StaticBatch::Attribute & aAttribute,
+                            const Affine & aWorld,
+                            const std::array<float, 9> & aNormalMatrix,
+                            bool aIsMirroring,
+                            std::span<const float> aSource,
+                            float * aDestination,
+                            Aabb & aBounds)
+    {
+        const std::size_t componentCount = aAttribute.componentCount;
+        std::copy(aSource.begin(), aSource.end(), aDestination);
+
+        if (aAttribute.semantic == "POSITION")
+        {
+            for (float * position = aDestination; position != aDestination + aSource.size(); position += 3)
+            {
+                const Vec3 world = transformPosition(aWorld, {position[0], position[1], position[2]});
+                std::copy(world.begin(), world.end(), position);
+                aBounds.extend({world, world});
+            }
+        }
+        else if (aAttribute.semantic == "NORMAL" && componentCount == 3)
+        {
+            for (float * normal = aDestination; normal != aDestination + aSource.size(); normal += 3)
+            {
+                transformVector(aNormalMatrix.data(), normal, true);
+            }
+        }
+        else if (aAttribute.semantic == "TANGENT" && componentCount == 4)
+        {
+            for (float * tangent = aDestination; tangent != aDestination + aSource.size(); tangent += 4)
+            {
+                // The linear part is the first 3 rows of the affine transformation.
+                transformVector(aWorld.elements.data(), tangent, true);
+                // The bitangent is derived from the cross product, which mirroring reverses.
+                if (aIsMirroring)
+                {
+                    tangent[3] = -tangent[3];
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
+
+
+std::vector<StaticBatch> batchStaticMeshes(BufferCache & aBuffers,
+                                           const SceneGraph & aScene,
+                                           std::span<const SceneGraph::NodeId> aNodes)
+{
+    const Gltf & gltf = aBuffers.getGltf();
+
+    //
+    // Assign each primitive instance its range in a batch.
+    //
+    struct Task
+    {
+        std::size_t batch;
+        std::size_t submesh;
+    };
+    std::vector<Task> tasks;
+    std::vector<StaticBatch> batches;
+    std::vector<std::size_t> vertexCounts; // per batch
+    std::map<BatchKey, std::size_t> batchIds;
+
+    for (SceneGraph::NodeId id : aNodes)
+    {
+        const Node & node = gltf.get(aScene.getNode(id));
+        if (!node.mesh || node.skin)
+        {
+            continue;
+        }
+
+        std::span<const Primitive> primitives = gltf.get(*node.mesh)->primitives;
+        for (std::size_t primitiveId = 0; primitiveId != primitives.size(); ++primitiveId)
+        {
+            const Primitive & primitive = primitives[primitiveId];
+            auto position = primitive.attributes.find("POSITION");
+            if (primitive.mode != gTrianglesMode || position == primitive.attributes.end())
+            {
+                continue;
+            }
+
+            const std::size_t vertexCount = gltf.get(position->second)->count;
+            BatchKey key{primitive.material ? *primitive.material + 1 : 0, {}};
+            for (const auto & [semantic, accessorIndex] : primitive.attributes)
+            {
+                const Accessor & accessor = gltf.get(accessorIndex);
+                if (accessor.count != vertexCount)
+                {
+                    throw std::invalid_argument{"Attribute " + std::string{semantic}
+                                                + " count does not match the primitive POSITION count."};
+                }
+                key.attributes.emplace_back(semantic, countComponents(accessor.type));
+            }
+
+            auto [found, inserted] = batchIds.try_emplace(std::move(key), batches.size());
+            if (inserted)
+            {
+                StaticBatch & batch = batches.emplace_back();
+                batch.material = primitive.material;
+                for (const auto & [semantic, componentCount] : found->first.attributes)
+                {
+                    batch.attributes.push_back({std::string{semantic}, componentCount, {}});
+                }
+                vertexCounts.push_back(0);
+            }
+
+            StaticBatch & batch = batches[found->second];
+            const std::size_t indexCount = primitive.indices ? gltf.get(*primitive.indices)->count : vertexCount;
+            const std::size_t firstIndex = batch.submeshes.empty() ?
+                0 : batch.submeshes.back().firstIndex + batch.submeshes.back().indexCount;
+            const std::size_t firstVertex = vertexCounts[found->second];
+            if (firstIndex + indexCount > gMaxBatchSize || firstVertex + vertexCount > gMaxBatchSize)
+            {
+                throw std::length_error{"Static batch exceeds the capacity of 32 bits indices."};
+            }
+
+            tasks.push_back({found->second, batch.submeshes.size()});
+            batch.submeshes.push_back({
+                .node = id,
+                .mesh = *node.mesh,
+                .primitive = primitiveId,
+                .firstIndex = static_cast<std::uint32_t>(firstIndex),
+                .indexCount = static_cast<std::uint32_t>(indexCount),
+                .firstVertex = static_cast<std::uint32_t>(firstVertex),
+                .vertexCount = static_cast<std::uint32_t>(vertexCount),
+                .bounds = Aabb::Empty(),
+            });
+            vertexCounts[found->second] += vertexCount;
+        }
+    }
+
+    // Size the buffers up front, so the tasks write disjoint ranges.
+    for (std::size_t batchId = 0; batchId != batches.size(); ++batchId)
+    {
+        StaticBatch & batch = batches[batchId];
+        for (StaticBatch::Attribute & attribute : batch.attributes)
+        {
+            attribute.values.resize(vertexCounts[batchId] * attribute.componentCount);
+        }
+        batch.indices.resize(batch.submeshes.back().firstIndex + batch.submeshes.back().indexCount);
+    }
+
+    //
+    // Read and transform each instance.
+    //
+    detail::parallelFor(tasks.size(), [&](std::size_t aTaskId)
+    {
+        StaticBatch & batch = batches[tasks[aTaskId].batch];
+        StaticBatch::Submesh & submesh = batch.submeshes[tasks[aTaskId].submesh];
+        const Primitive & primitive = gltf.get(submesh.mesh)->primitives[submesh.primitive];
+        const Affine & world = aScene.getWorldTransformation(submesh.node);
+        const std::array<float, 9> normalMatrix = getNormalMatrix(world);
+        const bool mirroring = isMirroring(world);
+
+        for (StaticBatch::Attribute & attribute : batch.attributes)
+        {
+            const std::vector<float> source =
+                readAsFloats(aBuffers, gltf.get(primitive.attributes.at(attribute.semantic)));
+            transformAttribute(attribute, world, normalMatrix, mirroring, source,
+                               attribute.values.data() + submesh.firstVertex * attribute.componentCount,
+                               submesh.bounds);
+        }
+
+        std::uint32_t * destination = batch.indices.data() + submesh.firstIndex;
+        if (primitive.indices)
+        {
+            const std::vector<std::uint32_t> source = readAsIndices(aBuffers, gltf.get(*primitive.indices));
+            std::transform(source.begin(), source.end(), destination,
+                           [&](std::uint32_t aIndex){ return aIndex + submesh.firstVertex; });
+        }
+        else
+        {
+            std::iota(destination, destination + submesh.indexCount, submesh.firstVertex);
+        }
+
+        if (mirroring)
+        {
+            for (std::uint32_t triangle = 0; triangle + 2 < submesh.indexCount; triangle += 3)
+            {
+                std::swap(destination[triangle + 1], destination[triangle + 2]);
+            }
+        }
+    });
+
+    return batches;
+}
+
+
+std::vector<StaticBatch> batchStaticMeshes(BufferCache & aBuffers, const SceneGraph & aScene)
+{
+    std::vector<SceneGraph::NodeId> nodes(aScene.size());
+    std::iota(nodes.begin(), nodes.end(), 0);
+    return batchStaticMeshes(aBuffers, aScene, nodes);
+}
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
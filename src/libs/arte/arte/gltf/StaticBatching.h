@@ -0,0 +1,81 @@
+#pragma once
+
+
+#include "Accessor.h"
+#include "Bvh.h"
+#include "Gltf.h"
+#include "SceneGraph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace ad {
+namespace arte {
+namespace gltf {
+
+
+/// @brief Vertices and indices of several primitive instances sharing a material and a vertex layout,
+/// pre-transformed to world space so they can be drawn with a single call.
+struct StaticBatch
+{
+    /// @brief A source primitive instance, as a range of the batch buffers.
+    ///
+    /// Allows to cull or pick the instances individually, then draw the visible index ranges.
+    struct Submesh
+    {
+        SceneGraph::NodeId node;
+        Index<Mesh> mesh;
+        std::size_t primitive; // in the mesh primitives
+        std::uint32_t firstIndex;
+        std::uint32_t indexCount;
+        std::uint32_t firstVertex; // already added to the indices of the range
+        std::uint32_t vertexCount;
+        Aabb bounds; // world space
+    };
+
+    struct Attribute
+    {
+        std::string semantic;
+        std::size_t componentCount;
+        std::vector<float> values; // componentCount floats per vertex
+    };
+
+    std::size_t countVertices() const
+    { return attributes.front().values.size() / attributes.front().componentCount; }
+
+    std::optional<Index<Material>> material;
+    /// @brief Ordered by semantic, always containing POSITION.
+    std::vector<Attribute> attributes;
+    std::vector<std::uint32_t> indices;
+    std::vector<Submesh> submeshes;
+};
+
+
+/// @brief Merge the triangle primitives instantiated by `aNodes` into batches,
+/// one per distinct (material, attribute semantics and component counts).
+///
+/// The world transformations of `aScene` must be up to date, they are baked into the vertices:
+/// POSITION is transformed as a point, NORMAL by the inverse transpose, TANGENT by the linear part
+/// (its handedness being preserved), other attributes are copied.
+/// The winding of triangles is reversed for mirroring transformations.
+/// Batches are ordered by first appearance, submeshes follow the order of `aNodes`.
+/// Attributes are read and transformed concurrently, one task per submesh.
+/// @note Nodes without a mesh, skinned nodes, and primitives that are not triangle lists
+/// or without POSITION are ignored.
+/// @throw std::length_error if a batch exceeds 32 bits indices.
+std::vector<StaticBatch> batchStaticMeshes(BufferCache & aBuffers,
+                                           const SceneGraph & aScene,
+                                           std::span<const SceneGraph::NodeId> aNodes);
+
+/// @brief Batch all the mesh instances of the scene.
+std::vector<StaticBatch> batchStaticMeshes(BufferCache & aBuffers, const SceneGraph & aScene);
+
+
+} // namespace gltf
+} // namespace arte
+} // namespace ad
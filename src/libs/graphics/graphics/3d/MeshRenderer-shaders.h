@@ -0,0 +1,75 @@
+#pragma once
+
+
+#include <string>
+
+
+namespace ad {
+namespace graphics {
+namespace r3d {
+namespace MeshRendererShaders {
+
+
+const std::string gVertexShader = R"#(
+#version 400
+
+layout(location=0) in vec3 ve_Position_model; // quantized over the primitive bounding box
+layout(location=1) in vec4 ve_Normal_model;
+// Row-vector affine matrix uploaded row-major: its rows are the columns of the GLSL matrix.
+layout(location=4) in mat4x3 in_ModelTransformation;
+// Inverse transpose of the linear part, computed on the CPU once per instance.
+layout(location=8) in mat3 in_NormalTransformation;
+
+uniform vec3 u_PositionOffset;
+uniform vec3 u_PositionScale;
+
+layout(std140) uniform ViewingBlock
+{
+    mat4 u_Camera;
+    mat4 u_Projection;
+};
+
+out vec3 ex_Normal_world;
+
+void main(void)
+{
+    vec3 position_model = ve_Position_model * u_PositionScale + u_PositionOffset;
+    vec3 position_world = in_ModelTransformation * vec4(position_model, 1.);
+
+    // Zero when the primitive has no normals (the attribute is disabled).
+    ex_Normal_world = in_NormalTransformation * ve_Normal_model.xyz;
+
+    gl_Position = u_Projection * u_Camera * vec4(position_world, 1.);
+}
+)#";
+
+
+const std::string gFragmentShader = R"#(
+#version 400
+
+in vec3 ex_Normal_world;
+
+uniform vec4 u_BaseColorFactor;
+
+out vec4 out_Color;
+
+const vec3 gLightDirection_world = normalize(vec3(0.3, 1., 0.5));
+const float gAmbient = 0.25;
+
+void main(void)
+{
+    float lighting = 1.;
+    if (dot(ex_Normal_world, ex_Normal_world) > 0.)
+    {
+        lighting = gAmbient
+            + (1. - gAmbient) * max(dot(normalize(ex_Normal_world), gLightDirection_world), 0.);
+    }
+    out_Color = vec4(u_BaseColorFactor.rgb * lighting, u_BaseColorFactor.a);
+}
+)#";
+
+
+} // namespace MeshRendererShaders
+} // namespace r3d
+} // namespace graphics
+} // namespace ad
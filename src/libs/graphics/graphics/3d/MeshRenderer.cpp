@@ -0,0 +1,231 @@
+#include "MeshRenderer.h"
+
+#include "MeshRenderer-shaders.h"
+
+#include <renderer/Uniforms.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <tuple>
+
+
+namespace ad {
+namespace graphics {
+namespace r3d {
+
+
+namespace {
+
+    const AttributeFormat gTransformationFormat{
+        {MeshRenderer::gTransformationLocation},
+        {{3, 4}, 0, MappedGL<GLfloat>::enumerator},
+    };
+
+    const AttributeFormat gNormalTransformationFormat{
+        {MeshRenderer::gNormalTransformationLocation},
+        {{3, 3}, 0, MappedGL<GLfloat>::enumerator},
+    };
+
+    // Positions are quantized to the primitive bounds, normals packed in 32 bits.
+    const VertexStreamBuilder gBuilder{{
+        {"POSITION", MeshRenderer::gPositionLocation, VertexEncoding::Quantized16},
+        {"NORMAL", MeshRenderer::gNormalLocation, VertexEncoding::Snorm2_10_10_10},
+    }};
+
+    const VertexStreamBuilder gPositionOnlyBuilder{{
+        {"POSITION", MeshRenderer::gPositionLocation, VertexEncoding::Quantized16},
+    }};
+
+
+    /// @brief Load the indices of the primitive (generated for non-indexed primitives),
+    /// as 16 bits when they all fit.
+    /// @return The index type and count.
+    std::pair<GLenum, GLsizei> loadIndices(const VertexArrayObject & aVertexArray,
+                                           const IndexBufferObject & aIndexBuffer,
+                                           arte::gltf::BufferCache & aBuffers,
+                                           const arte::gltf::Primitive & aPrimitive,
+                                           std::size_t aVertexCount)
+    {
+        std::vector<std::uint32_t> indices;
+        if (aPrimitive.indices)
+        {
+            indices = arte::gltf::readAsIndices(aBuffers, aBuffers.getGltf().get(*aPrimitive.indices));
+        }
+        else
+        {
+            indices.resize(aVertexCount);
+            std::iota(indices.begin(), indices.end(), 0);
+        }
+
+        attachIndexBuffer(aIndexBuffer, aVertexArray);
+        const GLsizei count = static_cast<GLsizei>(indices.size());
+        if (aVertexCount <= std::numeric_limits<std::uint16_t>::max() + std::size_t{1})
+        {
+            const std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, std::span{shortIndices}.size_bytes(), shortIndices.data(),
+                         getGLBufferHint(BufferHint::StaticDraw));
+            return {GL_UNSIGNED_SHORT, count};
+        }
+        else
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, std::span{indices}.size_bytes(), indices.data(),
+                         getGLBufferHint(BufferHint::StaticDraw));
+            return {GL_UNSIGNED_INT, count};
+        }
+    }
+
+} // anonymous namespace
+
+
+MeshRenderer::MeshRenderer(arte::gltf::BufferCache & aBuffers) :
+    mProgram{
+        makeLinkedProgram({
+            {GL_VERTEX_SHADER, {MeshRendererShaders::gVertexShader, "MeshRendererShaders::gVertexShader"}},
+            {GL_FRAGMENT_SHADER, {MeshRendererShaders::gFragmentShader, "MeshRendererShaders::gFragmentShader"}},
+        })},
+    mViewingBlockIndex{glGetUniformBlockIndex(mProgram, "ViewingBlock")},
+    mPositionOffsetLocation{glGetUniformLocation(mProgram, "u_PositionOffset")},
+    mPositionScaleLocation{glGetUniformLocation(mProgram, "u_PositionScale")},
+    mBaseColorFactorLocation{glGetUniformLocation(mProgram, "u_BaseColorFactor")}
+{
+    const arte::Gltf & gltf = aBuffers.getGltf();
+    const std::span<const arte::gltf::Mesh> meshes = gltf.getMeshSpan();
+    mMeshInstances.resize(meshes.size());
+
+    // Draws are sorted by material, the default material (none) first.
+    std::vector<std::size_t> materials;
+    for (std::size_t meshId = 0; meshId != meshes.size(); ++meshId)
+    {
+        for (const arte::gltf::Primitive & primitive : meshes[meshId].primitives)
+        {
+            if (!primitive.attributes.contains("POSITION"))
+            {
+                continue;
+            }
+
+            const bool hasNormals = primitive.attributes.contains("NORMAL");
+            const VertexStream stream = (hasNormals ? gBuilder : gPositionOnlyBuilder).build(aBuffers, primitive);
+
+            const arte::gltf::material::PbrMetallicRoughness & pbr =
+                (primitive.material ? gltf.get(*primitive.material)->pbrMetallicRoughness : std::nullopt)
+                    .value_or(arte::gltf::material::gDefaultPbr);
+
+            Draw & draw = mDraws.emplace_back();
+            draw.mMode = static_cast<GLenum>(primitive.mode);
+            draw.mPosition = stream.dequantizations.front();
+            draw.mBaseColorFactor = pbr.baseColorFactor;
+            draw.mMesh = meshId;
+            draw.mVertexBuffer = loadVertexBuffer(draw.mVertexArray, stream, BufferHint::StaticDraw);
+            std::tie(draw.mIndexType, draw.mIndexCount) =
+                loadIndices(draw.mVertexArray, draw.mIndexBuffer, aBuffers, primitive, stream.vertexCount);
+            materials.push_back(primitive.material ? *primitive.material + 1 : 0);
+        }
+    }
+
+    std::vector<std::size_t> order(mDraws.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t aLhs, std::size_t aRhs){ return materials[aLhs] < materials[aRhs]; });
+    std::vector<Draw> sorted;
+    sorted.reserve(mDraws.size());
+    for (std::size_t drawId : order)
+    {
+        sorted.push_back(std::move(mDraws[drawId]));
+    }
+    mDraws = std::move(sorted);
+}
+
+
+void MeshRenderer::resetInstances(const arte::Gltf & aGltf, const arte::gltf::SceneGraph & aScene)
+{
+    using arte::gltf::SceneGraph;
+
+    // Counting sort of the instances by mesh.
+    std::fill(mMeshInstances.begin(), mMeshInstances.end(), InstanceRange{});
+    for (SceneGraph::NodeId id = 0; id != aScene.size(); ++id)
+    {
+        if (std::optional<arte::gltf::Index<arte::gltf::Mesh>> mesh = aGltf.get(aScene.getNode(id))->mesh)
+        {
+            ++mMeshInstances[*mesh].mCount;
+        }
+    }
+    std::size_t first = 0;
+    for (InstanceRange & range : mMeshInstances)
+    {
+        range.mFirst = first;
+        first += range.mCount;
+    }
+
+    mInstances.resize(first);
+    mCursors.resize(mMeshInstances.size());
+    std::transform(mMeshInstances.begin(), mMeshInstances.end(), mCursors.begin(),
+                   [](const InstanceRange & aRange){ return aRange.mFirst; });
+    for (SceneGraph::NodeId id = 0; id != aScene.size(); ++id)
+    {
+        if (std::optional<arte::gltf::Index<arte::gltf::Mesh>> mesh = aGltf.get(aScene.getNode(id))->mesh)
+        {
+            const arte::gltf::Affine & world = aScene.getWorldTransformation(id);
+            mInstances[mCursors[*mesh]++] = Instance{world, arte::gltf::getNormalMatrix(world)};
+        }
+    }
+
+    respecifyBuffer(mInstanceBuffer, std::span{mInstances}, BufferHint::StreamDraw);
+
+    // Only the attribute pointers change, the buffers of the draws are not respecified.
+    for (Draw & draw : mDraws)
+    {
+        const InstanceRange & range = mMeshInstances[draw.mMesh];
+        draw.mInstanceCount = static_cast<GLsizei>(range.mCount);
+        if (range.mCount != 0)
+        {
+            bind(draw.mVertexArray);
+            glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+            const std::size_t offset = range.mFirst * sizeof(Instance);
+            AttributeFormat transformation = gTransformationFormat;
+            transformation.mOffset = offset + offsetof(Instance, mTransformation);
+            attachBoundVertexBuffer(transformation, sizeof(Instance), 1);
+            AttributeFormat normalTransformation = gNormalTransformationFormat;
+            normalTransformation.mOffset = offset + offsetof(Instance, mNormalTransformation);
+            attachBoundVertexBuffer(normalTransformation, sizeof(Instance), 1);
+        }
+    }
+}
+
+
+void MeshRenderer::render(const CameraProjection & aCameraProjection) const
+{
+    aCameraProjection.bind();
+    glUniformBlockBinding(mProgram, mViewingBlockIndex, CameraProjection::gBinding);
+
+    use(mProgram);
+    // Primitives without normals read the generic value of the disabled attribute:
+    // a null normal disables lighting (the generic value is context state, not vertex array state).
+    glVertexAttrib4f(gNormalLocation, 0.f, 0.f, 0.f, 0.f);
+
+    for (const Draw & draw : mDraws)
+    {
+        if (draw.mInstanceCount == 0)
+        {
+            continue;
+        }
+
+        glProgramUniform3fv(mProgram, mPositionOffsetLocation, 1, draw.mPosition.offset.data());
+        glProgramUniform3fv(mProgram, mPositionScaleLocation, 1, draw.mPosition.scale.data());
+        setUniform(mProgram, mBaseColorFactorLocation, draw.mBaseColorFactor);
+
+        bind(draw.mVertexArray);
+        glDrawElementsInstanced(draw.mMode,
+                                draw.mIndexCount,
+                                draw.mIndexType,
+                                nullptr,
+                                draw.mInstanceCount);
+    }
+}
+
+
+} // namespace r3d
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,97 @@
+#pragma once
+
+
+#include "VertexStream.h"
+
+#include "../2d/Shaping.h"
+
+#include <arte/gltf/Affine.h>
+#include <arte/gltf/SceneGraph.h>
+
+#include <math/Color.h>
+
+#include <renderer/Shading.h>
+#include <renderer/VertexSpecification.h>
+
+#include <array>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+namespace r3d {
+
+
+/// @brief Draws the mesh instances of a glTF scene, with one instanced draw per primitive
+/// (i.e. per mesh and material pair).
+///
+/// Vertex and index data are uploaded once, at construction.
+/// The world transformations of the instances are written each frame to a single instance buffer,
+/// grouped by mesh, and the instance attributes of each primitive are pointed at the range of its mesh.
+/// @note This does not require ARB_base_instance, which is not available on all platforms (e.g. macos).
+class MeshRenderer
+{
+public:
+    static constexpr GLuint gPositionLocation = 0;
+    static constexpr GLuint gNormalLocation = 1;
+    /// @brief The instance transformation is a `mat4x3`, occupying 4 consecutive locations.
+    static constexpr GLuint gTransformationLocation = 4;
+    /// @brief The instance normal transformation is a `mat3`, occupying 3 consecutive locations.
+    static constexpr GLuint gNormalTransformationLocation = 8;
+
+    /// @brief Upload all the primitives with a POSITION attribute.
+    /// @throw std::invalid_argument if a primitive cannot be converted to the vertex stream.
+    explicit MeshRenderer(arte::gltf::BufferCache & aBuffers);
+
+    /// @brief Set the instances to draw: each node of `aScene` with a mesh, at its current world transformation.
+    /// @note Skinned meshes are drawn in their bind pose.
+    void resetInstances(const arte::Gltf & aGltf, const arte::gltf::SceneGraph & aScene);
+
+    void render(const CameraProjection & aCameraProjection) const;
+
+private:
+    struct Draw
+    {
+        VertexArrayObject mVertexArray;
+        VertexBufferObject mVertexBuffer;
+        IndexBufferObject mIndexBuffer;
+        GLenum mMode;
+        GLenum mIndexType;
+        GLsizei mIndexCount;
+        Dequantization mPosition;
+        math::hdr::Rgba<GLfloat> mBaseColorFactor;
+        std::size_t mMesh;
+        GLsizei mInstanceCount{0};
+    };
+
+    /// @brief Per instance attributes, the normal matrix being computed on the CPU once per instance.
+    struct Instance
+    {
+        arte::gltf::Affine mTransformation;
+        std::array<GLfloat, 9> mNormalTransformation;
+    };
+
+    struct InstanceRange
+    {
+        std::size_t mFirst{0};
+        std::size_t mCount{0};
+    };
+
+    Program mProgram;
+    GLuint mViewingBlockIndex;
+    GLint mPositionOffsetLocation;
+    GLint mPositionScaleLocation;
+    GLint mBaseColorFactorLocation;
+
+    std::vector<Draw> mDraws; // ordered by material
+    VertexBufferObject mInstanceBuffer;
+    // Kept between frames to reuse their storage.
+    std::vector<Instance> mInstances;          // grouped by mesh
+    std::vector<InstanceRange> mMeshInstances; // indexed by mesh
+    std::vector<std::size_t> mCursors;         // indexed by mesh
+};
+
+
+} // namespace r3d
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,448 @@
+#include "VertexStream.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AD_GRAPHICS_VERTEXSTREAM_SSE2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AD_GRAPHICS_TARGET(aIsa)
+#else
+#define AD_GRAPHICS_TARGET(aIsa) __attribute__((target(aIsa)))
+#endif
+#endif
+
+
+namespace ad {
+namespace graphics {
+namespace r3d {
+
+
+namespace {
+
+    struct EncodingFormat
+    {
+        GLenum componentType;
+        bool normalize;
+        std::size_t componentSize; // 4 for the packed type, which has a single "component".
+    };
+
+
+    EncodingFormat getFormat(VertexEncoding aEncoding)
+    {
+        switch(aEncoding)
+        {
+            case VertexEncoding::Float:             return {GL_FLOAT, false, 4};
+            case VertexEncoding::Half:              return {GL_HALF_FLOAT, false, 2};
+            case VertexEncoding::Snorm16:           return {GL_SHORT, true, 2};
+            case VertexEncoding::Unorm16:           return {GL_UNSIGNED_SHORT, true, 2};
+            case VertexEncoding::Snorm8:            return {GL_BYTE, true, 1};
+            case VertexEncoding::Unorm8:            return {GL_UNSIGNED_BYTE, true, 1};
+            case VertexEncoding::Snorm2_10_10_10:   return {GL_INT_2_10_10_10_REV, true, 4};
+            case VertexEncoding::Quantized16:       return {GL_UNSIGNED_SHORT, true, 2};
+        }
+        throw std::invalid_argument{"Invalid vertex encoding."};
+    }
+
+
+    constexpr std::size_t alignOn4(std::size_t aSize)
+    {
+        return (aSize + 3) & ~std::size_t{3};
+    }
+
+
+    // Round to nearest even, handling subnormals, infinities and NaN
+    // (after Fabian Giesen's float_to_half_fast3_rtne).
+    std::uint16_t toHalf(float aValue)
+    {
+        std::uint32_t bits = std::bit_cast<std::uint32_t>(aValue);
+        const std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+        bits &= 0x7FFFFFFF;
+
+        if (bits >= 0x7F800000) // Infinity or NaN
+        {
+            return sign | 0x7C00 | (bits > 0x7F800000 ? 0x0200 : 0);
+        }
+        else if (bits >= 0x477FF000) // Rounds to a value above the largest half.
+        {
+            return sign | 0x7C00;
+        }
+        else if (bits < 0x38800000) // Subnormal half: let the float addition align and round the mantissa.
+        {
+            const float shifted = std::bit_cast<float>(bits) + 0.5f;
+            return sign | static_cast<std::uint16_t>(std::bit_cast<std::uint32_t>(shifted) - 0x3F000000);
+        }
+        else
+        {
+            const std::uint32_t mantissaOdd = (bits >> 13) & 1;
+            bits += 0xC8000FFF + mantissaOdd; // Rebias the exponent, and round.
+            return sign | static_cast<std::uint16_t>(bits >> 13);
+        }
+    }
+
+
+    template <class T_integer>
+    T_integer toNormalized(float aValue, float aMinimum, float aMaximum)
+    {
+        constexpr float scale = std::numeric_limits<T_integer>::max();
+        return static_cast<T_integer>(std::lrint(std::clamp(aValue, aMinimum, aMaximum) * scale));
+    }
+
+
+    std::uint32_t packSnorm2_10_10_10(const float * aComponents, std::size_t aComponentCount)
+    {
+        auto component = [&](std::size_t aIndex, float aScale, std::uint32_t aMask) -> std::uint32_t
+        {
+            const float value = (aIndex < aComponentCount) ? std::clamp(aComponents[aIndex], -1.f, 1.f) : 0.f;
+            return static_cast<std::uint32_t>(std::lrint(value * aScale)) & aMask;
+        };
+        return component(0, 511.f, 0x3FF)
+            | (component(1, 511.f, 0x3FF) << 10)
+            | (component(2, 511.f, 0x3FF) << 20)
+            | (component(3, 1.f, 0x3) << 30);
+    }
+
+
+#if defined(AD_GRAPHICS_VERTEXSTREAM_SSE2)
+
+    bool detectF16c()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int registers[4];
+        __cpuid(registers, 1);
+        const bool osSavesYmm = (registers[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+        return osSavesYmm && (registers[2] & (1 << 29));
+#else
+        return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#endif
+    }
+
+    const bool gHasF16c = detectF16c();
+
+
+    /// @brief Convert the floats 8 at a time, returning the count of floats converted.
+    AD_GRAPHICS_TARGET("avx,f16c")
+    std::size_t encodeHalfF16c(std::span<const float> aValues, std::uint16_t * aOutput)
+    {
+        std::size_t index = 0;
+        for (; index + 8 <= aValues.size(); index += 8)
+        {
+            const __m256 values = _mm256_loadu_ps(aValues.data() + index);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(aOutput + index),
+                             _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+        }
+        return index;
+    }
+
+
+    /// @brief Clamp 4 floats to [aMinimum, aMaximum], then scale and round them to 32-bit integers.
+    __m128i toNormalized4(const float * aValues, __m128 aMinimum, __m128 aMaximum, __m128 aScale)
+    {
+        const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(aValues), aMinimum), aMaximum);
+        return _mm_cvtps_epi32(_mm_mul_ps(clamped, aScale)); // rounds to nearest even with the default MXCSR, as std::lrint
+    }
+
+#endif // AD_GRAPHICS_VERTEXSTREAM_SSE2
+
+
+    /// @brief Encode the values of one attribute, tightly packed, into aOutput.
+    void encode(VertexEncoding aEncoding,
+                std::span<const float> aValues,
+                std::size_t aComponentCount,
+                std::byte * aOutput)
+    {
+        switch(aEncoding)
+        {
+            case VertexEncoding::Float:
+                std::memcpy(aOutput, aValues.data(), aValues.size_bytes());
+                break;
+            case VertexEncoding::Half:
+                detail::encodeHalf(aValues, reinterpret_cast<std::uint16_t *>(aOutput));
+                break;
+            case VertexEncoding::Snorm16:
+                detail::encodeSnorm16(aValues, reinterpret_cast<std::int16_t *>(aOutput));
+                break;
+            case VertexEncoding::Unorm16:
+            case VertexEncoding::Quantized16:
+                detail::encodeUnorm16(aValues, reinterpret_cast<std::uint16_t *>(aOutput));
+                break;
+            case VertexEncoding::Snorm8:
+                detail::encodeSnorm8(aValues, reinterpret_cast<std::int8_t *>(aOutput));
+                break;
+            case VertexEncoding::Unorm8:
+                detail::encodeUnorm8(aValues, reinterpret_cast<std::uint8_t *>(aOutput));
+                break;
+            case VertexEncoding::Snorm2_10_10_10:
+                for (std::size_t first = 0, vertex = 0; first < aValues.size(); first += aComponentCount, ++vertex)
+                {
+                    const std::uint32_t packed = packSnorm2_10_10_10(aValues.data() + first, aComponentCount);
+                    std::memcpy(aOutput + vertex * sizeof(packed), &packed, sizeof(packed));
+                }
+                break;
+        }
+    }
+
+
+    /// @brief Remap each component to [0, 1] over its range in aValues.
+    Dequantization quantize(std::span<float> aValues, std::size_t aComponentCount)
+    {
+        Dequantization result;
+        for (std::size_t componentId = 0; componentId != aComponentCount; ++componentId)
+        {
+            float minimum = std::numeric_limits<float>::max();
+            float maximum = std::numeric_limits<float>::lowest();
+            for (std::size_t index = componentId; index < aValues.size(); index += aComponentCount)
+            {
+                minimum = std::min(minimum, aValues[index]);
+                maximum = std::max(maximum, aValues[index]);
+            }
+            if (minimum > maximum) // no vertices
+            {
+                minimum = maximum = 0.f;
+            }
+
+            const float extent = (maximum > minimum) ? maximum - minimum : 1.f;
+            result.offset[componentId] = minimum;
+            result.scale[componentId] = extent;
+            for (std::size_t index = componentId; index < aValues.size(); index += aComponentCount)
+            {
+                aValues[index] = (aValues[index] - minimum) / extent;
+            }
+        }
+        return result;
+    }
+
+} // anonymous namespace
+
+
+namespace detail {
+
+
+    void encodeHalf(std::span<const float> aValues, std::uint16_t * aOutput)
+    {
+        std::size_t index = 0;
+#if defined(AD_GRAPHICS_VERTEXSTREAM_SSE2)
+        if (gHasF16c)
+        {
+            index = encodeHalfF16c(aValues, aOutput);
+        }
+#endif
+        for (; index != aValues.size(); ++index)
+        {
+            aOutput[index] = toHalf(aValues[index]);
+        }
+    }
+
+
+    void encodeSnorm16(std::span<const float> aValues, std::int16_t * aOutput)
+    {
+        std::size_t index = 0;
+#if defined(AD_GRAPHICS_VERTEXSTREAM_SSE2)
+        const __m128 minimum = _mm_set1_ps(-1.f);
+        const __m128 maximum = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(32767.f);
+        for (; index + 8 <= aValues.size(); index += 8)
+        {
+            const __m128i low = toNormalized4(aValues.data() + index, minimum, maximum, scale);
+            const __m128i high = toNormalized4(aValues.data() + index + 4, minimum, maximum, scale);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(aOutput + index), _mm_packs_epi32(low, high));
+        }
+#endif
+        for (; index != aValues.size(); ++index)
+        {
+            aOutput[index] = toNormalized<std::int16_t>(aValues[index], -1.f, 1.f);
+        }
+    }
+
+
+    void encodeUnorm16(std::span<const float> aValues, std::uint16_t * aOutput)
+    {
+        std::size_t index = 0;
+#if defined(AD_GRAPHICS_VERTEXSTREAM_SSE2)
+        const __m128 minimum = _mm_setzero_ps();
+        const __m128 maximum = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(65535.f);
+        // SSE2 only has a signed saturating pack: shift to the signed range, then flip the sign bit back.
+        const __m128i bias = _mm_set1_epi32(32768);
+        const __m128i signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+        for (; index + 8 <= aValues.size(); index += 8)
+        {
+            const __m128i low = _mm_sub_epi32(toNormalized4(aValues.data() + index, minimum, maximum, scale), bias);
+            const __m128i high = _mm_sub_epi32(toNormalized4(aValues.data() + index + 4, minimum, maximum, scale), bias);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(aOutput + index),
+                             _mm_xor_si128(_mm_packs_epi32(low, high), signBit));
+        }
+#endif
+        for (; index != aValues.size(); ++index)
+        {
+            aOutput[index] = toNormalized<std::uint16_t>(aValues[index], 0.f, 1.f);
+        }
+    }
+
+
+    void encodeSnorm8(std::span<const float> aValues, std::int8_t * aOutput)
+    {
+        std::size_t index = 0;
+#if defined(AD_GRAPHICS_VERTEXSTREAM_SSE2)
+        const __m128 minimum = _mm_set1_ps(-1.f);
+        const __m128 maximum = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(127.f);
+        for (; index + 16 <= aValues.size(); index += 16)
+        {
+            const float * values = aValues.data() + index;
+            const __m128i low = _mm_packs_epi32(toNormalized4(values, minimum, maximum, scale),
+                                                toNormalized4(values + 4, minimum, maximum, scale));
+            const __m128i high = _mm_packs_epi32(toNormalized4(values + 8, minimum, maximum, scale),
+                                                 toNormalized4(values + 12, minimum, maximum, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(aOutput + index), _mm_packs_epi16(low, high));
+        }
+#endif
+        for (; index != aValues.size(); ++index)
+        {
+            aOutput[index] = toNormalized<std::int8_t>(aValues[index], -1.f, 1.f);
+        }
+    }
+
+
+    void encodeUnorm8(std::span<const float> aValues, std::uint8_t * aOutput)
+    {
+        std::size_t index = 0;
+#if defined(AD_GRAPHICS_VERTEXSTREAM_SSE2)
+        const __m128 minimum = _mm_setzero_ps();
+        const __m128 maximum = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(255.f);
+        for (; index + 16 <= aValues.size(); index += 16)
+        {
+            const float * values = aValues.data() + index;
+            const __m128i low = _mm_packs_epi32(toNormalized4(values, minimum, maximum, scale),
+                                                toNormalized4(values + 4, minimum, maximum, scale));
+            const __m128i high = _mm_packs_epi32(toNormalized4(values + 8, minimum, maximum, scale),
+                                                 toNormalized4(values + 12, minimum, maximum, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(aOutput + index), _mm_packus_epi16(low, high));
+        }
+#endif
+        for (; index != aValues.size(); ++index)
+        {
+            aOutput[index] = toNormalized<std::uint8_t>(aValues[index], 0.f, 1.f);
+        }
+    }
+
+
+} // namespace detail
+
+
+VertexStreamBuilder::VertexStreamBuilder(std::vector<VertexStreamAttribute> aLayout) :
+    mLayout{std::move(aLayout)}
+{}
+
+
+VertexStream VertexStreamBuilder::build(arte::gltf::BufferCache & aBuffers,
+                                        const arte::gltf::Primitive & aPrimitive) const
+{
+    using arte::gltf::Accessor;
+
+    struct Source
+    {
+        const Accessor & accessor;
+        std::size_t componentCount;
+        std::size_t elementSize; // before alignment
+    };
+
+    //
+    // Layout
+    //
+    VertexStream stream;
+    std::vector<Source> sources;
+    std::size_t offset = 0;
+    for (const VertexStreamAttribute & attribute : mLayout)
+    {
+        auto found = aPrimitive.attributes.find(attribute.semantic);
+        if (found == aPrimitive.attributes.end())
+        {
+            throw std::invalid_argument{"The primitive does not have a " + attribute.semantic + " attribute."};
+        }
+        const Accessor & accessor = aBuffers.getGltf().get(found->second);
+        const std::size_t componentCount = arte::gltf::countComponents(accessor.type);
+        if (componentCount > 4)
+        {
+            throw std::invalid_argument{"Matrix attributes are not supported: " + attribute.semantic + "."};
+        }
+
+        if (sources.empty())
+        {
+            stream.vertexCount = accessor.count;
+        }
+        else if (accessor.count != stream.vertexCount)
+        {
+            throw std::invalid_argument{"The " + attribute.semantic
+                                        + " attribute count does not match the vertex count."};
+        }
+
+        const EncodingFormat format = getFormat(attribute.encoding);
+        const bool packed = (attribute.encoding == VertexEncoding::Snorm2_10_10_10);
+        const std::size_t elementSize = packed ? format.componentSize : componentCount * format.componentSize;
+
+        stream.attributes.push_back(AttributeFormat{
+            {attribute.location, format.normalize},
+            {packed ? 4 : static_cast<GLuint>(componentCount), offset, format.componentType},
+        });
+        sources.push_back({accessor, componentCount, elementSize});
+        offset += alignOn4(elementSize);
+    }
+    stream.stride = static_cast<GLsizei>(offset);
+    stream.data.resize(stream.stride * stream.vertexCount);
+    stream.dequantizations.resize(mLayout.size());
+
+    //
+    // Conversion, then interleaving
+    //
+    std::vector<std::byte> encoded;
+    for (std::size_t attributeId = 0; attributeId != mLayout.size(); ++attributeId)
+    {
+        const Source & source = sources[attributeId];
+        const VertexEncoding encoding = mLayout[attributeId].encoding;
+
+        std::vector<float> values = arte::gltf::readAsFloats(aBuffers, source.accessor);
+        if (encoding == VertexEncoding::Quantized16)
+        {
+            stream.dequantizations[attributeId] = quantize(values, source.componentCount);
+        }
+
+        encoded.resize(source.elementSize * stream.vertexCount);
+        encode(encoding, values, source.componentCount, encoded.data());
+
+        std::byte * destination = stream.data.data() + stream.attributes[attributeId].mOffset;
+        for (std::size_t vertex = 0; vertex != stream.vertexCount; ++vertex)
+        {
+            std::memcpy(destination + vertex * stream.stride,
+                        encoded.data() + vertex * source.elementSize,
+                        source.elementSize);
+        }
+    }
+
+    return stream;
+}
+
+
+VertexBufferObject loadVertexBuffer(const VertexArrayObject & aVertexArray,
+                                    const VertexStream & aStream,
+                                    BufferHint aHint)
+{
+    return loadVertexBuffer(aVertexArray,
+                            std::span<const AttributeFormat>{aStream.attributes},
+                            aStream.stride,
+                            aStream.data.size(),
+                            aStream.data.data(),
+                            aHint);
+}
+
+
+} // namespace r3d
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,110 @@
+#pragma once
+
+
+#include <arte/gltf/Accessor.h>
+
+#include <renderer/VertexSpecification.h>
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+namespace r3d {
+
+
+/// @brief How an attribute is stored in the vertex stream.
+///
+/// Normalized encodings expect values in their range ([-1, 1] or [0, 1]), and clamp the others.
+enum class VertexEncoding
+{
+    Float,              // GL_FLOAT, unchanged.
+    Half,               // GL_HALF_FLOAT, e.g. texture coordinates.
+    Snorm16,            // GL_SHORT normalized.
+    Unorm16,            // GL_UNSIGNED_SHORT normalized.
+    Snorm8,             // GL_BYTE normalized.
+    Unorm8,             // GL_UNSIGNED_BYTE normalized, e.g. colors.
+    Snorm2_10_10_10,    // GL_INT_2_10_10_10_REV normalized, e.g. normals and tangents (always 4 components).
+    Quantized16,        // GL_UNSIGNED_SHORT normalized over the attribute bounding box, e.g. positions.
+};
+
+
+/// @brief Where a glTF attribute goes in the vertex stream, and how it is stored.
+struct VertexStreamAttribute
+{
+    std::string semantic; // glTF attribute name, e.g. "POSITION" or "TEXCOORD_0".
+    GLuint location;      // vertex attribute index in the shader program.
+    VertexEncoding encoding{VertexEncoding::Float};
+};
+
+
+/// @brief Maps the value read by the shader back to the original value: `value * scale + offset`.
+///
+/// Identity unless the attribute is `VertexEncoding::Quantized16`.
+struct Dequantization
+{
+    std::array<float, 4> offset{0.f, 0.f, 0.f, 0.f};
+    std::array<float, 4> scale{1.f, 1.f, 1.f, 1.f};
+};
+
+
+/// @brief Interleaved vertex data, ready to be loaded in a vertex buffer.
+struct VertexStream
+{
+    std::size_t size() const
+    { return data.size(); }
+
+    std::vector<std::byte> data;
+    std::size_t vertexCount{0};
+    GLsizei stride{0};
+    std::vector<AttributeFormat> attributes;        // in the order of the builder layout.
+    std::vector<Dequantization> dequantizations;    // one per attribute.
+};
+
+
+/// @brief Interleaves the attributes of glTF primitives into a single vertex stream,
+/// converting them to compact encodings.
+///
+/// Each attribute is aligned on 4 bytes, as recommended by OpenGL.
+class VertexStreamBuilder
+{
+public:
+    explicit VertexStreamBuilder(std::vector<VertexStreamAttribute> aLayout);
+
+    /// @throw std::invalid_argument if the primitive misses an attribute of the layout,
+    /// or if an attribute does not fit its encoding.
+    VertexStream build(arte::gltf::BufferCache & aBuffers, const arte::gltf::Primitive & aPrimitive) const;
+
+    std::span<const VertexStreamAttribute> getLayout() const
+    { return mLayout; }
+
+private:
+    std::vector<VertexStreamAttribute> mLayout;
+};
+
+
+/// @brief Load the stream in a new vertex buffer, attached to `aVertexArray`.
+VertexBufferObject loadVertexBuffer(const VertexArrayObject & aVertexArray,
+                                    const VertexStream & aStream,
+                                    BufferHint aHint);
+
+
+namespace detail {
+
+    // Conversions of contiguous floats, exposed for testing.
+    void encodeHalf(std::span<const float> aValues, std::uint16_t * aOutput);
+    void encodeSnorm16(std::span<const float> aValues, std::int16_t * aOutput);
+    void encodeUnorm16(std::span<const float> aValues, std::uint16_t * aOutput);
+    void encodeSnorm8(std::span<const float> aValues, std::int8_t * aOutput);
+    void encodeUnorm8(std::span<const float> aValues, std::uint8_t * aOutput);
+
+} // namespace detail
+
+
+} // namespace r3d
+} // namespace graphics
+} // namespace ad
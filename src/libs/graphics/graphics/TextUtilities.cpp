@@ -174,5 +174,21 @@ math::Position<2, GLfloat> PenPosition::advance(math::Vec<2, float> aPenAdvance,
 }
 
 
+math::Position<2, GLfloat> PenPosition::advance(math::Vec<2, float> aPenAdvance,
+                                                unsigned int aFreetypeIndex,
+                                                const arte::KerningTable & aKerning,
+                                                const arte::FontFace & aFontFace)
+{
+    if(mPreviousFreetypeIndex)
+    {
+        mLocalPenPosition += aKerning.get(*mPreviousFreetypeIndex, aFreetypeIndex, aFontFace);
+    }
+    math::Position<2, GLfloat> result = mLocalPenPosition;
+    mPreviousFreetypeIndex = aFreetypeIndex;
+    mLocalPenPosition += aPenAdvance;
+    return result;
+}
+
+
 } // namespace graphics
 } // namespace ad
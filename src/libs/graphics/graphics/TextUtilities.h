@@ -1,7 +1,10 @@
 #pragma once
 
 
+#include "detail/Utf8.h"
+
 #include <arte/Freetype.h>
+#include <arte/KerningTable.h>
 
 #include <renderer/Texture.h>
 
@@ -9,9 +12,8 @@
 
 #include <functional>
 #include <optional>
-
-// TODO move
-#include <utf8.h> // utfcpp lib
+#include <string>
+#include <string_view>
 
 namespace ad {
 namespace graphics {
@@ -66,6 +68,19 @@ public:
                                        const arte::FontFace & aFontFace)
     { return advance(aGlyph.penAdvance, aGlyph.freetypeIndex, aFontFace); }
 
+    /// @brief Looks up kerning in `aKerning`, which only queries `aFontFace` for glyphs it was not built with.
+    /// @return The pen position for the current glyph, computed from all previous glyphs.
+    math::Position<2, GLfloat> advance(math::Vec<2, float> aPenAdvance,
+                                       unsigned int aFreetypeIndex,
+                                       const arte::KerningTable & aKerning,
+                                       const arte::FontFace & aFontFace);
+
+    /// @return The pen position for the current glyph, computed from all previous glyphs.
+    math::Position<2, GLfloat> advance(const graphics::RenderedGlyph & aGlyph,
+                                       const arte::KerningTable & aKerning,
+                                       const arte::FontFace & aFontFace)
+    { return advance(aGlyph.penAdvance, aGlyph.freetypeIndex, aKerning, aFontFace); }
+
 private:
     std::optional<unsigned int> mPreviousFreetypeIndex;
     math::Position<2, GLfloat> mLocalPenPosition;
@@ -75,23 +90,19 @@ private:
 using GlyphPositionCallback = 
     std::function<void(const RenderedGlyph &, math::Position<2, GLfloat>)>;
 
-// TODO move to an impl file if kept around, due to utf8 import.
 // TODO a CodePoint iterator would be much cleaner.
-template <class T_glyphMap>
-void forEachGlyph(const std::string & aString,
+/// @param aGlyphCallback Invocable as `GlyphPositionCallback`, it is templated so it can be inlined.
+template <class T_glyphMap, class T_callback>
+void forEachGlyph(std::string_view aString,
                   const arte::FontFace & aFontFace,
                   const T_glyphMap & aGlyphMap,
-                  const GlyphPositionCallback & aGlyphCallback,
+                  T_callback && aGlyphCallback,
                   math::Position<2, GLfloat> aPenOrigin_p = {0.f, 0.f})
 {
     unsigned int previousIndex = 0;
-    for (std::string::const_iterator it = aString.begin();
-         it != aString.end();
-         /* in body */)
+    detail::decodeUtf8(aString, [&](arte::CharCode aCodePoint)
     {
-        // Decode utf8 encoded string to individual Unicode code points
-        arte::CharCode codePoint = utf8::next(it, aString.end());
-        const RenderedGlyph & rendered = aGlyphMap.at(codePoint);
+        const RenderedGlyph & rendered = aGlyphMap.at(aCodePoint);
 
         // Kerning
         if (previousIndex != 0)
@@ -103,7 +114,7 @@ void forEachGlyph(const std::string & aString,
 
         aGlyphCallback(rendered, aPenOrigin_p);
         aPenOrigin_p += rendered.penAdvance;
-    }
+    });
 }
 
 
@@ -2,13 +2,22 @@
 
 #include "CameraUtilities.h"
 #include "shaders.h"
+#include "detail/BakedFont.h"
+#include "detail/Logging.h"
 #include "detail/UnitQuad.h"
 
 #include <math/Transformations.h>
 
+#include <renderer/BufferLoad.h>
 #include <renderer/Drawing.h>
 #include <renderer/Uniforms.h>
 
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <span>
+#include <stdexcept>
+
 
 namespace ad {
 namespace graphics {
@@ -16,25 +25,39 @@ namespace graphics {
 
 constexpr AttributeDescriptionList gGlyphInstanceDescription{
     { 2,                                     {2, offsetof(Texting::Instance, position_w),    MappedGL<GLfloat>::enumerator}},
-    { {3, ShaderParameter::Access::Integer}, {1, offsetof(Texting::Instance, offsetInTexture_p), MappedGL<GLint>::enumerator}},
+    { {3, ShaderParameter::Access::Integer}, {2, offsetof(Texting::Instance, offsetInTexture_p), MappedGL<GLint>::enumerator}},
     { 4,                                     {2, offsetof(Texting::Instance, boundingBox_p), MappedGL<GLfloat>::enumerator}},
     { 5,                                     {2, offsetof(Texting::Instance, bearing_p),     MappedGL<GLfloat>::enumerator}},
     { {6, true},                             {4, offsetof(Texting::Instance, color), MappedGL<GLubyte>::enumerator}},
 };
 
 
-constexpr GLint gTextureWidthCount = 256;
+constexpr AttributeDescriptionList gRunGlyphDescription{
+    { 2,                                     {2, offsetof(Texting::RunGlyph, position_p),        MappedGL<GLfloat>::enumerator}},
+    { {3, ShaderParameter::Access::Integer}, {2, offsetof(Texting::RunGlyph, offsetInTexture_p), MappedGL<GLint>::enumerator}},
+    { 4,                                     {2, offsetof(Texting::RunGlyph, boundingBox_p),     MappedGL<GLfloat>::enumerator}},
+    { 5,                                     {2, offsetof(Texting::RunGlyph, bearing_p),         MappedGL<GLfloat>::enumerator}},
+    { {6, ShaderParameter::Access::Integer}, {1, offsetof(Texting::RunGlyph, runIndex),          MappedGL<GLuint>::enumerator}},
+};
+
+
+// Each side of the glyph atlas textures, in texels (clamped to the maximum texture size).
+// A 2048 x 2048 atlas holds a few thousand glyphs 32 pixels high.
+constexpr GLint gAtlasDimension = 2048;
 
 Texting::Texting(const filesystem::path & aFontPath,
                  GLfloat aGlyphWorldHeight, 
                  GLfloat aScreenWorldHeight,
                  std::shared_ptr<AppInterface> aAppInterface,
-                 Filtering aTextureFiltering) :
+                 Filtering aTextureFiltering,
+                 Rendering aRendering) :
     mQuadVbo{
         loadUnattachedVertexBuffer<detail::VertexUnitQuad>(
             detail::make_RectangleVertices({ {0.f, -1.f}, {1.f, 1.f} }),
             BufferHint::StaticDraw)
     },
+    mHasBaseInstance{GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_base_instance},
+    mInstanceBuffer{initVertexBuffer<Instance>(mVao, gGlyphInstanceDescription, 1)},
     mVaoPool{
         [this]()
         {
@@ -49,11 +72,23 @@ Texting::Texting(const filesystem::path & aFontPath,
     },
     mGpuProgram{makeLinkedProgram({
         {GL_VERTEX_SHADER,   texting::gGlyphVertexShader},
-        {GL_FRAGMENT_SHADER, texting::gGlyphFragmentShader},
+        {GL_FRAGMENT_SHADER, aRendering == Msdf ? texting::gMsdfFragmentShader : texting::gGlyphFragmentShader},
+    })},
+    mRunProgram{makeLinkedProgram({
+        {GL_VERTEX_SHADER,   texting::gRunVertexShader},
+        {GL_FRAGMENT_SHADER, aRendering == Msdf ? texting::gMsdfFragmentShader : texting::gGlyphFragmentShader},
     })},
-    mFontFace{mFreetype.load(aFontPath)},
+    mRunGlyphBuffer{initVertexBuffer<RunGlyph>(mRunVao, gRunGlyphDescription, 1)},
+    mFontPath{aFontPath},
+    mFontFace{mFreetype.load(mFontPath)},
     mPixelToWorld{decltype(mPixelToWorld)::Zero()}
 {
+    attachVertexBuffer<detail::VertexUnitQuad>(mQuadVbo, mVao, detail::gVertexScreenDescription);
+    attachVertexBuffer<detail::VertexUnitQuad>(mQuadVbo, mRunVao, detail::gVertexScreenDescription);
+
+    initialize<RunUniforms>(mRunUniformBuffer, gMaxRuns, BufferHint::DynamicDraw);
+    glUniformBlockBinding(mRunProgram, glGetUniformBlockIndex(mRunProgram, "RunBlock"), gRunBlockBinding);
+
     setCameraTransformation(math::AffineMatrix<3, GLfloat>::Identity());
     setProjectionTransformation(
         math::trans2d::orthographicProjection<GLfloat>(
@@ -64,16 +99,23 @@ Texting::Texting(const filesystem::path & aFontPath,
     GLfloat pixelToWorld = aGlyphWorldHeight / glyphPixelHeight;
     mPixelToWorld = {pixelToWorld, pixelToWorld};
     setUniform(mGpuProgram, "u_PixelToWorld", mPixelToWorld);
+    setUniform(mRunProgram, "u_PixelToWorld", mPixelToWorld);
 
     setUniform(mGpuProgram, "u_FontAtlas", gTextureUnit);
+    setUniform(mRunProgram, "u_FontAtlas", gTextureUnit);
+
+    if (aRendering == Msdf)
+    {
+        setUniform(mGpuProgram, "u_DistanceRange", detail::gMsdfRange);
+        setUniform(mRunProgram, "u_DistanceRange", detail::gMsdfRange);
+    }
 
-    // use recommended ribon margins
-    auto ribonMargins = detail::TextureRibon::gRecommendedMargins;
     mGlyphCache = detail::DynamicGlyphCache{
-        {(GLint)(gTextureWidthCount * glyphPixelHeight),
-         (GLint)(glyphPixelHeight + (2 * ribonMargins.y()))}, // Margin above and below
-        ribonMargins,
-        (aTextureFiltering == Filtering::Linear) ? (GLenum)GL_LINEAR : GL_NEAREST
+        mFontFace,
+        {gAtlasDimension, gAtlasDimension},
+        detail::TextureRibon::gRecommendedMargins,
+        (aTextureFiltering == Filtering::Linear || aRendering == Msdf) ? (GLenum)GL_LINEAR : GL_NEAREST,
+        (aRendering == Msdf) ? detail::GlyphRasterization::Msdf : detail::GlyphRasterization::Coverage,
     };
 
     // Font setup
@@ -84,7 +126,25 @@ Texting::Texting(const filesystem::path & aFontPath,
 
 void Texting::loadGlyphs(arte::CharCode aFirst, arte::CharCode aLast)
 {
-    mGlyphCache.preloadGlyphs(mFontFace, aFirst, aLast);
+    mGlyphCache.preloadGlyphs(mFontFace, mFontPath, aFirst, aLast);
+}
+
+
+bool Texting::loadGlyphs(const filesystem::path & aBakedFont)
+{
+    const detail::BakedFont bakedFont{aBakedFont};
+    const auto pixelHeight = static_cast<std::uint32_t>(mFontFace.getPixelSize().height());
+    if (const detail::BakedFontSizeView * baked = bakedFont.find(pixelHeight, mGlyphCache.rasterization))
+    {
+        mGlyphCache.loadBaked(*baked);
+        return true;
+    }
+    else
+    {
+        ADLOG(gMainLogger, warn)
+        ("No glyphs baked for pixel height {} in '{}'.", pixelHeight, aBakedFont.string());
+        return false;
+    }
 }
 
 
@@ -93,61 +153,223 @@ void Texting::render() const
     glUseProgram(mGpuProgram);
     glActiveTexture(GL_TEXTURE0 + gTextureUnit);
 
-    // glDrawElementsInstancedBaseInstance not supported on macOS,
-    // so workaround using several instance buffers.
-    for (const handy::Pooled<PerTextureVao> & perTexture : mPerTexture)
+    if (mHasBaseInstance)
     {
-        glBindVertexArray(perTexture->vao);
-        bind(*perTexture->texture);
-        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, gVertexCount, perTexture->instanceCount);
+        glBindVertexArray(mVao);
+        for (const PerTextureRange & range : mPerTextureRanges)
+        {
+            bind(*range.texture);
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, gVertexCount,
+                                              range.instanceCount, range.firstInstance);
+        }
+    }
+    else
+    {
+        // glDrawArraysInstancedBaseInstance not supported on macOS,
+        // so workaround using several instance buffers.
+        for (const handy::Pooled<PerTextureVao> & perTexture : mPerTexture)
+        {
+            glBindVertexArray(perTexture->vao);
+            bind(*perTexture->texture);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, gVertexCount, perTexture->instanceCount);
+        }
     }
+
+    renderRuns();
 }
 
 
-void Texting::setCameraTransformation(const math::AffineMatrix<3, GLfloat> & aTransformation)
+void Texting::renderRuns() const
 {
-    setUniform(mGpuProgram, "u_WorldToCamera", aTransformation); 
+    if (mRunDraws.empty())
+    {
+        return;
+    }
+
+    glUseProgram(mRunProgram);
+    glBindBufferBase(GL_UNIFORM_BUFFER, gRunBlockBinding, mRunUniformBuffer);
+    glBindVertexArray(mRunVao);
+
+    for (const PerTextureRange & draw : mRunDraws)
+    {
+        bind(*draw.texture);
+        if (mHasBaseInstance)
+        {
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, gVertexCount,
+                                              draw.instanceCount, draw.firstInstance);
+        }
+        else
+        {
+            // Point the instance attributes at the first glyph of the draw instead.
+            glBindBuffer(GL_ARRAY_BUFFER, mRunGlyphBuffer);
+            for (AttributeFormat attribute : gRunGlyphDescription)
+            {
+                attribute.mOffset += draw.firstInstance * sizeof(RunGlyph);
+                attachBoundVertexBuffer(attribute, sizeof(RunGlyph), 1);
+            }
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, gVertexCount, draw.instanceCount);
+        }
+    }
 }
 
 
-void Texting::setProjectionTransformation(const math::Matrix<3, 3, GLfloat> & aTransformation)
+Texting::RunId Texting::createRun(const std::string & aString,
+                                  const math::AffineMatrix<3, GLfloat> & aTransformation,
+                                  math::sdr::Rgba aColor)
 {
-    setUniform(mGpuProgram, "u_Projection", aTransformation); 
+    const RunId runId = mRuns.create();
+    Run & run = mRuns.at(runId);
+    run.string = aString;
+    setRunTransformation(runId, aTransformation);
+    setRunColor(runId, aColor);
+    layoutRun(run, runId);
+    uploadRun(run);
+    mRuns.getDraws(mRunDraws);
+    return runId;
 }
 
 
-math::Rectangle<GLfloat> Texting::getStringBounds(const std::string & aString, math::Position<2, GLfloat> aPenOrigin_w)
+void Texting::setRunString(RunId aRun, const std::string & aString)
 {
-    math::Vec<2, GLfloat> pixelToWorld = mPixelToWorld.as<math::Vec>();
-    math::Rectangle<GLfloat> boundingBox{aPenOrigin_w, {0.f, 0.f}};
+    Run & run = mRuns.at(aRun);
+    assert(run.alive);
+    if (run.string != aString)
+    {
+        run.string = aString;
+        layoutRun(run, aRun);
+        uploadRun(run);
+        mRuns.getDraws(mRunDraws);
+    }
+}
+
 
-    // Get rid of the first character bearing 
-    // (i.e. difference between initial pen position, and a corner of the glyph bounding box).
-    if(!aString.empty())
+void Texting::setRunTransformation(RunId aRun, const math::AffineMatrix<3, GLfloat> & aTransformation)
+{
+    assert(mRuns.at(aRun).alive);
+    GLfloat rows[3][4]{};
+    const GLfloat * elements = aTransformation.data();
+    for (std::size_t row = 0; row != 3; ++row)
     {
-        forEachGlyph({aString.begin(), aString.begin()+1}, aPenOrigin_w, mGlyphCache, mFontFace, mPixelToWorld,
-            [&boundingBox, pixelToWorld](const detail::RenderedGlyph & rendered, math::Position<2, GLfloat> penPosition_w)
-            {
-                boundingBox.origin() += rendered.bearing.cwMul(pixelToWorld);
-            });
+        for (std::size_t column = 0; column != 3; ++column)
+        {
+            rows[row][column] = elements[row * 3 + column];
+        }
+    }
+    replaceSubset(mRunUniformBuffer,
+                  getRunUniformsOffset(aRun, offsetof(RunUniforms, transformation)),
+                  std::span{rows});
+}
+
+
+void Texting::setRunColor(RunId aRun, math::sdr::Rgba aColor)
+{
+    assert(mRuns.at(aRun).alive);
+    const GLfloat color[1][4]{{aColor.r() / 255.f, aColor.g() / 255.f, aColor.b() / 255.f, aColor.a() / 255.f}};
+    replaceSubset(mRunUniformBuffer,
+                  getRunUniformsOffset(aRun, offsetof(RunUniforms, color)),
+                  std::span{color});
+}
+
+
+void Texting::removeRun(RunId aRun)
+{
+    Run & run = mRuns.at(aRun);
+    assert(run.alive);
+    for (std::uint32_t page : run.pages)
+    {
+        mGlyphCache.unpinPage(page);
     }
+    // The region of the run in the glyph buffer is reclaimed at the next repack.
+    mRuns.remove(aRun);
+    mRuns.getDraws(mRunDraws);
+}
 
-    forEachGlyph(aString, aPenOrigin_w, mGlyphCache, mFontFace, mPixelToWorld,
-        [&boundingBox, pixelToWorld](const detail::RenderedGlyph & rendered, math::Position<2, GLfloat> penPosition_w)
+
+void Texting::layoutRun(Run & aRun, RunId aRunId)
+{
+    std::vector<std::uint32_t> pages;
+    // The byte count bounds the glyph count, so the glyphs are laid out in place.
+    mPlacedGlyphs.resize(aRun.string.size());
+    // Laid out in pixels: the pixel to world scaling is applied by the vertex shader.
+    const detail::StringLayout layout = detail::layoutString(aRun.string, {0.f, 0.f}, {1.f, 1.f},
+        [this](arte::CharCode aCodePoint){ return mGlyphCache.at(aCodePoint, mFontFace); },
+        mGlyphCache.kerning, mFontFace,
+        std::span{mPlacedGlyphs},
+        [this, &pages, aRunId](const detail::RenderedGlyph & rendered, math::Position<2, GLfloat> penPosition_p)
         {
-            // Those computations should work for both horizontal and vertical layouts.
-            // Top-left corner of the glyph bounding box.
-            boundingBox.extendTo(penPosition_w 
-                                    + rendered.bearing.cwMul(pixelToWorld)); 
-            // Bottom-right corner of the glyph bounding box.
-            boundingBox.extendTo(penPosition_w 
-                                    + rendered.bearing.cwMul(pixelToWorld)
-                                    + math::Vec<2, GLfloat>{
-                                        +rendered.controlBoxSize.width(),
-                                        -rendered.controlBoxSize.height()}.cwMul(pixelToWorld));
+            if (std::find(pages.begin(), pages.end(), rendered.page) == pages.end())
+            {
+                pages.push_back(rendered.page);
+            }
+            return std::pair{
+                mGlyphCache.getTexture(rendered.page),
+                RunGlyph{
+                    .position_p = penPosition_p,
+                    .offsetInTexture_p = rendered.offsetInTexture,
+                    .boundingBox_p = rendered.controlBoxSize,
+                    .bearing_p = rendered.bearing,
+                    .runIndex = (GLuint)aRunId,
+                }
+            };
         });
 
-    return boundingBox;
+    // The run glyphs stay on the GPU across frames, their pages must not be recycled.
+    for (std::uint32_t page : pages)
+    {
+        mGlyphCache.pinPage(page);
+    }
+    for (std::uint32_t page : aRun.pages)
+    {
+        mGlyphCache.unpinPage(page);
+    }
+    aRun.pages = std::move(pages);
+
+    aRun.setGlyphs(std::span{mPlacedGlyphs}.first(layout.glyphCount));
+}
+
+
+void Texting::uploadRun(Run & aRun)
+{
+    if (!mRuns.reserve(aRun))
+    {
+        // Also reclaims the regions of removed runs, and of runs that outgrew them.
+        repackRuns();
+        return;
+    }
+    replaceSubset(mRunGlyphBuffer, aRun.firstGlyph, std::span{aRun.glyphs});
+}
+
+
+void Texting::repackRuns()
+{
+    const std::vector<RunGlyph> glyphs = mRuns.repack();
+    initialize<RunGlyph>(mRunGlyphBuffer, (GLsizei)mRuns.getGlyphCapacity(), BufferHint::DynamicDraw);
+    replaceSubset(mRunGlyphBuffer, 0, std::span{glyphs});
+}
+
+
+void Texting::setCameraTransformation(const math::AffineMatrix<3, GLfloat> & aTransformation)
+{
+    setUniform(mGpuProgram, "u_WorldToCamera", aTransformation); 
+    setUniform(mRunProgram, "u_WorldToCamera", aTransformation); 
+}
+
+
+void Texting::setProjectionTransformation(const math::Matrix<3, 3, GLfloat> & aTransformation)
+{
+    setUniform(mGpuProgram, "u_Projection", aTransformation); 
+    setUniform(mRunProgram, "u_Projection", aTransformation); 
+}
+
+
+math::Rectangle<GLfloat> Texting::getStringBounds(const std::string & aString, math::Position<2, GLfloat> aPenOrigin_w)
+{
+    // Laying out computes the bounds in the same pass, there is nothing left to do per glyph.
+    return detail::layoutString(aString, aPenOrigin_w, mPixelToWorld.as<math::Vec>(),
+        [this](arte::CharCode aCodePoint){ return mGlyphCache.at(aCodePoint, mFontFace); },
+        mGlyphCache.kerning, mFontFace,
+        [](const detail::RenderedGlyph &, math::Position<2, GLfloat>){})
+        .getBounds();
 }
 
 
@@ -3,6 +3,8 @@
 
 #include "AppInterface.h"
 #include "detail/GlyphUtilities_deprecated.h"
+#include "detail/TextLayout.h"
+#include "detail/TextRuns.h"
 
 #include <arte/Freetype.h>
 
@@ -14,11 +16,17 @@
 #include <platform/Filesystem.h>
 
 #include <renderer/Shading.h>
+#include <renderer/UniformBuffer.h>
 #include <renderer/VertexSpecification.h>
 
 #include <glad/glad.h>
 
+#include <cstddef>
 #include <map>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
 
 
 namespace ad {
@@ -34,21 +42,29 @@ public:
         Nearest,
     };
 
+    enum Rendering
+    {
+        Bitmap, // Glyphs are rasterized at the pixel height derived from the world heights.
+        Msdf, // Glyphs are distance fields, sharp at any scale (the filtering is always linear).
+    };
+
     struct Instance
     {
         Instance(math::Position<2, GLfloat> aPenOrigin_w,
                  const detail::RenderedGlyph & aRendered,
                  math::sdr::Rgba aColor);
 
-        // TODO Ideally, this should be replaced by the local position of the glyph within the string, in pixel unit
-        // this way, we do not have to keep mPixelToWorld value.
+        // Retained runs (see `RunGlyph`) are laid out in pixels relative to the run origin instead.
         math::Position<2, GLfloat> position_w; // position of the glyph instance in world coordinates.
-        GLint offsetInTexture_p; // horizontal offset to the glyph in its texture.
+        math::Vec<2, GLint> offsetInTexture_p; // offset to the glyph in its texture atlas.
         math::Size<2, GLfloat> boundingBox_p; // glyph bounding box in texture pixel coordinates;
         math::Vec<2, GLfloat> bearing_p;
         math::sdr::Rgba color;
     };
 
+    /// \brief The glyph instance of a text run, laid out in pixels relative to the run origin.
+    using RunGlyph = detail::RunGlyph;
+
     /// \brief A good type for the templated T_mapping (but not the only possiblity).
     using Mapping = std::map<Texture *, std::vector<Texting::Instance>>;
 
@@ -57,19 +73,69 @@ public:
                      GLfloat aGlyphWorldHeight, 
                      GLfloat aScreenWorldHeight,
                      std::shared_ptr<AppInterface> aAppInterface,
-                     Filtering aTextureFiltering = Linear);
+                     Filtering aTextureFiltering = Linear,
+                     Rendering aRendering = Bitmap);
 
     /// [aFirst, aLast[
+    /// \note Large ranges are rasterized on worker threads.
     void loadGlyphs(arte::CharCode aFirst, arte::CharCode aLast);
 
+    /// \brief Upload the glyphs baked for this text pixel height and rendering in `aBakedFont`,
+    /// a file written by the `fontbake` tool.
+    ///
+    /// The file is memory mapped, and the atlas pages are uploaded without rasterizing.
+    /// Glyphs that were not baked are still rendered on demand.
+    /// \return false if the file does not contain the matching size.
+    bool loadGlyphs(const filesystem::path & aBakedFont);
+
+    /// \brief Limit the glyph atlases to `aBytes` of texture memory, 0 for no limit (the default).
+    ///
+    /// Once the budget is reached, the atlas page least recently used is recycled for new glyphs.
+    /// The glyphs of strings prepared during the current or previous frame (see `updateInstances()`),
+    /// and of alive runs, are never evicted. The budget is exceeded when all pages are in use.
+    void setGlyphMemoryBudget(std::size_t aBytes)
+    { mGlyphCache.setMemoryBudget(aBytes); }
+
+    detail::GlyphCacheStatistics getGlyphCacheStatistics() const
+    { return mGlyphCache.getStatistics(); }
+
     /// \brief Replace the strings that will be renderer when calling `render()`.
     /// \note Use `prepareString()` to populate the mapping taken as argument.
+    /// \note This ends the frame for glyph eviction: strings prepared before the previous update
+    /// might refer to recycled atlas pages.
     template <class T_mapping>
     void updateInstances(T_mapping aTextureMappedBuffers);
 
-    /// \brief Render all strings loaded in the buffers via `updateInstances()`.
+    /// \brief Render all strings loaded in the buffers via `updateInstances()`, then all text runs.
     void render() const;
 
+    /// \brief Identifies a retained text run, see `createRun()`.
+    using RunId = detail::TextRuns::RunId;
+
+    /// \brief Maximum number of text runs alive at once (the size of the per-run uniform block).
+    static constexpr std::size_t gMaxRuns = detail::TextRuns::gMaxRuns;
+
+    /// \brief Create a retained text run, laid out once in pixel space.
+    ///
+    /// Contrary to strings from `prepareString()`, the glyphs of a run stay on the GPU
+    /// until the run string changes or the run is removed.
+    /// \param aTransformation Places the run origin (i.e. its initial pen position) in world space.
+    /// \throw std::length_error if `gMaxRuns` runs are already alive.
+    RunId createRun(const std::string & aString,
+                    const math::AffineMatrix<3, GLfloat> & aTransformation,
+                    math::sdr::Rgba aColor);
+
+    /// \brief Lay out the run again and upload its glyphs, only if `aString` differs from its current string.
+    void setRunString(RunId aRun, const std::string & aString);
+
+    /// \brief Only updates the per-run buffer: the glyphs are neither laid out nor uploaded again.
+    void setRunTransformation(RunId aRun, const math::AffineMatrix<3, GLfloat> & aTransformation);
+
+    /// \brief Only updates the per-run buffer: the glyphs are neither laid out nor uploaded again.
+    void setRunColor(RunId aRun, math::sdr::Rgba aColor);
+
+    void removeRun(RunId aRun);
+
     void setCameraTransformation(const math::AffineMatrix<3, GLfloat> & aTransformation);
     void setProjectionTransformation(const math::Matrix<3, 3, GLfloat> & aTransformation);
 
@@ -99,18 +165,65 @@ private:
         GLsizei instanceCount{0};
     };
 
+    /// @brief A range of instances in the single instance buffer, sampling the same texture.
+    using PerTextureRange = detail::PerTextureRange;
+
+    /// @brief The std140 layout of a run in the per-run uniform block.
+    struct RunUniforms
+    {
+        GLfloat transformation[3][4]; // rows of the affine transformation, padded to vec4.
+        GLfloat color[4];
+    };
+
+    /// @brief The offset of a member of the run uniforms in the uniform buffer, in vec4 (as expected by `replaceSubset()`).
+    static constexpr GLsizei getRunUniformsOffset(RunId aRun, std::size_t aMemberOffset)
+    {
+        using Vec4 = GLfloat[4];
+        static_assert(sizeof(RunUniforms) % sizeof(Vec4) == 0);
+        return static_cast<GLsizei>((aRun * sizeof(RunUniforms) + aMemberOffset) / sizeof(Vec4));
+    }
+
+    using Run = detail::TextRuns::Run;
+
+    static constexpr GLuint gRunBlockBinding{2};
+
+    /// @brief Fill the run glyphs and their per-texture ranges from the run string.
+    void layoutRun(Run & aRun, RunId aRunId);
+    /// @brief Write the run glyphs in its region of the glyph buffer, reserving a new region if needed.
+    void uploadRun(Run & aRun);
+    /// @brief Place all alive runs contiguously in a new glyph buffer data store.
+    void repackRuns();
+    void renderRuns() const;
+
     VertexBufferObject mQuadVbo; // will shared by all per-texture VAOs
+
+    // Used when ARB_base_instance is available (detected at runtime).
+    bool mHasBaseInstance;
+    VertexArrayObject mVao;
+    VertexBufferObject mInstanceBuffer;
+    std::vector<PerTextureRange> mPerTextureRanges;
+    std::vector<Instance> mInstances; // Kept between updates to reuse its storage.
+
+    // Fallback, when ARB_base_instance is not available.
     handy::Pool<PerTextureVao> mVaoPool;
     std::vector<handy::Pooled<PerTextureVao>> mPerTexture;
+
     Program mGpuProgram;
 
+    // Retained text runs.
+    Program mRunProgram;
+    VertexArrayObject mRunVao;
+    VertexBufferObject mRunGlyphBuffer;
+    UniformBufferObject mRunUniformBuffer;
+    detail::TextRuns mRuns;
+    std::vector<PerTextureRange> mRunDraws;
+    std::vector<std::pair<Texture *, RunGlyph>> mPlacedGlyphs; // Kept between layouts to reuse its storage.
+
     arte::Freetype mFreetype;
+    filesystem::path mFontPath; // opened again by the threads preloading glyphs
     arte::FontFace mFontFace;
-    // TODO mPixelToWorld should be removed, and all "string local" pen computation be done in pixel units.
-    // This would imply there is a "per string" buffer attribute which is the whole string transformation.
-    // By using different cache, it would notably mean one can animate strings without respecifying all glyphs each frame
-    // (but only the local-to-world transforms).
-    // Note: It might still be required in order to compute string bounding box in world space? (or it would just take the transformation)
+    // Scales the pixel layout to world units: applied on the CPU for the immediate strings and their bounds,
+    // by the vertex shader for the retained runs (whose per-run transformation places them in the world).
     math::Size<2, GLfloat> mPixelToWorld;
     // An alternative, with a single texture that has to be entirely pre-computed at instantiation.
     //detail::StaticGlyphCache mGlyphCache;
@@ -135,6 +248,27 @@ inline Texting::Instance::Instance(math::Position<2, GLfloat> aPenOrigin_w,
 template <class T_mapping>
 void Texting::updateInstances(T_mapping aTextureMappedBuffers)
 {
+    mGlyphCache.nextFrame();
+
+    if (mHasBaseInstance)
+    {
+        // All instances are written to a single buffer, each texture drawing a sub-range of it.
+        mPerTextureRanges.clear();
+        mInstances.clear();
+        for (const auto & [texture, buffer] : aTextureMappedBuffers)
+        {
+            mPerTextureRanges.push_back(PerTextureRange{
+                .texture = texture,
+                .firstInstance = (GLuint)mInstances.size(),
+                .instanceCount = (GLsizei)buffer.size(),
+            });
+            mInstances.insert(mInstances.end(), std::begin(buffer), std::end(buffer));
+        }
+        respecifyBuffer(mInstanceBuffer, std::span{mInstances}, BufferHint::StreamDraw);
+        return;
+    }
+
+    // Without "ARB_base_instance" (e.g. on macos), a whole VAO is switched between draw calls.
     mPerTexture.clear();
 
     for (const auto & [texture, buffer] : aTextureMappedBuffers)
@@ -148,37 +282,6 @@ void Texting::updateInstances(T_mapping aTextureMappedBuffers)
 
         mPerTexture.push_back(std::move(perTexture));
     }
-
-    // Note: Life would be simple if we had "ARB_base_instance" on all platforms (i.e. if it was available on macos)
-    // We would create a single instancebuffer with all instances, and do sub-range of instances
-    // per draw call with `glDrawElementsInstancedBaseInstance`.
-    // Instead, we are stuck with huge machinery to switch entire VAOs between draw calls.
-    //mPerTexture.clear();
-    //std::size_t count = 0;
-    //for (const auto & [texture, buffer] : aTextureMappedBuffers)
-    //{
-    //    count += buffer.size();
-    //}
-
-    //glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
-    //// Orphan the previous buffer
-    //glBufferData(GL_ARRAY_BUFFER, count * sizeof(Instance), NULL, GL_STATIC_DRAW);
-
-    //GLsizei firstInstance = 0;
-    //for (const auto & [texture, buffer] : aTextureMappedBuffers)
-    //{
-    //    mPerTexture.push_back(PerTextureInfo{
-    //        texture,
-    //        firstInstance,
-    //        (GLsizei)buffer.size(),
-    //    });
-
-    //    glBufferSubData(GL_ARRAY_BUFFER,
-    //                    firstInstance * sizeof(Instance),
-    //                    buffer.size() * sizeof(Instance),
-    //                    std::span(buffer).data());
-    //    firstInstance += buffer.size();
-    //}
 }
 
 
@@ -189,10 +292,20 @@ void Texting::prepareString(const std::string & aString,
                             math::sdr::Rgba aColor,
                             T_mapping & aOutputMap)
 {
-    forEachGlyph(aString, aPenOrigin_w, mGlyphCache, mFontFace, mPixelToWorld,
-        [&aOutputMap, aColor](const detail::RenderedGlyph & rendered, math::Position<2, GLfloat> penPosition_w)
+    // Consecutive glyphs are usually on the same page, the output buffer is only looked up when it changes.
+    typename T_mapping::mapped_type * buffer = nullptr;
+    std::uint32_t bufferPage = 0;
+    detail::layoutString(aString, aPenOrigin_w, mPixelToWorld.as<math::Vec>(),
+        [this](arte::CharCode aCodePoint){ return mGlyphCache.at(aCodePoint, mFontFace); },
+        mGlyphCache.kerning, mFontFace,
+        [&, this](const detail::RenderedGlyph & rendered, math::Position<2, GLfloat> penPosition_w)
         {
-            aOutputMap[rendered.texture].push_back(Texting::Instance{penPosition_w, rendered, aColor});
+            if (buffer == nullptr || rendered.page != bufferPage)
+            {
+                buffer = &aOutputMap[mGlyphCache.getTexture(rendered.page)];
+                bufferPage = rendered.page;
+            }
+            buffer->push_back(Texting::Instance{penPosition_w, rendered, aColor});
         });
 }
 
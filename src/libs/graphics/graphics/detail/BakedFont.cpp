@@ -0,0 +1,368 @@
+#include "BakedFont.h"
+
+#include "ShelfPacker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+namespace {
+
+    baked::Glyph toBaked(arte::CharCode aCharCode, const RenderedGlyph & aGlyph)
+    {
+        return baked::Glyph{
+            .charCode = aCharCode,
+            .offsetInTexture = {aGlyph.offsetInTexture.x(), aGlyph.offsetInTexture.y()},
+            .controlBoxSize = {aGlyph.controlBoxSize.width(), aGlyph.controlBoxSize.height()},
+            .bearing = {aGlyph.bearing.x(), aGlyph.bearing.y()},
+            .penAdvance = {aGlyph.penAdvance.x(), aGlyph.penAdvance.y()},
+            .freetypeIndex = aGlyph.freetypeIndex,
+            .page = aGlyph.page,
+            .reserved = 0,
+        };
+    }
+
+
+    std::uint64_t alignOffset(std::uint64_t aOffset)
+    {
+        return (aOffset + 7) & ~std::uint64_t{7};
+    }
+
+
+    /// @brief Accumulates the file content, keeping each array aligned.
+    class FileBuffer
+    {
+    public:
+        /// @return The offset of the appended array.
+        template <class T_element>
+        std::uint64_t append(std::span<const T_element> aArray)
+        {
+            const std::uint64_t offset = mBytes.size();
+            const auto bytes = std::as_bytes(aArray);
+            mBytes.insert(mBytes.end(), bytes.begin(), bytes.end());
+            mBytes.resize(alignOffset(mBytes.size()));
+            return offset;
+        }
+
+        template <class T_element>
+        void overwrite(std::uint64_t aOffset, const T_element & aValue)
+        {
+            std::memcpy(mBytes.data() + aOffset, &aValue, sizeof(T_element));
+        }
+
+        std::span<const std::byte> getBytes() const
+        { return mBytes; }
+
+    private:
+        std::vector<std::byte> mBytes;
+    };
+
+
+    /// @brief View `aCount` elements at `aOffset` in the mapped file.
+    /// @throw std::runtime_error if the array is not entirely in the file.
+    template <class T_element>
+    std::span<const T_element> getArray(std::span<const std::byte> aFile, std::uint64_t aOffset, std::uint64_t aCount)
+    {
+        // The mapping itself is aligned on a memory page.
+        if (aOffset % alignof(T_element) != 0
+            || aOffset > aFile.size()
+            || aCount > (aFile.size() - aOffset) / sizeof(T_element))
+        {
+            throw std::runtime_error{"Baked font array is out of the file bounds."};
+        }
+        return {reinterpret_cast<const T_element *>(aFile.data() + aOffset), aCount};
+    }
+
+} // anonymous namespace
+
+
+BakedFontSizeView BakedFontSize::view() const
+{
+    BakedFontSizeView result{
+        .pixelHeight = pixelHeight,
+        .rasterization = rasterization,
+        .atlasDimension = atlasDimension,
+        .margins = margins,
+        .ascender = ascender,
+        .descender = descender,
+        .lineHeight = lineHeight,
+        .placeholder = placeholder,
+        .pages = {},
+        .glyphs = glyphs,
+        .ranges = ranges,
+        .eagerGlyphs = eagerGlyphs,
+        .kerningPairs = kerningPairs,
+    };
+    for (const Page & page : pages)
+    {
+        result.pages.push_back({page.usedHeight, page.pixels});
+    }
+    return result;
+}
+
+
+BakedFontSize bakeFontSize(const arte::FontFace & aFontFace,
+                           std::span<const baked::Range> aRanges,
+                           GlyphRasterization aRasterization,
+                           math::Size<2, GLint> aAtlasDimension,
+                           math::Vec<2, GLint> aMargins,
+                           arte::CharCode aPlaceholder)
+{
+    const FT_Size_Metrics & metrics = aFontFace.get()->size->metrics;
+    BakedFontSize result{
+        .pixelHeight = static_cast<std::uint32_t>(aFontFace.getPixelSize().height()),
+        .rasterization = aRasterization,
+        .atlasDimension = aAtlasDimension,
+        .margins = aMargins,
+        .ascender = metrics.ascender / 64.f,
+        .descender = metrics.descender / 64.f,
+        .lineHeight = metrics.height / 64.f,
+        .placeholder = aPlaceholder,
+        .pages = {},
+        .glyphs = {},
+        .ranges = {aRanges.begin(), aRanges.end()},
+        .eagerGlyphs = {},
+        .kerningPairs = {},
+    };
+
+    const std::size_t bytesPerPixel = (aRasterization == GlyphRasterization::Msdf) ? 3 : 1;
+    const std::size_t rowSize = bytesPerPixel * aAtlasDimension.width();
+
+    std::optional<ShelfPacker> packer; // of the last page
+    std::unordered_set<arte::CharCode> baked;
+    std::vector<FT_UInt> glyphIndices;
+
+    auto bake = [&](arte::CharCode aCharCode)
+    {
+        if (!aFontFace.hasGlyph(aCharCode) || !baked.insert(aCharCode).second)
+        {
+            return;
+        }
+        const RasterizedGlyph rasterized = rasterizeGlyph(aFontFace, aCharCode, aRasterization);
+
+        // Same placement as `TextureAtlas::write()`, the margins being reserved on both sides.
+        const math::Size<2, GLint> reserved{
+            rasterized.resolution.width() + 2 * aMargins.x(),
+            rasterized.resolution.height() + 2 * aMargins.y()};
+        std::optional<math::Position<2, GLint>> position = packer ? packer->insert(reserved) : std::nullopt;
+        if (!position)
+        {
+            packer.emplace(aAtlasDimension);
+            result.pages.push_back({0, {}});
+            position = packer->insert(reserved);
+            if (!position)
+            {
+                throw std::invalid_argument{"Glyph does not fit in an empty atlas."};
+            }
+        }
+
+        // The rows opened by the packer are empty until glyphs are copied to them.
+        BakedFontSize::Page & page = result.pages.back();
+        page.usedHeight = packer->getUsedHeight();
+        page.pixels.resize(rowSize * page.usedHeight);
+
+        const math::Position<2, GLint> start = *position + aMargins;
+        const std::size_t glyphRowSize = bytesPerPixel * rasterized.resolution.width();
+        for (GLint row = 0; row != rasterized.resolution.height(); ++row)
+        {
+            std::copy_n(rasterized.bitmap.begin() + row * glyphRowSize,
+                        glyphRowSize,
+                        page.pixels.begin() + (start.y() + row) * rowSize + bytesPerPixel * start.x());
+        }
+
+        const RenderedGlyph rendered = makeRenderedGlyph(
+            rasterized,
+            position->as<math::Vec>(),
+            aMargins,
+            aRasterization,
+            static_cast<std::uint32_t>(result.pages.size() - 1));
+        result.glyphs.push_back(toBaked(aCharCode, rendered));
+        glyphIndices.push_back(rendered.freetypeIndex);
+    };
+
+    for (const baked::Range & range : aRanges)
+    {
+        for (arte::CharCode charCode = range.first; charCode < range.last; ++charCode)
+        {
+            bake(charCode);
+        }
+    }
+    bake(aPlaceholder);
+
+    arte::KerningTable kerning{aFontFace};
+    kerning.addGlyphs(aFontFace, glyphIndices);
+
+    // Sorted, so baking the same font always produces the same file.
+    result.eagerGlyphs = kerning.getEagerGlyphs();
+    std::sort(result.eagerGlyphs.begin(), result.eagerGlyphs.end());
+    for (const arte::KerningTable::Pair & pair : kerning.getPairs())
+    {
+        result.kerningPairs.push_back({pair.left, pair.right, {pair.offset.x(), pair.offset.y()}});
+    }
+    std::sort(result.kerningPairs.begin(), result.kerningPairs.end(),
+              [](const baked::KerningPair & aLhs, const baked::KerningPair & aRhs)
+              {
+                  return std::tie(aLhs.left, aLhs.right) < std::tie(aRhs.left, aRhs.right);
+              });
+
+    return result;
+}
+
+
+void writeBakedFont(const filesystem::path & aPath, std::span<const BakedFontSizeView> aSizes)
+{
+    FileBuffer buffer;
+
+    baked::Header header{};
+    std::copy(std::begin(baked::gMagic), std::end(baked::gMagic), header.magic);
+    header.version = baked::gVersion;
+    header.sizeCount = static_cast<std::uint32_t>(aSizes.size());
+    buffer.append(std::span<const baked::Header>{&header, 1});
+
+    // The entries are patched with the offsets once the arrays are appended.
+    std::vector<baked::SizeEntry> entries(aSizes.size());
+    const std::uint64_t entriesOffset = buffer.append(std::span<const baked::SizeEntry>{entries});
+
+    for (std::size_t sizeIndex = 0; sizeIndex != aSizes.size(); ++sizeIndex)
+    {
+        const BakedFontSizeView & size = aSizes[sizeIndex];
+
+        std::vector<baked::Page> pages;
+        for (const BakedPageView & page : size.pages)
+        {
+            pages.push_back({page.usedHeight, 0, buffer.append(page.pixels)});
+        }
+
+        entries[sizeIndex] = baked::SizeEntry{
+            .pixelHeight = size.pixelHeight,
+            .rasterization = static_cast<std::uint32_t>(size.rasterization),
+            .atlasDimension = {size.atlasDimension.width(), size.atlasDimension.height()},
+            .margins = {size.margins.x(), size.margins.y()},
+            .ascender = size.ascender,
+            .descender = size.descender,
+            .lineHeight = size.lineHeight,
+            .placeholder = size.placeholder,
+            .pageCount = static_cast<std::uint32_t>(pages.size()),
+            .glyphCount = static_cast<std::uint32_t>(size.glyphs.size()),
+            .rangeCount = static_cast<std::uint32_t>(size.ranges.size()),
+            .eagerGlyphCount = static_cast<std::uint32_t>(size.eagerGlyphs.size()),
+            .kerningPairCount = static_cast<std::uint32_t>(size.kerningPairs.size()),
+            .reserved = 0,
+            .pagesOffset = buffer.append(std::span<const baked::Page>{pages}),
+            .glyphsOffset = buffer.append(size.glyphs),
+            .rangesOffset = buffer.append(size.ranges),
+            .eagerGlyphsOffset = buffer.append(size.eagerGlyphs),
+            .kerningPairsOffset = buffer.append(size.kerningPairs),
+        };
+        buffer.overwrite(entriesOffset + sizeIndex * sizeof(baked::SizeEntry), entries[sizeIndex]);
+    }
+
+    std::ofstream file{aPath, std::ios::binary};
+    const std::span<const std::byte> bytes = buffer.getBytes();
+    file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    if (!file)
+    {
+        throw std::runtime_error{"Cannot write baked font file: " + aPath.string()};
+    }
+}
+
+
+BakedFont::BakedFont(const filesystem::path & aPath) :
+    mFile{aPath}
+{
+    const std::span<const std::byte> data = mFile.data();
+
+    const baked::Header & header = getArray<baked::Header>(data, 0, 1).front();
+    if (!std::equal(std::begin(baked::gMagic), std::end(baked::gMagic), header.magic))
+    {
+        throw std::runtime_error{"Not a baked font file: " + aPath.string()};
+    }
+    // Note: a file baked with another byte order is rejected here as well.
+    if (header.version != baked::gVersion)
+    {
+        throw std::runtime_error{"Unsupported baked font version " + std::to_string(header.version)
+                                 + " in: " + aPath.string()};
+    }
+
+    for (const baked::SizeEntry & entry
+         : getArray<baked::SizeEntry>(data, sizeof(baked::Header), header.sizeCount))
+    {
+        if (entry.rasterization > static_cast<std::uint32_t>(GlyphRasterization::Msdf))
+        {
+            throw std::runtime_error{"Unknown glyph rasterization in: " + aPath.string()};
+        }
+
+        BakedFontSizeView & size = mSizes.emplace_back(BakedFontSizeView{
+            .pixelHeight = entry.pixelHeight,
+            .rasterization = static_cast<GlyphRasterization>(entry.rasterization),
+            .atlasDimension = {entry.atlasDimension[0], entry.atlasDimension[1]},
+            .margins = {entry.margins[0], entry.margins[1]},
+            .ascender = entry.ascender,
+            .descender = entry.descender,
+            .lineHeight = entry.lineHeight,
+            .placeholder = entry.placeholder,
+            .pages = {},
+            .glyphs = getArray<baked::Glyph>(data, entry.glyphsOffset, entry.glyphCount),
+            .ranges = getArray<baked::Range>(data, entry.rangesOffset, entry.rangeCount),
+            .eagerGlyphs = getArray<FT_UInt>(data, entry.eagerGlyphsOffset, entry.eagerGlyphCount),
+            .kerningPairs = getArray<baked::KerningPair>(data, entry.kerningPairsOffset, entry.kerningPairCount),
+        });
+
+        // Each range is allocated as a dense table when the font is loaded.
+        for (const baked::Range & range : size.ranges)
+        {
+            if (range.first >= range.last || range.last > baked::gCodePointEnd)
+            {
+                throw std::runtime_error{"Invalid baked code point range in: " + aPath.string()};
+            }
+        }
+
+        const std::uint64_t rowSize = size.getBytesPerPixel() * std::max(0, size.atlasDimension.width());
+        for (const baked::Page & page : getArray<baked::Page>(data, entry.pagesOffset, entry.pageCount))
+        {
+            if (page.usedHeight < 0 || page.usedHeight > size.atlasDimension.height())
+            {
+                throw std::runtime_error{"Baked font page is taller than its atlas in: " + aPath.string()};
+            }
+            size.pages.push_back({
+                page.usedHeight,
+                getArray<std::byte>(data, page.pixelsOffset, rowSize * page.usedHeight),
+            });
+        }
+
+        for (const baked::Glyph & glyph : size.glyphs)
+        {
+            if (glyph.page >= size.pages.size())
+            {
+                throw std::runtime_error{"Baked glyph on a missing page in: " + aPath.string()};
+            }
+        }
+    }
+}
+
+
+const BakedFontSizeView * BakedFont::find(std::uint32_t aPixelHeight, GlyphRasterization aRasterization) const
+{
+    auto found = std::find_if(mSizes.begin(), mSizes.end(),
+                              [&](const BakedFontSizeView & aSize)
+                              {
+                                  return aSize.pixelHeight == aPixelHeight && aSize.rasterization == aRasterization;
+                              });
+    return found != mSizes.end() ? &*found : nullptr;
+}
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
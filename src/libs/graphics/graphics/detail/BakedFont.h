@@ -0,0 +1,220 @@
+#pragma once
+
+
+#include "GlyphUtilities_deprecated.h"
+
+#include <arte/MappedFile.h>
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+/// @brief The on-disk layout of baked fonts, see `writeBakedFont()`.
+///
+/// The file is a header followed by one entry per baked size, then the arrays referenced by offsets
+/// (from the start of the file). Arrays are aligned on 8 bytes, so they can be used in place
+/// from a memory mapping. Values are in the byte order of the machine which baked the file.
+namespace baked {
+
+    constexpr char gMagic[4] = {'A', 'D', 'F', 'B'};
+    constexpr std::uint32_t gVersion = 1;
+
+    struct Header
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t sizeCount;
+        std::uint32_t reserved;
+    };
+
+    struct SizeEntry
+    {
+        std::uint32_t pixelHeight;
+        std::uint32_t rasterization; // GlyphRasterization
+        std::int32_t atlasDimension[2];
+        std::int32_t margins[2];
+        float ascender;
+        float descender; // Usually negative.
+        float lineHeight;
+        std::uint32_t placeholder;
+        std::uint32_t pageCount;
+        std::uint32_t glyphCount;
+        std::uint32_t rangeCount;
+        std::uint32_t eagerGlyphCount;
+        std::uint32_t kerningPairCount;
+        std::uint32_t reserved;
+        std::uint64_t pagesOffset;
+        std::uint64_t glyphsOffset;
+        std::uint64_t rangesOffset;
+        std::uint64_t eagerGlyphsOffset;
+        std::uint64_t kerningPairsOffset;
+    };
+
+    /// Only the rows [0, usedHeight[ of an atlas page are stored, the rest being empty.
+    struct Page
+    {
+        std::int32_t usedHeight;
+        std::uint32_t reserved;
+        std::uint64_t pixelsOffset;
+    };
+
+    /// The fields of a `RenderedGlyph`, with its code point.
+    struct Glyph
+    {
+        std::uint32_t charCode;
+        std::int32_t offsetInTexture[2];
+        float controlBoxSize[2];
+        float bearing[2];
+        float penAdvance[2];
+        std::uint32_t freetypeIndex;
+        std::uint32_t page;
+        std::uint32_t reserved;
+    };
+
+    /// One past the last Unicode code point, no range extends beyond it.
+    constexpr std::uint32_t gCodePointEnd = 0x110000;
+
+    /// A range of code points [first, last[ looked up by direct indexing.
+    struct Range
+    {
+        std::uint32_t first;
+        std::uint32_t last;
+    };
+
+    struct KerningPair
+    {
+        std::uint32_t left;
+        std::uint32_t right;
+        float offset[2];
+    };
+
+    static_assert(std::is_trivially_copyable_v<SizeEntry> && sizeof(SizeEntry) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<Page> && sizeof(Page) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<Glyph> && sizeof(Glyph) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<KerningPair> && sizeof(KerningPair) % 8 == 0);
+
+} // namespace baked
+
+
+/// @brief An atlas page of a baked font size.
+struct BakedPageView
+{
+    GLint usedHeight;
+    std::span<const std::byte> pixels; // `usedHeight` full-width rows, from the bottom of the atlas.
+};
+
+
+/// @brief The glyphs of a font at one pixel height, rendered ahead of time.
+///
+/// This is all the glyph cache needs to render the baked glyphs, without a font face.
+struct BakedFontSizeView
+{
+    std::uint32_t pixelHeight;
+    GlyphRasterization rasterization;
+    math::Size<2, GLint> atlasDimension;
+    math::Vec<2, GLint> margins;
+    GLfloat ascender;
+    GLfloat descender;
+    GLfloat lineHeight;
+    arte::CharCode placeholder;
+    std::vector<BakedPageView> pages;
+    std::span<const baked::Glyph> glyphs;
+    std::span<const baked::Range> ranges;
+    std::span<const FT_UInt> eagerGlyphs;
+    std::span<const baked::KerningPair> kerningPairs;
+
+    /// @brief The number of bytes per texel in the pages.
+    std::size_t getBytesPerPixel() const
+    { return rasterization == GlyphRasterization::Msdf ? 3 : 1; }
+};
+
+
+/// @brief Owns the data of a font size baked in memory, see `bakeFontSize()`.
+struct BakedFontSize
+{
+    struct Page
+    {
+        GLint usedHeight;
+        std::vector<std::byte> pixels;
+    };
+
+    BakedFontSizeView view() const;
+
+    std::uint32_t pixelHeight;
+    GlyphRasterization rasterization;
+    math::Size<2, GLint> atlasDimension;
+    math::Vec<2, GLint> margins;
+    GLfloat ascender;
+    GLfloat descender;
+    GLfloat lineHeight;
+    arte::CharCode placeholder;
+    std::vector<Page> pages;
+    std::vector<baked::Glyph> glyphs;
+    std::vector<baked::Range> ranges;
+    std::vector<FT_UInt> eagerGlyphs;
+    std::vector<baked::KerningPair> kerningPairs;
+};
+
+
+/// @brief Render the glyphs of `aRanges` to atlas pages in memory, and compute the kerning between them.
+///
+/// The face must be configured (pixel size, transform) as the face the glyphs will be rendered with.
+/// The placeholder glyph is always baked. Code points without glyph are skipped.
+/// @note Does not access the graphics API, it can run in offline tools.
+BakedFontSize bakeFontSize(const arte::FontFace & aFontFace,
+                           std::span<const baked::Range> aRanges,
+                           GlyphRasterization aRasterization,
+                           math::Size<2, GLint> aAtlasDimension,
+                           math::Vec<2, GLint> aMargins = TextureRibon::gRecommendedMargins,
+                           arte::CharCode aPlaceholder = 0x3F);
+
+
+/// @brief Write the baked sizes to a file that can be loaded with `BakedFont`.
+/// @throw std::runtime_error if the file cannot be written.
+void writeBakedFont(const filesystem::path & aPath, std::span<const BakedFontSizeView> aSizes);
+
+
+/// @brief A baked font file, memory mapped.
+///
+/// The views returned by `find()` point into the mapping, so they are valid as long as this object.
+class BakedFont
+{
+public:
+    /// @throw std::runtime_error if the file cannot be mapped or is not a valid baked font.
+    explicit BakedFont(const filesystem::path & aPath);
+
+    /// @return The baked size with `aPixelHeight` and `aRasterization`, or nullptr if it is not in the file.
+    const BakedFontSizeView * find(std::uint32_t aPixelHeight, GlyphRasterization aRasterization) const;
+
+    std::span<const BakedFontSizeView> getSizes() const
+    { return mSizes; }
+
+private:
+    arte::MappedFile mFile;
+    std::vector<BakedFontSizeView> mSizes;
+};
+
+
+inline RenderedGlyph fromBaked(const baked::Glyph & aGlyph, std::uint32_t aFirstPage = 0)
+{
+    return RenderedGlyph{
+        {aGlyph.offsetInTexture[0], aGlyph.offsetInTexture[1]},
+        {aGlyph.controlBoxSize[0], aGlyph.controlBoxSize[1]},
+        {aGlyph.bearing[0], aGlyph.bearing[1]},
+        {aGlyph.penAdvance[0], aGlyph.penAdvance[1]},
+        aGlyph.freetypeIndex,
+        aFirstPage + aGlyph.page,
+    };
+}
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
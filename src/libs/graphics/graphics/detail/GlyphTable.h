@@ -0,0 +1,322 @@
+#pragma once
+
+
+#include <arte/Freetype.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+/// @brief Maps code points to glyphs, with direct indexing for the hot code point ranges.
+///
+/// ASCII and Latin-1 (below `gDenseCount`), as well as the ranges added with `addDenseRange()`,
+/// are looked up by indexing into a dense array of slots, the glyphs being stored contiguously.
+/// Other code points are found in an open-addressing hash table (linear probing), which stores the glyphs inline.
+///
+/// @note Pointers returned by `find()` and `insert()` are invalidated by any modification of the table.
+template <class T_glyph>
+class GlyphTable
+{
+public:
+    /// @brief The code points [0, gDenseCount[ are always directly indexed.
+    static constexpr arte::CharCode gDenseCount = 0x100;
+
+    GlyphTable()
+    { addDenseRange(0, gDenseCount); }
+
+    /// @brief Directly index the code points in [aFirst, aLast[.
+    ///
+    /// The range is merged with the dense ranges it overlaps or touches.
+    /// Glyphs already in the table for those code points are moved out of the hash table.
+    void addDenseRange(arte::CharCode aFirst, arte::CharCode aLast);
+
+    /// @return The glyph for `aCharCode`, or nullptr if it is not in the table.
+    const T_glyph * find(arte::CharCode aCharCode) const
+    {
+        if (const std::uint32_t * dense = findDense(aCharCode))
+        {
+            return *dense == gEmpty ? nullptr : &mDenseGlyphs[*dense];
+        }
+        const HashEntry * entry = findHashed(aCharCode);
+        return (entry == nullptr || entry->key == gEmptyKey) ? nullptr : &entry->glyph;
+    }
+
+    /// @brief Insert `aGlyph` for `aCharCode`, which must not be in the table yet.
+    /// @return The inserted glyph.
+    const T_glyph & insert(arte::CharCode aCharCode, const T_glyph & aGlyph);
+
+    /// @brief Remove the glyphs satisfying `aPredicate`.
+    /// @return The number of removed glyphs.
+    /// @note Rebuilds the table, it is intended for infrequent bulk removals.
+    template <class T_predicate>
+    std::size_t eraseIf(T_predicate aPredicate);
+
+    std::size_t size() const
+    { return mDenseGlyphs.size() + mHashCount; }
+
+    /// @brief Call `aFunction` with each glyph, in unspecified order.
+    template <class T_function>
+    void forEach(T_function && aFunction) const;
+
+private:
+    static constexpr std::uint32_t gEmpty = std::numeric_limits<std::uint32_t>::max();
+    // Not a valid Unicode code point.
+    static constexpr arte::CharCode gEmptyKey = std::numeric_limits<arte::CharCode>::max();
+
+    struct DenseRange
+    {
+        arte::CharCode end() const
+        { return first + static_cast<arte::CharCode>(slots.size()); }
+
+        arte::CharCode first;
+        std::vector<std::uint32_t> slots; // index in mDenseGlyphs, or gEmpty
+    };
+
+    struct HashEntry
+    {
+        arte::CharCode key{gEmptyKey};
+        T_glyph glyph{};
+    };
+
+    /// @return The dense slot of `aCharCode`, or nullptr if it is not in a dense range.
+    const std::uint32_t * findDense(arte::CharCode aCharCode) const
+    {
+        // The first range always starts at 0, so Latin-1 is a single bounds check.
+        const DenseRange & front = mDenseRanges.front();
+        if (aCharCode < front.slots.size())
+        {
+            return &front.slots[aCharCode];
+        }
+        // The ranges are sorted and disjoint: only the last range starting at or before aCharCode can contain it.
+        auto range = std::upper_bound(mDenseRanges.begin() + 1, mDenseRanges.end(), aCharCode,
+                                      [](arte::CharCode aValue, const DenseRange & aRange)
+                                      { return aValue < aRange.first; });
+        if (range == mDenseRanges.begin() + 1)
+        {
+            return nullptr;
+        }
+        --range;
+        // Unsigned arithmetic: the range starts at or before aCharCode.
+        const arte::CharCode offset = aCharCode - range->first;
+        return offset < range->slots.size() ? &range->slots[offset] : nullptr;
+    }
+
+    std::size_t hashPosition(arte::CharCode aCharCode) const
+    {
+        // Fibonacci hashing: the high bits of the product are well distributed.
+        return static_cast<std::size_t>((aCharCode * 0x9E3779B9u) >> mHashShift);
+    }
+
+    /// @return The entry for `aCharCode`, or the empty entry where it would be inserted.
+    /// Null while the hash table is empty.
+    const HashEntry * findHashed(arte::CharCode aCharCode) const
+    {
+        if (mHash.empty())
+        {
+            return nullptr;
+        }
+        for (std::size_t position = hashPosition(aCharCode); ; position = (position + 1) & (mHash.size() - 1))
+        {
+            const HashEntry & entry = mHash[position];
+            if (entry.key == aCharCode || entry.key == gEmptyKey)
+            {
+                return &entry;
+            }
+        }
+    }
+
+    HashEntry & insertHashed(arte::CharCode aCharCode, T_glyph aGlyph)
+    {
+        std::size_t position = hashPosition(aCharCode);
+        while (mHash[position].key != gEmptyKey)
+        {
+            position = (position + 1) & (mHash.size() - 1);
+        }
+        return mHash[position] = HashEntry{aCharCode, std::move(aGlyph)};
+    }
+
+    /// @brief Reinsert the entries of `aPrevious` satisfying `aKeep` in a hash table of `aCapacity` entries.
+    template <class T_keep>
+    void rehash(std::vector<HashEntry> aPrevious, std::size_t aCapacity, T_keep aKeep);
+
+    /// @brief Keep the load factor of the hash table at most 1/2.
+    void growHash();
+
+    std::vector<T_glyph> mDenseGlyphs;
+    std::vector<DenseRange> mDenseRanges; // Sorted and disjoint, the first one starting at 0.
+    std::vector<HashEntry> mHash; // power of two size
+    std::size_t mHashCount{0};
+    int mHashShift{32};
+};
+
+
+//
+// Implementations
+//
+template <class T_glyph>
+void GlyphTable<T_glyph>::addDenseRange(arte::CharCode aFirst, arte::CharCode aLast)
+{
+    if (aFirst >= aLast)
+    {
+        return;
+    }
+
+    // The ranges overlapping or touching [aFirst, aLast[ are contiguous in the sorted ranges.
+    auto mergedBegin = std::find_if(mDenseRanges.begin(), mDenseRanges.end(),
+                                    [aFirst](const DenseRange & aRange){ return aRange.end() >= aFirst; });
+    auto mergedEnd = std::find_if(mergedBegin, mDenseRanges.end(),
+                                  [aLast](const DenseRange & aRange){ return aRange.first > aLast; });
+    if (mergedBegin != mergedEnd)
+    {
+        aFirst = std::min(aFirst, mergedBegin->first);
+        aLast = std::max(aLast, std::prev(mergedEnd)->end());
+    }
+
+    DenseRange added{aFirst, std::vector<std::uint32_t>(aLast - aFirst, gEmpty)};
+    for (auto range = mergedBegin; range != mergedEnd; ++range)
+    {
+        std::copy(range->slots.begin(), range->slots.end(), added.slots.begin() + (range->first - aFirst));
+    }
+    auto position = mDenseRanges.erase(mergedBegin, mergedEnd);
+    DenseRange & inserted = *mDenseRanges.insert(position, std::move(added));
+
+    // Move the hashed glyphs whose code points are now dense.
+    const std::size_t hashCount = mHashCount;
+    for (HashEntry & entry : mHash)
+    {
+        if (entry.key != gEmptyKey && entry.key >= aFirst && entry.key < aLast)
+        {
+            inserted.slots[entry.key - aFirst] = static_cast<std::uint32_t>(mDenseGlyphs.size());
+            mDenseGlyphs.push_back(std::move(entry.glyph));
+            --mHashCount;
+        }
+    }
+    if (mHashCount != hashCount)
+    {
+        const std::size_t capacity = mHash.size();
+        rehash(std::move(mHash), capacity,
+               [aFirst, aLast](const HashEntry & aEntry){ return aEntry.key < aFirst || aEntry.key >= aLast; });
+    }
+}
+
+
+template <class T_glyph>
+const T_glyph & GlyphTable<T_glyph>::insert(arte::CharCode aCharCode, const T_glyph & aGlyph)
+{
+    // The const is only casted away to share the lookup with find().
+    if (auto * dense = const_cast<std::uint32_t *>(findDense(aCharCode)))
+    {
+        *dense = static_cast<std::uint32_t>(mDenseGlyphs.size());
+        return mDenseGlyphs.emplace_back(aGlyph);
+    }
+    else
+    {
+        growHash();
+        ++mHashCount;
+        return insertHashed(aCharCode, aGlyph).glyph;
+    }
+}
+
+
+template <class T_glyph>
+template <class T_predicate>
+std::size_t GlyphTable<T_glyph>::eraseIf(T_predicate aPredicate)
+{
+    // Compact the dense glyphs, remembering where each kept glyph moved.
+    std::vector<std::uint32_t> remap(mDenseGlyphs.size(), gEmpty);
+    std::vector<T_glyph> kept;
+    for (std::size_t slot = 0; slot != mDenseGlyphs.size(); ++slot)
+    {
+        if (!aPredicate(std::as_const(mDenseGlyphs[slot])))
+        {
+            remap[slot] = static_cast<std::uint32_t>(kept.size());
+            kept.push_back(std::move(mDenseGlyphs[slot]));
+        }
+    }
+    std::size_t erased = mDenseGlyphs.size() - kept.size();
+    if (erased != 0)
+    {
+        mDenseGlyphs = std::move(kept);
+        for (DenseRange & range : mDenseRanges)
+        {
+            for (std::uint32_t & slot : range.slots)
+            {
+                slot = (slot == gEmpty) ? gEmpty : remap[slot];
+            }
+        }
+    }
+
+    if (!mHash.empty())
+    {
+        const std::size_t hashCount = mHashCount;
+        const std::size_t capacity = mHash.size();
+        // Reinserting the remaining entries also removes the erased ones from the probe sequences.
+        rehash(std::move(mHash), capacity,
+               [&aPredicate](const HashEntry & aEntry){ return !aPredicate(aEntry.glyph); });
+        erased += hashCount - mHashCount;
+    }
+    return erased;
+}
+
+
+template <class T_glyph>
+template <class T_function>
+void GlyphTable<T_glyph>::forEach(T_function && aFunction) const
+{
+    for (const T_glyph & glyph : mDenseGlyphs)
+    {
+        aFunction(glyph);
+    }
+    for (const HashEntry & entry : mHash)
+    {
+        if (entry.key != gEmptyKey)
+        {
+            aFunction(entry.glyph);
+        }
+    }
+}
+
+
+template <class T_glyph>
+template <class T_keep>
+void GlyphTable<T_glyph>::rehash(std::vector<HashEntry> aPrevious, std::size_t aCapacity, T_keep aKeep)
+{
+    mHash.assign(aCapacity, HashEntry{});
+    mHashShift = 32 - std::countr_zero(aCapacity);
+    mHashCount = 0;
+    for (HashEntry & entry : aPrevious)
+    {
+        if (entry.key != gEmptyKey && aKeep(std::as_const(entry)))
+        {
+            insertHashed(entry.key, std::move(entry.glyph));
+            ++mHashCount;
+        }
+    }
+}
+
+
+template <class T_glyph>
+void GlyphTable<T_glyph>::growHash()
+{
+    if (2 * (mHashCount + 1) > mHash.size())
+    {
+        const std::size_t capacity = std::max<std::size_t>(16, 2 * mHash.size());
+        rehash(std::move(mHash), capacity,
+               [](const HashEntry &){ return true; });
+    }
+}
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
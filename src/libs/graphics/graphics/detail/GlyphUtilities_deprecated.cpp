@@ -1,11 +1,16 @@
 #include "GlyphUtilities_deprecated.h"
 
+#include "BakedFont.h"
 #include "Logging.h"
+#include "TextLayout.h"
+
+#include <arte/detail/Parallel.h>
 
 #include <freetype/freetype.h>
 #include <freetype/ftimage.h>
 #include <renderer/SynchronousQueries.h>
-#include <utf8.h> // utfcpp lib
+
+#include <algorithm>
 
 namespace ad {
 namespace graphics {
@@ -14,54 +19,321 @@ namespace detail {
 StaticGlyphCache::StaticGlyphCache(const arte::FontFace & aFontFace,
                                    arte::CharCode aFirst,
                                    arte::CharCode aLast,
-                                   math::Vec<2, GLint> aMargins)
+                                   math::Vec<2, GLint> aMargins) :
+    kerning{aFontFace}
 {
     atlas = makeTightGlyphAtlas(aFontFace, aFirst, aLast, glyphMap, aMargins);
+
+    std::vector<FT_UInt> glyphIndices;
+    glyphMap.forEach([&glyphIndices](const RenderedGlyph & aRendered)
+    {
+        glyphIndices.push_back(aRendered.freetypeIndex);
+    });
+    kerning.addGlyphs(aFontFace, glyphIndices);
+
+    // The table is not modified after construction, so the pointer stays valid.
+    placeholderGlyph = glyphMap.find(placeholder);
 }
 
-RenderedGlyph StaticGlyphCache::at(arte::CharCode aCharCode) const
+const RenderedGlyph & StaticGlyphCache::at(arte::CharCode aCharCode) const
 {
-    if (auto found = glyphMap.find(aCharCode); found != glyphMap.end())
+    if (const RenderedGlyph * found = glyphMap.find(aCharCode))
+    {
+        return *found;
+    }
+    else if (placeholderGlyph != nullptr)
     {
-        return found->second;
+        return *placeholderGlyph;
     }
     else
     {
-        return glyphMap.at(placeholder);
+        throw std::out_of_range{"The placeholder glyph is not in the static cache."};
     }
 }
 
-DynamicGlyphCache::DynamicGlyphCache(math::Size<2, GLint> aRibonDimension_p,
+DynamicGlyphCache::DynamicGlyphCache(const arte::FontFace & aFontFace,
+                                     math::Size<2, GLint> aAtlasDimension_p,
                                      math::Vec<2, GLint> aMargins,
-                                     GLenum aTextureFiltering) :
+                                     GLenum aTextureFiltering,
+                                     GlyphRasterization aRasterization) :
     textureFiltering{aTextureFiltering},
-    ribonDimension{[&]() -> math::Size<2, GLint> {
-        if (aRibonDimension_p.height() > getMaxTextureSize())
-        {
-            throw std::invalid_argument{"Texture ribon too tall."};
-        }
-        else if (aRibonDimension_p.width() > getMaxTextureSize())
+    atlasDimension{[&]() -> math::Size<2, GLint> {
+        const GLint maxSize = getMaxTextureSize();
+        if (aAtlasDimension_p.width() > maxSize || aAtlasDimension_p.height() > maxSize)
         {
             ADLOG(gMainLogger, warn)
-            ("Requested ribon dimension ({}, {}) exceeds maximum texture "
-             "dimension {}. Clamping the width.",
-             aRibonDimension_p.width(), aRibonDimension_p.height(),
-             getMaxTextureSize());
-            return {getMaxTextureSize(), aRibonDimension_p.height()};
+            ("Requested atlas dimension ({}, {}) exceeds maximum texture "
+             "dimension {}. Clamping.",
+             aAtlasDimension_p.width(), aAtlasDimension_p.height(),
+             maxSize);
+            return {std::min(aAtlasDimension_p.width(), maxSize),
+                    std::min(aAtlasDimension_p.height(), maxSize)};
         }
-        return aRibonDimension_p;
+        return aAtlasDimension_p;
     }()},
-    margins{aMargins}
+    margins{aMargins},
+    kerning{aFontFace},
+    rasterization{aRasterization}
 {
     growAtlas();
 }
 
+RasterizedGlyph rasterizeGlyph(const arte::FontFace & aFontFace,
+                               arte::CharCode aCharCode,
+                               GlyphRasterization aRasterization)
+{
+    if (aRasterization == GlyphRasterization::Msdf)
+    {
+        arte::GlyphDistanceField field = arte::generateMsdf(aFontFace, aCharCode, gMsdfRange);
+        // The glyph slot still holds the glyph loaded by generateMsdf().
+        FT_GlyphSlot slot = aFontFace.get()->glyph;
+        // The quad covers the whole field, its top-left corner is offset by the bearing.
+        return RasterizedGlyph{
+            .bitmap = std::move(field.texels),
+            .format = GL_RGB,
+            .resolution = field.resolution,
+            .controlBoxSize = {static_cast<GLfloat>(field.resolution.width()),
+                               static_cast<GLfloat>(field.resolution.height())},
+            .bearing = {static_cast<GLfloat>(field.origin.x()),
+                        static_cast<GLfloat>(field.origin.y() + field.resolution.height())},
+            .penAdvance = {fixedToFloat(slot->metrics.horiAdvance),
+                           0.f /* hardcoded horizontal layout */},
+            .freetypeIndex = slot->glyph_index,
+        };
+    }
+
+    // Rendered once, as coverage (loading with FT_LOAD_RENDER would render the outline beforehand).
+    FT_GlyphSlot slot = aFontFace.loadChar(aCharCode, FT_LOAD_DEFAULT);
+    FT_Bitmap bitmap = aFontFace.renderGlyphSlot(FT_RENDER_MODE_NORMAL);
+
+    // The bitmap is owned by the glyph slot, it is overwritten by the next load.
+    return RasterizedGlyph{
+        .bitmap = copyRows(bitmap),
+        .format = GL_RED,
+        .resolution = {static_cast<GLint>(bitmap.width), static_cast<GLint>(bitmap.rows)},
+        // Note: We observe noticeable "edge trimming" when using the
+        // exact glyph bounding box. This is because a fragment is
+        // generated only if the primitive hits the center of the pixel.
+        // Adding margin on each dimension allows to make sure the top
+        // and right border pixels are not discarded, when rendering at
+        // matching resolution. Important: The margin is added to each
+        // side, so each glyph dimension is agumented by 2 horizontal
+        // and 2 vertical margins.
+        .controlBoxSize = {fixedToFloat(slot->metrics.width),
+                           fixedToFloat(slot->metrics.height)},
+        // The bearing goes **back** the left horizontal margin, and
+        // goes **up** the top vertical margin.
+        .bearing = {fixedToFloat(slot->metrics.horiBearingX),
+                    fixedToFloat(slot->metrics.horiBearingY)},
+        .penAdvance = {fixedToFloat(slot->metrics.horiAdvance),
+                       0.f /* hardcoded horizontal layout */},
+        .freetypeIndex = slot->glyph_index,
+    };
+}
+
+std::vector<std::optional<RasterizedGlyph>> rasterizeGlyphs(const arte::FontFace & aFontFace,
+                                                            const filesystem::path & aFontPath,
+                                                            std::span<const arte::CharCode> aCharCodes,
+                                                            GlyphRasterization aRasterization)
+{
+    std::vector<std::optional<RasterizedGlyph>> rasterized(aCharCodes.size());
+    const std::size_t blockCount = std::clamp<std::size_t>(aCharCodes.size() / DynamicGlyphCache::gMinParallelPreload,
+                                                           1, arte::detail::getWorkerCount());
+    const std::size_t blockSize = (aCharCodes.size() + blockCount - 1) / blockCount;
+    arte::detail::parallelFor(blockCount, [&](std::size_t aBlock)
+    {
+        // One library per thread as well, so faces are never created concurrently in a library.
+        arte::Freetype freetype;
+        arte::FontFace fontFace = freetype.load(aFontPath);
+        fontFace.matchSettings(aFontFace);
+
+        const std::size_t end = std::min(aCharCodes.size(), (aBlock + 1) * blockSize);
+        for (std::size_t index = aBlock * blockSize; index < end; ++index)
+        {
+            if (fontFace.hasGlyph(aCharCodes[index]))
+            {
+                rasterized[index] = rasterizeGlyph(fontFace, aCharCodes[index], aRasterization);
+            }
+        }
+    });
+    return rasterized;
+}
+
+std::vector<std::byte> copyRows(const FT_Bitmap & aBitmap)
+{
+    std::vector<std::byte> rows(std::size_t{aBitmap.width} * aBitmap.rows);
+    if (aBitmap.rows == 0)
+    {
+        return rows;
+    }
+
+    // The pitch is the offset from a row to the one below, whatever the flow.
+    const std::ptrdiff_t pitch = aBitmap.pitch;
+    const std::byte * top = reinterpret_cast<const std::byte *>(aBitmap.buffer)
+                          + (pitch < 0 ? -pitch * (static_cast<std::ptrdiff_t>(aBitmap.rows) - 1) : 0);
+    for (std::size_t row = 0; row != aBitmap.rows; ++row)
+    {
+        std::copy_n(top + static_cast<std::ptrdiff_t>(row) * pitch,
+                    aBitmap.width,
+                    rows.begin() + row * aBitmap.width);
+    }
+    return rows;
+}
+
+const RenderedGlyph & DynamicGlyphCache::insert(arte::CharCode aCharCode,
+                                                const RasterizedGlyph & aGlyph,
+                                                math::Vec<2, GLint> aAtlasOffset)
+{
+    pageUsages[currentPage].lastUseFrame = frame;
+    return glyphMap.insert(
+        aCharCode,
+        makeRenderedGlyph(aGlyph,
+                          aAtlasOffset,
+                          margins,
+                          rasterization,
+                          currentPage));
+}
+
+void DynamicGlyphCache::acquirePage()
+{
+    if (std::optional<std::uint32_t> recycled = selectRecycledPage())
+    {
+        TextureAtlas & atlas = atlases[*recycled];
+        clear(atlas.texture, {math::hdr::gBlack<GLfloat>, 0.f});
+        atlas.packer = ShelfPacker{atlas.packer.getDimensions()};
+        statistics.evictedGlyphs += glyphMap.eraseIf(
+            [page = *recycled](const RenderedGlyph & aGlyph){ return aGlyph.page == page; });
+        ++statistics.recycledPages;
+
+        pageUsages[*recycled].lastUseFrame = frame;
+        currentPage = *recycled;
+        return;
+    }
+    growAtlas();
+}
+
+std::optional<std::uint32_t> DynamicGlyphCache::selectRecycledPage()
+{
+    if (maxPages == 0 || pageUsages.size() < maxPages)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<std::uint32_t> recycled = findRecyclablePage(pageUsages, frame);
+    if (!recycled)
+    {
+        ADLOG(gMainLogger, info)
+        ("All {} glyph atlas pages are in use, exceeding the memory budget.", pageUsages.size());
+        ++statistics.pagesOverBudget;
+    }
+    return recycled;
+}
+
+std::optional<std::uint32_t> DynamicGlyphCache::findRecyclablePage(std::span<const PageUsage> aPageUsages,
+                                                                   std::uint64_t aFrame)
+{
+    std::optional<std::uint32_t> coldest;
+    for (std::uint32_t page = 0; page != aPageUsages.size(); ++page)
+    {
+        const PageUsage & usage = aPageUsages[page];
+        if (usage.pins == 0
+            && usage.lastUseFrame + 1 < aFrame
+            && (!coldest || usage.lastUseFrame < aPageUsages[*coldest].lastUseFrame))
+        {
+            coldest = page;
+        }
+    }
+    return coldest;
+}
+
+void DynamicGlyphCache::setMemoryBudget(std::size_t aBytes)
+{
+    maxPages = (aBytes == 0) ? 0 : std::max<std::size_t>(1, aBytes / getPageBytes());
+}
+
+void DynamicGlyphCache::loadBaked(const BakedFontSizeView & aBaked)
+{
+    if (atlasDimension == math::Size<2, GLint>{0, 0})
+    {
+        atlasDimension = aBaked.atlasDimension;
+        margins = aBaked.margins;
+        rasterization = aBaked.rasterization;
+        placeholder = aBaked.placeholder;
+    }
+    else if (aBaked.rasterization != rasterization)
+    {
+        throw std::invalid_argument{"The baked glyphs rasterization does not match the glyph cache."};
+    }
+
+    const GLint maxSize = getMaxTextureSize();
+    if (aBaked.atlasDimension.width() > maxSize || aBaked.atlasDimension.height() > maxSize)
+    {
+        throw std::invalid_argument{"The baked atlas pages exceed the maximum texture dimension."};
+    }
+
+    // An empty trailing atlas is replaced by the baked pages, the last of which hosts glyphs rendered later.
+    if (!atlases.empty()
+        && currentPage == atlases.size() - 1
+        && atlases.back().packer.getUsedHeight() == 0)
+    {
+        atlases.pop_back();
+        pageUsages.pop_back();
+    }
+
+    const auto firstPage = static_cast<std::uint32_t>(atlases.size());
+    const GLenum format = (aBaked.rasterization == GlyphRasterization::Msdf) ? GL_RGB : GL_RED;
+    for (const BakedPageView & page : aBaked.pages)
+    {
+        TextureAtlas & atlas = atlases.emplace_back(make_TextureAtlas(
+            aBaked.atlasDimension,
+            aBaked.rasterization == GlyphRasterization::Msdf ? GL_RGB8 : GL_R8,
+            margins,
+            textureFiltering));
+        pageUsages.push_back({frame, 0});
+        currentPage = static_cast<std::uint32_t>(atlases.size() - 1);
+        if (page.usedHeight > 0)
+        {
+            writeTo(atlas.texture,
+                    page.pixels.data(),
+                    {{aBaked.atlasDimension.width(), page.usedHeight}, format, GL_UNSIGNED_BYTE, 1},
+                    math::Position<2, GLint>{0, 0});
+            // Glyphs rendered on demand are packed above the baked rows.
+            atlas.packer.insert({aBaked.atlasDimension.width(), page.usedHeight});
+        }
+    }
+    if (atlases.empty())
+    {
+        growAtlas();
+    }
+
+    for (const baked::Range & range : aBaked.ranges)
+    {
+        glyphMap.addDenseRange(range.first, range.last);
+    }
+    for (const baked::Glyph & glyph : aBaked.glyphs)
+    {
+        if (glyphMap.find(glyph.charCode) == nullptr)
+        {
+            glyphMap.insert(glyph.charCode, fromBaked(glyph, firstPage));
+        }
+    }
+
+    std::vector<arte::KerningTable::Pair> pairs;
+    pairs.reserve(aBaked.kerningPairs.size());
+    for (const baked::KerningPair & pair : aBaked.kerningPairs)
+    {
+        pairs.push_back({pair.left, pair.right, {pair.offset[0], pair.offset[1]}});
+    }
+    kerning.addPairs(aBaked.eagerGlyphs, pairs);
+}
+
 RenderedGlyph DynamicGlyphCache::at(arte::CharCode aCharCode,
                                     const arte::FontFace & aFontFace)
 {
-    if (auto found = glyphMap.find(aCharCode); found != glyphMap.end())
+    if (const RenderedGlyph * found = glyphMap.find(aCharCode))
     {
-        return found->second;
+        pageUsages[found->page].lastUseFrame = frame;
+        return *found;
     }
     else
     {
@@ -69,48 +341,22 @@ RenderedGlyph DynamicGlyphCache::at(arte::CharCode aCharCode,
         ("Glyph for charcode {} not found in cache, rendering.", aCharCode);
         if (aFontFace.hasGlyph(aCharCode))
         {
-            FT_GlyphSlot slot = aFontFace.loadChar(
-                aCharCode,
-                FT_LOAD_RENDER | FT_LOAD_TARGET_(FT_RENDER_MODE_SDF));
-            FT_Bitmap bitmap = aFontFace.renderGlyphSlot(FT_RENDER_MODE_NORMAL);
+            RasterizedGlyph rasterized = rasterizeGlyph(aFontFace, aCharCode, rasterization);
 
-            if (!atlases.back().isFitting(bitmap.width))
+            std::optional<math::Vec<2, GLint>> offset =
+                atlases[currentPage].write(rasterized.bitmap.data(), rasterized.getInputParameters());
+            if (!offset)
             {
                 ADLOG(gMainLogger, info)
-                ("Growing dynamic atlas with a new texture.", aCharCode);
-                growAtlas();
+                ("Acquiring a new dynamic atlas page for charcode {}.", aCharCode);
+                acquirePage();
+                offset = atlases[currentPage].write(rasterized.bitmap.data(), rasterized.getInputParameters());
+                if (!offset)
+                {
+                    throw std::invalid_argument{"Glyph does not fit in an empty atlas."};
+                }
             }
-            assert(atlases.back().isFitting(bitmap.width));
-
-            InputImageParameters inputParams{
-                {static_cast<int>(bitmap.width), static_cast<int>(bitmap.rows)},
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                1};
-
-            RenderedGlyph rendered{
-                &atlases.back().texture,
-                atlases.back().write(
-                    reinterpret_cast<const std::byte *>(bitmap.buffer),
-                    inputParams),
-                // Note: We observe noticeable "edge trimming" when using the
-                // exact glyph bounding box. This is because a fragment is
-                // generated only if the primitive hits the center of the pixel.
-                // Adding margin on each dimension allows to make sure the top
-                // and right border pixels are not discarded, when rendering at
-                // matching resolution. Important: The margin is added to each
-                // side, so each glyph dimension is agumented by 2 horizontal
-                // and 2 vertical margins.
-                {fixedToFloat(slot->metrics.width),
-                 fixedToFloat(slot->metrics.height)},
-                {fixedToFloat(slot->metrics.horiBearingX),
-                 fixedToFloat(slot->metrics.horiBearingY)},
-                // The bearing goes **back** the left horizontal margin, and
-                // goes **up** the top vertical margin.
-                {fixedToFloat(slot->metrics.horiAdvance),
-                 0.f /* hardcoded horizontal layout */},
-                slot->glyph_index};
-            return glyphMap.insert({aCharCode, rendered}).first->second;
+            return insert(aCharCode, rasterized, *offset);
         }
         else
         {
@@ -123,6 +369,198 @@ RenderedGlyph DynamicGlyphCache::at(arte::CharCode aCharCode,
     return at(placeholder, aFontFace);
 }
 
+namespace {
+
+/// @brief Writes glyphs to an atlas, batching the uploads of the glyphs on newly opened shelves.
+///
+/// The shelves above the rows used when the batch starts have never been written,
+/// so they can be uploaded as a single full-width block of rows (the atlas was cleared to zero,
+/// like the block padding). Glyphs going to previously opened shelves are written individually.
+class AtlasBatch
+{
+public:
+    explicit AtlasBatch(TextureAtlas & aAtlas) :
+        mAtlas{aAtlas},
+        mFirstRow{aAtlas.packer.getUsedHeight()}
+    {}
+
+    AtlasBatch(const AtlasBatch &) = delete;
+    AtlasBatch & operator=(const AtlasBatch &) = delete;
+
+    ~AtlasBatch()
+    { flush(); }
+
+    /// @brief Same contract as `TextureAtlas::write()`, `aGlyph` must outlive the batch.
+    std::optional<math::Vec<2, GLint>> write(const RasterizedGlyph & aGlyph)
+    {
+        const math::Vec<2, GLint> margins = mAtlas.margins;
+        std::optional<math::Position<2, GLint>> position = mAtlas.packer.insert({
+            aGlyph.resolution.width() + 2 * margins.x(),
+            aGlyph.resolution.height() + 2 * margins.y()});
+        if (!position)
+        {
+            return std::nullopt;
+        }
+
+        if (position->y() >= mFirstRow)
+        {
+            mStaged.push_back({*position + margins, &aGlyph});
+        }
+        else
+        {
+            writeTo(mAtlas.texture, aGlyph.bitmap.data(), aGlyph.getInputParameters(), *position + margins);
+        }
+        return position->as<math::Vec>();
+    }
+
+    /// @brief Upload the staged glyphs with a single sub-image write.
+    void flush()
+    {
+        if (mStaged.empty())
+        {
+            return;
+        }
+
+        // All the glyphs of an atlas have the same format.
+        const GLenum format = mStaged.front().glyph->format;
+        const std::size_t bytesPerPixel = mStaged.front().glyph->getBytesPerPixel();
+        const GLint width = mAtlas.packer.getDimensions().width();
+        const GLint rows = mAtlas.packer.getUsedHeight() - mFirstRow;
+        std::vector<std::byte> block(bytesPerPixel * width * rows);
+        for (const auto & [position, glyph] : mStaged)
+        {
+            const std::size_t rowSize = bytesPerPixel * glyph->resolution.width();
+            for (GLint row = 0; row != glyph->resolution.height(); ++row)
+            {
+                std::copy_n(glyph->bitmap.begin() + row * rowSize,
+                            rowSize,
+                            block.begin() + bytesPerPixel * ((position.y() - mFirstRow + row) * width + position.x()));
+            }
+        }
+        writeTo(mAtlas.texture,
+                block.data(),
+                {{width, rows}, format, GL_UNSIGNED_BYTE, 1},
+                math::Position<2, GLint>{0, mFirstRow});
+
+        mStaged.clear();
+        mFirstRow = mAtlas.packer.getUsedHeight();
+    }
+
+private:
+    struct Staged
+    {
+        math::Position<2, GLint> position; // where the bitmap starts, inside the margins
+        const RasterizedGlyph * glyph;
+    };
+
+    TextureAtlas & mAtlas;
+    GLint mFirstRow;
+    std::vector<Staged> mStaged;
+};
+
+} // anonymous namespace
+
+void DynamicGlyphCache::preloadGlyphs(const arte::FontFace & aFontFace,
+                                      const filesystem::path & aFontPath,
+                                      arte::CharCode aFirst,
+                                      arte::CharCode aLast)
+{
+    const std::size_t count = aLast > aFirst ? aLast - aFirst : 0;
+    if (count < gMinParallelPreload)
+    {
+        preloadGlyphs(aFontFace, aFirst, aLast);
+        return;
+    }
+    glyphMap.addDenseRange(aFirst, aLast);
+
+    //
+    // Rasterize the missing glyphs on worker threads
+    //
+    std::vector<arte::CharCode> missing;
+    for (arte::CharCode charCode = aFirst; charCode != aLast; ++charCode)
+    {
+        if (glyphMap.find(charCode) == nullptr)
+        {
+            missing.push_back(charCode);
+        }
+    }
+    std::vector<std::optional<RasterizedGlyph>> rasterized =
+        rasterizeGlyphs(aFontFace, aFontPath, missing, rasterization);
+
+    //
+    // Pack the glyphs in code point order, as the serial path does
+    //
+    std::vector<FT_UInt> glyphIndices;
+    glyphIndices.reserve(count);
+    std::optional<RasterizedGlyph> rasterizedPlaceholder;
+    // The glyphs already present must survive the pages recycled while packing.
+    for (std::size_t index = 0; index != count; ++index)
+    {
+        if (const RenderedGlyph * found = glyphMap.find(aFirst + static_cast<arte::CharCode>(index)))
+        {
+            pageUsages[found->page].lastUseFrame = frame;
+        }
+    }
+
+    std::optional<AtlasBatch> batch{std::in_place, atlases[currentPage]};
+
+    auto write = [&](arte::CharCode aCharCode, const RasterizedGlyph & aGlyph) -> const RenderedGlyph &
+    {
+        std::optional<math::Vec<2, GLint>> offset = batch->write(aGlyph);
+        if (!offset)
+        {
+            ADLOG(gMainLogger, info)
+            ("Acquiring a new dynamic atlas page for charcode {}.", aCharCode);
+            batch.reset(); // flushes before the next page is acquired
+            acquirePage();
+            batch.emplace(atlases[currentPage]);
+            offset = batch->write(aGlyph);
+            if (!offset)
+            {
+                throw std::invalid_argument{"Glyph does not fit in an empty atlas."};
+            }
+        }
+        return insert(aCharCode, aGlyph, *offset);
+    };
+
+    // The missing code points are in code point order, so their glyphs are consumed in order.
+    std::size_t nextMissing = 0;
+    for (std::size_t index = 0; index != count; ++index)
+    {
+        const arte::CharCode charCode = aFirst + static_cast<arte::CharCode>(index);
+        const std::optional<RasterizedGlyph> * glyph = nullptr;
+        if (nextMissing != missing.size() && missing[nextMissing] == charCode)
+        {
+            glyph = &rasterized[nextMissing++];
+        }
+
+        if (const RenderedGlyph * found = glyphMap.find(charCode))
+        {
+            glyphIndices.push_back(found->freetypeIndex);
+        }
+        else if (glyph != nullptr && glyph->has_value())
+        {
+            glyphIndices.push_back(write(charCode, **glyph).freetypeIndex);
+        }
+        else
+        {
+            ADLOG(gMainLogger, warn)
+            ("No glyph for character code: {}", charCode);
+            const RenderedGlyph * found = glyphMap.find(placeholder);
+            if (found == nullptr)
+            {
+                // Rendered on this thread, it is not worth a worker.
+                rasterizedPlaceholder = rasterizeGlyph(aFontFace, placeholder, rasterization);
+                found = &write(placeholder, *rasterizedPlaceholder);
+            }
+            glyphIndices.push_back(found->freetypeIndex);
+        }
+    }
+    batch.reset();
+
+    kerning.addGlyphs(aFontFace, glyphIndices);
+}
+
 Texture makeTightGlyphAtlas(const arte::FontFace & aFontFace,
                             arte::CharCode aFirst,
                             arte::CharCode aLast,
@@ -172,9 +610,8 @@ Texture makeTightGlyphAtlas(const arte::FontFace & aFontFace,
             GL_RED,
             GL_UNSIGNED_BYTE,
             1};
-        RenderedGlyph rendered{&ribon.texture,
-                               ribon.write(
-            reinterpret_cast<const std::byte *>(bitmap.buffer), inputParams),
+        RenderedGlyph rendered{{ribon.write(
+            reinterpret_cast<const std::byte *>(bitmap.buffer), inputParams), 0},
                                // See DynamicGlyphCache::at() for the ratrionale
                                // behind the addition
                                {static_cast<float>(slot->bitmap.width) + 2 * aMargins.x(),
@@ -183,10 +620,9 @@ Texture makeTightGlyphAtlas(const arte::FontFace & aFontFace,
                                 static_cast<float>(slot->bitmap.rows - slot->bitmap_top) + aMargins.y()},
                                {fixedToFloat(slot->metrics.horiAdvance),
                                 0.f /* hardcoded horizontal layout */},
-                               slot->glyph_index};
-        rendered.texture = &ribon.texture; // Replace the nullptr with the
-                                           // actual the ribon texture.
-        aGlyphMap.insert({charcode, rendered});
+                               slot->glyph_index,
+                               0 /* single page */};
+        aGlyphMap.insert(charcode, rendered);
     }
 
     return std::move(ribon.texture);
@@ -200,27 +636,9 @@ void forEachGlyph(const std::string & aString,
                   std::function<void(RenderedGlyph, math::Position<2, GLfloat>)>
                       aGlyphCallback)
 {
-    unsigned int previousIndex = 0;
-    for (std::string::const_iterator it = aString.begin(); it != aString.end();
-         /* in body */)
-    {
-        // Decode utf8 encoded string to individual Unicode code points
-        arte::CharCode codePoint = utf8::next(it, aString.end());
-        detail::RenderedGlyph rendered = aGlyphCache.at(codePoint, aFontFace);
-
-        // Kerning
-        if (previousIndex != 0)
-        {
-            Vec2<GLfloat> kerning =
-                aFontFace.kern(previousIndex, rendered.freetypeIndex);
-            aPenOrigin_w += kerning.cwMul(aPixelToLocal.as<math::Vec>());
-        }
-        previousIndex = rendered.freetypeIndex;
-
-        aGlyphCallback(rendered, aPenOrigin_w);
-        aPenOrigin_w +=
-            rendered.penAdvance.cwMul(aPixelToLocal.as<math::Vec>());
-    }
+    layoutString(aString, aPenOrigin_w, aPixelToLocal.as<math::Vec>(),
+                 [&](arte::CharCode aCodePoint){ return aGlyphCache.at(aCodePoint, aFontFace); },
+                 aGlyphCache.kerning, aFontFace, aGlyphCallback);
 }
 
 void forEachGlyph(
@@ -231,25 +649,9 @@ void forEachGlyph(
     std::function<void(const RenderedGlyph &, math::Position<2, GLfloat>)>
         aGlyphCallback)
 {
-    unsigned int previousIndex = 0;
-    for (std::string::const_iterator it = aString.begin(); it != aString.end();
-         /* in body */)
-    {
-        // Decode utf8 encoded string to individual Unicode code points
-        arte::CharCode codePoint = utf8::next(it, aString.end());
-        detail::RenderedGlyph rendered = aGlyphCache.at(codePoint);
-
-        // Kerning
-        if (previousIndex != 0)
-        {
-            aPenOrigin_p +=
-                aFontFace.kern(previousIndex, rendered.freetypeIndex);
-        }
-        previousIndex = rendered.freetypeIndex;
-
-        aGlyphCallback(rendered, aPenOrigin_p);
-        aPenOrigin_p += rendered.penAdvance;
-    }
+    layoutString(aString, aPenOrigin_p, {1.f, 1.f},
+                 [&](arte::CharCode aCodePoint) -> const RenderedGlyph & { return aGlyphCache.at(aCodePoint); },
+                 aGlyphCache.kerning, aFontFace, aGlyphCallback);
 }
 
 math::Size<2, GLfloat> getStringDimension(const std::string & aString,
@@ -258,8 +660,10 @@ math::Size<2, GLfloat> getStringDimension(const std::string & aString,
 {
     math::Size<2, GLfloat> result{
         static_cast<math::Size<2, GLfloat>>(aFontFace.getPixelSize())};
-    forEachGlyph(
-        aString, math::Position<2, GLfloat>{0.f, 0.f}, aGlyphCache, aFontFace,
+    layoutString(
+        aString, math::Position<2, GLfloat>{0.f, 0.f}, {1.f, 1.f},
+        [&](arte::CharCode aCodePoint) -> const RenderedGlyph & { return aGlyphCache.at(aCodePoint); },
+        aGlyphCache.kerning, aFontFace,
         [&result](const auto & rendered, auto position) {
             result = (position + rendered.penAdvance).template as<math::Size>();
         });
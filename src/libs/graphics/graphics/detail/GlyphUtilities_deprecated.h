@@ -1,7 +1,12 @@
 #pragma once
 
 
+#include "GlyphTable.h"
+#include "ShelfPacker.h"
+
+#include <arte/DistanceField.h>
 #include <arte/Freetype.h>
+#include <arte/KerningTable.h>
 
 #include <math/Vector.h>
 
@@ -9,8 +14,12 @@
 
 #include <glad/glad.h>
 
-#include <list>
-#include <unordered_map>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <vector>
 
 
 namespace ad {
@@ -48,22 +57,62 @@ struct TextureRibon
 };
 
 
+/// Bidimensionnal array of rasters, packed by shelves.
+struct TextureAtlas
+{
+    /// \param aMargins The empty margin on each side of the glyph.
+    /// Contrary to the ribon, the margins are reserved on all four sides of each glyph.
+    TextureAtlas(Texture aTexture, math::Size<2, GLint> aDimensions, math::Vec<2, GLint> aMargins) :
+        texture{std::move(aTexture)},
+        packer{aDimensions},
+        margins{aMargins}
+    {}
+
+    Texture texture;
+    ShelfPacker packer;
+    math::Vec<2, GLint> margins;
+
+    /// @brief Write the raw bitmap `aData` to the atlas, if there is room left.
+    /// @return The offset to the written data (i.e. where its left and bottom margins start),
+    /// or an empty optional if the atlas is full.
+    std::optional<math::Vec<2, GLint>> write(const std::byte * aData, InputImageParameters aInputParameters);
+};
+
+
 // Note: Linear offers smoother translations, at the cost of sharpness.
 // Note: Nearest currently has a drawback that all letters of a string do not necessarily advance a pixel together.
-inline TextureRibon make_TextureRibon(math::Size<2, GLint> aDimensions, GLenum aInternalFormat, math::Vec<2, GLint> aMargins, GLenum aTextureFiltering)
+inline Texture make_GlyphTexture(math::Size<2, GLint> aDimensions, GLenum aInternalFormat, GLenum aTextureFiltering)
 {
-    TextureRibon ribon{Texture{GL_TEXTURE_RECTANGLE}, aDimensions.width(), aMargins};
-    allocateStorage(ribon.texture, aInternalFormat, aDimensions.width(), aDimensions.height());
+    Texture texture{GL_TEXTURE_RECTANGLE};
+    allocateStorage(texture, aInternalFormat, aDimensions.width(), aDimensions.height());
     // Note: Only the first (red) value will be used for a GL_R8 texture, but the API requires a 4-channel color.
-    clear(ribon.texture, {math::hdr::gBlack<GLfloat>, 0.f});
+    clear(texture, {math::hdr::gBlack<GLfloat>, 0.f});
 
-    bind(ribon.texture);
+    bind(texture);
     glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, aTextureFiltering);
     glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, aTextureFiltering);
     glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP);
     glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP);
 
-    return ribon;
+    return texture;
+}
+
+
+inline TextureRibon make_TextureRibon(math::Size<2, GLint> aDimensions, GLenum aInternalFormat, math::Vec<2, GLint> aMargins, GLenum aTextureFiltering)
+{
+    return TextureRibon{
+        make_GlyphTexture(aDimensions, aInternalFormat, aTextureFiltering),
+        aDimensions.width(),
+        aMargins};
+}
+
+
+inline TextureAtlas make_TextureAtlas(math::Size<2, GLint> aDimensions, GLenum aInternalFormat, math::Vec<2, GLint> aMargins, GLenum aTextureFiltering)
+{
+    return TextureAtlas{
+        make_GlyphTexture(aDimensions, aInternalFormat, aTextureFiltering),
+        aDimensions,
+        aMargins};
 }
 
 
@@ -80,21 +129,106 @@ inline GLint TextureRibon::write(const std::byte * aData, InputImageParameters a
 }
 
 
+inline std::optional<math::Vec<2, GLint>> TextureAtlas::write(const std::byte * aData, InputImageParameters aInputParameters)
+{
+    // The margins are reserved on both sides, in each dimension.
+    std::optional<math::Position<2, GLint>> position = packer.insert({
+        aInputParameters.resolution.width() + 2 * margins.x(),
+        aInputParameters.resolution.height() + 2 * margins.y()});
+    if (!position)
+    {
+        return std::nullopt;
+    }
+    writeTo(texture, aData, aInputParameters, *position + margins);
+    return position->as<math::Vec>();
+}
+
+
 struct RenderedGlyph
 {
-    // TODO Storing a naked texture pointer is not ideal
-    // Note: the texture is stored here for the cases where several textures are used for a single logical font atlas (dynamic)
-    // Ideally, this association should be handled by the client, but it would mean 1 GlyphMap / texture (complicating lookups).
-    Texture * texture;
-    GLint offsetInTexture; // The texture is a "1D" strip, only horizontal position. This is the position where the left margin starts.
+    math::Vec<2, GLint> offsetInTexture; // This is the position where the left and bottom margins start (always 0 vertically in a ribon).
     math::Size<2, GLfloat> controlBoxSize; // Including added margin if any
     math::Vec<2, GLfloat> bearing; // Including the added margin if any
     math::Vec<2, GLfloat> penAdvance;
     unsigned int freetypeIndex; // Notably usefull for kerning queries.
+    // Note: several textures can be used for a single logical font atlas (dynamic).
+    // The page indexes the texture in the glyph cache, keeping the glyph compact.
+    std::uint32_t page;
 };
 
 
-using GlyphMap = std::unordered_map<arte::CharCode, RenderedGlyph>;
+using GlyphMap = GlyphTable<RenderedGlyph>;
+
+
+/// @brief How glyphs are rendered to the atlas textures.
+enum class GlyphRasterization
+{
+    Coverage, // Anti-aliased coverage, for a single text size (GL_R8).
+    Msdf, // Multi-channel signed distance field, sharp at any size (GL_RGB8).
+};
+
+
+/// The width of the distance ramp in MSDF glyphs, in texels.
+constexpr float gMsdfRange = 4.f;
+
+
+/// @brief A glyph rendered to a CPU bitmap, not yet written to a texture.
+struct RasterizedGlyph
+{
+    std::vector<std::byte> bitmap; // Tightly packed rows.
+    GLenum format; // GL_RED or GL_RGB, one byte per channel.
+    math::Size<2, GLint> resolution;
+    math::Size<2, GLfloat> controlBoxSize;
+    math::Vec<2, GLfloat> bearing;
+    math::Vec<2, GLfloat> penAdvance;
+    unsigned int freetypeIndex;
+
+    std::size_t getBytesPerPixel() const
+    { return format == GL_RGB ? 3 : 1; }
+
+    InputImageParameters getInputParameters() const
+    { return {resolution, format, GL_UNSIGNED_BYTE, 1}; }
+};
+
+
+/// @brief The glyph for `aGlyph`, written at `aAtlasOffset` (where its margins start) in the atlas `aPage`.
+inline RenderedGlyph makeRenderedGlyph(const RasterizedGlyph & aGlyph,
+                                       math::Vec<2, GLint> aAtlasOffset,
+                                       math::Vec<2, GLint> aMargins,
+                                       GlyphRasterization aRasterization,
+                                       std::uint32_t aPage)
+{
+    // Distance fields are sampled over their exact texels (coverage glyphs start at their margins).
+    return RenderedGlyph{
+        (aRasterization == GlyphRasterization::Msdf) ? aAtlasOffset + aMargins : aAtlasOffset,
+        aGlyph.controlBoxSize,
+        aGlyph.bearing,
+        aGlyph.penAdvance,
+        aGlyph.freetypeIndex,
+        aPage};
+}
+
+
+/// @brief Render the glyph of `aCharCode`, which must be present in `aFontFace`.
+/// @note Only accesses `aFontFace`, so it can run on any thread owning the face.
+RasterizedGlyph rasterizeGlyph(const arte::FontFace & aFontFace,
+                               arte::CharCode aCharCode,
+                               GlyphRasterization aRasterization = GlyphRasterization::Coverage);
+
+/// @brief Render the glyphs of `aCharCodes` on worker threads, by contiguous blocks.
+///
+/// Each worker opens its own face from `aFontPath` (faces are not thread-safe),
+/// matching the settings of `aFontFace`, so the glyphs are the same as with `rasterizeGlyph()`.
+/// @param aFontPath The file `aFontFace` was loaded from.
+/// @return The glyphs in the order of `aCharCodes`, empty for the code points without a glyph in the face.
+std::vector<std::optional<RasterizedGlyph>> rasterizeGlyphs(const arte::FontFace & aFontFace,
+                                                            const filesystem::path & aFontPath,
+                                                            std::span<const arte::CharCode> aCharCodes,
+                                                            GlyphRasterization aRasterization);
+
+/// @brief Copy the rows of `aBitmap` from top to bottom, tightly packed (without the row padding).
+/// @note A negative pitch is an upward flow: the buffer then starts with the bottom row.
+std::vector<std::byte> copyRows(const FT_Bitmap & aBitmap);
 
 
 inline GLfloat fixedToFloat(FT_Pos aPos, int aFixedDecimals = 6)
@@ -118,48 +252,186 @@ struct StaticGlyphCache
                      arte::CharCode aFirst, arte::CharCode aLast,
                      math::Vec<2, GLint> aDimensionExtension = TextureRibon::gRecommendedMargins);
 
-    RenderedGlyph at(arte::CharCode aCharCode) const;
+    const RenderedGlyph & at(arte::CharCode aCharCode) const;
+
+    /// @brief All the glyphs are on the single page 0.
+    const Texture * getTexture(std::uint32_t /*aPage*/) const
+    { return &atlas; }
 
     Texture atlas{0};
     GlyphMap glyphMap;
+    const RenderedGlyph * placeholderGlyph{nullptr};
+    arte::KerningTable kerning; // between all the glyphs of the atlas
     static constexpr arte::CharCode placeholder = 0x3F; // '?'
 };
 
 
+struct BakedFontSizeView;
+
+
+/// @brief Counters to tune the memory budget of a `DynamicGlyphCache`.
+struct GlyphCacheStatistics
+{
+    std::size_t pages; // atlas textures currently allocated
+    std::size_t glyphs; // glyphs currently in the atlases
+    std::uint64_t recycledPages; // pages emptied to host new glyphs
+    std::uint64_t evictedGlyphs; // glyphs removed with the recycled pages
+    std::uint64_t pagesOverBudget; // pages allocated beyond the budget, all pages being in use
+};
+
+
+/// @brief Renders glyphs on demand, packing them in 2D texture atlases.
+///
+/// A new texture is only added when the current atlas is full,
+/// so all the glyphs of a typical UI are sampled from a single texture.
+///
+/// When a memory budget is set, a full cache recycles its least recently used page instead of
+/// growing: the page is cleared, and its glyphs are rendered again if they are requested later.
+/// Only pages that were not used during the current and previous frames, and which are not pinned, are recycled.
 struct DynamicGlyphCache
 {
-    // Since we are storing texture pointer, growing the atlas should not re-allocate!
-    std::list<TextureRibon> atlases;
+    /// @brief Tracks the use of an atlas page, for eviction.
+    struct PageUsage
+    {
+        std::uint64_t lastUseFrame{0};
+        std::uint32_t pins{0};
+    };
+
+    // The glyph pages index into the atlases.
+    // Since texture pointers are handed out, growing the atlases should not re-allocate!
+    std::deque<TextureAtlas> atlases;
+    std::vector<PageUsage> pageUsages; // parallel to atlases
+    std::uint32_t currentPage = 0; // The atlas receiving the glyphs rendered on demand.
+    std::size_t maxPages = 0; // 0 for an unbounded cache.
+    std::uint64_t frame = 0;
+    GlyphCacheStatistics statistics{};
     GlyphMap glyphMap;
     GLenum textureFiltering = GL_LINEAR;
-    math::Size<2, GLint> ribonDimension = {0, 0};
+    math::Size<2, GLint> atlasDimension = {0, 0};
     math::Vec<2, GLint> margins = {0, 0};
     arte::CharCode placeholder = 0x3F; // '?'
+    arte::KerningTable kerning; // eagerly computed between preloaded glyphs
+    GlyphRasterization rasterization = GlyphRasterization::Coverage;
 
     DynamicGlyphCache() = default;
 
     // The empty cache
-    DynamicGlyphCache(math::Size<2, GLint> aRibonDimension_p, math::Vec<2, GLint> aMargins, GLenum aTextureFiltering);
-
+    /// @param aAtlasDimension_p Dimension of each atlas texture, clamped to the maximum texture size.
+    /// @param aRasterization Distance fields must be sampled with linear filtering.
+    DynamicGlyphCache(const arte::FontFace & aFontFace,
+                      math::Size<2, GLint> aAtlasDimension_p,
+                      math::Vec<2, GLint> aMargins,
+                      GLenum aTextureFiltering,
+                      GlyphRasterization aRasterization = GlyphRasterization::Coverage);
+
+    /// @brief Append a new atlas, which becomes the current page.
     void growAtlas()
     {
-        atlases.push_back(make_TextureRibon(ribonDimension, GL_R8, margins, textureFiltering));
+        atlases.push_back(make_TextureAtlas(
+            atlasDimension,
+            rasterization == GlyphRasterization::Msdf ? GL_RGB8 : GL_R8,
+            margins,
+            textureFiltering));
+        pageUsages.push_back({frame, 0});
+        currentPage = static_cast<std::uint32_t>(atlases.size() - 1);
+    }
+
+    /// @brief Make room for glyphs when the current page is full,
+    /// by recycling the least recently used page if the budget is reached, or by growing the atlases.
+    void acquirePage();
+
+    /// @brief The page `acquirePage()` recycles, without touching the atlases.
+    /// @return Nothing if the atlases must grow: the budget is not reached, or all pages are in use.
+    /// In the latter case, the page is counted as over budget.
+    std::optional<std::uint32_t> selectRecycledPage();
+
+    /// @brief The least recently used page which is not pinned, and was used neither during `aFrame`
+    /// nor during the previous frame.
+    /// @return Nothing if all pages are in use.
+    static std::optional<std::uint32_t> findRecyclablePage(std::span<const PageUsage> aPageUsages,
+                                                            std::uint64_t aFrame);
+
+    /// @brief Limit the atlases to `aBytes` of texture memory (at least one page), 0 for no limit.
+    /// @note Pages already allocated beyond the budget are recycled, not released.
+    void setMemoryBudget(std::size_t aBytes);
+
+    std::size_t getPageBytes() const
+    { return std::size_t{rasterization == GlyphRasterization::Msdf ? 3u : 1u}
+             * atlasDimension.width() * atlasDimension.height(); }
+
+    /// @brief Start a new frame: the pages not used since the previous frame become candidates for recycling.
+    void nextFrame()
+    { ++frame; }
+
+    /// @brief Prevent `aPage` from being recycled, until a matching `unpinPage()`.
+    /// Used for glyphs that stay on the GPU across frames.
+    void pinPage(std::uint32_t aPage)
+    { ++pageUsages[aPage].pins; }
+
+    void unpinPage(std::uint32_t aPage)
+    {
+        assert(pageUsages[aPage].pins > 0);
+        --pageUsages[aPage].pins;
+    }
+
+    GlyphCacheStatistics getStatistics() const
+    {
+        GlyphCacheStatistics result = statistics;
+        result.pages = atlases.size();
+        result.glyphs = glyphMap.size();
+        return result;
     }
 
     RenderedGlyph at(arte::CharCode aCharCode, const arte::FontFace & aFontFace);
 
+    /// @brief Add the glyph for `aCharCode`, with `aAtlasOffset` returned when writing `aGlyph` to the current page.
+    const RenderedGlyph & insert(arte::CharCode aCharCode,
+                                 const RasterizedGlyph & aGlyph,
+                                 math::Vec<2, GLint> aAtlasOffset);
+
+    Texture * getTexture(std::uint32_t aPage)
+    { return &atlases[aPage].texture; }
+
+    /// @brief Upload the pages of `aBaked` as new atlases, and add its glyphs and kerning pairs.
+    ///
+    /// Glyphs already in the cache are kept. Glyphs that were not baked are still rendered on demand
+    /// by `at()`, in the free rows of the last baked page.
+    /// A default constructed cache takes the atlas dimension, margins and rasterization of `aBaked`,
+    /// so baked glyphs can be rendered without a font face.
+    /// @throw std::invalid_argument if `aBaked` uses another rasterization than this cache.
+    void loadBaked(const BakedFontSizeView & aBaked);
+
+    /// @brief Render the glyphs in [aFirst, aLast[, and compute the kerning between them.
+    ///
+    /// The range is then looked up by direct indexing.
     void preloadGlyphs(const arte::FontFace & aFontFace, arte::CharCode aFirst, arte::CharCode aLast)
     {
+        glyphMap.addDenseRange(aFirst, aLast);
+        std::vector<FT_UInt> glyphIndices;
         for(; aFirst != aLast; ++aFirst)
         {
-            at(aFirst, aFontFace);
+            glyphIndices.push_back(at(aFirst, aFontFace).freetypeIndex);
         }
+        kerning.addGlyphs(aFontFace, glyphIndices);
     }
+
+    /// @brief Same as the other overload, but rasterizing the glyphs on worker threads.
+    ///
+    /// Each worker opens its own face from `aFontPath` (faces are not thread-safe),
+    /// matching the settings of `aFontFace`. The bitmaps are then packed in the same order
+    /// as the serial path, and uploaded in batches, so the resulting atlases are identical.
+    /// @param aFontPath The file `aFontFace` was loaded from.
+    void preloadGlyphs(const arte::FontFace & aFontFace,
+                       const filesystem::path & aFontPath,
+                       arte::CharCode aFirst, arte::CharCode aLast);
+
+    /// Ranges smaller than this are preloaded serially, opening faces would dominate.
+    static constexpr std::size_t gMinParallelPreload = 256;
 };
 
 
 // TODO aPixelToLocal should be removed, when the Texting rendering does all "local layout" in pixel coordinates
-/// \deprecated
+/// \deprecated Use `layoutString()`, which inlines the callback.
 void forEachGlyph(const std::string & aString,
                   math::Position<2, GLfloat> aPenOrigin_w,
                   DynamicGlyphCache & aGlyphCache,
@@ -170,6 +442,7 @@ void forEachGlyph(const std::string & aString,
 
 /// @brief Prepare a string for rendering by invoking `aGlyphCallback` for each glyph in `aString`.
 /// @param aPenOrigin_u Pen origin when starting to write the string, expressed in pixels of the render target.
+/// @note Wraps `layoutString()`, which should be prefered in hot paths (it does not go through a `std::function`).
 void forEachGlyph(const std::string & aString,
                   math::Position<2, GLfloat> aPenOrigin_p,
                   const StaticGlyphCache & aGlyphCache,
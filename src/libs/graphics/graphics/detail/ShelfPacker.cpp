@@ -0,0 +1,52 @@
+#include "ShelfPacker.h"
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+ShelfPacker::ShelfPacker(math::Size<2, GLint> aDimensions) :
+    mDimensions{aDimensions}
+{}
+
+
+std::optional<math::Position<2, GLint>> ShelfPacker::insert(math::Size<2, GLint> aSize)
+{
+    if (aSize.width() > mDimensions.width() || aSize.height() > mDimensions.height())
+    {
+        return std::nullopt;
+    }
+
+    // Best fit among the existing shelves: the least wasted height.
+    Shelf * best = nullptr;
+    for (Shelf & shelf : mShelves)
+    {
+        if (shelf.height >= aSize.height()
+            && mDimensions.width() - shelf.nextX >= aSize.width()
+            && (best == nullptr || shelf.height < best->height))
+        {
+            best = &shelf;
+        }
+    }
+
+    const bool canOpenShelf = mDimensions.height() - getUsedHeight() >= aSize.height();
+    if (canOpenShelf && (best == nullptr || best->height > gMaxHeightRatio * aSize.height()))
+    {
+        best = &mShelves.emplace_back(Shelf{.y = getUsedHeight(), .height = aSize.height()});
+    }
+
+    if (best == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    math::Position<2, GLint> position{best->nextX, best->y};
+    best->nextX += aSize.width();
+    return position;
+}
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,58 @@
+#pragma once
+
+
+#include <math/Vector.h>
+
+#include <glad/glad.h>
+
+#include <optional>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+/// @brief Packs rectangles in a 2D area, by rows ("shelves") stacked from the bottom.
+///
+/// Each rectangle goes on the existing shelf wasting the least height, a new shelf being
+/// opened above the last one when no shelf fits it closely enough.
+/// This is well suited to glyphs, whose heights are similar for a given font size.
+class ShelfPacker
+{
+public:
+    /// @brief Creates an empty packer covering `aDimensions`.
+    explicit ShelfPacker(math::Size<2, GLint> aDimensions);
+
+    /// @brief Reserve a rectangle of `aSize`.
+    /// @return The position of the reserved rectangle lower-left corner,
+    /// or an empty optional when the area is too full to host it.
+    std::optional<math::Position<2, GLint>> insert(math::Size<2, GLint> aSize);
+
+    math::Size<2, GLint> getDimensions() const
+    { return mDimensions; }
+
+    /// @brief The height occupied by the shelves, between 0 and the packer height.
+    GLint getUsedHeight() const
+    { return mShelves.empty() ? 0 : mShelves.back().y + mShelves.back().height; }
+
+private:
+    struct Shelf
+    {
+        GLint y;
+        GLint height;
+        GLint nextX{0};
+    };
+
+    /// A shelf more than this many times taller than a rectangle only hosts it when no new shelf can be opened.
+    static constexpr GLint gMaxHeightRatio = 2;
+
+    math::Size<2, GLint> mDimensions;
+    std::vector<Shelf> mShelves; // ordered by y
+};
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
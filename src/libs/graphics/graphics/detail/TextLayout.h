@@ -0,0 +1,133 @@
+#pragma once
+
+
+#include "GlyphUtilities_deprecated.h"
+#include "Utf8.h"
+
+#include <arte/Freetype.h>
+#include <arte/KerningTable.h>
+
+#include <math/Rectangle.h>
+#include <math/Vector.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <span>
+#include <string_view>
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+/// @brief The result of laying out a string with `layoutString()`.
+struct StringLayout
+{
+    /// @brief The rectangle enclosing the bounding boxes of all glyphs.
+    /// It does not necessarily contain the pen origin, nor the final pen position.
+    /// For a string without glyphs, it is empty at the pen origin.
+    math::Rectangle<GLfloat> getBounds() const
+    { return {boundsMin, (boundsMax - boundsMin).as<math::Size>()}; }
+
+    math::Position<2, GLfloat> penPosition; // The pen position after the last glyph.
+    math::Position<2, GLfloat> boundsMin;
+    math::Position<2, GLfloat> boundsMax;
+    std::size_t glyphCount{0};
+};
+
+
+/// @brief Lay out the glyphs of the UTF-8 encoded `aString`, invoking `aGlyphCallback` for each of them.
+///
+/// This is the core of all string layouts: the callback is inlined, the pen advances and the bounds
+/// are computed in a single pass, and it does not allocate.
+/// @param aScale Applied to the glyph metrics and the kerning, which are in pixels.
+/// @param aLookup Returns the `RenderedGlyph` for a code point.
+/// @param aGlyphCallback Invoked with each `RenderedGlyph` and its pen position.
+/// @throw std::invalid_argument on malformed UTF-8.
+template <class T_lookup, class T_callback>
+StringLayout layoutString(std::string_view aString,
+                          math::Position<2, GLfloat> aPenOrigin,
+                          math::Vec<2, GLfloat> aScale,
+                          T_lookup && aLookup,
+                          const arte::KerningTable & aKerning,
+                          const arte::FontFace & aFontFace,
+                          T_callback && aGlyphCallback)
+{
+    constexpr GLfloat infinity = std::numeric_limits<GLfloat>::infinity();
+
+    StringLayout layout{
+        .penPosition = aPenOrigin,
+        .boundsMin = {+infinity, +infinity},
+        .boundsMax = {-infinity, -infinity},
+    };
+    const bool hasKerning = aKerning.hasKerning();
+    unsigned int previousIndex = 0;
+
+    decodeUtf8(aString, [&](arte::CharCode aCodePoint)
+    {
+        decltype(auto) rendered = aLookup(aCodePoint);
+
+        if (hasKerning && previousIndex != 0)
+        {
+            layout.penPosition += aKerning.get(previousIndex, rendered.freetypeIndex, aFontFace).cwMul(aScale);
+        }
+        previousIndex = rendered.freetypeIndex;
+
+        // Those computations work for both horizontal and vertical layouts.
+        const math::Position<2, GLfloat> topLeft = layout.penPosition + rendered.bearing.cwMul(aScale);
+        const math::Position<2, GLfloat> bottomRight =
+            topLeft + math::Vec<2, GLfloat>{+rendered.controlBoxSize.width(),
+                                            -rendered.controlBoxSize.height()}.cwMul(aScale);
+        for (std::size_t axis = 0; axis != 2; ++axis)
+        {
+            const GLfloat first = topLeft[axis];
+            const GLfloat second = bottomRight[axis];
+            layout.boundsMin[axis] = std::min(layout.boundsMin[axis], std::min(first, second));
+            layout.boundsMax[axis] = std::max(layout.boundsMax[axis], std::max(first, second));
+        }
+
+        aGlyphCallback(rendered, layout.penPosition);
+        ++layout.glyphCount;
+        layout.penPosition += rendered.penAdvance.cwMul(aScale);
+    });
+
+    if (layout.glyphCount == 0)
+    {
+        layout.boundsMin = layout.boundsMax = aPenOrigin;
+    }
+    return layout;
+}
+
+
+/// @brief Lay out `aString`, writing the instance returned by `aMakeInstance` for each glyph to `aOutput`.
+///
+/// The glyph count is bounded by the size in bytes of the string,
+/// so an output of `aString.size()` elements is always large enough.
+/// @param aMakeInstance Returns the instance for a `RenderedGlyph` and its pen position.
+/// @return The layout, whose `glyphCount` is the number of instances written at the start of `aOutput`.
+template <class T_lookup, class T_instance, class T_makeInstance>
+StringLayout layoutString(std::string_view aString,
+                          math::Position<2, GLfloat> aPenOrigin,
+                          math::Vec<2, GLfloat> aScale,
+                          T_lookup && aLookup,
+                          const arte::KerningTable & aKerning,
+                          const arte::FontFace & aFontFace,
+                          std::span<T_instance> aOutput,
+                          T_makeInstance && aMakeInstance)
+{
+    T_instance * output = aOutput.data();
+    [[maybe_unused]] T_instance * const outputEnd = aOutput.data() + aOutput.size();
+    return layoutString(aString, aPenOrigin, aScale, aLookup, aKerning, aFontFace,
+        [&](const auto & aRendered, math::Position<2, GLfloat> aPenPosition)
+        {
+            assert(output != outputEnd);
+            *output++ = aMakeInstance(aRendered, aPenPosition);
+        });
+}
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,147 @@
+#include "TextRuns.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+namespace {
+
+    // The glyph buffer of the text runs is never allocated smaller than this count of glyphs.
+    constexpr std::size_t gMinimumGlyphCapacity = 1024;
+
+} // anonymous namespace
+
+
+void TextRuns::Run::setGlyphs(std::span<std::pair<Texture *, RunGlyph>> aPlaced)
+{
+    std::stable_sort(aPlaced.begin(), aPlaced.end(),
+                     [](const auto & aLhs, const auto & aRhs){ return std::less<>{}(aLhs.first, aRhs.first); });
+
+    glyphs.clear();
+    ranges.clear();
+    for (const auto & [texture, glyph] : aPlaced)
+    {
+        if (ranges.empty() || ranges.back().texture != texture)
+        {
+            ranges.push_back(PerTextureRange{
+                .texture = texture,
+                .firstInstance = (GLuint)glyphs.size(),
+                .instanceCount = 0,
+            });
+        }
+        ++ranges.back().instanceCount;
+        glyphs.push_back(glyph);
+    }
+}
+
+
+TextRuns::RunId TextRuns::create()
+{
+    RunId runId;
+    if (!mFreeRuns.empty())
+    {
+        runId = mFreeRuns.back();
+        mFreeRuns.pop_back();
+    }
+    else if (mRuns.size() < gMaxRuns)
+    {
+        runId = mRuns.size();
+        mRuns.emplace_back();
+    }
+    else
+    {
+        throw std::length_error{"Too many text runs alive at once."};
+    }
+
+    mRuns[runId].alive = true;
+    return runId;
+}
+
+
+void TextRuns::remove(RunId aRun)
+{
+    mRuns.at(aRun) = Run{};
+    mFreeRuns.push_back(aRun);
+}
+
+
+bool TextRuns::reserve(Run & aRun)
+{
+    if (aRun.glyphs.size() > aRun.capacity)
+    {
+        if (mGlyphEnd + aRun.glyphs.size() > mGlyphCapacity)
+        {
+            return false;
+        }
+        aRun.firstGlyph = (GLuint)mGlyphEnd;
+        aRun.capacity = (GLuint)aRun.glyphs.size();
+        mGlyphEnd += aRun.capacity;
+    }
+    return true;
+}
+
+
+std::vector<RunGlyph> TextRuns::repack()
+{
+    std::vector<RunGlyph> glyphs;
+    for (Run & run : mRuns)
+    {
+        if (run.alive)
+        {
+            run.firstGlyph = (GLuint)glyphs.size();
+            run.capacity = (GLuint)run.glyphs.size();
+            glyphs.insert(glyphs.end(), run.glyphs.begin(), run.glyphs.end());
+        }
+    }
+    mGlyphEnd = glyphs.size();
+
+    // Leave room to grow, so the next runs do not immediately trigger another repack.
+    mGlyphCapacity = std::max(2 * glyphs.size(), gMinimumGlyphCapacity);
+    return glyphs;
+}
+
+
+void TextRuns::getDraws(std::vector<PerTextureRange> & aDraws) const
+{
+    std::vector<const Run *> ordered;
+    for (const Run & run : mRuns)
+    {
+        if (run.alive)
+        {
+            ordered.push_back(&run);
+        }
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const Run * aLhs, const Run * aRhs){ return aLhs->firstGlyph < aRhs->firstGlyph; });
+
+    // Consecutive ranges sampling the same texture are drawn together.
+    aDraws.clear();
+    for (const Run * run : ordered)
+    {
+        for (PerTextureRange range : run->ranges)
+        {
+            range.firstInstance += run->firstGlyph;
+            if (!aDraws.empty()
+                && aDraws.back().texture == range.texture
+                && aDraws.back().firstInstance + aDraws.back().instanceCount == range.firstInstance)
+            {
+                aDraws.back().instanceCount += range.instanceCount;
+            }
+            else
+            {
+                aDraws.push_back(range);
+            }
+        }
+    }
+}
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,114 @@
+#pragma once
+
+
+#include <math/Vector.h>
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace ad {
+namespace graphics {
+
+
+struct Texture;
+
+
+namespace detail {
+
+
+/// @brief The glyph instance of a text run, laid out in pixels relative to the run origin.
+struct RunGlyph
+{
+    math::Position<2, GLfloat> position_p;
+    math::Vec<2, GLint> offsetInTexture_p;
+    math::Size<2, GLfloat> boundingBox_p;
+    math::Vec<2, GLfloat> bearing_p;
+    GLuint runIndex; // The run in the per-run uniform block.
+};
+
+
+/// @brief A range of instances in a single instance buffer, sampling the same texture.
+struct PerTextureRange
+{
+    Texture * texture;
+    GLuint firstInstance;
+    GLsizei instanceCount;
+};
+
+
+/// @brief The CPU side of the retained text runs: their slots, and their regions in a shared glyph buffer.
+///
+/// Each run reserves a region of the glyph buffer, which it keeps while its glyphs fit in it.
+/// A run outgrowing its region reserves a new one after the last region,
+/// and when the buffer is full all alive runs are repacked contiguously.
+/// This does not issue any GL call: the owner uploads the glyphs where they are placed.
+class TextRuns
+{
+public:
+    /// @brief Identifies a run, it is also its index in the per-run uniform block.
+    using RunId = std::size_t;
+
+    /// @brief Maximum number of runs alive at once (the size of the per-run uniform block).
+    static constexpr std::size_t gMaxRuns = 256;
+
+    struct Run
+    {
+        /// @brief Replace the run glyphs, grouping them by texture so each texture is a single range of the run.
+        /// @param aPlaced The glyphs, with the texture they sample. It is reordered.
+        void setGlyphs(std::span<std::pair<Texture *, RunGlyph>> aPlaced);
+
+        std::string string;
+        std::vector<RunGlyph> glyphs; // ordered by texture
+        std::vector<PerTextureRange> ranges; // relative to the first glyph of the run
+        std::vector<std::uint32_t> pages; // of the glyph cache, pinned while the run is laid out on them
+        GLuint firstGlyph{0}; // region reserved for the run in the glyph buffer
+        GLuint capacity{0};
+        bool alive{false};
+    };
+
+    /// @brief Get an alive run without glyphs, reusing the slot of a removed run if any.
+    /// @throw std::length_error if `gMaxRuns` runs are already alive.
+    RunId create();
+
+    /// @brief Free the slot of the run, its region is reclaimed at the next repack.
+    /// @note The pages of the run must have been unpinned by the caller.
+    void remove(RunId aRun);
+
+    Run & at(RunId aRun)
+    { return mRuns.at(aRun); }
+
+    const Run & at(RunId aRun) const
+    { return mRuns.at(aRun); }
+
+    /// @brief Make sure the region of the run can hold its glyphs, reserving a new region if needed.
+    /// @return false if there is no room left in the glyph buffer, `repack()` must then be called.
+    bool reserve(Run & aRun);
+
+    /// @brief Place all alive runs contiguously, in slot order, leaving room to grow.
+    /// @return The glyphs of all alive runs in buffer order, to upload to a buffer of `getGlyphCapacity()` glyphs.
+    std::vector<RunGlyph> repack();
+
+    /// @brief The ranges of all runs in buffer order, consecutive ranges sampling the same texture being merged.
+    /// @param aDraws Cleared, then filled with the draws.
+    void getDraws(std::vector<PerTextureRange> & aDraws) const;
+
+    std::size_t getGlyphCapacity() const
+    { return mGlyphCapacity; }
+
+private:
+    std::vector<Run> mRuns; // indexed by RunId
+    std::vector<RunId> mFreeRuns;
+    std::size_t mGlyphCapacity{0};
+    std::size_t mGlyphEnd{0}; // regions are reserved after this glyph
+};
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
@@ -0,0 +1,149 @@
+#pragma once
+
+
+#include <arte/Freetype.h>
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AD_GRAPHICS_UTF8_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace ad {
+namespace graphics {
+namespace detail {
+
+
+/// @brief Decode the multi-byte sequence starting at `aBytes`, and advance `aBytes` past it.
+/// @throw std::invalid_argument if the sequence is malformed, truncated, overlong,
+/// or encodes a surrogate or a value above U+10FFFF.
+inline arte::CharCode decodeUtf8Sequence(const unsigned char *& aBytes, const unsigned char * aEnd)
+{
+    const unsigned char lead = *aBytes;
+    int length;
+    arte::CharCode codePoint;
+    arte::CharCode minimum;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        length = 2;
+        codePoint = lead & 0x1F;
+        minimum = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length = 3;
+        codePoint = lead & 0x0F;
+        minimum = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length = 4;
+        codePoint = lead & 0x07;
+        minimum = 0x10000;
+    }
+    else
+    {
+        throw std::invalid_argument{"Invalid UTF-8 lead byte."};
+    }
+
+    if (aEnd - aBytes < length)
+    {
+        throw std::invalid_argument{"Truncated UTF-8 sequence."};
+    }
+    for (int index = 1; index != length; ++index)
+    {
+        if ((aBytes[index] & 0xC0) != 0x80)
+        {
+            throw std::invalid_argument{"Invalid UTF-8 continuation byte."};
+        }
+        codePoint = (codePoint << 6) | (aBytes[index] & 0x3F);
+    }
+    if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+    {
+        throw std::invalid_argument{"Invalid UTF-8 encoded code point."};
+    }
+
+    aBytes += length;
+    return codePoint;
+}
+
+
+#if defined(AD_GRAPHICS_UTF8_SSE2)
+constexpr int gUtf8BlockSize = 16;
+
+/// @return The number of ASCII bytes at the start of the `gUtf8BlockSize` bytes at `aBlock`.
+inline int countAsciiPrefix(const unsigned char * aBlock)
+{
+    // The mask has a bit set for each byte with its high bit set, i.e. not ASCII.
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aBlock));
+    const auto nonAscii = static_cast<unsigned int>(_mm_movemask_epi8(block));
+    return (nonAscii == 0) ? gUtf8BlockSize : std::countr_zero(nonAscii);
+}
+#else
+constexpr int gUtf8BlockSize = 8;
+
+/// @return The number of ASCII bytes at the start of the `gUtf8BlockSize` bytes at `aBlock`.
+inline int countAsciiPrefix(const unsigned char * aBlock)
+{
+    std::uint64_t word;
+    std::memcpy(&word, aBlock, sizeof(word));
+    const std::uint64_t nonAscii = word & 0x8080808080808080u;
+    if (nonAscii == 0)
+    {
+        return gUtf8BlockSize;
+    }
+    // The first byte is the least significant on little endian machines.
+    return (std::endian::native == std::endian::little ? std::countr_zero(nonAscii)
+                                                       : std::countl_zero(nonAscii)) / 8;
+}
+#endif
+
+
+/// @brief Invoke `aCallback` with each code point of the UTF-8 encoded `aString`.
+///
+/// Runs of ASCII characters are detected a block at a time (16 bytes with SSE2, 8 bytes otherwise),
+/// so mostly ASCII text does not pay for multi-byte decoding.
+/// @throw std::invalid_argument on malformed UTF-8, see `decodeUtf8Sequence()`.
+template <class T_callback>
+void decodeUtf8(std::string_view aString, T_callback && aCallback)
+{
+    const auto * bytes = reinterpret_cast<const unsigned char *>(aString.data());
+    const auto * const end = bytes + aString.size();
+
+    // Code points are decoded a block at a time, then forwarded from a single call site,
+    // so the compiler can inline the callback.
+    arte::CharCode decoded[gUtf8BlockSize];
+    while (bytes != end)
+    {
+        int count = 0;
+        if (end - bytes >= gUtf8BlockSize)
+        {
+            count = countAsciiPrefix(bytes);
+            for (int index = 0; index != count; ++index)
+            {
+                decoded[index] = bytes[index];
+            }
+            bytes += count;
+        }
+        if (count != gUtf8BlockSize && bytes != end)
+        {
+            decoded[count++] = (*bytes < 0x80) ? arte::CharCode{*bytes++} : decodeUtf8Sequence(bytes, end);
+        }
+
+        for (int index = 0; index != count; ++index)
+        {
+            aCallback(decoded[index]);
+        }
+    }
+}
+
+
+} // namespace detail
+} // namespace graphics
+} // namespace ad
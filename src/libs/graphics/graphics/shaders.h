@@ -236,7 +236,7 @@ namespace texting
         layout(location=1) in vec2 ve_UV; // not integral, it is multiplied by the float bbox anyway.
 
         layout(location=2) in vec2  in_Position_w;
-        layout(location=3) in ivec2 in_TextureOffset; // implicit 0 on y
+        layout(location=3) in ivec2 in_TextureOffset;
         layout(location=4) in vec2  in_BoundingBox;
         layout(location=5) in vec2  in_Bearing;
         layout(location=6) in vec4  in_Color;
@@ -262,6 +262,52 @@ namespace texting
         }
     )#";
 
+    /// @brief Text runs are laid out in pixels, their transformation and color are fetched from a uniform block.
+    inline const GLchar* gRunVertexShader = R"#(
+        #version 400
+
+        layout(location=0) in vec2 ve_Position_u;
+        layout(location=1) in vec2 ve_UV;
+
+        layout(location=2) in vec2  in_Position_p; // relative to the run origin
+        layout(location=3) in ivec2 in_TextureOffset;
+        layout(location=4) in vec2  in_BoundingBox;
+        layout(location=5) in vec2  in_Bearing;
+        layout(location=6) in uint  in_RunIndex;
+
+        struct Run
+        {
+            vec4 rows[3]; // affine transformation, applied to row vectors
+            vec4 color;
+        };
+
+        layout(std140) uniform RunBlock
+        {
+            Run u_Runs[256]; // Texting::gMaxRuns
+        };
+
+        uniform vec2 u_PixelToWorld;
+        uniform mat3 u_WorldToCamera;
+        uniform mat3 u_Projection;
+
+        out vec2  ex_TextureUV;
+        out vec4  ex_Color;
+
+        void main(void)
+        {
+            vec2 localPosition = (in_Position_p + in_Bearing + (ve_Position_u * in_BoundingBox)) * u_PixelToWorld;
+            Run run = u_Runs[in_RunIndex];
+            vec2 worldPosition = localPosition.x * run.rows[0].xy
+                               + localPosition.y * run.rows[1].xy
+                               + run.rows[2].xy;
+
+            vec3 transformed = u_Projection * u_WorldToCamera * vec3(worldPosition, 1.);
+            gl_Position = vec4(transformed.xy, 0., 1.);
+            ex_TextureUV = in_TextureOffset + (ve_UV * in_BoundingBox);
+            ex_Color = run.color;
+        }
+    )#";
+
     inline const GLchar* gGlyphFragmentShader = R"#(
         #version 400
 
@@ -277,6 +323,33 @@ namespace texting
             out_Color = ex_Color * vec4(1., 1., 1., alpha);
         }
     )#";
+
+    /// @brief Reconstructs the glyph outline from a multi-channel signed distance field atlas.
+    inline const GLchar* gMsdfFragmentShader = R"#(
+        #version 400
+
+        in vec2 ex_TextureUV;
+        in vec4 ex_Color;
+        out vec4 out_Color;
+
+        uniform sampler2DRect u_FontAtlas;
+        uniform float u_DistanceRange; // width of the distance ramp, in texels
+
+        float median(vec3 v)
+        {
+            return max(min(v.r, v.g), min(max(v.r, v.g), v.b));
+        }
+
+        void main(void)
+        {
+            float signedDistance = median(texture(u_FontAtlas, ex_TextureUV).rgb) - 0.5;
+            // Texture coordinates are in texels, so this is the count of screen pixels per texel.
+            vec2 screenTexelSize = 1. / fwidth(ex_TextureUV);
+            float screenRange = max(0.5 * dot(vec2(u_DistanceRange), screenTexelSize), 1.);
+            float alpha = clamp(signedDistance * screenRange + 0.5, 0., 1.);
+            out_Color = ex_Color * vec4(1., 1., 1., alpha);
+        }
+    )#";
 };
 
 
@@ -46,6 +46,8 @@ MAP_AND_REVERSE(MappedGL, GLint, GL_INT);
 MAP_AND_REVERSE(MappedGL, GLuint, GL_UNSIGNED_INT);
 // Only reverse is possible, because GLboolean is the same type as GLubyte
 REVERSE_MAP(MappedGL, GLboolean, GL_BOOL);
+// Only reverse is possible, because GLhalf is the same type as GLushort
+REVERSE_MAP(MappedGL, GLhalf, GL_HALF_FLOAT);
 
 
 #define TYPEENUMCASE(enumval)           \
@@ -66,6 +68,7 @@ constexpr GLuint getByteSize(GLenum aTypeEnum)
         TYPEENUMCASE(GL_INT);
         TYPEENUMCASE(GL_UNSIGNED_INT);
         TYPEENUMCASE(GL_BOOL);
+        TYPEENUMCASE(GL_HALF_FLOAT);
     default:
         throw std::domain_error{"Invalid type enumerator."};
     }
@@ -74,6 +77,15 @@ constexpr GLuint getByteSize(GLenum aTypeEnum)
 #undef TYPEENUMCASE
 
 
+/// @brief Packed types store all the components of a vertex attribute in a single 32-bit value.
+constexpr bool isPackedType(GLenum aTypeEnum)
+{
+    return aTypeEnum == GL_INT_2_10_10_10_REV
+        || aTypeEnum == GL_UNSIGNED_INT_2_10_10_10_REV
+        || aTypeEnum == GL_UNSIGNED_INT_10F_11F_11F_REV;
+}
+
+
 /// @brief Return a the string associated to a GL enumerator (the plain enumerator name).
 std::string to_string(GLenum aGLEnumerator);
 
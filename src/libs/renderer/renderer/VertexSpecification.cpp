@@ -74,6 +74,20 @@ void attachVertexBuffer(const VertexBufferObject & aVertexBuffer,
                         AttributeDescriptionList aAttributes,
                         GLsizei aStride,
                         GLuint aAttributeDivisor)
+{
+    attachVertexBuffer(aVertexBuffer,
+                       aVertexArray,
+                       std::span<const AttributeFormat>{aAttributes.begin(), aAttributes.size()},
+                       aStride,
+                       aAttributeDivisor);
+}
+
+
+void attachVertexBuffer(const VertexBufferObject & aVertexBuffer,
+                        const VertexArrayObject & aVertexArray,
+                        std::span<const AttributeFormat> aAttributes,
+                        GLsizei aStride,
+                        GLuint aAttributeDivisor)
 {
     // TODO some static assertions on the PODness of the element type
     glBindVertexArray(aVertexArray);
@@ -89,6 +103,17 @@ VertexBufferObject initVertexBuffer(const VertexArrayObject & aVertexArray,
                                     std::initializer_list<AttributeFormat> aAttributes,
                                     GLsizei aStride,
                                     GLuint aAttributeDivisor)
+{
+    return initVertexBuffer(aVertexArray,
+                            std::span<const AttributeFormat>{aAttributes.begin(), aAttributes.size()},
+                            aStride,
+                            aAttributeDivisor);
+}
+
+VertexBufferObject initVertexBuffer(const VertexArrayObject & aVertexArray,
+                                    std::span<const AttributeFormat> aAttributes,
+                                    GLsizei aStride,
+                                    GLuint aAttributeDivisor)
 {
     VertexBufferObject vbo;
     attachVertexBuffer(vbo, aVertexArray, aAttributes, aStride, aAttributeDivisor);
@@ -102,6 +127,23 @@ VertexBufferObject loadVertexBuffer(const VertexArrayObject & aVertexArray,
                                     const GLvoid * aData,
                                     BufferHint aHint,
                                     GLuint aAttributeDivisor)
+{
+    return loadVertexBuffer(aVertexArray,
+                            std::span<const AttributeFormat>{aAttributes.begin(), aAttributes.size()},
+                            aStride,
+                            aSize,
+                            aData,
+                            aHint,
+                            aAttributeDivisor);
+}
+
+VertexBufferObject loadVertexBuffer(const VertexArrayObject & aVertexArray,
+                                    std::span<const AttributeFormat> aAttributes,
+                                    GLsizei aStride,
+                                    size_t aSize,
+                                    const GLvoid * aData,
+                                    BufferHint aHint,
+                                    GLuint aAttributeDivisor)
 {
     VertexBufferObject vbo = initVertexBuffer(aVertexArray, aAttributes, aStride, aAttributeDivisor);
     // The vertex buffer is still bound from initialization
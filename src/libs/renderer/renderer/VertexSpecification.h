@@ -123,7 +123,7 @@ struct ClientAttribute
     GLenum mComponentType;   // data individual components' type.
 
     constexpr GLsizei sizeBytesFirstDimension() const
-    { return mDimension[0] * getByteSize(mComponentType); }
+    { return isPackedType(mComponentType) ? 4 : mDimension[0] * getByteSize(mComponentType); }
 
     constexpr GLsizei sizeBytes() const
     { return mDimension[1] * sizeBytesFirstDimension(); }
@@ -161,6 +161,13 @@ void attachVertexBuffer(const VertexBufferObject & aVertexBuffer,
                         GLsizei aStride,
                         GLuint aAttributeDivisor = 0);
 
+/// \brief This overload accepts attributes only known at runtime (e.g. built from a model file).
+void attachVertexBuffer(const VertexBufferObject & aVertexBuffer,
+                        const VertexArrayObject & aVertexArray,
+                        std::span<const AttributeFormat> aAttributes,
+                        GLsizei aStride,
+                        GLuint aAttributeDivisor = 0);
+
 /// \brief This overload deduces the stride from T_vertex.
 template <class T_vertex>
 void attachVertexBuffer(const VertexBufferObject & aVertexBuffer,
@@ -180,6 +187,11 @@ VertexBufferObject initVertexBuffer(const VertexArrayObject & aVertexArray,
                                     GLsizei aStride,
                                     GLuint aAttributeDivisor = 0);
 
+VertexBufferObject initVertexBuffer(const VertexArrayObject & aVertexArray,
+                                    std::span<const AttributeFormat> aAttributes,
+                                    GLsizei aStride,
+                                    GLuint aAttributeDivisor = 0);
+
 
 /// \brief This overload deduces the stride from T_vertex.
 template <class T_vertex>
@@ -207,6 +219,15 @@ VertexBufferObject loadVertexBuffer(const VertexArrayObject & aVertexArray,
                                     BufferHint aHint,
                                     GLuint aAttributeDivisor = 0);
 
+/// \brief This overload accepts attributes only known at runtime (e.g. built from a model file).
+VertexBufferObject loadVertexBuffer(const VertexArrayObject & aVertexArray,
+                                    std::span<const AttributeFormat> aAttributes,
+                                    GLsizei aStride,
+                                    size_t aSize,
+                                    const GLvoid * aData,
+                                    BufferHint aHint,
+                                    GLuint aAttributeDivisor = 0);
+
 
 // TODO Ideally, client-code could invoke the functions expecting std::span 
 // without explicitly constructing the std::span{} on call.